@@ -172,15 +172,21 @@ macro (oiio_add_all_tests)
                     nonwhole-tiles
                     oiiotool-composite
                     oiiotool-fixnan
+                    oiiotool-fuse
+                    oiiotool-parallel-frames
                     oiiotool-pattern
                     oiiotool-readerror
+                    oiiotool-stream
                     oiiotool-subimage oiiotool-text
                     diff
                     dither dup-channels
+                    idiff-quiet
                     jpeg-corrupt
+                    maketx-batch maketx-incremental
                     missingcolor
                     null
                     rational
+                    texture-batchbench
                     texture-derivs texture-fill
                     texture-flipt texture-gettexels texture-gray
                     texture-interp-bicubic
@@ -192,6 +198,7 @@ macro (oiio_add_all_tests)
                     texture-mip-trilinear
                     texture-missing
                     texture-pointsample
+                    texture-shadow
                     texture-udim texture-udim2
                     texture-uint8
                     texture-width0blur
@@ -295,6 +302,10 @@ macro (oiio_add_all_tests)
     oiio_add_tests (tiff-suite tiff-depths tiff-misc
                     IMAGEDIR libtiffpic
                     URL http://www.simplesystems.org/libtiff/images.html)
+    # Round trips through libtiff's own command line tools
+    find_program (TIFFCP_EXECUTABLE tiffcp)
+    oiio_add_tests (tiff-compress
+                    FOUNDVAR TIFFCP_EXECUTABLE)
     oiio_add_tests (webp
                     FOUNDVAR WebP_FOUND ENABLEVAR ENABLE_WebP
                     IMAGEDIR oiio-images/webp URL "Recent checkout of oiio-images")
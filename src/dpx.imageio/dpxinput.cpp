@@ -27,7 +27,7 @@ public:
     virtual const char* format_name(void) const override { return "dpx"; }
     virtual int supports(string_view feature) const override
     {
-        return (feature == "ioproxy");
+        return (feature == "ioproxy" || feature == "mmap_pixels");
     }
     virtual bool valid_file(const std::string& filename) const override;
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
@@ -40,6 +40,8 @@ public:
                                       void* data) override;
     virtual bool read_native_scanlines(int subimage, int miplevel, int ybegin,
                                        int yend, int z, void* data) override;
+    virtual const void* mapped_native_pixels(int subimage,
+                                             int miplevel) override;
     virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
     {
         m_io = ioproxy;
@@ -56,6 +58,7 @@ private:
     std::unique_ptr<Filesystem::IOProxy> m_io_local;
     Filesystem::IOProxy* m_io = nullptr;
     int64_t m_io_offset       = 0;
+    std::string m_filename;
 
     /// Reset everything to initial state
     ///
@@ -147,6 +150,7 @@ DPXInput::open(const std::string& name, ImageSpec& newspec)
         return false;
     }
     m_io_offset = m_io->tell();
+    m_filename  = name;
 
     m_stream = new InStream(m_io);
     if (!m_stream) {
@@ -638,6 +642,46 @@ DPXInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
 
 
 
+const void*
+DPXInput::mapped_native_pixels(int subimage, int miplevel)
+{
+    lock_guard lock(*this);
+    if (!seek_subimage(subimage, miplevel))
+        return nullptr;
+
+    // Only unpacked, unpadded, unencoded data whose components fill their
+    // words exactly and are already in our byte order can be used in place.
+    const dpx::Header& h(m_dpx.header);
+    if (h.ImageEncoding(subimage) != dpx::kNone
+        || h.EndOfLinePadding(subimage) != 0
+        || h.BitDepth(subimage) != 8 * m_spec.format.size()
+        || (m_spec.format.size() > 1 && h.RequiresByteSwap()))
+        return nullptr;
+    // Without raw color, only descriptors that read_native_scanlines
+    // passes through untouched may be used.
+    if (!m_rawcolor) {
+        switch (h.ImageDescriptor(subimage)) {
+        case dpx::kRed:
+        case dpx::kGreen:
+        case dpx::kBlue:
+        case dpx::kAlpha:
+        case dpx::kLuma:
+        case dpx::kDepth:
+        case dpx::kRGB:
+        case dpx::kRGBA: break;
+        default: return nullptr;
+        }
+    }
+
+    cspan<unsigned char> file = mapped_file(m_filename, m_io);
+    size_t offset             = h.DataOffset(subimage);
+    if (offset + m_spec.image_bytes() > size_t(file.size()))
+        return nullptr;
+    return file.data() + offset;
+}
+
+
+
 std::string
 DPXInput::get_characteristic_string(dpx::Characteristic c)
 {
@@ -157,6 +157,52 @@ print_subimage(ImageBuf& img0, int subimage, int miplevel)
 
 
 
+// Compare the images a band of scanlines at a time, stopping as soon as
+// there are more than maxfail failures or an error over hardfail, since
+// the comparison can only fail from there. Only nfail, nwarn, and
+// maxerror (and where it was) are computed, and they only cover the
+// bands that were compared. Comparing in bands gives the same answers as
+// comparing the whole image only while the errors are finite (compare
+// passes over the first non-finite mismatch of each call), so once a band
+// has a non-finite error, compare the whole image after all.
+static ImageBufAlgo::CompareResults
+compare_until_failure(const ImageBuf& img0, const ImageBuf& img1,
+                      float failthresh, float warnthresh, double maxfail,
+                      float hardfail)
+{
+    ImageBufAlgo::CompareResults cr;
+    cr.meanerror = cr.rms_error = cr.PSNR = cr.maxerror = 0;
+    cr.maxx = cr.maxy = cr.maxz = cr.maxc = 0;
+    cr.nwarn = cr.nfail = 0;
+    cr.error            = false;
+    ROI roi   = roi_union(get_roi(img0.spec()), get_roi(img1.spec()));
+    int bandy = std::max(1, (1 << 20) / std::max(1, roi.width() * roi.depth()));
+    for (int y = roi.ybegin; y < roi.yend; y += bandy) {
+        ROI band(roi.xbegin, roi.xend, y, std::min(y + bandy, roi.yend),
+                 roi.zbegin, roi.zend, roi.chbegin, roi.chend);
+        auto bandcr = ImageBufAlgo::compare(img0, img1, failthresh, warnthresh,
+                                            band);
+        if (!std::isfinite(bandcr.maxerror))
+            return ImageBufAlgo::compare(img0, img1, failthresh, warnthresh,
+                                         roi);
+        cr.error |= bandcr.error;
+        cr.nwarn += bandcr.nwarn;
+        cr.nfail += bandcr.nfail;
+        if (!(bandcr.maxerror <= cr.maxerror)) {
+            cr.maxerror = bandcr.maxerror;
+            cr.maxx     = bandcr.maxx;
+            cr.maxy     = bandcr.maxy;
+            cr.maxz     = bandcr.maxz;
+            cr.maxc     = bandcr.maxc;
+        }
+        if (cr.nfail > maxfail || cr.maxerror > hardfail)
+            break;
+    }
+    return cr;
+}
+
+
+
 int
 main(int argc, char* argv[])
 {
@@ -258,10 +304,16 @@ main(int argc, char* argv[])
                 npels = 1;  // Avoid divide by zero for 0x0 images
             OIIO_ASSERT(img0.spec().format == TypeFloat);
 
-            // Compare the two images.
+            // Compare the two images. If we won't be printing the
+            // statistics, we can stop as soon as we know it failed.
             //
             ImageBufAlgo::CompareResults cr;
-            ImageBufAlgo::compare(img0, img1, failthresh, warnthresh, cr);
+            if (quiet && !verbose)
+                cr = compare_until_failure(img0, img1, failthresh, warnthresh,
+                                           failpercent / 100.0 * npels,
+                                           hardfail);
+            else
+                ImageBufAlgo::compare(img0, img1, failthresh, warnthresh, cr);
 
             int yee_failures = 0;
             if (perceptual && !img0.deep()) {
@@ -21,11 +21,28 @@ OIIO_NAMESPACE_BEGIN
 /// (amongst other places)
 class OIIO_API ColorProcessor {
 public:
-    ColorProcessor() {};
-    virtual ~ColorProcessor(void) {};
+    ColorProcessor();
+    virtual ~ColorProcessor(void);
     virtual bool isNoOp() const { return false; }
     virtual bool hasChannelCrosstalk() const { return false; }
 
+    // For a processor without channel crosstalk, return a table holding
+    // the result of apply() for every code value of the given 8 or 16 bit
+    // integer format, 4 floats (one per channel) per code value. It's
+    // baked on first use and kept with the processor. Return nullptr for
+    // other formats, or if the processor has channel crosstalk.
+    const float* lut1d(TypeDesc format) const;
+
+    // Return a processor that approximates this one by a 3D LUT with size
+    // samples along each axis, applied with tetrahedral interpolation.
+    // If range > 1, a log shaper spreads the samples over input values
+    // [0,range] (for HDR images); otherwise the LUT covers [0,1]. Inputs
+    // outside the LUT's domain are clamped to it. The baked processor is
+    // kept with this one, so asking again for the same size and range is
+    // cheap.
+    std::shared_ptr<ColorProcessor> bake3d(int size = 33,
+                                           float range = 1.0f) const;
+
     // Convert an array/image of color values. The strides are the distance,
     // in bytes, between subsequent color channels, pixels, and scanlines.
     virtual void apply(float* data, int width, int height, int channels,
@@ -37,6 +54,10 @@ public:
         apply((float*)data, 1, 1, 3, sizeof(float), 3 * sizeof(float),
               3 * sizeof(float));
     }
+
+private:
+    struct BakedLUTs;
+    std::unique_ptr<BakedLUTs> m_baked;
 };
 
 // Preprocessor symbol to allow conditional compilation depending on
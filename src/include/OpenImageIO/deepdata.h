@@ -105,7 +105,13 @@ public:
     void set_all_samples(cspan<unsigned int> samples);
 
     /// Set the capacity of samples for the given pixel. This must be called
-    /// after init().
+    /// after init(). Once the sample data is allocated, growing a pixel's
+    /// capacity only moves samples within the pixel's own block of
+    /// pixels: one scanline when initialized from an `ImageSpec`, or 1024
+    /// consecutive pixels when initialized with `init(npix, ...)`. Only
+    /// the `ImageSpec` form makes it safe for threads to grow pixels of
+    /// different scanlines concurrently; with the other form, concurrent
+    /// growth is safe only for pixels in different 1024-pixel blocks.
     void set_capacity(int64_t pixel, int samps);
 
     /// Retrieve the capacity (number of allocated samples) for the given
@@ -145,6 +151,12 @@ public:
 
     cspan<TypeDesc> all_channeltypes() const;
     cspan<unsigned int> all_samples() const;
+    /// Retrieve all the sample data as one contiguous span, each pixel
+    /// taking up its capacity, in pixel order. This is a copy gathered
+    /// from the per-scanline storage, so it does not move the samples or
+    /// invalidate pointers from data_ptr, but it does not reflect later
+    /// changes to the samples. The span is reused by the next call to
+    /// all_data() (from any thread), which overwrites it.
     cspan<char> all_data() const;
 
     /// Fill in the vector with pointers to the start of the first
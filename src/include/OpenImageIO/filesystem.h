@@ -331,6 +331,43 @@ OIIO_UTIL_API bool scan_for_matching_filenames (const std::string &pattern,
 
 
 
+/// Memory mapping of an entire file. The pages are brought in by the OS
+/// on demand, so mapping a file and touching only part of it costs no
+/// more than reading that part. The mapping is private and copy-on-write:
+/// the memory may be modified, but changes are never written back to the
+/// file. The mapping is released when the MappedFile is closed or
+/// destroyed.
+class OIIO_UTIL_API MappedFile {
+public:
+    MappedFile () {}
+    MappedFile (string_view filename) { open (filename); }
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+    ~MappedFile () { close (); }
+
+    /// Map the named file, first closing any file that was already
+    /// mapped. Return true on success, false if the file could not be
+    /// opened or mapped (including if it is empty).
+    bool open (string_view filename);
+
+    /// Release the mapping, if any.
+    void close ();
+
+    bool is_open () const { return m_data != nullptr; }
+    const unsigned char* data () const { return m_data; }
+    size_t size () const { return m_size; }
+    cspan<unsigned char> buffer () const {
+        return cspan<unsigned char>(m_data, oiio_span_size_type(m_size));
+    }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    void* m_handle = nullptr;   // Windows file mapping handle
+};
+
+
+
 /// Proxy class for I/O. This provides a simplified interface for file I/O
 /// that can have custom overrides.
 class OIIO_UTIL_API IOProxy {
@@ -476,6 +513,22 @@ protected:
     cspan<unsigned char> m_buf;
 };
 
+
+
+/// IOProxy subclass for reading that memory-maps the named file and then
+/// behaves as an IOMemReader over the mapping. Readers that recognize an
+/// IOMemReader may hand out pointers directly into the mapped file rather
+/// than copying from it (see `ImageInput::mapped_native_pixels()`).
+class OIIO_UTIL_API IOMemMapped : public IOMemReader {
+public:
+    IOMemMapped(string_view filename);
+    virtual const char* proxytype() const { return "memmapped"; }
+    virtual void close();
+
+protected:
+    MappedFile m_file;
+};
+
 };  // namespace Filesystem
 
 OIIO_NAMESPACE_END
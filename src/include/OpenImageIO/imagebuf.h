@@ -182,7 +182,14 @@ public:
     /// @param config
     ///             Optionally, a pointer to an ImageSpec whose metadata
     ///             contains configuration hints that set options related
-    ///             to the opening and reading of the file.
+    ///             to the opening and reading of the file. A nonzero int
+    ///             hint `"oiio:mmap_pixels"` asks that, when the file's
+    ///             native pixels are read and the reader can provide
+    ///             them in place (see `ImageInput::mapped_native_pixels()`),
+    ///             the ImageBuf wrap a memory mapping of the file as an
+    ///             `APPBUFFER` rather than copy the pixels. The file
+    ///             should then not be overwritten while the ImageBuf
+    ///             refers to it.
     /// @param ioproxy
     ///         Optional pointer to an IOProxy to use when reading from the
     ///         file. The caller retains ownership of the proxy.
@@ -1932,6 +1932,14 @@ enum MakeTextureMode {
 ///                                  output file doesn't already exist, or is
 ///                                  older than the input file, or was created
 ///                                  with different command-line arguments. (0)
+///    - `maketx:incremental` (int) : If nonzero, store per-block hashes of
+///                                  the top level in the texture, and when
+///                                  rewriting an existing texture made with
+///                                  the same settings, skip the write if no
+///                                  pixels changed, or (for box-filtered
+///                                  MIP-maps) recompute only the parts of
+///                                  each MIP level that depend on changed
+///                                  blocks. (0)
 ///    - `maketx:constant_color_detect` (int) :
 ///                           If nonzero, detect images that are entirely
 ///                           one color, and change them to be low
@@ -210,6 +210,40 @@ public:
     ///           enabled, this reduces the number of file opens, at the
     ///           expense of not being able to open files if their format do
     ///           not actually match their filename extension). Default: 0
+    /// - `int prefetch_threads` :
+    ///           The number of background threads used to service
+    ///           `prefetch()` requests and read-ahead. If 0, prefetch
+    ///           requests are carried out immediately by the calling
+    ///           thread. (Default: 2)
+    /// - `int readahead` :
+    ///           When nonzero, every time a tile must be read from disk
+    ///           because it was not found in the cache, the tiles within
+    ///           this many tiles of it (in x and y, at the same MIP level)
+    ///           are also queued for asynchronous reading. An individual
+    ///           file may override this with an `int imagecache:readahead`
+    ///           hint in the `config` passed to `add_file()`. (Default: 0)
+    /// - `int tile_cache_shards` :
+    ///           The number of independent shards the tile cache is split
+    ///           into for the purpose of enforcing `max_memory_MB`. Each
+    ///           shard gets an equal slice of the memory budget, its own
+    ///           "clock hand" and its own eviction lock, so that many
+    ///           threads can free tiles concurrently instead of waiting on
+    ///           one another. The value is rounded down to a power of 2 and
+    ///           clamped to [1,128]. Values larger than 1 are helpful for
+    ///           applications with very many threads that keep the cache
+    ///           full. (Default: 1)
+    /// - `string disk_cache` :
+    ///           When set to the path of a directory, tiles read from
+    ///           textures that carry a SHA-1 fingerprint (as written by
+    ///           `maketx`, the same one used for `deduplicate`) are also
+    ///           stored there, already decoded, in a form that can later be
+    ///           mapped straight back into memory. When such a tile is
+    ///           evicted or needed again by another process, it is paged
+    ///           back in from this cache instead of being decompressed
+    ///           again. The directory may be shared by many processes. It
+    ///           is never pruned by OIIO, so it should be on local scratch
+    ///           disk that is cleaned up externally. The default is the
+    ///           empty string, which disables the disk cache.
     ///
     /// - `string options`
     ///           This catch-all is simply a comma-separated list of
@@ -247,6 +281,21 @@ public:
     ///           query), and the peak number of tiles in memory at any
     ///           time.
     ///
+    /// - `int64 stat:tiles_evicted` :
+    ///           Total number of tiles freed to enforce the memory limit.
+    ///
+    /// - `int64 stat:prefetch_tiles_queued` ,
+    ///   `int64 stat:prefetch_tiles_read` :
+    ///           Number of tile reads queued by `prefetch()` or read-ahead,
+    ///           and how many of those actually needed to be read from disk
+    ///           (the others were already in cache by the time they ran).
+    ///
+    /// - `int64 stat:disk_cache_hits` ,
+    ///   `int64 stat:disk_cache_misses` ,
+    ///   `int64 stat:disk_cache_writes` :
+    ///           Number of tiles found in, not found in, and written to the
+    ///           `disk_cache` directory.
+    ///
     /// - `int stat:open_files_created` ,
     ///   `int stat:open_files_current` ,
     ///   `int stat:open_files_peak` :
@@ -843,6 +892,33 @@ public:
     /// `close()` all files known to the cache.
     virtual void close_all () = 0;
 
+    /// Asynchronously read into the cache all the tiles of the given
+    /// subimage and MIP level that overlap `roi` (only the spatial extent
+    /// of `roi` is used; the default of `ROI::All()` means the whole data
+    /// window). The reads are carried out by a pool of background threads
+    /// (see the `prefetch_threads` attribute), so this returns right away,
+    /// and a later lookup of those pixels will find them in the cache
+    /// rather than stalling on disk I/O. The optional `cache_chbegin` and
+    /// `cache_chend` have the same meaning as for `get_pixels()`.
+    ///
+    /// Prefetched tiles are subject to the usual memory limit, so asking
+    /// for more than fits in the cache is counterproductive. Return true if
+    /// the request was accepted, false if the file, subimage, or MIP level
+    /// could not be found or is not valid.
+    virtual bool prefetch (ustring filename, int subimage, int miplevel,
+                           ROI roi = ROI::All(),
+                           int cache_chbegin = 0, int cache_chend = -1) = 0;
+    /// A slightly more efficient variety of `prefetch()` for cases where
+    /// you can use an `ImageHandle*` to specify the image and optionally
+    /// have a `Perthread*` for the calling thread.
+    virtual bool prefetch (ImageHandle *file, Perthread *thread_info,
+                           int subimage, int miplevel, ROI roi = ROI::All(),
+                           int cache_chbegin = 0, int cache_chend = -1) = 0;
+
+    /// Block until all tile reads queued by `prefetch()` (or by read-ahead)
+    /// have completed.
+    virtual void prefetch_wait () = 0;
+
     /// An opaque data type that allows us to have a pointer to a tile but
     /// without exposing any internals.
     class Tile;
@@ -960,6 +1036,79 @@ public:
     /// more and more esoteric information.
     virtual std::string getstats(int level = 1) const = 0;
 
+    /// Per-file counters, as reported by `get_stats()`.
+    struct FileStats {
+        ustring filename;
+        long long times_opened         = 0;      ///< Separate opens of the file
+        long long tiles_read           = 0;      ///< Tiles read from the file
+        long long bytes_read           = 0;      ///< Bytes read from the file
+        long long redundant_tiles      = 0;      ///< Tiles read more than once
+        long long redundant_bytes_read = 0;
+        double io_time                 = 0;      ///< Seconds spent reading it
+        bool broken                    = false;  ///< The file could not be read
+    };
+
+    /// A structured snapshot of the ImageCache statistics, filled in by
+    /// `get_stats()`. Times are in seconds, summed over all threads.
+    struct Stats {
+        long long find_tile_calls     = 0;  ///< Tile lookups
+        long long microcache_misses   = 0;  ///< ... missing the per-thread
+                                            ///<     microcache
+        long long cache_misses        = 0;  ///< ... requiring a tile read
+        long long tiles_created       = 0;
+        long long tiles_current       = 0;
+        long long tiles_peak          = 0;
+        long long tiles_evicted       = 0;  ///< Tiles freed to stay in budget
+        long long bytes_evicted       = 0;
+        long long cache_memory_used   = 0;  ///< Bytes of tiles held now
+        long long bytes_read          = 0;  ///< Bytes read from image files
+        long long open_files_created  = 0;
+        long long open_files_current  = 0;
+        long long open_files_peak     = 0;
+        long long unique_files        = 0;
+        long long disk_cache_hits     = 0;
+        long long disk_cache_misses   = 0;
+        long long disk_cache_writes   = 0;
+        long long texture_queries     = 0;  ///< TextureSystem lookups made
+        long long texture3d_queries   = 0;  ///<   through this cache
+        long long shadow_queries      = 0;
+        long long environment_queries = 0;
+        double fileio_time            = 0;
+        double fileopen_time          = 0;
+        double file_locking_time      = 0;
+        double tile_locking_time      = 0;
+        double find_file_time         = 0;
+        double find_tile_time         = 0;
+        std::vector<FileStats> files;       ///< Only if asked for per_file
+
+        /// Fraction of tile lookups that did not need to read a tile.
+        double hit_rate() const
+        {
+            if (!find_tile_calls)
+                return 1.0;
+            return 1.0 - double(cache_misses) / double(find_tile_calls);
+        }
+        /// Fraction of tile lookups satisfied by the microcache.
+        double microcache_hit_rate() const
+        {
+            if (!find_tile_calls)
+                return 1.0;
+            return 1.0 - double(microcache_misses) / double(find_tile_calls);
+        }
+    };
+
+    /// Fill in `stats` with a snapshot of the statistics gathered so far,
+    /// and if `per_file` is true, the counters of every file the cache
+    /// has seen. Unlike `getstats()`, nothing is formatted. The snapshot
+    /// briefly holds the lock guarding the list of per-thread records
+    /// while it sums their counters; lookups only need that lock when a
+    /// thread first uses the cache or after a microcache purge, so
+    /// polling periodically for live monitoring is cheap, but the call is
+    /// not lock-free. The per-file pass also briefly locks each part of
+    /// the file table in turn. Because threads keep counting while the
+    /// snapshot is taken, related counters may be a few updates apart.
+    virtual void get_stats(Stats& stats, bool per_file = false) const = 0;
+
     /// Reset most statistics to be as they were with a fresh ImageCache.
     /// Caveat emptor: this does not flush the cache itelf, so the resulting
     /// statistics from the next set of texture requests will not match the
@@ -953,6 +953,11 @@ public:
     /// - `"ioproxy"` :
     ///       Does this format reader support reading from an `IOProxy`?
     ///
+    /// - `"mmap_pixels"` :
+    ///       Can this format reader return a pointer directly into a memory
+    ///       mapping of the file for uncompressed native pixels (see
+    ///       `mapped_native_pixels()`)?
+    ///
     /// This list of queries may be extended in future releases. Since this
     /// can be done simply by recognizing new query strings, and does not
     /// require any new API entry points, addition of support for new
@@ -1545,6 +1550,23 @@ public:
                                     int xbegin, int xend, int ybegin, int yend,
                                     int zbegin, int zend,
                                     int chbegin, int chend, void *data);
+
+    /// For readers that `supports("mmap_pixels")`, return a pointer to the
+    /// native pixels of the whole subimage and MIP level, laid out exactly
+    /// as `read_native_scanlines()` would deliver them for all scanlines
+    /// and channels, but residing in a memory mapping of the file (or in
+    /// the buffer of an `IOMemReader` proxy) so that nothing is copied.
+    /// The mapping is copy-on-write, so the memory may be modified
+    /// without altering the file. The pointer remains valid until the
+    /// ImageInput is destroyed.
+    ///
+    /// @returns
+    ///         The pointer to the pixels, or `nullptr` if the pixels of
+    ///         this subimage are not stored in the file in their native
+    ///         layout (for example, if they are compressed, tiled, padded,
+    ///         or of the opposite byte order), or if the file could not be
+    ///         mapped. Callers should then fall back to reading the pixels.
+    virtual const void* mapped_native_pixels (int subimage, int miplevel);
     /// @}
 
 
@@ -1658,6 +1680,14 @@ protected:
     ImageSpec m_spec;  // format spec of the current open subimage/MIPlevel
                        // BEWARE using m_spec directly -- not thread-safe
 
+    // Helper for readers implementing mapped_native_pixels(): return the
+    // bytes of the whole file, either the buffer of `io` if it is an
+    // IOMemReader, or else a mapping of the named file that is held until
+    // this ImageInput is destroyed. An empty span means that the file
+    // could not be mapped (or that `io` is some other custom proxy).
+    cspan<unsigned char> mapped_file (const std::string& filename,
+                                      Filesystem::IOProxy* io = nullptr);
+
 private:
     // PIMPL idiom -- this lets us hide details of the internals of the
     // ImageInput parent class so that changing them does not break the
@@ -2427,6 +2457,12 @@ OIIO_API std::string geterror(bool clear = true);
 ///    many threads as the amount of hardware concurrency detected. Note
 ///    that this is separate from the OIIO `"threads"` attribute.
 ///
+///    When OIIO is built to read OpenEXR with its C "core" library
+///    (`OIIO_USE_EXR_C_API`), chunks are instead decoded in parallel on the
+///    OIIO thread pool, using this many threads (0 means as many as OIIO
+///    uses, -1 means single-threaded) unless the ImageInput's own
+///    `threads()` was set.
+///
 /// - `string plugin_searchpath`
 ///
 ///    Colon-separated list of directories to search for dynamically-loaded
@@ -2477,6 +2513,30 @@ OIIO_API std::string geterror(bool clear = true);
 ///    may not read these correctly, but OIIO will. That's why the default
 ///    is not to support it.
 ///
+/// - `int imagebufalgo:convolve_fft_threshold`
+///
+///    `ImageBufAlgo::convolve()` applies separable kernels as two 1D
+///    passes. Other 2D kernels with at least this many taps (width times
+///    height) are applied by multiplication in the frequency domain, which
+///    is much faster for large kernels. A value of 0 disables the FFT path
+///    and always convolves directly. The default is 121 (i.e., an 11x11
+///    kernel).
+///
+/// - `int imagebufalgo:colorconvert_lut3d`
+///
+///    When nonzero, `ImageBufAlgo::colorconvert()` (and the functions built
+///    on it, such as `ociodisplay()` and `ociolook()`) approximate each
+///    color transform by a baked 3D LUT with this many samples per axis,
+///    applied with tetrahedral interpolation, which is much cheaper than a
+///    complex OCIO transform but not exact. The default is 0 (exact).
+///
+/// - `float imagebufalgo:colorconvert_lut3d_range`
+///
+///    The largest input value the baked 3D LUT covers. If greater than
+///    1.0, the LUT axes use a log shaper so that HDR values are sampled
+///    sensibly. The default is 1.0 (a LUT over [0,1], suitable for
+///    display-referred inputs).
+///
 /// - `int log_times`
 ///
 ///    When the `"log_times"` attribute is nonzero, `ImageBufAlgo` functions
@@ -2672,6 +2732,10 @@ get_extension_map()
 /// If you want a straight C-like data cast convertion (e.g., uint8 255 ->
 /// float 255.0), then you should prefer the un-normalized convert_type()
 /// utility function found in typedesc.h.
+///
+/// Conversions among the small pixel types may take a SIMD path whose
+/// integer results can differ by 1 LSB from converting one value at a
+/// time with convert_type(); floating point results are always the same.
 OIIO_API bool convert_pixel_values (TypeDesc src_type, const void *src,
                                     TypeDesc dst_type, void *dst, int n = 1);
 
@@ -237,8 +237,8 @@ public:
     float fill;                 ///< Fill value for missing channels
     const float* missingcolor;  ///< Color for missing texture
     float time;                 ///< Time (for time-dependent texture lookups)
-    float bias;                 ///< Bias for shadows
-    int samples;                ///< Number of samples for shadows
+    float bias;                 ///< Depth bias for shadows
+    int samples;                ///< Number of PCF samples for shadows
 
     // For 3D volume texture lookups only:
     Wrap rwrap;    ///< Wrap mode in the r direction
@@ -305,6 +305,8 @@ public:
     int conservative_filter = 1;          ///< True: over-blur rather than alias
     float fill = 0.0f;                    ///< Fill value for missing channels
     const float *missingcolor = nullptr;  ///< Color for missing texture
+    float bias = 0.0f;                    ///< Depth bias for shadows
+    int samples = 1;                      ///< Number of samples for shadows
 
 private:
     // Options set INTERNALLY by libtexture after the options are passed
@@ -959,6 +961,17 @@ public:
 
     // Retrieve a shadow lookup for a single position P.
     //
+    // The shadow map is a 1-channel depth texture (as made by
+    // make_texture() in MakeShadow mode) whose metadata holds the
+    // light's "worldtoNDC" or "worldtoscreen" matrix and, optionally,
+    // the "worldtocamera" matrix whose z is the stored depth. P is
+    // projected into the map, and the depth texels under the filter
+    // footprint implied by dPdx, dPdy, swidth/twidth and sblur/tblur
+    // are compared against P's depth less `options.bias`, using
+    // `options.samples` percentage-closer filtered taps. result[0]
+    // receives the occluded fraction: 0 is fully lit, 1 fully in
+    // shadow. Points outside the map or behind the light are lit.
+    //
     // Return true if the file is found and could be opened by an
     // available ImageIO plugin, otherwise return false.
     virtual bool shadow (ustring filename, TextureOpt &options,
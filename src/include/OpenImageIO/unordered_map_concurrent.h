@@ -249,6 +249,10 @@ public:
             return (m_biniterator != m_umc->m_bins[m_bin].map.end());
         }
 
+        /// Return the index of the bin the iterator points into, or -1 if
+        /// it points to nothing.
+        int bin() const { return m_bin; }
+
     private:
         // No longer refer to a particular bin, release lock on the bin
         // it had (if any).
@@ -280,10 +284,17 @@ public:
 
 
     /// Return an interator pointing to the first entry in the map.
-    iterator begin()
+    iterator begin() { return begin(0); }
+
+    /// Return an iterator pointing to the first entry in the map that is
+    /// in bin `firstbin` or any bin after it. This allows a caller to walk
+    /// just a subrange of the bins.
+    iterator begin(size_t firstbin)
     {
         iterator i(this);
-        i.rebin(0);
+        if (firstbin >= BINS)
+            return i;
+        i.rebin(int(firstbin));
         while (i.m_biniterator == m_bins[i.m_bin].map.end()) {
             if (i.m_bin == BINS - 1) {
                 // ran off the end
@@ -482,6 +493,13 @@ public:
     /// holds the lock).
     void unlock_bin(size_t bin) { m_bins[bin].unlock(); }
 
+    /// Return the bin number that the key will always appear in, without
+    /// locking anything.
+    size_t bin_for(const KEY& key) { return whichbin(m_hash(key)); }
+
+    /// Return the total number of bins.
+    static constexpr size_t nbins() { return BINS; }
+
     // Return a mask that is 1 for bits of the hash that are not used to
     // determine the bin number.
     static constexpr size_t nobin_mask() { return ~size_t(0) >> log2(BINS); }
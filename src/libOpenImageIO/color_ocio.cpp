@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -649,6 +651,60 @@ ColorConfig::configname() const
 
 
 
+struct ColorProcessor::BakedLUTs {
+    std::mutex mutex;
+    std::vector<float> lut8, lut16;
+    std::map<std::pair<int, float>, ColorProcessorHandle> lut3d;
+};
+
+
+
+ColorProcessor::ColorProcessor()
+    : m_baked(new BakedLUTs)
+{
+}
+
+
+
+ColorProcessor::~ColorProcessor() {}
+
+
+
+const float*
+ColorProcessor::lut1d(TypeDesc format) const
+{
+    if ((format != TypeDesc::UINT8 && format != TypeDesc::UINT16)
+        || hasChannelCrosstalk())
+        return nullptr;
+    std::lock_guard<std::mutex> lock(m_baked->mutex);
+    std::vector<float>& lut(format == TypeDesc::UINT8 ? m_baked->lut8
+                                                      : m_baked->lut16);
+    if (lut.empty()) {
+        // Run every code value through the processor as an RGBA pixel
+        // with all four channels equal to it. Converting the code values
+        // the same way the un-baked path does makes the table exact.
+        int n = format == TypeDesc::UINT8 ? 256 : 65536;
+        std::vector<uint16_t> codes(4 * n);
+        for (int v = 0; v < n; ++v)
+            codes[4 * v] = codes[4 * v + 1] = codes[4 * v + 2]
+                = codes[4 * v + 3]          = uint16_t(v);
+        lut.resize(4 * n);
+        if (format == TypeDesc::UINT8) {
+            std::vector<uint8_t> codes8(codes.begin(), codes.end());
+            convert_pixel_values(format, codes8.data(), TypeDesc::FLOAT,
+                                 lut.data(), 4 * n);
+        } else {
+            convert_pixel_values(format, codes.data(), TypeDesc::FLOAT,
+                                 lut.data(), 4 * n);
+        }
+        apply(lut.data(), n, 1, 4, sizeof(float), 4 * sizeof(float),
+              4 * n * sizeof(float));
+    }
+    return lut.data();
+}
+
+
+
 #ifdef USE_OCIO
 
 #    if OCIO_VERSION_HEX >= 0x02000000
@@ -883,6 +939,150 @@ private:
 };
 
 
+// ColorProcessor that approximates another one with a baked 3D LUT,
+// applied with tetrahedral interpolation. With range > 1, the LUT axes go
+// through a log shaper spanning [0,range], so the lattice nodes are spread
+// sensibly over HDR values; otherwise the LUT covers [0,1]. Inputs outside
+// the domain are clamped to it. Only the first 3 channels are altered.
+class ColorProcessor_LUT3D final : public ColorProcessor {
+public:
+    ColorProcessor_LUT3D(const ColorProcessor& processor, int size,
+                         float range)
+        : ColorProcessor()
+        , m_size(size)
+        , m_range(range)
+    {
+        int n = size * size * size;
+        // Sample the processor at every lattice node, red varying fastest.
+        std::vector<float> rgb(3 * n);
+        float* p = rgb.data();
+        for (int b = 0; b < size; ++b)
+            for (int g = 0; g < size; ++g)
+                for (int r = 0; r < size; ++r, p += 3) {
+                    p[0] = unshape(float(r) / (size - 1));
+                    p[1] = unshape(float(g) / (size - 1));
+                    p[2] = unshape(float(b) / (size - 1));
+                }
+        processor.apply(rgb.data(), n, 1, 3, sizeof(float), 3 * sizeof(float),
+                        n * 3 * sizeof(float));
+        m_lut.resize(n);
+        for (int i = 0; i < n; ++i)
+            m_lut[i] = simd::vfloat4(rgb[3 * i], rgb[3 * i + 1],
+                                     rgb[3 * i + 2], 0.0f);
+    }
+    ~ColorProcessor_LUT3D() {}
+
+    virtual bool hasChannelCrosstalk() const { return true; }
+    virtual void apply(float* data, int width, int height, int channels,
+                       stride_t chanstride, stride_t xstride,
+                       stride_t ystride) const
+    {
+        using namespace simd;
+        if (channels >= 3 && chanstride == sizeof(float)) {
+            for (int y = 0; y < height; ++y) {
+                char* d = (char*)data + y * ystride;
+                for (int x = 0; x < width; ++x, d += xstride) {
+                    vfloat4 color;
+                    color.load((float*)d, 3);
+                    lookup(color).store((float*)d, 3);
+                }
+            }
+        } else {
+            channels = std::min(channels, 3);
+            for (int y = 0; y < height; ++y) {
+                char* d = (char*)data + y * ystride;
+                for (int x = 0; x < width; ++x, d += xstride) {
+                    vfloat4 color(0.0f);
+                    char* dc = d;
+                    for (int c = 0; c < channels; ++c, dc += chanstride)
+                        color[c] = *(float*)dc;
+                    vfloat4 xcolor = lookup(color);
+                    dc             = d;
+                    for (int c = 0; c < channels; ++c, dc += chanstride)
+                        *(float*)dc = xcolor[c];
+                }
+            }
+        }
+    }
+
+private:
+    int m_size;
+    float m_range;
+    std::vector<simd::vfloat4> m_lut;
+
+    // The shaper maps [0,range] to [0,1] by log2(1 + k*x) / log2(1 + k*range),
+    // which is nearly linear for small values and logarithmic above.
+    static constexpr float shaper_k = 64.0f;
+    float unshape(float t) const
+    {
+        if (m_range <= 1.0f)
+            return t;
+        return (std::exp2(t * std::log2(1.0f + shaper_k * m_range)) - 1.0f)
+               / shaper_k;
+    }
+    simd::vfloat4 shape(const simd::vfloat4& x) const
+    {
+        using namespace simd;
+        if (m_range <= 1.0f)
+            return x;
+        vfloat4 v = max(x, vfloat4::Zero()) * shaper_k + vfloat4::One();
+        return fast_log2(v) / std::log2(1.0f + shaper_k * m_range);
+    }
+
+    simd::vfloat4 lookup(const simd::vfloat4& color) const
+    {
+        using namespace simd;
+        const int N = m_size;
+        // Send NaN to 0 before anything else. The SSE max() already does
+        // that, but the scalar fallback of max() passes NaN through, and
+        // ifloor of NaN is undefined.
+        vfloat4 c = select(color == color, color, vfloat4::Zero());
+        vfloat4 t = clamp(shape(c), vfloat4::Zero(), vfloat4::One())
+                    * float(N - 1);
+        vint4 i   = min(ifloor(t), vint4(N - 2));
+        vfloat4 f = t - vfloat4(i);
+        float fr = f[0], fg = f[1], fb = f[2];
+        const int dg = N, db = N * N;
+        const vfloat4* c000 = &m_lut[i[2] * db + i[1] * dg + i[0]];
+        const vfloat4& c111(c000[1 + dg + db]);
+        // Pick which of the 6 tetrahedra of the cell holds the point, and
+        // blend its 4 corners.
+        if (fr >= fg) {
+            if (fg >= fb)
+                return (1.0f - fr) * c000[0] + (fr - fg) * c000[1]
+                       + (fg - fb) * c000[1 + dg] + fb * c111;
+            if (fr >= fb)
+                return (1.0f - fr) * c000[0] + (fr - fb) * c000[1]
+                       + (fb - fg) * c000[1 + db] + fg * c111;
+            return (1.0f - fb) * c000[0] + (fb - fr) * c000[db]
+                   + (fr - fg) * c000[1 + db] + fg * c111;
+        }
+        if (fb >= fg)
+            return (1.0f - fb) * c000[0] + (fb - fg) * c000[db]
+                   + (fg - fr) * c000[dg + db] + fr * c111;
+        if (fb >= fr)
+            return (1.0f - fg) * c000[0] + (fg - fb) * c000[dg]
+                   + (fb - fr) * c000[dg + db] + fr * c111;
+        return (1.0f - fg) * c000[0] + (fg - fr) * c000[dg]
+               + (fr - fb) * c000[1 + dg] + fb * c111;
+    }
+};
+
+
+
+ColorProcessorHandle
+ColorProcessor::bake3d(int size, float range) const
+{
+    size = OIIO::clamp(size, 2, 129);
+    std::lock_guard<std::mutex> lock(m_baked->mutex);
+    ColorProcessorHandle& baked(m_baked->lut3d[std::make_pair(size, range)]);
+    if (!baked)
+        baked = std::make_shared<ColorProcessor_LUT3D>(*this, size, range);
+    return baked;
+}
+
+
+
 // ColorProcessor that does nothing (identity transform)
 class ColorProcessor_Ident final : public ColorProcessor {
 public:
@@ -912,6 +1112,7 @@ public:
     }
     ~ColorProcessor_Matrix() {}
 
+    virtual bool hasChannelCrosstalk() const { return true; }
     virtual void apply(float* data, int width, int height, int channels,
                        stride_t chanstride, stride_t xstride,
                        stride_t ystride) const
@@ -1602,61 +1803,83 @@ colorconvert_impl(ImageBuf& R, const ImageBuf& A,
 
 
 // Specialized version where both buffers are in memory (not cache based),
-// float data, and we are dealing with 4 channels.
+// with contiguous 3 or 4 channel pixels, so each scanline can be loaded,
+// transformed, and stored in one pass with bulk format conversions rather
+// than per-pixel iterator access. If lut is not null, it's the processor
+// baked for every code value of A's integer format (see
+// ColorProcessor::lut1d), and a lookup replaces the load and apply.
 static bool
-colorconvert_impl_float_rgba(ImageBuf& R, const ImageBuf& A,
-                             const ColorProcessor* processor, bool unpremult,
-                             ROI roi, int nthreads)
+colorconvert_impl_local(ImageBuf& R, const ImageBuf& A,
+                        const ColorProcessor* processor, bool unpremult,
+                        const float* lut, ROI roi, int nthreads)
 {
     using namespace ImageBufAlgo;
     using namespace simd;
+    const int nchannels = A.nchannels();
     OIIO_ASSERT(R.localpixels() && A.localpixels()
-                && R.spec().format == TypeFloat && A.spec().format == TypeFloat
-                && R.nchannels() == 4 && A.nchannels() == 4);
+                && (nchannels == 3 || nchannels == 4)
+                && R.nchannels() == nchannels);
+    if (nchannels < 4)
+        unpremult = false;
+    const TypeDesc Aformat = A.spec().format, Rformat = R.spec().format;
     parallel_image(roi, parallel_image_options(nthreads), [&](ROI roi) {
         int width = roi.width();
-        // Temporary space to hold one RGBA scanline
+        int nvals = width * nchannels;
+        // Temporary space to hold one scanline as float
         vfloat4* scanline;
         OIIO_ALLOCATE_STACK_OR_HEAP(scanline, vfloat4, width);
+        float* vals = (float*)scanline;
         float* alpha;
         OIIO_ALLOCATE_STACK_OR_HEAP(alpha, float, width);
         const float fltmin = std::numeric_limits<float>::min();
         for (int k = roi.zbegin; k < roi.zend; ++k) {
             for (int j = roi.ybegin; j < roi.yend; ++j) {
-                // Load the scanline
-                memcpy((void*)scanline, A.pixeladdr(roi.xbegin, j, k),
-                       width * 4 * sizeof(float));
-                // Optionally unpremult
-                if (unpremult) {
-                    for (int i = 0; i < width; ++i) {
-                        vfloat4 p(scanline[i]);
-                        float a  = extract<3>(p);
-                        alpha[i] = a;
-                        a        = a >= fltmin ? a : 1.0f;
-                        if (a == 1.0f)
-                            scanline[i] = p;
-                        else
-                            scanline[i] = p / vfloat4(a, a, a, 1.0f);
+                const void* a = A.pixeladdr(roi.xbegin, j, k);
+                if (lut && Aformat == TypeDesc::UINT8) {
+                    const uint8_t* in = (const uint8_t*)a;
+                    for (int i = 0; i < nvals; i += nchannels)
+                        for (int c = 0; c < nchannels; ++c)
+                            vals[i + c] = lut[4 * in[i + c] + c];
+                } else if (lut) {
+                    const uint16_t* in = (const uint16_t*)a;
+                    for (int i = 0; i < nvals; i += nchannels)
+                        for (int c = 0; c < nchannels; ++c)
+                            vals[i + c] = lut[4 * in[i + c] + c];
+                } else {
+                    // Load the scanline
+                    convert_pixel_values(Aformat, a, TypeDesc::FLOAT, vals,
+                                         nvals);
+                    // Optionally unpremult
+                    if (unpremult) {
+                        for (int i = 0; i < width; ++i) {
+                            vfloat4 p(scanline[i]);
+                            float a  = extract<3>(p);
+                            alpha[i] = a;
+                            a        = a >= fltmin ? a : 1.0f;
+                            if (a != 1.0f)
+                                scanline[i] = p / vfloat4(a, a, a, 1.0f);
+                        }
                     }
-                }
 
-                // Apply the color transformation in place
-                processor->apply((float*)&scanline[0], width, 1, 4,
-                                 sizeof(float), 4 * sizeof(float),
-                                 width * 4 * sizeof(float));
-
-                // Optionally premult
-                if (unpremult) {
-                    for (int i = 0; i < width; ++i) {
-                        vfloat4 p(scanline[i]);
-                        float a = alpha[i];
-                        a       = a >= fltmin ? a : 1.0f;
-                        p *= vfloat4(a, a, a, 1.0f);
-                        scanline[i] = p;
+                    // Apply the color transformation in place
+                    processor->apply(vals, width, 1, nchannels, sizeof(float),
+                                     nchannels * sizeof(float),
+                                     nvals * sizeof(float));
+
+                    // Optionally premult
+                    if (unpremult) {
+                        for (int i = 0; i < width; ++i) {
+                            vfloat4 p(scanline[i]);
+                            float a = alpha[i];
+                            a       = a >= fltmin ? a : 1.0f;
+                            p *= vfloat4(a, a, a, 1.0f);
+                            scanline[i] = p;
+                        }
                     }
                 }
-                memcpy(R.pixeladdr(roi.xbegin, j, k), scanline,
-                       width * 4 * sizeof(float));
+                // Store the scanline
+                convert_pixel_values(TypeDesc::FLOAT, vals, Rformat,
+                                     R.pixeladdr(roi.xbegin, j, k), nvals);
             }
         }
     });
@@ -1700,11 +1923,41 @@ ImageBufAlgo::colorconvert(ImageBuf& dst, const ImageBuf& src,
         unpremult = false;
     }
 
-    if (dst.localpixels() && src.localpixels() && dst.spec().format == TypeFloat
-        && src.spec().format == TypeFloat && dst.nchannels() == 4
-        && src.nchannels() == 4) {
-        return colorconvert_impl_float_rgba(dst, src, processor, unpremult, roi,
-                                            nthreads);
+    // If asked to, trade exactness for speed by applying a baked 3D LUT
+    // approximation of the processor (which is cached with it).
+    ColorProcessorHandle baked;
+    if (pvt::oiio_colorconvert_lut3d > 0) {
+        baked = processor->bake3d(pvt::oiio_colorconvert_lut3d,
+                                  pvt::oiio_colorconvert_lut3d_range);
+        processor = baked.get();
+    }
+
+    // Fast path for in-memory 3 or 4 channel images of the common pixel
+    // types, which covers almost all plates.
+    auto fastformat = [](const ImageBuf& ib) {
+        TypeDesc f = ib.spec().format;
+        return ib.localpixels()
+               && (f == TypeDesc::FLOAT || f == TypeDesc::HALF
+                   || f == TypeDesc::UINT16 || f == TypeDesc::UINT8)
+               && ib.pixel_stride() == stride_t(ib.spec().pixel_bytes());
+    };
+    int nchannels = src.nchannels();
+    if ((nchannels == 3 || nchannels == 4) && dst.nchannels() == nchannels
+        && roi.chbegin == 0 && roi.chend == nchannels && fastformat(dst)
+        && fastformat(src)) {
+        // For 8 and 16 bit sources, if there are enough pixels to make it
+        // worthwhile, a table of the processor's result for every code
+        // value gives exactly the same answer as applying it. Only possible
+        // when channels are independent and there's no unpremult.
+        const float* lut = nullptr;
+        TypeDesc srcformat(src.spec().format);
+        imagesize_t ncodes = srcformat == TypeDesc::UINT8 ? 256 : 65536;
+        if ((srcformat == TypeDesc::UINT8 || srcformat == TypeDesc::UINT16)
+            && !(unpremult && nchannels == 4)
+            && roi.npixels() >= 4 * ncodes)
+            lut = processor->lut1d(srcformat);
+        return colorconvert_impl_local(dst, src, processor, unpremult, lut,
+                                       roi, nthreads);
     }
 
     bool ok = true;
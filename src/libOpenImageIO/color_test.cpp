@@ -6,11 +6,14 @@
 #include <array>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include <OpenImageIO/argparse.h>
 #include <OpenImageIO/benchmark.h>
 #include <OpenImageIO/color.h>
+#include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/simd.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/timer.h>
@@ -120,6 +123,135 @@ test_Rec709_conversion()
 
 
 
+// Check the colorconvert fast paths (and the baked tables they use for 8
+// and 16 bit sources) against applying the processor pixel by pixel.
+static void
+test_colorconvert_fastpaths()
+{
+    ColorConfig config;
+    ColorProcessorHandle proc = config.createColorProcessor("sRGB", "linear");
+    OIIO_CHECK_ASSERT(proc && !proc->hasChannelCrosstalk());
+    OIIO_CHECK_ASSERT(proc->lut1d(TypeDesc::UINT8) != nullptr);
+    OIIO_CHECK_ASSERT(proc->lut1d(TypeDesc::FLOAT) == nullptr);
+
+    for (TypeDesc format : { TypeDesc::UINT8, TypeDesc::UINT16, TypeDesc::HALF,
+                             TypeDesc::FLOAT }) {
+        for (int nchannels = 3; nchannels <= 4; ++nchannels) {
+            // Big enough that the 16 bit table is worth baking
+            ImageBuf src(ImageSpec(512, 512, nchannels, format));
+            float topleft[]  = { 0.0f, 0.25f, 1.0f, 1.0f };
+            float topright[] = { 1.0f, 0.0f, 0.5f, 1.0f };
+            float botleft[]  = { 0.5f, 1.0f, 0.0f, 0.5f };
+            float botright[] = { 0.1f, 0.75f, 0.3f, 0.25f };
+            ImageBufAlgo::fill(src, topleft, topright, botleft, botright);
+            ImageBuf dst = ImageBufAlgo::colorconvert(src, proc.get(), false);
+            OIIO_CHECK_EQUAL(dst.spec().format, format);
+
+            float tol = format == TypeDesc::UINT8    ? 1.0f / 255.0f
+                        : format == TypeDesc::UINT16 ? 1.0f / 65535.0f
+                        : format == TypeDesc::HALF   ? 1.0e-3f
+                                                     : 1.0e-6f;
+            int failures = 0;
+            for (ImageBuf::ConstIterator<float> s(src), d(dst); !s.done();
+                 ++s, ++d) {
+                float pixel[4];
+                for (int c = 0; c < nchannels; ++c)
+                    pixel[c] = s[c];
+                proc->apply(pixel, 1, 1, nchannels, sizeof(float),
+                            nchannels * sizeof(float),
+                            nchannels * sizeof(float));
+                for (int c = 0; c < nchannels; ++c)
+                    if (std::abs(d[c] - pixel[c]) > tol * (1.0f + pixel[c]))
+                        ++failures;
+            }
+            if (failures)
+                std::cout << "colorconvert " << format << " " << nchannels
+                          << " channels: " << failures << " mismatches\n";
+            OIIO_CHECK_EQUAL(failures, 0);
+        }
+    }
+}
+
+
+
+// The baked 3D LUT approximation should be exact for a matrix (tetrahedral
+// interpolation reproduces linear functions), close for a curve, and be
+// used by colorconvert when the attribute asks for it.
+static void
+test_colorconvert_lut3d()
+{
+    ColorConfig config;
+    Imath::M44f M(0.6f, 0.2f, 0.1f, 0.0f, 0.3f, 0.7f, 0.1f, 0.0f, 0.1f, 0.1f,
+                  0.8f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+    ColorProcessorHandle matrix = config.createMatrixTransform(M);
+    ColorProcessorHandle curve  = config.createColorProcessor("linear",
+                                                             "sRGB");
+    ColorProcessorHandle bakedmatrix = matrix->bake3d(17);
+    ColorProcessorHandle bakedcurve  = curve->bake3d(65);
+    ColorProcessorHandle hdrcurve    = curve->bake3d(65, 64.0f);
+    OIIO_CHECK_ASSERT(bakedmatrix && bakedmatrix->hasChannelCrosstalk());
+    OIIO_CHECK_ASSERT(curve->bake3d(65) == bakedcurve);  // cached
+
+    for (float r : { 0.0f, 0.13f, 0.5f, 0.77f, 1.0f }) {
+        for (float g : { 0.05f, 0.4f, 0.9f }) {
+            for (float b : { 0.0f, 0.31f, 0.66f, 1.0f }) {
+                float exact[3] = { r, g, b }, approx[3] = { r, g, b };
+                matrix->apply(exact);
+                bakedmatrix->apply(approx);
+                for (int c = 0; c < 3; ++c)
+                    OIIO_CHECK_EQUAL_THRESH(approx[c], exact[c], 1.0e-5f);
+
+                float e[3] = { r, g, b }, a[3] = { r, g, b };
+                float h[3]  = { 10.0f * r, 10.0f * g, 10.0f * b };
+                float he[3] = { h[0], h[1], h[2] };
+                curve->apply(e);
+                bakedcurve->apply(a);
+                curve->apply(he);
+                hdrcurve->apply(h);
+                for (int c = 0; c < 3; ++c) {
+                    OIIO_CHECK_EQUAL_THRESH(a[c], e[c], 5.0e-3f);
+                    OIIO_CHECK_EQUAL_THRESH(h[c], he[c],
+                                            2.0e-2f * he[c] + 5.0e-3f);
+                }
+            }
+        }
+    }
+
+    // Selected for IBA::colorconvert by attribute
+    ImageBuf src(ImageSpec(64, 64, 3, TypeDesc::FLOAT));
+    ImageBufAlgo::fill(src, { 0.0f, 0.5f, 1.0f }, { 1.0f, 0.0f, 0.5f },
+                       { 0.5f, 1.0f, 0.0f }, { 0.25f, 0.75f, 0.1f });
+    ImageBuf exact = ImageBufAlgo::colorconvert(src, matrix.get(), false);
+    OIIO::attribute("imagebufalgo:colorconvert_lut3d", 9);
+    ImageBuf approx = ImageBufAlgo::colorconvert(src, curve.get(), false);
+    ImageBuf approxmatrix = ImageBufAlgo::colorconvert(src, matrix.get(),
+                                                       false);
+    OIIO::attribute("imagebufalgo:colorconvert_lut3d", 0);
+    ImageBuf reference = ImageBufAlgo::colorconvert(src, curve.get(), false);
+    auto cmp = ImageBufAlgo::compare(approxmatrix, exact, 1.0e-5f, 1.0e-5f);
+    OIIO_CHECK_EQUAL(cmp.nfail, 0);
+    cmp = ImageBufAlgo::compare(approx, reference, 0.15f, 0.15f);
+    OIIO_CHECK_EQUAL(cmp.nfail, 0);
+    OIIO_CHECK_ASSERT(cmp.maxerror > 0.0f);  // 9^3 is truly approximate
+
+    // A NaN channel is looked up as 0, both in the contiguous path and in
+    // the per-channel path taken when the channels are strided.
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    float zero[3]   = { 0.25f, 0.0f, 0.75f };
+    bakedmatrix->apply(zero);
+    float rgb[3] = { 0.25f, nan, 0.75f };
+    bakedmatrix->apply(rgb);
+    float strided[6] = { 0.25f, -1.0f, nan, -1.0f, 0.75f, -1.0f };
+    bakedmatrix->apply(strided, 1, 1, 3, 2 * sizeof(float) /*chanstride*/,
+                       6 * sizeof(float), 6 * sizeof(float));
+    for (int c = 0; c < 3; ++c) {
+        OIIO_CHECK_EQUAL(rgb[c], zero[c]);
+        OIIO_CHECK_EQUAL(strided[2 * c], zero[c]);
+    }
+}
+
+
+
 int
 main(int argc, char* argv[])
 {
@@ -135,6 +267,8 @@ main(int argc, char* argv[])
 
     test_sRGB_conversion();
     test_Rec709_conversion();
+    test_colorconvert_fastpaths();
+    test_colorconvert_lut3d();
 
     return unit_test_failures != 0;
 }
@@ -0,0 +1,228 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+
+//
+// Task: verify convert_pixel_values for every pair of pixel data types
+// against a scalar convert_type reference, and (with --bench) benchmark
+// each pair.
+//
+
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <OpenImageIO/argparse.h>
+#include <OpenImageIO/benchmark.h>
+#include <OpenImageIO/fmath.h>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/strutil.h>
+#include <OpenImageIO/unittest.h>
+
+using namespace OIIO;
+
+static int iterations = 100;
+static int ntrials    = 5;
+static int nvalues    = 1 << 18;
+static bool verbose   = false;
+static bool run_bench = false;
+
+static const TypeDesc alltypes[] = { TypeUInt8,  TypeInt8,  TypeUInt16,
+                                     TypeInt16,  TypeHalf,  TypeFloat,
+                                     TypeUInt32, TypeInt32, TypeDesc::DOUBLE };
+
+
+
+// Scalar reference: convert n values S->float->D one at a time.
+template<typename S, typename D>
+static void
+reference_convert(const void* src, void* dst, int n)
+{
+    for (int i = 0; i < n; ++i)
+        ((D*)dst)[i] = convert_type<float, D>(
+            convert_type<S, float>(((const S*)src)[i]));
+}
+
+
+
+template<typename S>
+static void
+reference_convert_from(TypeDesc dst_type, const void* src, void* dst, int n)
+{
+    // clang-format off
+    switch (dst_type.basetype) {
+    case TypeDesc::UINT8:  reference_convert<S, uint8_t> (src, dst, n); break;
+    case TypeDesc::INT8:   reference_convert<S, int8_t>  (src, dst, n); break;
+    case TypeDesc::UINT16: reference_convert<S, uint16_t>(src, dst, n); break;
+    case TypeDesc::INT16:  reference_convert<S, int16_t> (src, dst, n); break;
+    case TypeDesc::HALF:   reference_convert<S, half>    (src, dst, n); break;
+    case TypeDesc::FLOAT:  reference_convert<S, float>   (src, dst, n); break;
+    case TypeDesc::UINT:   reference_convert<S, uint32_t>(src, dst, n); break;
+    case TypeDesc::INT:    reference_convert<S, int32_t> (src, dst, n); break;
+    case TypeDesc::DOUBLE: reference_convert<S, double>  (src, dst, n); break;
+    default: OIIO_ASSERT(0);
+    }
+    // clang-format on
+}
+
+
+
+static void
+reference_convert(TypeDesc src_type, const void* src, TypeDesc dst_type,
+                  void* dst, int n)
+{
+    // clang-format off
+    switch (src_type.basetype) {
+    case TypeDesc::UINT8:  reference_convert_from<uint8_t> (dst_type, src, dst, n); break;
+    case TypeDesc::INT8:   reference_convert_from<int8_t>  (dst_type, src, dst, n); break;
+    case TypeDesc::UINT16: reference_convert_from<uint16_t>(dst_type, src, dst, n); break;
+    case TypeDesc::INT16:  reference_convert_from<int16_t> (dst_type, src, dst, n); break;
+    case TypeDesc::HALF:   reference_convert_from<half>    (dst_type, src, dst, n); break;
+    case TypeDesc::FLOAT:  reference_convert_from<float>   (dst_type, src, dst, n); break;
+    case TypeDesc::UINT:   reference_convert_from<uint32_t>(dst_type, src, dst, n); break;
+    case TypeDesc::INT:    reference_convert_from<int32_t> (dst_type, src, dst, n); break;
+    case TypeDesc::DOUBLE: reference_convert_from<double>  (dst_type, src, dst, n); break;
+    default: OIIO_ASSERT(0);
+    }
+    // clang-format on
+}
+
+
+
+// Make n values of type t spanning a bit more than the [-1,1] range, so
+// that clamping and negative handling are exercised.
+static std::vector<char>
+make_values(TypeDesc t, int n)
+{
+    std::vector<float> f(n);
+    for (int i = 0; i < n; ++i)
+        f[i] = -1.25f + 2.5f * float((int64_t(i) * 7919) % n) / float(n);
+    std::vector<char> v(n * t.size());
+    reference_convert(TypeFloat, f.data(), t, v.data(), n);
+    return v;
+}
+
+
+
+// Integer results may be off by one where a multiply-add in the scalar
+// code got contracted differently; floating point results must match.
+static float
+tolerance(TypeDesc t)
+{
+    switch (t.basetype) {
+    case TypeDesc::UINT8: return 1.001f / 255.0f;
+    case TypeDesc::INT8: return 1.001f / 127.0f;
+    case TypeDesc::UINT16: return 1.001f / 65535.0f;
+    case TypeDesc::INT16: return 1.001f / 32767.0f;
+    case TypeDesc::UINT:
+    case TypeDesc::INT: return 1.0e-6f;
+    default: return 0.0f;
+    }
+}
+
+
+
+static void
+test_convert_pixel_values()
+{
+    // Odd length, so the non-SIMD tail of the kernels is checked too.
+    const int n = 1001;
+    for (TypeDesc st : alltypes) {
+        std::vector<char> src = make_values(st, n);
+        for (TypeDesc dt : alltypes) {
+            std::vector<char> dst(n * dt.size()), ref(n * dt.size());
+            OIIO_CHECK_ASSERT(
+                convert_pixel_values(st, src.data(), dt, dst.data(), n));
+            reference_convert(st, src.data(), dt, ref.data(), n);
+            // Compare as float, so one tolerance() fits every type.
+            std::vector<float> fdst(n), fref(n);
+            reference_convert(dt, dst.data(), TypeFloat, fdst.data(), n);
+            reference_convert(dt, ref.data(), TypeFloat, fref.data(), n);
+            float eps = tolerance(dt);
+            int bad = 0;
+            for (int i = 0; i < n; ++i)
+                if (std::abs(fdst[i] - fref[i]) > eps)
+                    ++bad;
+            if (bad)
+                Strutil::printf("  %s -> %s: %d mismatches\n", st.c_str(),
+                                dt.c_str(), bad);
+            OIIO_CHECK_EQUAL(bad, 0);
+        }
+    }
+}
+
+
+
+static void
+benchmark_convert_pixel_values()
+{
+    Benchmarker bench;
+    bench.iterations(iterations);
+    bench.trials(ntrials);
+    bench.work(nvalues);
+    bench.units(Benchmarker::Unit::us);
+    bench.indent(2);
+    for (TypeDesc st : alltypes) {
+        std::vector<char> src = make_values(st, nvalues);
+        for (TypeDesc dt : alltypes) {
+            if (st == dt)
+                continue;
+            std::vector<char> dst(nvalues * dt.size());
+            std::string name = Strutil::sprintf("%s -> %s", st.c_str(),
+                                                dt.c_str());
+            bench(name, [&]() {
+                convert_pixel_values(st, src.data(), dt, dst.data(), nvalues);
+                DoNotOptimize(dst[0]);
+            });
+        }
+    }
+}
+
+
+
+static void
+getargs(int argc, char* argv[])
+{
+    ArgParse ap;
+    // clang-format off
+    ap.intro("convert_test\n" OIIO_INTRO_STRING)
+      .usage("convert_test [options]");
+
+    ap.arg("-v", &verbose)
+      .help("Verbose mode");
+    ap.arg("--bench", &run_bench)
+      .help("Also time each conversion");
+    ap.arg("--iters %d", &iterations)
+      .help(Strutil::sprintf("Number of iterations (default: %d)", iterations));
+    ap.arg("--trials %d", &ntrials)
+      .help("Number of trials");
+    ap.arg("--values %d", &nvalues)
+      .help(Strutil::sprintf("Values per conversion (default: %d)", nvalues));
+    // clang-format on
+
+    ap.parse(argc, (const char**)argv);
+}
+
+
+
+int
+main(int argc, char* argv[])
+{
+#if !defined(NDEBUG) || defined(OIIO_CI) || defined(OIIO_CODE_COVERAGE)
+    // For the sake of test time, reduce the default iterations for DEBUG,
+    // CI, and code coverage builds. Explicit use of --iters or --trials
+    // will override this, since it comes before the getargs() call.
+    iterations /= 10;
+    ntrials = 1;
+#endif
+
+    getargs(argc, argv);
+
+    test_convert_pixel_values();
+    if (run_bench)
+        benchmark_convert_pixel_values();
+
+    return unit_test_failures;
+}
@@ -3,6 +3,7 @@
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <numeric>
@@ -26,6 +27,18 @@ OIIO_NAMESPACE_BEGIN
 // need to lock the mutex. As long as capacity is not changing, threads may
 // change number of samples (inserting or deleting) as well as altering
 // data, simultaneously, as long as they are working on separate pixels.
+//
+// The samples are allocated in arenas of consecutive pixels (one scanline
+// each when we know the image width), each with its own lock, and
+// m_sampleoffset is relative to the start of the pixel's arena. Growing a
+// pixel's capacity moves just that pixel's samples to the end of its arena
+// (or extends them in place if they are already last), so growth costs
+// amortized time proportional to the pixel's own samples, and threads
+// working on different scanlines never contend for a lock. The holes left
+// behind are squeezed out when they outgrow the live samples of the arena.
+// all_data() gathers a copy of the arenas, in pixel order, into a separate
+// m_gathered buffer for callers that need them contiguous; it never moves
+// the live samples, so pointers into the arenas stay valid.
 
 
 
@@ -38,9 +51,16 @@ public:
     std::vector<size_t> m_channeloffsets;  // for each channel [c]
     std::vector<unsigned int> m_nsamples;  // for each pixel [p]
     std::vector<unsigned int> m_capacity;  // for each pixel [p]
-    std::vector<unsigned int>
-        m_cumcapacity;         // cumulative capacity before pixel [p]
-    std::vector<char> m_data;  // for each sample [p][s][c]
+    std::vector<size_t> m_sampleoffset;  // first sample of pixel [p]
+
+    struct Arena {
+        std::vector<char> data;  // for each sample of its pixels
+        size_t capacity = 0;     // total capacity of its pixels
+        spin_mutex mutex;        // guards growing the data
+    };
+    std::vector<Arena> m_arenas;  // for each block of m_arena_pixels
+    int64_t m_arena_pixels;       // pixels per arena
+    std::vector<char> m_gathered;  // all_data() copy, [p][s][c]
     std::vector<std::string> m_channelnames;  // For each channel[c]
     std::vector<int> m_myalphachannel;        // For each channel[c], its alpha
         // myalphachannel[c] gives the alpha channel corresponding to channel
@@ -52,7 +72,7 @@ public:
     int m_AR_channel;
     int m_AG_channel;
     int m_AB_channel;
-    bool m_allocated;
+    std::atomic<bool> m_allocated;
     spin_mutex m_mutex;
 
     Impl()
@@ -61,6 +81,36 @@ public:
         clear();
     }
 
+    // std::atomic is not copyable, so spell out the copy.
+    Impl& operator=(const Impl& d)
+    {
+        m_channeltypes   = d.m_channeltypes;
+        m_channelsizes   = d.m_channelsizes;
+        m_channeloffsets = d.m_channeloffsets;
+        m_nsamples       = d.m_nsamples;
+        m_capacity       = d.m_capacity;
+        m_sampleoffset   = d.m_sampleoffset;
+        m_arenas         = d.m_arenas;
+        m_arena_pixels   = d.m_arena_pixels;
+        m_gathered.clear();
+        m_channelnames   = d.m_channelnames;
+        m_myalphachannel = d.m_myalphachannel;
+        m_samplesize     = d.m_samplesize;
+        m_z_channel      = d.m_z_channel;
+        m_zback_channel  = d.m_zback_channel;
+        m_alpha_channel  = d.m_alpha_channel;
+        m_AR_channel     = d.m_AR_channel;
+        m_AG_channel     = d.m_AG_channel;
+        m_AB_channel     = d.m_AB_channel;
+        m_allocated.store(d.allocated(), std::memory_order_release);
+        return *this;
+    }
+
+    bool allocated() const
+    {
+        return m_allocated.load(std::memory_order_acquire);
+    }
+
     void clear()
     {
         m_channeltypes.clear();
@@ -68,8 +118,10 @@ public:
         m_channeloffsets.clear();
         m_nsamples.clear();
         m_capacity.clear();
-        m_cumcapacity.clear();
-        m_data.clear();
+        m_sampleoffset.clear();
+        m_arenas.clear();
+        m_arena_pixels = 1024;
+        m_gathered.clear();
         m_channelnames.clear();
         m_myalphachannel.clear();
         m_samplesize    = 0;
@@ -79,45 +131,98 @@ public:
         m_AR_channel    = -1;
         m_AG_channel    = -1;
         m_AB_channel    = -1;
-        m_allocated     = false;
+        m_allocated.store(false, std::memory_order_release);
     }
 
-    // If not already done, allocate data and cumcapacity
-    void alloc(size_t npixels)
+    // If not already done, allocate data and sample offsets
+    void alloc(int64_t npixels)
     {
-        if (!m_allocated) {
+        if (!allocated()) {
             spin_lock lock(m_mutex);
-            if (!m_allocated) {
-                // m_cumcapacity.resize (npixels);
-                size_t totalcapacity = 0;
-                for (size_t i = 0; i < npixels; ++i) {
-                    m_cumcapacity[i] = totalcapacity;
-                    totalcapacity += m_capacity[i];
+            if (!allocated()) {
+                int64_t narenas = (npixels + m_arena_pixels - 1)
+                                  / m_arena_pixels;
+                m_arenas.resize(narenas);
+                for (int64_t a = 0; a < narenas; ++a) {
+                    int64_t pbegin       = a * m_arena_pixels;
+                    int64_t pend         = std::min(pbegin + m_arena_pixels,
+                                                    npixels);
+                    size_t totalcapacity = 0;
+                    for (int64_t p = pbegin; p < pend; ++p) {
+                        m_sampleoffset[p] = totalcapacity;
+                        totalcapacity += m_capacity[p];
+                    }
+                    m_arenas[a].data.resize(totalcapacity * m_samplesize);
+                    m_arenas[a].capacity = totalcapacity;
                 }
-                m_data.resize(totalcapacity * m_samplesize);
-                m_allocated = true;
+                m_allocated.store(true, std::memory_order_release);
             }
         }
     }
 
+    // Copy the samples of every pixel, in pixel order and each taking up
+    // its capacity, into m_gathered. The live samples are left alone.
+    void gather(int64_t npixels)
+    {
+        spin_lock lock(m_mutex);
+        m_gathered.clear();
+        size_t base = 0;
+        for (size_t a = 0; a < m_arenas.size(); ++a) {
+            // Hold the arena's lock so its pixels can't grow under us.
+            Arena& ar(m_arenas[a]);
+            spin_lock arenalock(ar.mutex);
+            m_gathered.resize((base + ar.capacity) * m_samplesize);
+            int64_t pbegin = int64_t(a) * m_arena_pixels;
+            int64_t pend   = std::min(pbegin + m_arena_pixels, npixels);
+            for (int64_t p = pbegin; p < pend; ++p) {
+                if (m_capacity[p])
+                    memcpy(&m_gathered[base * m_samplesize],
+                           &ar.data[m_sampleoffset[p] * m_samplesize],
+                           m_capacity[p] * m_samplesize);
+                base += m_capacity[p];
+            }
+        }
+    }
+
+    // Squeeze the holes left by relocated pixels out of an arena. The
+    // caller must hold the arena's lock.
+    void compact(int64_t arena, int64_t npixels)
+    {
+        Arena& ar(m_arenas[arena]);
+        std::vector<char> data(ar.capacity * m_samplesize);
+        int64_t pbegin = arena * m_arena_pixels;
+        int64_t pend   = std::min(pbegin + m_arena_pixels, npixels);
+        size_t base    = 0;
+        for (int64_t p = pbegin; p < pend; ++p) {
+            if (m_capacity[p])
+                memcpy(&data[base * m_samplesize],
+                       &ar.data[m_sampleoffset[p] * m_samplesize],
+                       m_capacity[p] * m_samplesize);
+            m_sampleoffset[p] = base;
+            base += m_capacity[p];
+        }
+        ar.data.swap(data);
+    }
+
+    // The storage that holds the samples of the pixel.
+    std::vector<char>& storage(int64_t pixel)
+    {
+        return m_arenas[pixel / m_arena_pixels].data;
+    }
+
     size_t data_offset(int64_t pixel, int channel, int sample)
     {
-        OIIO_DASSERT(int(m_cumcapacity.size()) > pixel);
+        OIIO_DASSERT(int64_t(m_sampleoffset.size()) > pixel);
         OIIO_DASSERT(m_capacity[pixel] >= m_nsamples[pixel]);
-        return (m_cumcapacity[pixel] + sample) * m_samplesize
+        return (m_sampleoffset[pixel] + sample) * m_samplesize
                + m_channeloffsets[channel];
     }
 
     void* data_ptr(int64_t pixel, int channel, int sample)
     {
         size_t offset = data_offset(pixel, channel, sample);
-        OIIO_DASSERT(offset < m_data.size());
-        return &m_data[offset];
-    }
-
-    size_t total_capacity() const
-    {
-        return m_cumcapacity.back() + m_capacity.back();
+        OIIO_DASSERT(offset < storage(pixel).size());
+        return &storage(pixel)[offset];
     }
 
     inline void sanity() const
@@ -127,15 +232,22 @@ public:
         OIIO_ASSERT(m_channeltypes.size() == m_channeloffsets.size());
         int64_t npixels = int64_t(m_capacity.size());
         OIIO_ASSERT(m_nsamples.size() == m_capacity.size());
-        OIIO_ASSERT(m_cumcapacity.size() == m_capacity.size());
-        if (m_allocated) {
-            size_t totalcapacity = 0;
-            for (int64_t p = 0; p < npixels; ++p) {
-                OIIO_ASSERT(m_cumcapacity[p] == totalcapacity);
-                totalcapacity += m_capacity[p];
-                OIIO_ASSERT(m_capacity[p] >= m_nsamples[p]);
+        OIIO_ASSERT(m_sampleoffset.size() == m_capacity.size());
+        if (allocated()) {
+            for (size_t a = 0; a < m_arenas.size(); ++a) {
+                int64_t pbegin       = int64_t(a) * m_arena_pixels;
+                int64_t pend         = std::min(pbegin + m_arena_pixels,
+                                                npixels);
+                size_t totalcapacity = 0;
+                for (int64_t p = pbegin; p < pend; ++p) {
+                    OIIO_ASSERT((m_sampleoffset[p] + m_capacity[p])
+                                    * m_samplesize
+                                <= m_arenas[a].data.size());
+                    totalcapacity += m_capacity[p];
+                    OIIO_ASSERT(m_capacity[p] >= m_nsamples[p]);
+                }
+                OIIO_ASSERT(totalcapacity == m_arenas[a].capacity);
             }
-            OIIO_ASSERT(totalcapacity * m_samplesize == m_data.size());
         }
     }
 };
@@ -333,7 +445,7 @@ DeepData::init(int64_t npix, int nchan, cspan<TypeDesc> channeltypes,
     m_impl->m_samplesize = 0;
     m_impl->m_nsamples.resize(m_npixels, 0);
     m_impl->m_capacity.resize(m_npixels, 0);
-    m_impl->m_cumcapacity.resize(m_npixels, 0);
+    m_impl->m_sampleoffset.resize(m_npixels, 0);
 
     // Channel name hunt
     // First, find Z, Zback, A
@@ -411,6 +523,10 @@ DeepData::init(const ImageSpec& spec)
     else
         init((int)spec.image_pixels(), spec.nchannels, spec.format,
              spec.channelnames);
+    // One arena per scanline, so that operations working on separate rows
+    // never grow the same arena.
+    if (spec.width > 0)
+        m_impl->m_arena_pixels = spec.width;
 }
 
 
@@ -447,7 +563,7 @@ DeepData::initialized() const
 bool
 DeepData::allocated() const
 {
-    return m_impl && m_impl->m_allocated;
+    return m_impl && m_impl->allocated();
 }
 
 
@@ -469,28 +585,39 @@ DeepData::set_capacity(int64_t pixel, int samps)
     if (pixel < 0 || pixel >= m_npixels)
         return;
     OIIO_DASSERT(m_impl);
-    spin_lock lock(m_impl->m_mutex);
-    if (m_impl->m_allocated) {
-        // Data already allocated. Expand capacity if necessary, don't
-        // contract. (FIXME?)
-        int n = (int)capacity(pixel);
-        if (samps > n) {
-            int toadd = samps - n;
-            if (m_impl->m_data.empty()) {
-                size_t newtotal = (m_impl->total_capacity() + toadd);
-                m_impl->m_data.resize(newtotal * samplesize());
-            } else {
-                size_t offset = m_impl->data_offset(pixel, 0, n);
-                m_impl->m_data.insert(m_impl->m_data.begin() + offset,
-                                      toadd * samplesize(), 0);
-            }
-            // Adjust the cumulative prefix sum of samples for subsequent pixels
-            for (int64_t p = pixel + 1; p < m_npixels; ++p)
-                m_impl->m_cumcapacity[p] += toadd;
+    if (!m_impl->allocated()) {
+        spin_lock lock(m_impl->m_mutex);
+        if (!m_impl->allocated()) {
             m_impl->m_capacity[pixel] = samps;
+            return;
+        }
+    }
+    // Data already allocated. Expand capacity if necessary, don't
+    // contract. (FIXME?)
+    if (samps <= capacity(pixel))
+        return;
+    int64_t arena = pixel / m_impl->m_arena_pixels;
+    spin_lock lock(m_impl->m_arenas[arena].mutex);
+    int n = capacity(pixel);
+    if (samps > n) {
+        Impl::Arena& ar(m_impl->m_arenas[arena]);
+        size_t ss    = samplesize();
+        size_t begin = m_impl->m_sampleoffset[pixel];
+        size_t end   = ar.data.size() / ss;
+        if (begin + n != end) {
+            // Not the last pixel in the arena -- move its samples to the
+            // end, leaving a hole behind.
+            ar.data.resize((end + samps) * ss, 0);
+            if (n)
+                memcpy(&ar.data[end * ss], &ar.data[begin * ss], n * ss);
+            m_impl->m_sampleoffset[pixel] = end;
+        } else {
+            ar.data.resize((begin + samps) * ss, 0);
         }
-    } else {
         m_impl->m_capacity[pixel] = samps;
+        ar.capacity += samps - n;
+        if (ar.data.size() > 2 * ar.capacity * ss)
+            m_impl->compact(arena, m_npixels);
     }
 }
 
@@ -513,7 +640,7 @@ DeepData::set_samples(int64_t pixel, int samps)
     if (pixel < 0 || pixel >= m_npixels)
         return;
     OIIO_DASSERT(m_impl);
-    if (m_impl->m_allocated) {
+    if (m_impl->allocated()) {
         // Data already allocated. Turn it into an insert or delete
         int n = (int)m_impl->m_nsamples[pixel];
         if (samps > n)
@@ -535,7 +662,7 @@ DeepData::set_all_samples(cspan<unsigned int> samples)
     if (samples.size() != m_npixels)
         return;
     OIIO_DASSERT(m_impl);
-    if (m_impl->m_allocated) {
+    if (m_impl->allocated()) {
         // Data already allocated: set pixels individually
         for (int64_t p = 0; p < m_npixels; ++p)
             set_samples(p, int(samples[p]));
@@ -558,14 +685,14 @@ DeepData::insert_samples(int64_t pixel, int samplepos, int n)
     // is adjusted, we can alter nsamples or copy the data around within
     // the pixel without a lock, we presume that if multiple threads are
     // in play, they are working on separate pixels.
-    if (m_impl->m_allocated) {
+    if (m_impl->allocated()) {
         // Move the data
         if (samplepos < oldsamps) {
+            std::vector<char>& data(m_impl->storage(pixel));
             size_t offset = m_impl->data_offset(pixel, 0, samplepos);
             size_t end    = m_impl->data_offset(pixel, 0, oldsamps);
-            std::copy_backward(m_impl->m_data.begin() + offset,
-                               m_impl->m_data.begin() + end,
-                               m_impl->m_data.begin() + end + n * samplesize());
+            std::copy_backward(data.begin() + offset, data.begin() + end,
+                               data.begin() + end + n * samplesize());
         }
     }
     // Add to this pixel's sample count
@@ -581,14 +708,14 @@ DeepData::erase_samples(int64_t pixel, int samplepos, int n)
     // Because erase_samples only moves data within a pixel and doesn't
     // change the capacity, no lock is needed.
     n = std::min(n, int(m_impl->m_nsamples[pixel]));
-    if (m_impl->m_allocated) {
+    if (m_impl->allocated()) {
         // Move the data
+        std::vector<char>& data(m_impl->storage(pixel));
         int oldsamps  = samples(pixel);
         size_t offset = m_impl->data_offset(pixel, 0, samplepos);
         size_t end    = m_impl->data_offset(pixel, 0, oldsamps);
-        std::copy(m_impl->m_data.begin() + offset + n * samplesize(),
-                  m_impl->m_data.begin() + end,
-                  m_impl->m_data.begin() + offset);
+        std::copy(data.begin() + offset + n * samplesize(), data.begin() + end,
+                  data.begin() + offset);
     }
     m_impl->m_nsamples[pixel] -= n;
 }
@@ -611,7 +738,7 @@ const void*
 DeepData::data_ptr(int64_t pixel, int channel, int sample) const
 {
     if (pixel < 0 || pixel >= m_npixels || channel < 0 || channel >= m_nchannels
-        || !m_impl || !m_impl->m_data.size() || sample < 0
+        || !m_impl || !m_impl->allocated() || sample < 0
         || sample >= int(m_impl->m_nsamples[pixel]))
         return NULL;
     return m_impl->data_ptr(pixel, channel, sample);
@@ -808,7 +935,8 @@ DeepData::all_data() const
 {
     OIIO_DASSERT(m_impl);
     m_impl->alloc(m_npixels);
-    return m_impl->m_data;
+    m_impl->gather(m_npixels);
+    return m_impl->m_gathered;
 }
 
 
@@ -980,35 +1108,29 @@ DeepData::split(int64_t pixel, float depth)
 
 namespace {
 
-// Comparitor functor for depth sorting sample indices of a deep pixel.
+// Comparitor functor for depth sorting sample indices of a deep pixel,
+// given the depths of the samples already gathered into arrays.
 class SampleComparator {
 public:
-    SampleComparator(const DeepData& dd, int pixel, int zchan, int zbackchan)
-        : deepdata(dd)
-        , pixel(pixel)
-        , zchan(zchan)
-        , zbackchan(zbackchan)
+    SampleComparator(const float* z, const float* zback)
+        : z(z)
+        , zback(zback)
     {
     }
     bool operator()(int i, int j) const
     {
         // If either has a lower z, that's the lower
-        float iz = deepdata.deep_value(pixel, zchan, i);
-        float jz = deepdata.deep_value(pixel, zchan, j);
-        if (iz < jz)
+        if (z[i] < z[j])
             return true;
-        if (iz > jz)
+        if (z[i] > z[j])
             return false;
         // If both z's are equal, sort based on zback
-        float izb = deepdata.deep_value(pixel, zbackchan, i);
-        float jzb = deepdata.deep_value(pixel, zbackchan, j);
-        return izb < jzb;
+        return zback[i] < zback[j];
     }
 
 private:
-    const DeepData& deepdata;
-    int pixel;
-    int zchan, zbackchan;
+    const float* z;
+    const float* zback;
 };
 
 }  // namespace
@@ -1028,13 +1150,25 @@ DeepData::sort(int64_t pixel)
     if (nsamples < 2)
         return;  // 0 or 1 samples -- no sort necessary
 
+    // Gather the depths once, rather than converting them again for every
+    // comparison, and don't move anything if the samples are in order
+    // already (as they often are, e.g. when merge_deep_pixels re-sorts).
+    float* z     = OIIO_ALLOCA(float, nsamples);
+    float* zback = OIIO_ALLOCA(float, nsamples);
+    for (int s = 0; s < nsamples; ++s) {
+        z[s]     = deep_value(pixel, zchan, s);
+        zback[s] = deep_value(pixel, zbackchan, s);
+    }
+    SampleComparator comparator(z, zback);
+    int* sample_indices = OIIO_ALLOCA(int, nsamples);
+    std::iota(sample_indices, sample_indices + nsamples, 0);
+    if (std::is_sorted(sample_indices, sample_indices + nsamples, comparator))
+        return;
+
     // Ick, std::sort and friends take a custom comparator, but not a custom
     // swapper, so there's no way to std::sort a data type whose size is not
     // known at compile time. So we just sort the indices!
-    int* sample_indices = OIIO_ALLOCA(int, nsamples);
-    std::iota(sample_indices, sample_indices + nsamples, 0);
-    std::stable_sort(sample_indices, sample_indices + nsamples,
-                     SampleComparator(*this, pixel, zchan, zbackchan));
+    std::stable_sort(sample_indices, sample_indices + nsamples, comparator);
 
     // Now copy around using a temp buffer
     size_t samplebytes = samplesize();
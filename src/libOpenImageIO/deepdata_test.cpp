@@ -0,0 +1,150 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+
+#include <cstring>
+#include <vector>
+
+#include <OpenImageIO/deepdata.h>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/unittest.h>
+
+using namespace OIIO;
+
+
+// The value we store in channel c of sample id (an identifier we give each
+// sample when it is inserted, not its position).
+static float
+sample_value(int64_t pixel, int c, int id)
+{
+    return float(pixel * 1000 + id * 2 + c);
+}
+
+
+
+// Check every sample of dd against the model, which holds the ids of the
+// samples of each pixel in order.
+static void
+check_samples(const DeepData& dd, const std::vector<std::vector<int>>& model)
+{
+    for (int64_t p = 0; p < dd.pixels(); ++p) {
+        OIIO_CHECK_EQUAL(dd.samples(p), int(model[p].size()));
+        for (int s = 0; s < int(model[p].size()); ++s)
+            for (int c = 0; c < dd.channels(); ++c)
+                OIIO_CHECK_EQUAL(dd.deep_value(p, c, s),
+                                 sample_value(p, c, model[p][s]));
+    }
+}
+
+
+
+// Check that all_data() holds the pixels one after the other, each taking
+// up its capacity, and that the samples found there are the right ones.
+static void
+check_all_data(const DeepData& dd, const std::vector<std::vector<int>>& model)
+{
+    cspan<char> all = dd.all_data();
+    size_t ss       = dd.samplesize();
+    size_t offset   = 0;
+    for (int64_t p = 0; p < dd.pixels(); ++p) {
+        for (int s = 0; s < int(model[p].size()); ++s) {
+            for (int c = 0; c < dd.channels(); ++c) {
+                float val;
+                memcpy(&val, &all[offset + s * ss + c * sizeof(float)],
+                       sizeof(float));
+                OIIO_CHECK_EQUAL(val, sample_value(p, c, model[p][s]));
+            }
+        }
+        offset += dd.capacity(p) * ss;
+    }
+    OIIO_CHECK_EQUAL(all.size(), offset);
+}
+
+
+
+// Grow the pixels of one scanline a sample at a time, round robin, so that
+// each growth relocates a pixel and leaves a hole behind. By the third
+// round the holes outweigh the live samples and the scanline's storage is
+// compacted, and that keeps happening in the rounds after.
+static void
+test_interleaved_growth()
+{
+    std::cout << "test_interleaved_growth\n";
+    const int width = 16, height = 4, growrow = 1, rounds = 8;
+    ImageSpec spec(width, height, 2, TypeFloat);
+    spec.channelnames = { "A", "Z" };
+    spec.deep         = true;
+    DeepData dd(spec);
+
+    std::vector<std::vector<int>> model(dd.pixels());
+    int nextid = 0;
+    for (int64_t p = 0; p < dd.pixels(); ++p) {
+        dd.set_samples(p, 1);
+        model[p].push_back(nextid++);
+    }
+    for (int64_t p = 0; p < dd.pixels(); ++p)
+        for (int c = 0; c < 2; ++c)
+            dd.set_deep_value(p, c, 0, sample_value(p, c, model[p][0]));
+    OIIO_CHECK_ASSERT(dd.allocated());
+
+    for (int r = 0; r < rounds; ++r) {
+        for (int x = 0; x < width; ++x) {
+            int64_t p = growrow * width + x;
+            // Alternate between appending and inserting in front, which
+            // shuffles the existing samples within the pixel as well.
+            int pos = (r + x) & 1 ? 0 : dd.samples(p);
+            int id  = nextid++;
+            dd.insert_samples(p, pos, 1);
+            for (int c = 0; c < 2; ++c)
+                dd.set_deep_value(p, c, pos, sample_value(p, c, id));
+            model[p].insert(model[p].begin() + pos, id);
+        }
+    }
+    check_samples(dd, model);
+
+    // Copies taken while the samples are still split by scanline.
+    DeepData copy(dd);
+    check_samples(copy, model);
+    DeepData assigned;
+    assigned = dd;
+    check_samples(assigned, model);
+
+    // Gathering everything in pixel order leaves the samples where they
+    // were, so pointers taken before are still good. Then grow again and
+    // gather once more.
+    int64_t p          = growrow * width + 3;
+    const void* before = dd.data_ptr(p, 0, 0);
+    check_all_data(dd, model);
+    OIIO_CHECK_EQUAL(dd.data_ptr(p, 0, 0), before);
+    dd.set_capacity(p, dd.capacity(p) + 5);
+    check_samples(dd, model);
+    dd.insert_samples(p, 0, 1);
+    for (int c = 0; c < 2; ++c)
+        dd.set_deep_value(p, c, 0, sample_value(p, c, nextid));
+    model[p].insert(model[p].begin(), nextid++);
+    check_samples(dd, model);
+    check_all_data(dd, model);
+
+    // Copies taken after gathering.
+    DeepData copy2(dd);
+    check_samples(copy2, model);
+    check_all_data(copy2, model);
+    assigned = dd;
+    check_samples(assigned, model);
+    check_all_data(assigned, model);
+
+    // The earlier copies were not disturbed by any of that.
+    model[p].erase(model[p].begin());
+    check_samples(copy, model);
+}
+
+
+
+int
+main(int /*argc*/, char* /*argv*/[])
+{
+    test_interleaved_growth();
+
+    return unit_test_failures;
+}
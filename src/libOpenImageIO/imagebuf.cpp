@@ -296,6 +296,8 @@ private:
     std::unique_ptr<ImageSpec> m_configspec;  // Configuration spec
     Filesystem::IOProxy* m_rioproxy = nullptr;
     Filesystem::IOProxy* m_wioproxy = nullptr;
+    // Keeps the file mapping alive for APPBUFFER pixels that point into it
+    std::shared_ptr<ImageInput> m_mapped_input;
     mutable std::string m_err;  ///< Last error message
 
     // Private reset m_pixels to new allocation of new size, copy if
@@ -304,6 +306,9 @@ private:
     char* new_pixels(size_t size, const void* data = nullptr);
     // Private release of m_pixels.
     void free_pixels();
+    // Try to point the pixels directly at a memory mapping of the file,
+    // returning true if that was possible.
+    bool read_mapped(int subimage, int miplevel);
 
     TypeDesc write_format(int channel = 0) const
     {
@@ -432,6 +437,7 @@ ImageBufImpl::ImageBufImpl(const ImageBufImpl& src)
     , m_write_tile_width(src.m_write_tile_width)
     , m_write_tile_height(src.m_write_tile_height)
     , m_write_tile_depth(src.m_write_tile_depth)
+    , m_mapped_input(src.m_mapped_input)
 // NO -- copy ctr does not transfer proxy   , m_rioproxy(src.m_rioproxy)
 // NO -- copy ctr does not transfer proxy   , m_wioproxy(src.m_wioproxy)
 {
@@ -623,6 +629,7 @@ ImageBufImpl::free_pixels()
         m_allocated_size = 0;
     }
     m_pixels.reset();
+    m_mapped_input.reset();
     m_deepdata.free();
     m_storage = ImageBuf::UNINITIALIZED;
     m_blackpixel.clear();
@@ -1040,6 +1047,15 @@ ImageBufImpl::read(int subimage, int miplevel, int chbegin, int chend,
 
     m_pixelaspect = m_spec.get_float_attribute("pixelaspectratio", 1.0f);
 
+    // If the "oiio:mmap_pixels" config hint asked for it, and we want the
+    // native pixels anyway, try to use the file's memory mapping in place.
+    if (m_configspec && m_configspec->get_int_attribute("oiio:mmap_pixels")
+        && !m_rioproxy && !use_channel_subset
+        && (convert == TypeDesc::UNKNOWN || convert == m_nativespec.format)
+        && m_nativespec.channelformats.empty()
+        && read_mapped(subimage, miplevel))
+        return true;
+
     // If we don't already have "local" pixels, and we aren't asking to
     // convert the pixels to a specific (and different) type, then take an
     // early out by relying on the cache.
@@ -1163,6 +1179,46 @@ ImageBufImpl::read(int subimage, int miplevel, int chbegin, int chend,
 
 
 
+bool
+ImageBufImpl::read_mapped(int subimage, int miplevel)
+{
+    std::shared_ptr<ImageInput> in(ImageInput::create(m_name.string()));
+    if (!in || !in->supports("mmap_pixels"))
+        return false;
+    ImageSpec newspec;
+    if (!in->open(m_name.string(), newspec, *m_configspec))
+        return false;
+    const void* pixels = in->mapped_native_pixels(subimage, miplevel);
+    if (!pixels)
+        return false;
+    // The strip offsets in the file need not respect the alignment of the
+    // pixel type; if they don't, a normal read is the safe choice.
+    if ((uintptr_t)pixels % m_nativespec.format.basesize())
+        return false;
+
+    free_pixels();
+    m_spec.format      = m_nativespec.format;
+    m_spec.tile_width  = m_nativespec.tile_width;
+    m_spec.tile_height = m_nativespec.tile_height;
+    m_spec.tile_depth  = m_nativespec.tile_depth;
+    m_channel_stride   = m_spec.format.size();
+    m_xstride          = m_spec.pixel_bytes();
+    m_ystride          = m_spec.scanline_bytes();
+    m_zstride          = clamped_mult64(m_ystride, (imagesize_t)m_spec.height);
+    m_blackpixel.resize(round_to_multiple(m_xstride, OIIO_SIMD_MAX_SIZE_BYTES),
+                        0);
+    // The mapping is copy-on-write, so the ImageBuf may modify the pixels
+    // without touching the file.
+    m_localpixels  = (char*)pixels;
+    m_mapped_input = in;
+    m_storage      = ImageBuf::APPBUFFER;
+    m_pixels_valid = true;
+    eval_contiguous();
+    return true;
+}
+
+
+
 bool
 ImageBuf::read(int subimage, int miplevel, bool force, TypeDesc convert,
                ProgressCallback progress_callback, void* progress_callback_data)
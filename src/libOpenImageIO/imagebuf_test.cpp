@@ -500,6 +500,53 @@ test_write_over()
 
 
 
+
+// Read an uncompressed TIFF through its memory mapping (the
+// "oiio:mmap_pixels" config hint) and make sure it matches a normal read.
+void
+test_read_mapped()
+{
+    std::cout << "test_read_mapped\n";
+    const char* filename = "tmp-mapped.tif";
+    {
+        ImageSpec spec(64, 48, 3, TypeUInt16);
+        spec.attribute("compression", "none");
+        ImageBuf img(spec);
+        ImageBufAlgo::fill(img, { 0.1f, 0.2f, 0.3f }, { 0.9f, 0.8f, 0.7f });
+        img.write(filename);
+    }
+
+    ImageSpec config;
+    config.attribute("oiio:mmap_pixels", 1);
+    ImageBuf mapped(filename, 0, 0, nullptr, &config);
+    OIIO_CHECK_ASSERT(mapped.read(0, 0, false, TypeUnknown));
+    OIIO_CHECK_EQUAL(mapped.storage(), ImageBuf::APPBUFFER);
+    OIIO_CHECK_EQUAL(mapped.spec().format, TypeUInt16);
+
+    ImageBuf normal(filename);
+    OIIO_CHECK_ASSERT(normal.read(0, 0, true, TypeUInt16));
+    OIIO_CHECK_EQUAL(normal.storage(), ImageBuf::LOCALBUFFER);
+
+    auto cr = ImageBufAlgo::compare(mapped, normal, 0.0f, 0.0f);
+    OIIO_CHECK_ASSERT(!cr.error);
+    OIIO_CHECK_EQUAL(cr.nfail, 0);
+    OIIO_CHECK_EQUAL(cr.maxerror, 0.0);
+
+    // The mapping is private, so writing to the mapped pixels must not
+    // change the file.
+    const float white[3] = { 1.0f, 1.0f, 1.0f };
+    mapped.setpixel(0, 0, white);
+    mapped.reset();
+    ImageBuf reread(filename);
+    float pixel[3];
+    reread.getpixel(0, 0, pixel);
+    OIIO_CHECK_EQUAL_THRESH(pixel[0], 0.1f, 1.0e-4f);
+    reread.reset();
+    normal.reset();
+
+    Filesystem::remove(filename);
+}
+
 int
 main(int /*argc*/, char* /*argv*/[])
 {
@@ -532,6 +579,7 @@ main(int /*argc*/, char* /*argv*/[])
     time_get_pixels();
 
     test_write_over();
+    test_read_mapped();
 
     Filesystem::remove("A_imagebuf_test.tif");
     return unit_test_failures;
@@ -351,7 +351,7 @@ ImageBufAlgo::type_merge(TypeDesc::BASETYPE a, TypeDesc::BASETYPE b)
 template<typename DSTTYPE, typename SRCTYPE>
 static bool
 convolve_(ImageBuf& dst, const ImageBuf& src, const ImageBuf& kernel,
-          bool normalize, ROI roi, int nthreads)
+          float scale, ROI roi, int nthreads)
 {
     using namespace ImageBufAlgo;
     OIIO_DASSERT(kernel.spec().format == TypeDesc::FLOAT && kernel.localpixels()
@@ -359,14 +359,6 @@ convolve_(ImageBuf& dst, const ImageBuf& src, const ImageBuf& kernel,
     parallel_image(roi, nthreads, [&](ROI roi) {
         ROI kroi   = kernel.roi();
         int kchans = kernel.nchannels();
-
-        float scale = 1.0f;
-        if (normalize) {
-            scale = 0.0f;
-            for (ImageBuf::ConstIterator<float> k(kernel); !k.done(); ++k)
-                scale += k[0];
-            scale = 1.0f / scale;
-        }
         float* sum = OIIO_ALLOCA(float, roi.chend);
 
         ImageBuf::Iterator<DSTTYPE> d(dst, roi);
@@ -392,6 +384,202 @@ convolve_(ImageBuf& dst, const ImageBuf& src, const ImageBuf& kernel,
 
 
 
+// Is the 2D kernel the outer product of a column and a row? If so, store
+// the row in hk and the column in vk, and return true.
+static bool
+kernel_is_separable(const ImageBuf& kernel, std::vector<float>& hk,
+                    std::vector<float>& vk)
+{
+    const ImageSpec& kspec(kernel.spec());
+    if (kspec.depth != 1)
+        return false;
+    int w = kspec.width, h = kspec.height, kchans = kspec.nchannels;
+    const float* k = (const float*)kernel.localpixels();
+    auto tap = [&](int x, int y) { return k[(size_t(y) * w + x) * kchans]; };
+
+    // Pivot on the biggest tap: its row and column determine the factors.
+    int px = 0, py = 0;
+    float big = 0.0f;
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            if (fabsf(tap(x, y)) > fabsf(big)) {
+                big = tap(x, y);
+                px  = x;
+                py  = y;
+            }
+    if (big == 0.0f)
+        return false;
+    hk.resize(w);
+    vk.resize(h);
+    for (int x = 0; x < w; ++x)
+        hk[x] = tap(x, py);
+    for (int y = 0; y < h; ++y)
+        vk[y] = tap(px, y) / big;
+    float tolerance = 1.0e-6f * fabsf(big);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            if (fabsf(vk[y] * hk[x] - tap(x, y)) > tolerance)
+                return false;
+    return true;
+}
+
+
+
+// Separable convolution: a horizontal pass with hk into a float buffer
+// holding every source row the vertical pass will need, then a vertical
+// pass with vk. The horizontal pass reads the source with WrapClamp, so
+// edges are handled exactly as in the direct method.
+template<typename DSTTYPE, typename SRCTYPE>
+static bool
+convolve_separable_(ImageBuf& dst, const ImageBuf& src, const ImageBuf& kernel,
+                    cspan<float> hk, cspan<float> vk, float scale, ROI roi,
+                    int nthreads)
+{
+    using namespace ImageBufAlgo;
+    ROI kroi = kernel.roi();
+    int kw = kroi.width(), kh = kroi.height();
+    int z      = roi.zbegin;
+    int nchans = roi.chend;
+    int width  = roi.width();
+    int ylo    = roi.ybegin + kroi.ybegin;
+    int yhi    = roi.yend + kroi.yend - 1;
+    std::vector<float> H(size_t(width) * (yhi - ylo) * nchans);
+
+    ROI hroi(roi.xbegin, roi.xend, ylo, yhi, z, z + 1, roi.chbegin, roi.chend);
+    parallel_image(hroi, nthreads, [&](ROI r) {
+        int rw     = r.width() + kw - 1;
+        float* row = OIIO_ALLOCA(float, rw * nchans);
+        for (int y = r.ybegin; y < r.yend; ++y) {
+            ImageBuf::ConstIterator<SRCTYPE> s(src, r.xbegin + kroi.xbegin,
+                                               r.xend + kroi.xend - 1, y,
+                                               y + 1, z, z + 1,
+                                               ImageBuf::WrapClamp);
+            for (float* p = row; !s.done(); ++s, p += nchans)
+                for (int c = r.chbegin; c < r.chend; ++c)
+                    p[c] = s[c];
+            float* h = &H[(size_t(y - ylo) * width + (r.xbegin - roi.xbegin))
+                          * nchans];
+            for (int x = 0; x < r.width(); ++x, h += nchans) {
+                for (int c = r.chbegin; c < r.chend; ++c)
+                    h[c] = 0.0f;
+                const float* p = row + x * nchans;
+                for (int i = 0; i < kw; ++i, p += nchans)
+                    for (int c = r.chbegin; c < r.chend; ++c)
+                        h[c] += hk[i] * p[c];
+            }
+        }
+    });
+
+    parallel_image(roi, nthreads, [&](ROI r) {
+        int rw     = r.width();
+        float* sum = OIIO_ALLOCA(float, rw * nchans);
+        for (int y = r.ybegin; y < r.yend; ++y) {
+            memset(sum, 0, rw * nchans * sizeof(float));
+            for (int j = 0; j < kh; ++j) {
+                const float* h = &H[(size_t(y + kroi.ybegin + j - ylo) * width
+                                      + (r.xbegin - roi.xbegin))
+                                     * nchans];
+                for (int i = 0; i < rw * nchans; i += nchans)
+                    for (int c = r.chbegin; c < r.chend; ++c)
+                        sum[i + c] += vk[j] * h[i + c];
+            }
+            ImageBuf::Iterator<DSTTYPE> d(dst, r.xbegin, r.xend, y, y + 1, z,
+                                          z + 1);
+            for (const float* p = sum; !d.done(); ++d, p += nchans)
+                for (int c = r.chbegin; c < r.chend; ++c)
+                    d[c] = scale * p[c];
+        }
+    });
+    return true;
+}
+
+
+
+// Smallest size >= n whose only prime factors are 2, 3, and 5, which
+// kissfft transforms efficiently.
+static int
+fft_good_size(int n)
+{
+    for (;; ++n) {
+        int m = n;
+        for (int f : { 2, 3, 5 })
+            while (m % f == 0)
+                m /= f;
+        if (m == 1)
+            return n;
+    }
+}
+
+
+
+// Convolution by multiplication in the frequency domain. Each channel of
+// the source region (padded by the kernel size with WrapClamp values, so
+// the result matches the direct method) is transformed, multiplied by the
+// conjugate of the transformed kernel, and transformed back.
+template<typename DSTTYPE, typename SRCTYPE>
+static bool
+convolve_fft_(ImageBuf& dst, const ImageBuf& src, const ImageBuf& kernel,
+              float scale, ROI roi, int nthreads)
+{
+    using namespace ImageBufAlgo;
+    ROI kroi   = kernel.roi();
+    int kchans = kernel.nchannels();
+    int z      = roi.zbegin;
+    int pw     = roi.width() + kroi.width() - 1;
+    int ph     = roi.height() + kroi.height() - 1;
+    // Padding out to the transform size guarantees that the circular
+    // correlation computed by the FFT never wraps around.
+    ROI fftroi(0, fft_good_size(pw), 0, fft_good_size(ph), 0, 1, 0, 1);
+    float rescale = scale * sqrtf(float(fftroi.npixels()));
+
+    ImageBuf Kpad = zero(fftroi);
+    const float* k = (const float*)kernel.localpixels();
+    for (int y = 0; y < kroi.height(); ++y)
+        for (int x = 0; x < kroi.width(); ++x, k += kchans)
+            *(float*)Kpad.pixeladdr(x, y) = k[0];
+    ImageBuf KF = fft(Kpad, ROI::All(), nthreads);
+    if (KF.has_error()) {
+        dst.errorfmt("{}", KF.geterror());
+        return false;
+    }
+    const std::complex<float>* kf = (const std::complex<float>*)
+                                        KF.localpixels();
+
+    int x0 = roi.xbegin + kroi.xbegin, y0 = roi.ybegin + kroi.ybegin;
+    ImageBuf P = zero(fftroi);
+    for (int c = roi.chbegin; c < roi.chend; ++c) {
+        parallel_image(ROI(x0, x0 + pw, y0, y0 + ph, z, z + 1), nthreads,
+                       [&](ROI r) {
+                           ImageBuf::ConstIterator<SRCTYPE> s(
+                               src, r, ImageBuf::WrapClamp);
+                           for (; !s.done(); ++s)
+                               *(float*)P.pixeladdr(s.x() - x0, s.y() - y0)
+                                   = s[c];
+                       });
+        ImageBuf PF = fft(P, ROI::All(), nthreads);
+        if (PF.has_error()) {
+            dst.errorfmt("{}", PF.geterror());
+            return false;
+        }
+        std::complex<float>* pf = (std::complex<float>*)PF.localpixels();
+        for (imagesize_t i = 0, n = fftroi.npixels(); i < n; ++i)
+            pf[i] *= std::conj(kf[i]) * rescale;
+        ImageBuf R = ifft(PF, ROI::All(), nthreads);
+        if (R.has_error()) {
+            dst.errorfmt("{}", R.geterror());
+            return false;
+        }
+        parallel_image(roi, nthreads, [&](ROI r) {
+            for (ImageBuf::Iterator<DSTTYPE> d(dst, r); !d.done(); ++d)
+                d[c] = *(const float*)R.pixeladdr(d.x() - roi.xbegin,
+                                                  d.y() - roi.ybegin);
+        });
+    }
+    return true;
+}
+
+
+
 bool
 ImageBufAlgo::convolve(ImageBuf& dst, const ImageBuf& src,
                        const ImageBuf& kernel, bool normalize, ROI roi,
@@ -408,8 +596,37 @@ ImageBufAlgo::convolve(ImageBuf& dst, const ImageBuf& src,
         Ktmp.copy(kernel, TypeDesc::FLOAT);
         K = &Ktmp;
     }
+    float scale = 1.0f;
+    if (normalize) {
+        scale = 0.0f;
+        for (ImageBuf::ConstIterator<float> k(*K); !k.done(); ++k)
+            scale += k[0];
+        scale = 1.0f / scale;
+    }
+
+    // Big blurs are usually separable, and cost only width+height
+    // operations per pixel that way instead of width*height. Failing that,
+    // large kernels are cheaper to apply with FFTs.
+    if (K->spec().depth == 1 && src.spec().depth == 1 && roi.depth() == 1) {
+        std::vector<float> hk, vk;
+        if (kernel_is_separable(*K, hk, vk)) {
+            OIIO_DISPATCH_COMMON_TYPES2(ok, "convolve", convolve_separable_,
+                                        dst.spec().format, src.spec().format,
+                                        dst, src, *K, hk, vk, scale, roi,
+                                        nthreads);
+            return ok;
+        }
+        int fft_threshold = pvt::oiio_convolve_fft_threshold;
+        if (fft_threshold > 0 && K->spec().image_pixels() >= fft_threshold) {
+            OIIO_DISPATCH_COMMON_TYPES2(ok, "convolve", convolve_fft_,
+                                        dst.spec().format, src.spec().format,
+                                        dst, src, *K, scale, roi, nthreads);
+            return ok;
+        }
+    }
+
     OIIO_DISPATCH_COMMON_TYPES2(ok, "convolve", convolve_, dst.spec().format,
-                                src.spec().format, dst, src, *K, normalize, roi,
+                                src.spec().format, dst, src, *K, scale, roi,
                                 nthreads);
     return ok;
 }
@@ -667,7 +884,8 @@ median_filter_impl(ImageBuf& R, const ImageBuf& A, int width, int height,
             if (n) {
                 int mid = n / 2;
                 for (int c = 0; c < nchannels; ++c) {
-                    std::sort(chans[c] + 0, chans[c] + n);
+                    std::nth_element(chans[c] + 0, chans[c] + mid,
+                                     chans[c] + n);
                     r[c] = chans[c][mid];
                 }
             } else {
@@ -681,6 +899,85 @@ median_filter_impl(ImageBuf& R, const ImageBuf& A, int width, int height,
 
 
 
+// Does every pixel that a WrapClamp iterator visits exist? That's the case
+// when the data window covers the whole display window, and lets the
+// sliding-window filters below skip checking each pixel.
+static bool
+wrapclamp_always_exists(const ImageBuf& A)
+{
+    const ImageSpec& spec(A.spec());
+    return spec.x <= spec.full_x && spec.y <= spec.full_y
+           && spec.x + spec.width >= spec.full_x + spec.full_width
+           && spec.y + spec.height >= spec.full_y + spec.full_height;
+}
+
+
+
+// Perreault & Hebert constant-time median for 8-bit images: each column
+// keeps a histogram of the window rows, updated by one pixel in and one
+// out as the row advances, and the window histogram slides along the row
+// by adding one column histogram and subtracting another.
+template<class Rtype>
+static bool
+median_filter_hist_(ImageBuf& R, const ImageBuf& A, int width, int height,
+                    ROI roi, int nthreads)
+{
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
+        int w_2       = std::max(1, width / 2);
+        int h_2       = std::max(1, height / 2);
+        int nchannels = R.nchannels();
+        int x0        = roi.xbegin - w_2;
+        int ncols     = roi.width() + width - 1;
+        int target    = width * height / 2 + 1;  // rank of the median
+        int nbins     = nchannels * 256;            // histogram per channel
+        std::vector<int> colhist(size_t(ncols) * nbins, 0);
+        std::vector<int> hist(nbins);
+        auto addrow = [&](int y, int delta) {
+            ImageBuf::ConstIterator<unsigned char, unsigned char> a(
+                A, x0, x0 + ncols, y, y + 1, roi.zbegin, roi.zbegin + 1,
+                ImageBuf::WrapClamp);
+            for (int* h = colhist.data(); !a.done(); ++a, h += nbins)
+                for (int c = 0; c < nchannels; ++c)
+                    h[c * 256 + a[c]] += delta;
+        };
+        for (int y = roi.ybegin - h_2; y < roi.ybegin - h_2 + height; ++y)
+            addrow(y, 1);
+
+        for (int y = roi.ybegin; y < roi.yend; ++y) {
+            if (y > roi.ybegin) {
+                addrow(y - 1 - h_2, -1);
+                addrow(y - 1 - h_2 + height, 1);
+            }
+            std::fill(hist.begin(), hist.end(), 0);
+            for (int i = 0; i < width; ++i) {
+                const int* h = &colhist[size_t(i) * nbins];
+                for (int b = 0; b < nbins; ++b)
+                    hist[b] += h[b];
+            }
+            ImageBuf::Iterator<Rtype> r(R, roi.xbegin, roi.xend, y, y + 1,
+                                        roi.zbegin, roi.zbegin + 1);
+            for (int i = 0; !r.done(); ++r, ++i) {
+                for (int c = 0; c < nchannels; ++c) {
+                    const int* h = &hist[c * 256];
+                    int v = 0;
+                    for (int count = h[0]; count < target; count += h[++v])
+                        ;
+                    r[c] = convert_type<unsigned char, float>(v);
+                }
+                if (i + width < ncols) {
+                    const int* in  = &colhist[size_t(i + width) * nbins];
+                    const int* out = &colhist[size_t(i) * nbins];
+                    for (int b = 0; b < nbins; ++b)
+                        hist[b] += in[b] - out[b];
+                }
+            }
+        }
+    });
+    return true;
+}
+
+
+
 bool
 ImageBufAlgo::median_filter(ImageBuf& dst, const ImageBuf& src, int width,
                             int height, ROI roi, int nthreads)
@@ -690,7 +987,28 @@ ImageBufAlgo::median_filter(ImageBuf& dst, const ImageBuf& src, int width,
                  IBAprep_REQUIRE_SAME_NCHANNELS | IBAprep_NO_SUPPORT_VOLUME))
         return false;
 
+    if (width < 1)
+        width = 1;
+    if (height < 1)
+        height = width;
     bool ok;
+    // For all but tiny windows, histograms beat selecting from each window.
+    // Timing standalone copies of both kernels on 1024x1024 RGB uint8
+    // noise (single thread; imagebufalgo_test's benchmark has the same
+    // cases through the real code paths), the histogram already wins at
+    // 3x3 for values spread over 0-255 (0.36s vs 0.39s). For bright
+    // images, where finding the median scans most of the bins, the
+    // crossover is between 9 pixels (3x3: 0.57s vs 0.41s) and 12 pixels
+    // (4x3: 0.51s vs 0.57s). From 16 pixels up (4x4: 0.52s vs 0.84s), the
+    // histogram is faster for any image, and its time does not grow with
+    // the window.
+    if (src.spec().format == TypeDesc::UINT8 && width * height >= 16
+        && wrapclamp_always_exists(src)) {
+        OIIO_DISPATCH_TYPES(ok, "median_filter", median_filter_hist_,
+                            dst.spec().format, dst, src, width, height, roi,
+                            nthreads);
+        return ok;
+    }
     OIIO_DISPATCH_COMMON_TYPES2(ok, "median_filter", median_filter_impl,
                                 dst.spec().format, src.spec().format, dst, src,
                                 width, height, roi, nthreads);
@@ -763,6 +1081,116 @@ morph_impl(ImageBuf& R, const ImageBuf& A, int width, int height, MorphOp op,
 
 
 
+// van Herk/Gil-Werman running max (or min): out[i] = op(in[i..i+k-1]) for
+// 0 <= i <= n-k, using about three comparisons per element no matter how
+// big k is. g and h are scratch space of length n.
+template<class OP>
+static void
+vhgw_1d(const float* in, int n, int k, float* out, float* g, float* h, OP op)
+{
+    for (int i = 0; i < n; ++i)
+        g[i] = (i % k == 0) ? in[i] : op(g[i - 1], in[i]);
+    for (int i = n - 1; i >= 0; --i)
+        h[i] = (i == n - 1 || (i + 1) % k == 0) ? in[i] : op(h[i + 1], in[i]);
+    for (int i = 0; i + k <= n; ++i)
+        out[i] = op(h[i], g[i + k - 1]);
+}
+
+
+
+// Separable morphology: the max (or min) over the window is the max of
+// the per-row maxes, so do a horizontal then a vertical vHGW pass.
+template<class Rtype, class Atype, class OP>
+static bool
+morph_vhgw_(ImageBuf& R, const ImageBuf& A, int width, int height, OP op,
+            ROI roi, int nthreads)
+{
+    int w_2       = std::max(1, width / 2);
+    int h_2       = std::max(1, height / 2);
+    int nchannels = R.nchannels();
+    int z         = roi.zbegin;
+    int rw        = roi.width();
+    int ylo       = roi.ybegin - h_2;
+    int nrows     = roi.height() + height - 1;
+    std::vector<float> H(size_t(rw) * nrows * nchannels);
+
+    // Horizontal pass into H, for every row the vertical pass will need
+    ROI hroi(roi.xbegin, roi.xend, ylo, ylo + nrows, z, z + 1);
+    ImageBufAlgo::parallel_image(hroi, nthreads, [&](ROI r) {
+        int n = r.width() + width - 1;
+        std::vector<float> row(size_t(n) * nchannels), in(n), g(n), h(n);
+        std::vector<float> out(r.width());
+        for (int y = r.ybegin; y < r.yend; ++y) {
+            ImageBuf::ConstIterator<Atype> a(A, r.xbegin - w_2,
+                                             r.xbegin - w_2 + n, y, y + 1, z,
+                                             z + 1, ImageBuf::WrapClamp);
+            for (float* p = row.data(); !a.done(); ++a, p += nchannels)
+                for (int c = 0; c < nchannels; ++c)
+                    p[c] = a[c];
+            float* hrow = &H[(size_t(y - ylo) * rw + (r.xbegin - roi.xbegin))
+                             * nchannels];
+            for (int c = 0; c < nchannels; ++c) {
+                for (int i = 0; i < n; ++i)
+                    in[i] = row[i * nchannels + c];
+                vhgw_1d(in.data(), n, width, out.data(), g.data(), h.data(),
+                        op);
+                for (int i = 0; i < r.width(); ++i)
+                    hrow[i * nchannels + c] = out[i];
+            }
+        }
+    });
+
+    // Vertical pass from H into R
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI r) {
+        int n = r.height() + height - 1;
+        std::vector<float> in(n), g(n), h(n), out(r.height());
+        std::vector<float> result(size_t(r.width()) * r.height() * nchannels);
+        for (int x = r.xbegin; x < r.xend; ++x) {
+            const float* col = &H[(size_t(r.ybegin - roi.ybegin) * rw
+                                   + (x - roi.xbegin))
+                                  * nchannels];
+            for (int c = 0; c < nchannels; ++c) {
+                for (int j = 0; j < n; ++j)
+                    in[j] = col[size_t(j) * rw * nchannels + c];
+                vhgw_1d(in.data(), n, height, out.data(), g.data(), h.data(),
+                        op);
+                for (int j = 0; j < r.height(); ++j)
+                    result[(size_t(j) * r.width() + (x - r.xbegin)) * nchannels
+                           + c]
+                        = out[j];
+            }
+        }
+        const float* p = result.data();
+        for (ImageBuf::Iterator<Rtype> d(R, r); !d.done(); ++d, p += nchannels)
+            for (int c = 0; c < nchannels; ++c)
+                d[c] = p[c];
+    });
+    return true;
+}
+
+
+
+template<class Rtype, class Atype>
+static bool
+morph_fast_(ImageBuf& R, const ImageBuf& A, int width, int height, MorphOp op,
+            ROI roi, int nthreads)
+{
+    if (width < 1)
+        width = 1;
+    if (height < 1)
+        height = width;
+    if (op == MorphDilate)
+        return morph_vhgw_<Rtype, Atype>(
+            R, A, width, height, [](float a, float b) { return std::max(a, b); },
+            roi, nthreads);
+    else
+        return morph_vhgw_<Rtype, Atype>(
+            R, A, width, height, [](float a, float b) { return std::min(a, b); },
+            roi, nthreads);
+}
+
+
+
 bool
 ImageBufAlgo::dilate(ImageBuf& dst, const ImageBuf& src, int width, int height,
                      ROI roi, int nthreads)
@@ -773,6 +1201,12 @@ ImageBufAlgo::dilate(ImageBuf& dst, const ImageBuf& src, int width, int height,
         return false;
 
     bool ok;
+    if (wrapclamp_always_exists(src)) {
+        OIIO_DISPATCH_COMMON_TYPES2(ok, "dilate", morph_fast_,
+                                    dst.spec().format, src.spec().format, dst,
+                                    src, width, height, MorphDilate, roi, nthreads);
+        return ok;
+    }
     OIIO_DISPATCH_COMMON_TYPES2(ok, "dilate", morph_impl, dst.spec().format,
                                 src.spec().format, dst, src, width, height,
                                 MorphDilate, roi, nthreads);
@@ -804,6 +1238,12 @@ ImageBufAlgo::erode(ImageBuf& dst, const ImageBuf& src, int width, int height,
         return false;
 
     bool ok;
+    if (wrapclamp_always_exists(src)) {
+        OIIO_DISPATCH_COMMON_TYPES2(ok, "erode", morph_fast_,
+                                    dst.spec().format, src.spec().format, dst,
+                                    src, width, height, MorphErode, roi, nthreads);
+        return ok;
+    }
     OIIO_DISPATCH_COMMON_TYPES2(ok, "erode", morph_impl, dst.spec().format,
                                 src.spec().format, dst, src, width, height,
                                 MorphErode, roi, nthreads);
@@ -15,6 +15,7 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
+#include <OpenImageIO/simd.h>
 #include <OpenImageIO/thread.h>
 
 #include "imageio_pvt.h"
@@ -218,13 +219,24 @@ ImageBufAlgo::computePixelStats(PixelStats& stats, const ImageBuf& src, ROI roi,
 
 
 
+// Partial results of compare_ for one batch of pixels.
+struct CompareBatch {
+    double error    = 0;
+    double sqrerror = 0;
+    float maxval    = 1.0f;
+    bool nonfinite  = false;  // maxerror was not finite at some point
+    ImageBufAlgo::CompareResults result;  // maxerror and where, nwarn, nfail
+};
+
+
+
 template<class BUFT>
 inline void
 compare_value(ImageBuf::ConstIterator<BUFT, float>& a, int chan, float aval,
-              float bval, ImageBufAlgo::CompareResults& result, float& maxval,
-              double& batcherror, double& batch_sqrerror, bool& failed,
-              bool& warned, float failthresh, float warnthresh)
+              float bval, CompareBatch& batch, bool& failed, bool& warned,
+              float failthresh, float warnthresh)
 {
+    ImageBufAlgo::CompareResults& result(batch.result);
     if (!isfinite(aval) || !isfinite(bval)) {
         if (isnan(aval) == isnan(bval) && isinf(aval) == isinf(bval))
             return;  // NaN may match NaN, Inf may match Inf
@@ -235,13 +247,14 @@ compare_value(ImageBuf::ConstIterator<BUFT, float>& a, int chan, float aval,
             result.maxy     = a.y();
             result.maxz     = a.z();
             result.maxc     = chan;
+            batch.nonfinite = true;
             return;
         }
     }
-    maxval   = std::max(maxval, std::max(aval, bval));
-    double f = fabs(aval - bval);
-    batcherror += f;
-    batch_sqrerror += f * f;
+    batch.maxval = std::max(batch.maxval, std::max(aval, bval));
+    double f     = fabs(aval - bval);
+    batch.error += f;
+    batch.sqrerror += f * f;
     // We use the awkward '!(a<=threshold)' construct so that we have
     // failures when f is a NaN (since all comparisons involving NaN will
     // return false).
@@ -251,6 +264,7 @@ compare_value(ImageBuf::ConstIterator<BUFT, float>& a, int chan, float aval,
         result.maxy     = a.y();
         result.maxz     = a.z();
         result.maxc     = chan;
+        batch.nonfinite |= !isfinite(f);
     }
     if (!warned && !(f <= warnthresh)) {
         ++result.nwarn;
@@ -264,11 +278,66 @@ compare_value(ImageBuf::ConstIterator<BUFT, float>& a, int chan, float aval,
 
 
 
+// Compare up to 4 channels of a non-deep pixel at once. The common case of
+// all values finite stays in SIMD, except for adding up the errors and
+// noting a new maximum, which are done in channel order just as
+// compare_value would. Non-finite values are handed to compare_value.
+template<class BUFT>
+inline void
+compare_values4(ImageBuf::ConstIterator<BUFT, float>& a, int chan,
+                const float* avals, const float* bvals, int n,
+                CompareBatch& batch, bool& failed, bool& warned,
+                float failthresh, float warnthresh)
+{
+    using namespace simd;
+    ImageBufAlgo::CompareResults& result(batch.result);
+    vfloat4 aval(avals), bval(bvals);
+    vbool4 valid   = vbool4::from_bitmask((1 << n) - 1);
+    vfloat4 maxfin = std::numeric_limits<float>::max();
+    if (!all((abs(aval) <= maxfin) & (abs(bval) <= maxfin))) {
+        for (int i = 0; i < n; ++i)
+            compare_value(a, chan + i, avals[i], bvals[i], batch, failed,
+                          warned, failthresh, warnthresh);
+        return;
+    }
+    vfloat4 fv = abs(aval - bval);
+    float f[4], m[4];
+    fv.store(f);
+    max(aval, bval).store(m);
+    for (int i = 0; i < n; ++i) {
+        batch.maxval = std::max(batch.maxval, m[i]);
+        batch.error += f[i];
+        batch.sqrerror += double(f[i]) * double(f[i]);
+    }
+    // The awkward '!(a<=threshold)' construct matches compare_value.
+    if (any(!(fv <= vfloat4(result.maxerror)) & valid)) {
+        for (int i = 0; i < n; ++i)
+            if (!(f[i] <= result.maxerror)) {
+                result.maxerror = f[i];
+                result.maxx     = a.x();
+                result.maxy     = a.y();
+                result.maxz     = a.z();
+                result.maxc     = chan + i;
+                batch.nonfinite |= !isfinite(f[i]);
+            }
+    }
+    if (!warned && any(!(fv <= vfloat4(warnthresh)) & valid)) {
+        ++result.nwarn;
+        warned = true;
+    }
+    if (!failed && any(!(fv <= vfloat4(failthresh)) & valid)) {
+        ++result.nfail;
+        failed = true;
+    }
+}
+
+
+
 template<class Atype, class Btype>
 static bool
 compare_(const ImageBuf& A, const ImageBuf& B, float failthresh,
          float warnthresh, ImageBufAlgo::CompareResults& result, ROI roi,
-         int /*nthreads*/)
+         int nthreads)
 {
     imagesize_t npels = roi.npixels();
     imagesize_t nvals = npels * roi.nchannels();
@@ -290,15 +359,34 @@ compare_(const ImageBuf& A, const ImageBuf& B, float failthresh,
     // image. The compare_value() function we call on every pixel value will
     // check and adjust our max as needed.
 
-    ImageBuf::ConstIterator<Atype> a(A, roi, ImageBuf::WrapBlack);
-    ImageBuf::ConstIterator<Btype> b(B, roi, ImageBuf::WrapBlack);
     bool deep = A.deep();
     // Break up into batches to reduce cancelation errors as the error
     // sums become too much larger than the error for individual pixels.
+    // The batches are also the unit of parallelism: they are the same no
+    // matter how many threads there are, and their results are combined
+    // in order below, so the results don't depend on the thread count.
     const int batchsize = 4096;  // As good a guess as any
-    for (; !a.done();) {
-        double batcherror     = 0;
-        double batch_sqrerror = 0;
+    int64_t nbatches    = int64_t((npels + batchsize - 1) / batchsize);
+    std::vector<CompareBatch> batches(nbatches);
+
+    // Position a and b at the first pixel of batch bt.
+    auto seek = [&](ImageBuf::ConstIterator<Atype>& a,
+                    ImageBuf::ConstIterator<Btype>& b, int64_t bt) {
+        imagesize_t first = imagesize_t(bt) * batchsize;
+        imagesize_t plane = imagesize_t(roi.width()) * roi.height();
+        int x             = roi.xbegin + int(first % roi.width());
+        int y             = roi.ybegin + int(first % plane / roi.width());
+        int z             = roi.zbegin + int(first / plane);
+        a.pos(x, y, z);
+        b.pos(x, y, z);
+    };
+
+    // Compare the pixels of one batch, starting from its maximum error
+    // so far, and leave a and b just past it.
+    auto compare_batch = [&](ImageBuf::ConstIterator<Atype>& a,
+                             ImageBuf::ConstIterator<Btype>& b,
+                             CompareBatch& batch) {
+        float avals[4], bvals[4];
         if (deep) {
             for (int i = 0; i < batchsize && !a.done(); ++i, ++a, ++b) {
                 bool warned = false, failed = false;  // For this pixel
@@ -306,23 +394,78 @@ compare_(const ImageBuf& A, const ImageBuf& B, float failthresh,
                 for (int c = roi.chbegin; c < roi.chend; ++c)
                     for (int s = 0, e = nsamps; s < e; ++s) {
                         compare_value(a, c, a.deep_value(c, s),
-                                      b.deep_value(c, s), result, maxval,
-                                      batcherror, batch_sqrerror, failed,
+                                      b.deep_value(c, s), batch, failed,
                                       warned, failthresh, warnthresh);
                     }
             }
         } else {  // non-deep
             for (int i = 0; i < batchsize && !a.done(); ++i, ++a, ++b) {
                 bool warned = false, failed = false;  // For this pixel
-                for (int c = roi.chbegin; c < roi.chend; ++c)
-                    compare_value(a, c, c < Achannels ? a[c] : 0.0f,
-                                  c < Bchannels ? b[c] : 0.0f, result, maxval,
-                                  batcherror, batch_sqrerror, failed, warned,
-                                  failthresh, warnthresh);
+                for (int c = roi.chbegin; c < roi.chend; c += 4) {
+                    int n = std::min(4, roi.chend - c);
+                    for (int j = 0; j < 4; ++j) {
+                        avals[j] = j < n && c + j < Achannels ? a[c + j]
+                                                              : 0.0f;
+                        bvals[j] = j < n && c + j < Bchannels ? b[c + j]
+                                                              : 0.0f;
+                    }
+                    compare_values4(a, c, avals, bvals, n, batch, failed,
+                                    warned, failthresh, warnthresh);
+                }
             }
         }
-        totalerror += batcherror;
-        totalsqrerror += batch_sqrerror;
+    };
+
+    parallel_for_chunked(0, nbatches, 0, [&](int64_t bbegin, int64_t bend) {
+        ImageBuf::ConstIterator<Atype> a(A, roi, ImageBuf::WrapBlack);
+        ImageBuf::ConstIterator<Btype> b(B, roi, ImageBuf::WrapBlack);
+        seek(a, b, bbegin);
+        for (int64_t bt = bbegin; bt < bend; ++bt) {
+            ImageBufAlgo::CompareResults& r(batches[bt].result);
+            r.maxerror = 0;
+            r.maxx = 0, r.maxy = 0, r.maxz = 0, r.maxc = 0;
+            r.nfail = 0, r.nwarn = 0;
+            compare_batch(a, b, batches[bt]);
+        }
+    }, parallel_options(nthreads, Split_Y, 1));
+
+    for (int64_t bt = 0; bt < nbatches; ++bt) {
+        CompareBatch& batch(batches[bt]);
+        ImageBufAlgo::CompareResults& r(batch.result);
+        // Each batch started from a maximum error of 0. That only matters
+        // once the maximum so far is not finite: compare_value passes over
+        // a non-finite mismatch only while the maximum is finite, and a
+        // NaN maximum gives way to the very next error. So in that case a
+        // batch that met a non-finite error (or any batch, after a NaN) is
+        // redone from the maximum so far, exactly as comparing pixel by
+        // pixel would go. That only happens for broken images.
+        bool redo = !isfinite(result.maxerror)
+                    && (batch.nonfinite || isnan(result.maxerror));
+        if (redo) {
+            batch = CompareBatch();
+            r     = result;
+            r.nfail = 0, r.nwarn = 0;
+            ImageBuf::ConstIterator<Atype> a(A, roi, ImageBuf::WrapBlack);
+            ImageBuf::ConstIterator<Btype> b(B, roi, ImageBuf::WrapBlack);
+            seek(a, b, bt);
+            compare_batch(a, b, batch);
+        }
+        totalerror += batch.error;
+        totalsqrerror += batch.sqrerror;
+        maxval = std::max(maxval, batch.maxval);
+        result.nwarn += r.nwarn;
+        result.nfail += r.nfail;
+        // An earlier batch keeps the maximum unless a later one exceeds
+        // it, just as when comparing pixel by pixel. A batch whose maximum
+        // went non-finite (or that was redone) ended up with the same
+        // maximum as comparing pixel by pixel would have, so it wins.
+        if (redo || batch.nonfinite || !(r.maxerror <= result.maxerror)) {
+            result.maxerror = r.maxerror;
+            result.maxx     = r.maxx;
+            result.maxy     = r.maxy;
+            result.maxz     = r.maxz;
+            result.maxc     = r.maxc;
+        }
     }
     result.meanerror = totalerror / nvals;
     result.rms_error = sqrt(totalsqrerror / nvals);
@@ -356,9 +499,6 @@ ImageBufAlgo::compare(const ImageBuf& A, const ImageBuf& B, float failthresh,
     OIIO_DISPATCH_COMMON_TYPES2_CONST(ok, "compare", compare_, A.spec().format,
                                       B.spec().format, A, B, failthresh,
                                       warnthresh, result, roi, nthreads);
-    // FIXME - The nthreads argument is for symmetry with the rest of
-    // ImageBufAlgo and for future expansion. But for right now, we
-    // don't actually split by threads.  Maybe later.
     result.error = !ok;
     return result;
 }
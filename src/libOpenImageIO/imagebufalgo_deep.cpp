@@ -5,6 +5,7 @@
 
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
 #include <OpenImageIO/dassert.h>
@@ -12,6 +13,7 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
+#include <OpenImageIO/simd.h>
 #include <OpenImageIO/thread.h>
 #include <OpenImageIO/timer.h>
 
@@ -236,6 +238,54 @@ ImageBufAlgo::deepen(const ImageBuf& src, float zvalue, ROI roi, int nthreads)
 
 
 
+// Gather the Z and Zback of each sample of a deep pixel, padded with NaN
+// to a multiple of 4 so that count_splits can compare them four at a time
+// (a NaN never lies inside a segment).
+static void
+gather_depths(const DeepData& dd, int pixel, std::vector<float>& z,
+              std::vector<float>& zback)
+{
+    int zchan     = dd.Z_channel();
+    int zbackchan = dd.Zback_channel();
+    int n         = dd.samples(pixel);
+    z.assign((n + 3) & ~3, std::numeric_limits<float>::quiet_NaN());
+    zback.assign(z.size(), std::numeric_limits<float>::quiet_NaN());
+    for (int s = 0; s < n; ++s) {
+        z[s]     = dd.deep_value(pixel, zchan, s);
+        zback[s] = dd.deep_value(pixel, zbackchan, s);
+    }
+}
+
+
+
+// Count the splits that merging the first An samples of A with the
+// (padded) samples of B will make: each time an end of a segment of one
+// lies strictly inside a segment of the other.
+static int
+count_splits(const std::vector<float>& Az, const std::vector<float>& Azback,
+             int An, const std::vector<float>& Bz,
+             const std::vector<float>& Bzback)
+{
+    using namespace simd;
+    vint4 nsplits = vint4::Zero();
+    const vint4 one(1);
+    for (int s = 0; s < An; ++s) {
+        vfloat4 src_z(Az[s]), src_zback(Azback[s]);
+        for (size_t d = 0, n = Bz.size(); d < n; d += 4) {
+            vfloat4 dst_z(&Bz[d]), dst_zback(&Bzback[d]);
+            nsplits += blend0(one, (src_z > dst_z) & (src_z < dst_zback));
+            nsplits += blend0(one,
+                              (src_zback > dst_z) & (src_zback < dst_zback));
+            nsplits += blend0(one, (dst_z > src_z) & (dst_z < src_zback));
+            nsplits += blend0(one,
+                              (dst_zback > src_z) & (dst_zback < src_zback));
+        }
+    }
+    return reduce_add(nsplits);
+}
+
+
+
 bool
 ImageBufAlgo::deep_merge(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B,
                          bool occlusion_cull, ROI roi, int nthreads)
@@ -256,92 +306,51 @@ ImageBufAlgo::deep_merge(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B,
 
     // First, set the capacity of the dst image to reserve enough space for
     // the segments of both source images, including any splits that may
-    // occur.
+    // occur, so that the merge never has to grow a pixel. Pixels in
+    // different scanlines can be sized and merged concurrently.
     DeepData& dstdd(*dst.deepdata());
     const DeepData& Add(*A.deepdata());
     const DeepData& Bdd(*B.deepdata());
-    int Azchan     = Add.Z_channel();
-    int Azbackchan = Add.Zback_channel();
-    int Bzchan     = Bdd.Z_channel();
-    int Bzbackchan = Bdd.Zback_channel();
-    for (int z = roi.zbegin; z < roi.zend; ++z)
-        for (int y = roi.ybegin; y < roi.yend; ++y)
-            for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel            = dst.pixelindex(x, y, z, true);
-                int Apixel              = A.pixelindex(x, y, z, true);
-                int Bpixel              = B.pixelindex(x, y, z, true);
-                int Asamps              = Add.samples(Apixel);
-                int Bsamps              = Bdd.samples(Bpixel);
-                int nsplits             = 0;
-                int self_overlap_splits = 0;
-                for (int s = 0; s < Asamps; ++s) {
-                    float src_z     = Add.deep_value(Apixel, Azchan, s);
-                    float src_zback = Add.deep_value(Apixel, Azbackchan, s);
-                    for (int d = 0; d < Bsamps; ++d) {
-                        float dst_z     = Bdd.deep_value(Bpixel, Bzchan, d);
-                        float dst_zback = Bdd.deep_value(Bpixel, Bzbackchan, d);
-                        if (src_z > dst_z && src_z < dst_zback)
-                            ++nsplits;
-                        if (src_zback > dst_z && src_zback < dst_zback)
-                            ++nsplits;
-                        if (dst_z > src_z && dst_z < src_zback)
-                            ++nsplits;
-                        if (dst_zback > src_z && dst_zback < src_zback)
-                            ++nsplits;
-                    }
-                    // Check for splits src vs src -- in case they overlap!
-                    for (int ss = s; ss < Asamps; ++ss) {
-                        float src_z2     = Add.deep_value(Apixel, Azchan, ss);
-                        float src_zback2 = Add.deep_value(Apixel, Azbackchan,
-                                                          ss);
-                        if (src_z2 > src_z && src_z2 < src_zback)
-                            ++self_overlap_splits;
-                        if (src_zback2 > src_z && src_zback2 < src_zback)
-                            ++self_overlap_splits;
-                        if (src_z > src_z2 && src_z < src_zback2)
-                            ++self_overlap_splits;
-                        if (src_zback > src_z2 && src_zback < src_zback2)
-                            ++self_overlap_splits;
-                    }
-                }
-                // Check for splits dst vs dst -- in case they overlap!
-                for (int d = 0; d < Bsamps; ++d) {
-                    float dst_z     = Bdd.deep_value(Bpixel, Bzchan, d);
-                    float dst_zback = Bdd.deep_value(Bpixel, Bzbackchan, d);
-                    for (int dd = d; dd < Bsamps; ++dd) {
-                        float dst_z2     = Bdd.deep_value(Bpixel, Bzchan, dd);
-                        float dst_zback2 = Bdd.deep_value(Bpixel, Bzbackchan,
-                                                          dd);
-                        if (dst_z2 > dst_z && dst_z2 < dst_zback)
-                            ++self_overlap_splits;
-                        if (dst_zback2 > dst_z && dst_zback2 < dst_zback)
-                            ++self_overlap_splits;
-                        if (dst_z > dst_z2 && dst_z < dst_zback2)
-                            ++self_overlap_splits;
-                        if (dst_zback > dst_z2 && dst_zback < dst_zback2)
-                            ++self_overlap_splits;
-                    }
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
+        std::vector<float> Az, Azback, Bz, Bzback;
+        for (int z = roi.zbegin; z < roi.zend; ++z)
+            for (int y = roi.ybegin; y < roi.yend; ++y)
+                for (int x = roi.xbegin; x < roi.xend; ++x) {
+                    int dstpixel = dst.pixelindex(x, y, z, true);
+                    int Apixel   = A.pixelindex(x, y, z, true);
+                    int Bpixel   = B.pixelindex(x, y, z, true);
+                    int Asamps   = Add.samples(Apixel);
+                    int Bsamps   = Bdd.samples(Bpixel);
+                    gather_depths(Add, Apixel, Az, Azback);
+                    gather_depths(Bdd, Bpixel, Bz, Bzback);
+                    // Splits of A vs B, plus A vs A and B vs B -- in case
+                    // they overlap! The latter count every pair twice.
+                    int nsplits = count_splits(Az, Azback, Asamps, Bz, Bzback);
+                    int self_overlap_splits
+                        = count_splits(Az, Azback, Asamps, Az, Azback) / 2
+                          + count_splits(Bz, Bzback, Bsamps, Bz, Bzback) / 2;
+                    dstdd.set_capacity(dstpixel, Asamps + Bsamps + nsplits
+                                                     + self_overlap_splits);
                 }
-
-                dstdd.set_capacity(dstpixel, Asamps + Bsamps + nsplits
-                                                 + self_overlap_splits);
-            }
+    });
 
     bool ok = ImageBufAlgo::copy(dst, A, TypeDesc::UNKNOWN, roi, nthreads);
 
-    for (int z = roi.zbegin; z < roi.zend; ++z)
-        for (int y = roi.ybegin; y < roi.yend; ++y)
-            for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel = dst.pixelindex(x, y, z, true);
-                int Bpixel   = B.pixelindex(x, y, z, true);
-                OIIO_DASSERT(dstpixel >= 0);
-                // OIIO_UNUSED_OK int oldcap = dstdd.capacity (dstpixel);
-                dstdd.merge_deep_pixels(dstpixel, Bdd, Bpixel);
-                // OIIO_DASSERT (oldcap == dstdd.capacity(dstpixel) &&
-                //          "Broken: we did not preallocate enough capacity");
-                if (occlusion_cull)
-                    dstdd.occlusion_cull(dstpixel);
-            }
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
+        for (int z = roi.zbegin; z < roi.zend; ++z)
+            for (int y = roi.ybegin; y < roi.yend; ++y)
+                for (int x = roi.xbegin; x < roi.xend; ++x) {
+                    int dstpixel = dst.pixelindex(x, y, z, true);
+                    int Bpixel   = B.pixelindex(x, y, z, true);
+                    OIIO_DASSERT(dstpixel >= 0);
+                    // OIIO_UNUSED_OK int oldcap = dstdd.capacity (dstpixel);
+                    dstdd.merge_deep_pixels(dstpixel, Bdd, Bpixel);
+                    // OIIO_DASSERT (oldcap == dstdd.capacity(dstpixel) &&
+                    //          "Broken: we did not preallocate enough capacity");
+                    if (occlusion_cull)
+                        dstdd.occlusion_cull(dstpixel);
+                }
+    });
     return ok;
 }
 
@@ -362,7 +371,7 @@ ImageBufAlgo::deep_merge(const ImageBuf& A, const ImageBuf& B,
 
 bool
 ImageBufAlgo::deep_holdout(ImageBuf& dst, const ImageBuf& src,
-                           const ImageBuf& thresh, ROI roi, int /*nthreads*/)
+                           const ImageBuf& thresh, ROI roi, int nthreads)
 {
     pvt::LoggedTimer logtime("IBA::deep_holdout");
     if (!src.deep() || !thresh.deep()) {
@@ -380,51 +389,56 @@ ImageBufAlgo::deep_holdout(ImageBuf& dst, const ImageBuf& src,
     const DeepData& srcdd(*src.deepdata());
     // First, reserve enough space in dst, to reduce the number of
     // allocations we'll do later.
-    for (int z = roi.zbegin; z < roi.zend; ++z)
-        for (int y = roi.ybegin; y < roi.yend; ++y)
-            for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel = dst.pixelindex(x, y, z, true);
-                int srcpixel = src.pixelindex(x, y, z, true);
-                if (dstpixel >= 0 && srcpixel >= 0)
-                    dstdd.set_capacity(dstpixel, srcdd.capacity(srcpixel));
-            }
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
+        for (int z = roi.zbegin; z < roi.zend; ++z)
+            for (int y = roi.ybegin; y < roi.yend; ++y)
+                for (int x = roi.xbegin; x < roi.xend; ++x) {
+                    int dstpixel = dst.pixelindex(x, y, z, true);
+                    int srcpixel = src.pixelindex(x, y, z, true);
+                    if (dstpixel >= 0 && srcpixel >= 0)
+                        dstdd.set_capacity(dstpixel,
+                                           srcdd.capacity(srcpixel));
+                }
+    });
     // Now we compute each pixel: We copy the src pixel to dst, then split
     // any samples that span the opaque threshold, and then delete any
     // samples that lie beyond the threshold.
     int Zchan     = dstdd.Z_channel();
     int Zbackchan = dstdd.Zback_channel();
     const DeepData& threshdd(*thresh.deepdata());
-    for (ImageBuf::Iterator<float> r(dst, roi); !r.done(); ++r) {
-        int x = r.x(), y = r.y(), z = r.z();
-        int srcpixel = src.pixelindex(x, y, z, true);
-        if (srcpixel < 0)
-            continue;  // Nothing in this pixel
-        int dstpixel = dst.pixelindex(x, y, z, true);
-        dstdd.copy_deep_pixel(dstpixel, srcdd, srcpixel);
-        int threshpixel = thresh.pixelindex(x, y, z, true);
-        if (threshpixel < 0)
-            continue;  // No threshold mask for this pixel
-        float zthresh = threshdd.opaque_z(threshpixel);
-        // Eliminate the samples that are entirely beyond the depth
-        // threshold. Do this before the split; that makes it less
-        // likely that the split will force a re-allocation.
-        for (int s = 0, n = dstdd.samples(dstpixel); s < n; ++s) {
-            if (dstdd.deep_value(dstpixel, Zchan, s) > zthresh) {
-                dstdd.set_samples(dstpixel, s);
-                break;
-            }
-        }
-        // Now split any samples that straddle the z.
-        if (dstdd.split(dstpixel, zthresh)) {
-            // If a split did occur, do another discard pass.
+    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
+        for (ImageBuf::Iterator<float> r(dst, roi); !r.done(); ++r) {
+            int x = r.x(), y = r.y(), z = r.z();
+            int srcpixel = src.pixelindex(x, y, z, true);
+            if (srcpixel < 0)
+                continue;  // Nothing in this pixel
+            int dstpixel = dst.pixelindex(x, y, z, true);
+            dstdd.copy_deep_pixel(dstpixel, srcdd, srcpixel);
+            int threshpixel = thresh.pixelindex(x, y, z, true);
+            if (threshpixel < 0)
+                continue;  // No threshold mask for this pixel
+            float zthresh = threshdd.opaque_z(threshpixel);
+            // Eliminate the samples that are entirely beyond the depth
+            // threshold. Do this before the split; that makes it less
+            // likely that the split will force a re-allocation.
             for (int s = 0, n = dstdd.samples(dstpixel); s < n; ++s) {
-                if (dstdd.deep_value(dstpixel, Zbackchan, s) > zthresh) {
+                if (dstdd.deep_value(dstpixel, Zchan, s) > zthresh) {
                     dstdd.set_samples(dstpixel, s);
                     break;
                 }
             }
+            // Now split any samples that straddle the z.
+            if (dstdd.split(dstpixel, zthresh)) {
+                // If a split did occur, do another discard pass.
+                for (int s = 0, n = dstdd.samples(dstpixel); s < n; ++s) {
+                    if (dstdd.deep_value(dstpixel, Zbackchan, s) > zthresh) {
+                        dstdd.set_samples(dstpixel, s);
+                        break;
+                    }
+                }
+            }
         }
-    }
+    });
     return true;
 }
 
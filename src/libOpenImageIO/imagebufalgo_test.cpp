@@ -3,9 +3,12 @@
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
 
+#include <cmath>
 #include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <random>
 #include <string>
 
 #include <OpenImageIO/platform.h>
@@ -593,6 +596,106 @@ test_compare()
 
 
 
+// Are two CompareResults fields the same, counting NaN as equal to NaN?
+static bool
+same_result(double a, double b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+
+
+// Tests that ImageBufAlgo::compare gives identical results no matter how
+// many threads it uses, on images spanning many of its 4096-pixel batches,
+// with NaN and Inf values and channel counts that are not a multiple of 4.
+void
+test_compare_threads()
+{
+    std::cout << "test compare threads\n";
+    const int WIDTH = 300, HEIGHT = 110;
+    for (int nchans : { 1, 3, 5, 6 }) {
+        for (bool nonfinite : { false, true }) {
+            ImageSpec spec(WIDTH, HEIGHT, nchans, TypeDesc::FLOAT);
+            ImageBuf A(spec), B(spec);
+            ImageBufAlgo::noise(A, "uniform", 0.0f, 1.0f, false, 1);
+            ImageBufAlgo::copy(B, A);
+            ImageBufAlgo::noise(B, "uniform", -0.02f, 0.02f, false, 2);
+            if (nonfinite) {
+                const float nan = std::numeric_limits<float>::quiet_NaN();
+                const float inf = std::numeric_limits<float>::infinity();
+                int c           = nchans - 1;
+                // NaN matching NaN and Inf matching Inf are not errors.
+                A.setpixel(10, 5, 0, &nan, 1);
+                B.setpixel(10, 5, 0, &nan, 1);
+                A.setpixel(200, 30, 0, &inf, 1);
+                B.setpixel(200, 30, 0, &inf, 1);
+                // Mismatches, in later batches and in other channels.
+                float pix[6];
+                B.getpixel(150, 60, pix, nchans);
+                pix[c] = nan;
+                B.setpixel(150, 60, pix, nchans);
+                A.getpixel(299, 100, pix, nchans);
+                pix[c] = inf;
+                A.setpixel(299, 100, pix, nchans);
+            }
+            auto r1 = ImageBufAlgo::compare(A, B, 0.015f, 0.01f, {}, 1);
+            for (int nthreads : { 0, 2, numthreads }) {
+                auto r = ImageBufAlgo::compare(A, B, 0.015f, 0.01f, {},
+                                               nthreads);
+                OIIO_CHECK_ASSERT(same_result(r.meanerror, r1.meanerror));
+                OIIO_CHECK_ASSERT(same_result(r.rms_error, r1.rms_error));
+                OIIO_CHECK_ASSERT(same_result(r.PSNR, r1.PSNR));
+                OIIO_CHECK_ASSERT(same_result(r.maxerror, r1.maxerror));
+                OIIO_CHECK_EQUAL(r.maxx, r1.maxx);
+                OIIO_CHECK_EQUAL(r.maxy, r1.maxy);
+                OIIO_CHECK_EQUAL(r.maxz, r1.maxz);
+                OIIO_CHECK_EQUAL(r.maxc, r1.maxc);
+                OIIO_CHECK_EQUAL(r.nwarn, r1.nwarn);
+                OIIO_CHECK_EQUAL(r.nfail, r1.nfail);
+                OIIO_CHECK_EQUAL(r.error, r1.error);
+            }
+            OIIO_CHECK_ASSERT(r1.nfail > 0);
+            if (nonfinite)
+                OIIO_CHECK_EQUAL(r1.maxerror,
+                                 std::numeric_limits<double>::infinity());
+        }
+    }
+}
+
+
+
+// Tests that ImageBufAlgo::compare passes over only the first non-finite
+// mismatch of the whole image, as it always has, and not the first one of
+// each of the batches it splits the image into. The expected values are
+// what comparing pixel by pixel gives: the first Inf only sets maxerror,
+// and the others each count as a failure with an infinite error.
+void
+test_compare_nonfinite()
+{
+    std::cout << "test compare nonfinite\n";
+    const float inf = std::numeric_limits<float>::infinity();
+    ImageSpec spec(100, 100, 1, TypeDesc::FLOAT);
+    ImageBuf A(spec), B(spec);
+    ImageBufAlgo::zero(A);
+    ImageBufAlgo::zero(B);
+    // One Inf in each of the three 4096-pixel batches.
+    A.setpixel(10, 0, 0, &inf, 1);
+    A.setpixel(0, 50, 0, &inf, 1);
+    A.setpixel(0, 90, 0, &inf, 1);
+    for (int nthreads : { 1, 0 }) {
+        auto r = ImageBufAlgo::compare(A, B, 0.01f, 0.01f, {}, nthreads);
+        OIIO_CHECK_EQUAL(r.nfail, 2);
+        OIIO_CHECK_EQUAL(r.nwarn, 2);
+        OIIO_CHECK_EQUAL(r.maxerror, std::numeric_limits<double>::infinity());
+        OIIO_CHECK_EQUAL(r.maxx, 10);
+        OIIO_CHECK_EQUAL(r.maxy, 0);
+        OIIO_CHECK_EQUAL(r.maxc, 0);
+        OIIO_CHECK_EQUAL(r.meanerror, std::numeric_limits<double>::infinity());
+    }
+}
+
+
+
 // Tests ImageBufAlgo::isConstantColor
 void
 test_isConstantColor()
@@ -879,6 +982,190 @@ test_IBAprep()
 
 
 
+// Convolve the slow and obvious way, for comparison.
+static ImageBuf
+convolve_reference(const ImageBuf& src, const ImageBuf& kernel)
+{
+    ImageBuf R(src.spec());
+    ROI kroi   = kernel.roi();
+    int nchans = src.nchannels();
+    float ksum = 0.0f;
+    for (ImageBuf::ConstIterator<float> k(kernel); !k.done(); ++k)
+        ksum += k[0];
+    std::vector<float> sum(nchans), pel(nchans);
+    for (ImageBuf::Iterator<float> r(R); !r.done(); ++r) {
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        for (int j = kroi.ybegin; j < kroi.yend; ++j)
+            for (int i = kroi.xbegin; i < kroi.xend; ++i) {
+                float k = kernel.getchannel(i, j, 0, 0);
+                src.getpixel(r.x() + i, r.y() + j, 0, pel.data(), nchans,
+                             ImageBuf::WrapClamp);
+                for (int c = 0; c < nchans; ++c)
+                    sum[c] += k * pel[c];
+            }
+        for (int c = 0; c < nchans; ++c)
+            r[c] = sum[c] / ksum;
+    }
+    return R;
+}
+
+
+
+// Test ImageBufAlgo::convolve, for each of the ways it may be computed
+void
+test_convolve()
+{
+    std::cout << "test convolve\n";
+    ImageBuf src = ImageBufAlgo::noise("uniform", 0.0f, 1.0f, false, 1,
+                                       ROI(0, 64, 0, 48, 0, 1, 0, 3));
+    ImageBuf gauss = ImageBufAlgo::make_kernel("gaussian", 9, 9);
+    ImageBuf disk  = ImageBufAlgo::make_kernel("disk", 9, 9);
+    int fft_threshold = 0;
+    OIIO::getattribute("imagebufalgo:convolve_fft_threshold", fft_threshold);
+
+    // Separable
+    auto comp = ImageBufAlgo::compare(ImageBufAlgo::convolve(src, gauss),
+                                      convolve_reference(src, gauss), 1.0e-5f,
+                                      1.0e-5f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+
+    // Not separable, computed directly
+    OIIO::attribute("imagebufalgo:convolve_fft_threshold", 0);
+    comp = ImageBufAlgo::compare(ImageBufAlgo::convolve(src, disk),
+                                 convolve_reference(src, disk), 1.0e-5f,
+                                 1.0e-5f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+
+    // Not separable, computed with FFTs
+    OIIO::attribute("imagebufalgo:convolve_fft_threshold", 1);
+    comp = ImageBufAlgo::compare(ImageBufAlgo::convolve(src, disk),
+                                 convolve_reference(src, disk), 1.0e-4f,
+                                 1.0e-4f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+
+    // Timing: the same size blur computed each of the three ways. Nudging
+    // one tap of the Gaussian makes it no longer separable.
+    Benchmarker bench;
+    bench.iterations(1).trials(3);
+    ImageBuf big = ImageBufAlgo::noise("uniform", 0.0f, 1.0f, false, 1,
+                                       ROI(0, 256, 0, 256, 0, 1, 0, 3));
+    ImageBuf K = ImageBufAlgo::make_kernel("gaussian", 21, 21);
+    ImageBuf Knudged(K.spec());
+    Knudged.copy_pixels(K);
+    const float nudge = 0.001f;
+    Knudged.setpixel(K.xbegin(), K.ybegin(), &nudge);
+    ImageBuf R;
+    OIIO::attribute("imagebufalgo:convolve_fft_threshold", 0);
+    bench("  IBA::convolve 21x21 direct ",
+          [&]() { ImageBufAlgo::convolve(R, big, Knudged); });
+    bench("  IBA::convolve 21x21 separable ",
+          [&]() { ImageBufAlgo::convolve(R, big, K); });
+    OIIO::attribute("imagebufalgo:convolve_fft_threshold", 1);
+    bench("  IBA::convolve 21x21 fft ",
+          [&]() { ImageBufAlgo::convolve(R, big, Knudged); });
+    OIIO::attribute("imagebufalgo:convolve_fft_threshold", fft_threshold);
+}
+
+
+
+// Test median_filter, dilate, and erode against a brute force reference
+void
+test_median_morph()
+{
+    std::cout << "test median_filter, dilate, erode\n";
+    ImageBuf src = ImageBufAlgo::noise("uniform", 0.0f, 1.0f, false, 1,
+                                       ROI(0, 40, 0, 30, 0, 1, 0, 3));
+    ImageBuf src8;
+    src8.copy(src, TypeUInt8);
+
+    // Compute the reference result of each filter, sorting each window.
+    auto reference = [](const ImageBuf& A, int w, int h, int which) {
+        ImageBuf R(ImageSpec(A.spec().width, A.spec().height,
+                             A.spec().nchannels, TypeFloat));
+        int nchans = A.nchannels();
+        std::vector<float> pel(nchans);
+        std::vector<std::vector<float>> vals(nchans);
+        for (ImageBuf::Iterator<float> r(R); !r.done(); ++r) {
+            for (auto& v : vals)
+                v.clear();
+            for (int y = r.y() - h / 2; y < r.y() - h / 2 + h; ++y)
+                for (int x = r.x() - w / 2; x < r.x() - w / 2 + w; ++x) {
+                    A.getpixel(x, y, 0, pel.data(), nchans,
+                               ImageBuf::WrapClamp);
+                    for (int c = 0; c < nchans; ++c)
+                        vals[c].push_back(pel[c]);
+                }
+            for (int c = 0; c < nchans; ++c) {
+                std::sort(vals[c].begin(), vals[c].end());
+                r[c] = which < 0 ? vals[c].front()
+                                 : (which > 0 ? vals[c].back()
+                                              : vals[c][vals[c].size() / 2]);
+            }
+        }
+        return R;
+    };
+
+    ImageBuf R;
+    ImageBufAlgo::median_filter(R, src, 3, 3);
+    auto comp = ImageBufAlgo::compare(R, reference(src, 3, 3, 0), 0.0f, 0.0f);
+    OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+    ImageBufAlgo::median_filter(R, src8, 9, 7);  // histogram method
+    comp = ImageBufAlgo::compare(R, reference(src8, 9, 7, 0), 0.0f, 0.0f);
+    OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+    ImageBufAlgo::median_filter(R, src8, 4, 4);  // smallest histogram case
+    comp = ImageBufAlgo::compare(R, reference(src8, 4, 4, 0), 0.0f, 0.0f);
+    OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+    ImageBufAlgo::median_filter(R, src8, 5, 3);  // selection, below it
+    comp = ImageBufAlgo::compare(R, reference(src8, 5, 3, 0), 0.0f, 0.0f);
+    OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+    ImageBufAlgo::dilate(R, src, 5, 3);
+    comp = ImageBufAlgo::compare(R, reference(src, 5, 3, 1), 0.0f, 0.0f);
+    OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+    ImageBufAlgo::erode(R, src8, 7, 9);
+    comp = ImageBufAlgo::compare(R, reference(src8, 7, 9, -1), 0.0f, 0.0f);
+    OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+
+    // Timing
+    Benchmarker bench;
+    bench.iterations(1).trials(3);
+    ImageBuf big8;
+    big8.copy(ImageBufAlgo::noise("uniform", 0.0f, 1.0f, false, 1,
+                                  ROI(0, 512, 0, 512, 0, 1, 0, 3)),
+              TypeUInt8);
+    ImageBuf B;
+    bench("  IBA::median_filter 31x31 uint8 ",
+          [&]() { ImageBufAlgo::median_filter(B, big8, 31, 31); });
+    // Small windows with each median method, to find where the histogram
+    // method starts to win. A display window one pixel larger than the
+    // data window forces the selection method on the same pixels. Bright
+    // images are the histogram's worst case (longest scan for the median).
+    ImageBuf bright8;
+    bright8.copy(ImageBufAlgo::noise("uniform", 0.94f, 1.0f, false, 1,
+                                     ROI(0, 512, 0, 512, 0, 1, 0, 3)),
+                 TypeUInt8);
+    for (auto img : { &big8, &bright8 }) {
+        ImageBuf sel8(*img);
+        sel8.specmod().full_width += 1;
+        for (auto wh : { std::make_pair(3, 3), std::make_pair(4, 3),
+                         std::make_pair(4, 4), std::make_pair(5, 5),
+                         std::make_pair(7, 7) }) {
+            std::string name = Strutil::sprintf(
+                "  IBA::median_filter %dx%d uint8 %s ", wh.first, wh.second,
+                img == &big8 ? "noise " : "bright");
+            bench(name + "select",
+                  [&]() { ImageBufAlgo::median_filter(B, sel8, wh.first,
+                                                      wh.second); });
+            bench(name + "hist  ", [&]() {
+                ImageBufAlgo::median_filter(B, *img, wh.first, wh.second);
+            });
+        }
+    }
+    bench("  IBA::dilate 31x31 uint8 ",
+          [&]() { ImageBufAlgo::dilate(B, big8, 31, 31); });
+}
+
+
+
 void
 benchmark_parallel_image(int res, int iters)
 {
@@ -963,6 +1250,103 @@ test_opencv()
 
 
 
+// Make a deep RGBAZZBack image whose pixels have 0-5 samples of random
+// depth ranges, overlapping each other within the pixel, some of them
+// opaque and some of them just points.
+static ImageBuf
+make_random_deep(int width, int height, unsigned int seed)
+{
+    ImageSpec spec(width, height, 6, TypeDesc::FLOAT);
+    spec.channelnames  = { "R", "G", "B", "A", "Z", "ZBack" };
+    spec.alpha_channel = 3;
+    spec.z_channel     = 4;
+    spec.deep          = true;
+    ImageBuf buf(spec);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int n = int(rng() % 6);
+            buf.set_deep_samples(x, y, 0, n);
+            for (int s = 0; s < n; ++s) {
+                float a     = unit(rng) < 0.1f ? 1.0f : unit(rng);
+                float z     = 10.0f * unit(rng);
+                float zback = unit(rng) < 0.2f ? z : z + 3.0f * unit(rng);
+                for (int c = 0; c < 3; ++c)
+                    buf.set_deep_value(x, y, 0, c, s, a * unit(rng));
+                buf.set_deep_value(x, y, 0, 3, s, a);
+                buf.set_deep_value(x, y, 0, 4, s, z);
+                buf.set_deep_value(x, y, 0, 5, s, zback);
+            }
+        }
+    }
+    return buf;
+}
+
+
+
+// Check that two deep images have exactly the same samples.
+static void
+check_deep_identical(const ImageBuf& A, const ImageBuf& B)
+{
+    OIIO_CHECK_ASSERT(A.deep() && B.deep());
+    OIIO_CHECK_ASSERT(A.roi() == B.roi());
+    OIIO_CHECK_EQUAL(A.nchannels(), B.nchannels());
+    int nfail = 0;
+    ROI roi   = A.roi();
+    for (int y = roi.ybegin; y < roi.yend; ++y) {
+        for (int x = roi.xbegin; x < roi.xend; ++x) {
+            int n = A.deep_samples(x, y);
+            if (n != B.deep_samples(x, y)) {
+                ++nfail;
+                continue;
+            }
+            for (int s = 0; s < n; ++s)
+                for (int c = 0; c < A.nchannels(); ++c)
+                    if (A.deep_value(x, y, 0, c, s)
+                        != B.deep_value(x, y, 0, c, s))
+                        ++nfail;
+        }
+    }
+    OIIO_CHECK_EQUAL(nfail, 0);
+}
+
+
+
+// Tests that deep_merge and deep_holdout give the same results no matter
+// how many threads they use. The images are big enough to be split among
+// threads.
+void
+test_deep_merge_threads()
+{
+    std::cout << "test deep_merge/deep_holdout threads\n";
+    const int WIDTH = 256, HEIGHT = 192;
+    ImageBuf A = make_random_deep(WIDTH, HEIGHT, 42);
+    ImageBuf B = make_random_deep(WIDTH, HEIGHT, 43);
+
+    for (bool cull : { false, true }) {
+        ImageBuf merged1 = ImageBufAlgo::deep_merge(A, B, cull, {}, 1);
+        OIIO_CHECK_ASSERT(!merged1.has_error());
+        ImageBuf merged = ImageBufAlgo::deep_merge(A, B, cull);
+        check_deep_identical(merged1, merged);
+        merged = ImageBufAlgo::deep_merge(A, B, cull, {}, numthreads);
+        check_deep_identical(merged1, merged);
+        // Merging an image with itself: every sample overlaps its twin.
+        merged1 = ImageBufAlgo::deep_merge(A, A, cull, {}, 1);
+        merged  = ImageBufAlgo::deep_merge(A, A, cull);
+        check_deep_identical(merged1, merged);
+    }
+
+    ImageBuf held1 = ImageBufAlgo::deep_holdout(A, B, {}, 1);
+    OIIO_CHECK_ASSERT(!held1.has_error());
+    ImageBuf held = ImageBufAlgo::deep_holdout(A, B);
+    check_deep_identical(held1, held);
+    held = ImageBufAlgo::deep_holdout(A, B, {}, numthreads);
+    check_deep_identical(held1, held);
+}
+
+
+
 int
 main(int argc, char** argv)
 {
@@ -987,7 +1371,11 @@ main(int argc, char** argv)
     test_mul();
     test_mad();
     test_over();
+    test_convolve();
+    test_median_morph();
     test_compare();
+    test_compare_threads();
+    test_compare_nonfinite();
     test_isConstantColor();
     test_isConstantChannel();
     test_isMonochrome();
@@ -995,6 +1383,7 @@ main(int argc, char** argv)
     histogram_computation_test();
     test_maketx_from_imagebuf();
     test_IBAprep();
+    test_deep_merge_threads();
     test_opencv();
 
     benchmark_parallel_image(64, iterations * 64);
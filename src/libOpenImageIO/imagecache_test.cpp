@@ -3,13 +3,16 @@
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
 
+#include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/unittest.h>
 
+#include <atomic>
 #include <iostream>
+#include <thread>
 
 using namespace OIIO;
 
@@ -134,6 +137,220 @@ test_app_buffer()
 
 
 
+// Test that a cache split into several sweep shards still enforces its
+// memory limit and returns correct pixels.
+void
+test_tile_cache_shards()
+{
+    std::cout << "\nTesting sharded tile cache\n";
+    ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+    imagecache->attribute("max_memory_MB", 10.0f);
+    imagecache->attribute("tile_cache_shards", 6);  // rounds down to 4
+    int nshards = 0;
+    imagecache->getattribute("tile_cache_shards", nshards);
+    OIIO_CHECK_EQUAL(nshards, 4);
+
+    // Make a tiled image that is bigger than the cache (16 MB as float)
+    ustring filename("tileshards.tif");
+    ImageSpec spec(1024, 1024, 4, TypeDesc::FLOAT);
+    spec.tile_width  = 64;
+    spec.tile_height = 64;
+    ImageBuf A(spec);
+    const float top[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+    const float bot[4] = { 1.0f, 0.0f, 1.0f, 1.0f };
+    ImageBufAlgo::fill(A, top, bot);
+    A.write(filename);
+
+    // Read every pixel through the cache, twice, spot checking values.
+    std::vector<float> row(spec.width * spec.nchannels);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int y = 0; y < spec.height; ++y) {
+            OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0,
+                                                     spec.width, y, y + 1, 0, 1,
+                                                     TypeDesc::FLOAT,
+                                                     row.data()));
+            if (y % 128 == 0) {
+                float expected[4];
+                A.getpixel(17, y, expected);
+                OIIO_CHECK_EQUAL(row[17 * 4 + 0], expected[0]);
+                OIIO_CHECK_EQUAL(row[17 * 4 + 2], expected[2]);
+            }
+        }
+    }
+
+    long long memused = 0, evicted = 0;
+    imagecache->getattribute("stat:cache_memory_used", TypeInt64, &memused);
+    imagecache->getattribute("stat:tiles_evicted", TypeInt64, &evicted);
+    OIIO_CHECK_ASSERT(evicted > 0);
+    // Allow a little slop for tiles added while sweeps were in progress.
+    OIIO_CHECK_LE(memused, 11LL * 1024 * 1024);
+
+    ImageCache::destroy(imagecache);
+    Filesystem::remove(filename);
+}
+
+
+
+// Test that prefetch() brings tiles into the cache so that subsequent
+// lookups don't miss.
+void
+test_prefetch()
+{
+    std::cout << "\nTesting prefetch\n";
+    ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+
+    ustring filename("prefetch.tif");
+    ImageSpec spec(256, 128, 3, TypeDesc::HALF);
+    spec.tile_width  = 64;
+    spec.tile_height = 64;
+    ImageBuf A(spec);
+    const float color[3] = { 0.25f, 0.5f, 1.0f };
+    ImageBufAlgo::fill(A, color);
+    A.write(filename);
+
+    // Prefetch just the left half and wait for it to arrive
+    OIIO_CHECK_ASSERT(imagecache->prefetch(filename, 0, 0, ROI(0, 128, 0, 128)));
+    imagecache->prefetch_wait();
+    long long queued = 0, read = 0;
+    imagecache->getattribute("stat:prefetch_tiles_queued", TypeInt64, &queued);
+    imagecache->getattribute("stat:prefetch_tiles_read", TypeInt64, &read);
+    OIIO_CHECK_EQUAL(queued, 4);
+    OIIO_CHECK_EQUAL(read, 4);
+
+    // Reading the prefetched region should not miss the main cache
+    std::vector<float> pixels(128 * 128 * 3);
+    OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0, 128, 0, 128, 0,
+                                             1, TypeDesc::FLOAT,
+                                             pixels.data()));
+    int misses = -1;
+    imagecache->getattribute("stat:find_tile_cache_misses", misses);
+    OIIO_CHECK_EQUAL(misses, 0);
+    OIIO_CHECK_EQUAL(pixels[0], 0.25f);
+    OIIO_CHECK_EQUAL(pixels[2], 1.0f);
+
+    // Prefetching a nonexistent MIP level should fail
+    OIIO_CHECK_ASSERT(!imagecache->prefetch(filename, 0, 5));
+    imagecache->geterror();  // clear the error
+
+    ImageCache::destroy(imagecache);
+    Filesystem::remove(filename);
+}
+
+
+
+// Tiles of fingerprinted files should be written to the disk cache, and
+// found there once they are no longer in memory.
+void
+test_disk_cache()
+{
+    std::cout << "\nTesting disk cache\n";
+    std::string err;
+    Filesystem::remove_all("diskcache", err);
+
+    ustring filename("diskcache.tif");
+    ImageSpec spec(128, 128, 3, TypeDesc::HALF);
+    spec.tile_width  = 64;
+    spec.tile_height = 64;
+    spec.attribute("ImageDescription",
+                   "oiio:SHA-1=0123456789abcdef0123456789abcdef01234567");
+    ImageBuf A(spec);
+    const float color[3] = { 0.25f, 0.5f, 1.0f };
+    ImageBufAlgo::fill(A, color);
+    A.write(filename);
+
+    ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+    imagecache->attribute("disk_cache", "diskcache");
+    std::vector<float> pixels(128 * 128 * 3);
+    OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0, 128, 0, 128, 0,
+                                             1, TypeDesc::FLOAT,
+                                             pixels.data()));
+    long long hits = -1, writes = -1;
+    imagecache->getattribute("stat:disk_cache_hits", TypeInt64, &hits);
+    imagecache->getattribute("stat:disk_cache_writes", TypeInt64, &writes);
+    OIIO_CHECK_EQUAL(hits, 0);
+    OIIO_CHECK_EQUAL(writes, 4);
+
+    // Drop the tiles from memory and read again: all should come from disk
+    imagecache->invalidate(filename);
+    imagecache->reset_stats();
+    std::fill(pixels.begin(), pixels.end(), 0.0f);
+    OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0, 128, 0, 128, 0,
+                                             1, TypeDesc::FLOAT,
+                                             pixels.data()));
+    imagecache->getattribute("stat:disk_cache_hits", TypeInt64, &hits);
+    imagecache->getattribute("stat:disk_cache_writes", TypeInt64, &writes);
+    OIIO_CHECK_EQUAL(hits, 4);
+    OIIO_CHECK_EQUAL(writes, 0);
+    OIIO_CHECK_EQUAL(pixels[0], 0.25f);
+    OIIO_CHECK_EQUAL(pixels[128 * 128 * 3 - 1], 1.0f);
+
+    ImageCache::destroy(imagecache);
+    Filesystem::remove_all("diskcache", err);
+    Filesystem::remove(filename);
+}
+
+
+
+// get_stats() should be safe to call while other threads use the cache,
+// and should agree with what they did.
+void
+test_get_stats()
+{
+    std::cout << "\nTesting get_stats\n";
+    ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+
+    ustring filename("getstats.tif");
+    ImageSpec spec(128, 128, 3, TypeDesc::UINT8);
+    spec.tile_width  = 64;
+    spec.tile_height = 64;
+    ImageBuf A(spec);
+    const float color[3] = { 0.25f, 0.5f, 1.0f };
+    ImageBufAlgo::fill(A, color);
+    A.write(filename);
+
+    // Poll from another thread while this one reads through the cache.
+    std::atomic<bool> done(false);
+    std::thread poller([&]() {
+        ImageCache::Stats stats;
+        while (!done) {
+            imagecache->get_stats(stats, true);
+            OIIO_CHECK_ASSERT(stats.hit_rate() >= 0.0
+                              && stats.hit_rate() <= 1.0);
+        }
+    });
+    std::vector<float> pixels(128 * 128 * 3);
+    for (int i = 0; i < 10; ++i)
+        OIIO_CHECK_ASSERT(imagecache->get_pixels(filename, 0, 0, 0, 128, 0,
+                                                 128, 0, 1, TypeDesc::FLOAT,
+                                                 pixels.data()));
+    done = true;
+    poller.join();
+
+    ImageCache::Stats stats;
+    imagecache->get_stats(stats);
+    OIIO_CHECK_ASSERT(stats.files.empty());
+    OIIO_CHECK_ASSERT(stats.find_tile_calls > 0);
+    OIIO_CHECK_EQUAL(stats.cache_misses, 4);
+    OIIO_CHECK_EQUAL(stats.tiles_created, 4);
+    OIIO_CHECK_EQUAL(stats.unique_files, 1);
+    OIIO_CHECK_ASSERT(stats.bytes_read > 0);
+    OIIO_CHECK_ASSERT(stats.hit_rate() > 0.5);
+
+    imagecache->get_stats(stats, true);
+    OIIO_CHECK_EQUAL(stats.files.size(), 1);
+    if (stats.files.size() == 1) {
+        OIIO_CHECK_EQUAL(stats.files[0].filename, filename);
+        OIIO_CHECK_EQUAL(stats.files[0].tiles_read, 4);
+        OIIO_CHECK_EQUAL(stats.files[0].bytes_read, stats.bytes_read);
+        OIIO_CHECK_ASSERT(!stats.files[0].broken);
+    }
+
+    ImageCache::destroy(imagecache);
+    Filesystem::remove(filename);
+}
+
+
+
 int
 main(int /*argc*/, char* /*argv*/[])
 {
@@ -145,6 +362,10 @@ main(int /*argc*/, char* /*argv*/[])
     test_get_pixels_cachechannels(6, 9, 6, 9);
 
     test_app_buffer();
+    test_tile_cache_shards();
+    test_prefetch();
+    test_disk_cache();
+    test_get_stats();
 
     return unit_test_failures;
 }
@@ -422,11 +422,89 @@ test_read_tricky_sizes()
 
 
 
+// Read a whole TIFF file and return the chunk tallies it reports.
+static void
+read_tiff_chunk_stats(const std::string& filename, int& parallel, int& serial)
+{
+    parallel = serial = -1;
+    auto in = ImageInput::open(filename);
+    OIIO_CHECK_ASSERT(in);
+    if (!in)
+        return;
+    // Nothing has been decoded yet.
+    OIIO_CHECK_EQUAL(in->spec().get_int_attribute("tiff:parallel_chunks", -1),
+                     -1);
+    std::vector<unsigned char> pixels(in->spec().image_bytes());
+    OIIO_CHECK_ASSERT(in->read_image(TypeUInt8, pixels.data()));
+    parallel = in->spec().get_int_attribute("tiff:parallel_chunks");
+    serial   = in->spec().get_int_attribute("tiff:serial_chunks");
+}
+
+
+
+// Test the "tiff:parallel_chunks" and "tiff:serial_chunks" tallies of how
+// the strips and tiles of an image were decoded.
+static void
+test_tiff_chunk_stats()
+{
+    std::cout << "test_tiff_chunk_stats\n";
+    int oldthreads = 0, oldmultithread = 1;
+    OIIO::getattribute("threads", oldthreads);
+    OIIO::getattribute("tiff:multithread", oldmultithread);
+    OIIO::attribute("threads", 4);  // make sure there is a thread pool
+
+    struct Case {
+        const char* name;
+        int tilesize;
+        bool separate;
+        int chunks;  // strips or tiles, times planes if separate
+    };
+    // 64x64 pixels: 4 strips of 16 rows, or 16 tiles of 16x16
+    const Case cases[] = { { "strips", 0, false, 4 },
+                           { "strips, separate", 0, true, 12 },
+                           { "tiles", 16, false, 16 },
+                           { "tiles, separate", 16, true, 48 } };
+    const std::string filename = "tmp-chunkstats.tif";
+    for (const auto& c : cases) {
+        ImageSpec spec(64, 64, 3, TypeUInt8);
+        spec.attribute("compression", "zip");
+        spec.attribute("tiff:RowsPerStrip", 16);
+        if (c.tilesize)
+            spec.tile_width = spec.tile_height = c.tilesize;
+        if (c.separate)
+            spec.attribute("planarconfig", "separate");
+        ImageBuf buf(spec);
+        ImageBufAlgo::fill(buf, { 0.0f, 0.5f, 1.0f }, { 1.0f, 0.5f, 0.0f });
+        OIIO_CHECK_ASSERT(buf.write(filename));
+
+        int parallel, serial;
+        OIIO::attribute("tiff:multithread", 1);
+        read_tiff_chunk_stats(filename, parallel, serial);
+        std::cout << "   " << c.name << ": " << parallel << " parallel, "
+                  << serial << " serial\n";
+        OIIO_CHECK_EQUAL(parallel, c.chunks);
+        OIIO_CHECK_EQUAL(serial, 0);
+
+        OIIO::attribute("tiff:multithread", 0);
+        read_tiff_chunk_stats(filename, parallel, serial);
+        std::cout << "   " << c.name << " (single threaded): " << parallel
+                  << " parallel, " << serial << " serial\n";
+        OIIO_CHECK_EQUAL(parallel, 0);
+        OIIO_CHECK_EQUAL(serial, c.chunks);
+    }
+    Filesystem::remove(filename);
+    OIIO::attribute("tiff:multithread", oldmultithread);
+    OIIO::attribute("threads", oldthreads);
+}
+
+
+
 int
 main(int /*argc*/, char* /*argv*/[])
 {
     test_all_formats();
     test_read_tricky_sizes();
+    test_tiff_chunk_stats();
 
     return unit_test_failures;
 }
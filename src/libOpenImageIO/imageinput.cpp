@@ -5,6 +5,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -35,6 +36,9 @@ public:
     // Thread-specific error message for this ImageInput.
     thread_specific_ptr<std::string> m_errormessage;
     int m_threads = 0;
+    // Mapping of the file, for mapped_native_pixels().
+    Filesystem::MappedFile m_mapped;
+    std::string m_mapped_filename;
 };
 
 
@@ -1030,6 +1034,31 @@ ImageInput::read_native_deep_image(int subimage, int miplevel,
 
 
 
+const void*
+ImageInput::mapped_native_pixels(int /*subimage*/, int /*miplevel*/)
+{
+    return nullptr;
+}
+
+
+
+cspan<unsigned char>
+ImageInput::mapped_file(const std::string& filename, Filesystem::IOProxy* io)
+{
+    if (auto memreader = dynamic_cast<Filesystem::IOMemReader*>(io))
+        return memreader->buffer();
+    if (io && strcmp(io->proxytype(), "file"))
+        return cspan<unsigned char>();  // some other kind of custom proxy
+    lock_guard lock(*this);
+    if (!m_impl->m_mapped.is_open() || m_impl->m_mapped_filename != filename) {
+        m_impl->m_mapped.open(filename);
+        m_impl->m_mapped_filename = filename;
+    }
+    return m_impl->m_mapped.buffer();
+}
+
+
+
 int
 ImageInput::send_to_input(const char* /*format*/, ...)
 {
@@ -38,6 +38,9 @@ atomic_int oiio_exr_threads(threads_default());
 atomic_int oiio_read_chunk(256);
 int tiff_half(0);
 int tiff_multithread(1);
+int oiio_convolve_fft_threshold(121);
+int oiio_colorconvert_lut3d(0);
+float oiio_colorconvert_lut3d_range(1.0f);
 ustring plugin_searchpath(OIIO_DEFAULT_PLUGIN_SEARCHPATH);
 std::string format_list;         // comma-separated list of all formats
 std::string input_format_list;   // comma-separated list of readable formats
@@ -320,6 +323,19 @@ attribute(string_view name, TypeDesc type, const void* val)
         tiff_multithread = *(const int*)val;
         return true;
     }
+    if (name == "imagebufalgo:convolve_fft_threshold" && type == TypeInt) {
+        oiio_convolve_fft_threshold = *(const int*)val;
+        return true;
+    }
+    if (name == "imagebufalgo:colorconvert_lut3d" && type == TypeInt) {
+        oiio_colorconvert_lut3d = std::max(*(const int*)val, 0);
+        return true;
+    }
+    if (name == "imagebufalgo:colorconvert_lut3d_range"
+        && type == TypeFloat) {
+        oiio_colorconvert_lut3d_range = *(const float*)val;
+        return true;
+    }
     if (name == "debug" && type == TypeInt) {
         oiio_print_debug = *(const int*)val;
         return true;
@@ -407,6 +423,19 @@ getattribute(string_view name, TypeDesc type, void* val)
         *(int*)val = tiff_multithread;
         return true;
     }
+    if (name == "imagebufalgo:convolve_fft_threshold" && type == TypeInt) {
+        *(int*)val = oiio_convolve_fft_threshold;
+        return true;
+    }
+    if (name == "imagebufalgo:colorconvert_lut3d" && type == TypeInt) {
+        *(int*)val = oiio_colorconvert_lut3d;
+        return true;
+    }
+    if (name == "imagebufalgo:colorconvert_lut3d_range"
+        && type == TypeFloat) {
+        *(float*)val = oiio_colorconvert_lut3d_range;
+        return true;
+    }
     if (name == "debug" && type == TypeInt) {
         *(int*)val = oiio_print_debug;
         return true;
@@ -500,6 +529,155 @@ _contiguize(const T* src, int nchannels, stride_t xstride, stride_t ystride,
     return dstsave;
 }
 
+
+// Direct SIMD format conversion among the "small" pixel types (uint8,
+// int8, uint16, int16, half, float), a full native vector at a time and
+// without staging through a float buffer in memory. Floating point results
+// are identical to converting S->float->D with convert_type; integer
+// results may differ from it by 1 LSB, because the scalar scale-and-round
+// may be contracted into a fused multiply-add where these kernels round the
+// product before adding 0.5.
+#if OIIO_SIMD >= 16
+typedef simd::vfloat16 cvt_vfloat;
+#elif OIIO_SIMD >= 8
+typedef simd::vfloat8 cvt_vfloat;
+#else
+typedef simd::vfloat4 cvt_vfloat;
+#endif
+
+// Load a vector of S values, remapped to float like convert_type<S,float>.
+template<typename S>
+inline cvt_vfloat
+cvt_load(const S* src)
+{
+    cvt_vfloat f(src);
+    if (std::numeric_limits<S>::is_integer)
+        f *= cvt_vfloat(1.0f / float(std::numeric_limits<S>::max()));
+    return f;
+}
+
+template<>
+inline cvt_vfloat
+cvt_load(const int8_t* src)
+{
+    // simd loads signed bytes as char
+    return cvt_vfloat((const char*)src) * cvt_vfloat(1.0f / 127.0f);
+}
+
+// Store a vector of floats as D values, like convert_type<float,D>.
+template<typename D>
+inline void
+cvt_store(const cvt_vfloat& f, D* dst)
+{
+    // Unsigned integer types: round by adding 0.5 and truncating, clamp
+    // first so the truncation never sees a negative.
+    cvt_vfloat max(float(std::numeric_limits<D>::max()));
+    cvt_vfloat s = simd::min(simd::max(f * max + cvt_vfloat(0.5f),
+                                       cvt_vfloat::Zero()),
+                             max);
+    cvt_vfloat::vint_t i(s);
+    i.store(dst);
+}
+
+template<typename D>
+inline void
+cvt_store_signed(const cvt_vfloat& f, D* dst)
+{
+    // Signed integer types: round half away from zero, then clamp and
+    // truncate. The int stores are truncating, so store as unsigned bits.
+    cvt_vfloat max(float(std::numeric_limits<D>::max()));
+    cvt_vfloat min(float(std::numeric_limits<D>::min()));
+    cvt_vfloat s = f * max;
+    s += simd::select(s < cvt_vfloat::Zero(), cvt_vfloat(-0.5f),
+                      cvt_vfloat(0.5f));
+    cvt_vfloat::vint_t i(simd::min(simd::max(s, min), max));
+    i.store((typename std::make_unsigned<D>::type*)dst);
+}
+
+template<>
+inline void
+cvt_store(const cvt_vfloat& f, int8_t* dst)
+{
+    cvt_store_signed(f, dst);
+}
+
+template<>
+inline void
+cvt_store(const cvt_vfloat& f, int16_t* dst)
+{
+    cvt_store_signed(f, dst);
+}
+
+template<>
+inline void
+cvt_store(const cvt_vfloat& f, half* dst)
+{
+    f.store(dst);
+}
+
+template<>
+inline void
+cvt_store(const cvt_vfloat& f, float* dst)
+{
+    f.store(dst);
+}
+
+
+
+template<typename S, typename D>
+void
+convert_simd(const S* src, D* dst, size_t n)
+{
+    const size_t w = cvt_vfloat::elements;
+    for (; n >= w; n -= w, src += w, dst += w)
+        cvt_store(cvt_load(src), dst);
+    for (; n; --n)
+        *dst++ = convert_type<float, D>(convert_type<S, float>(*src++));
+}
+
+
+
+template<typename S>
+bool
+convert_simd_from(const S* src, TypeDesc dst_type, void* dst, size_t n)
+{
+    // clang-format off
+    switch (dst_type.basetype) {
+    case TypeDesc::UINT8:  convert_simd(src, (uint8_t*) dst, n); return true;
+    case TypeDesc::INT8:   convert_simd(src, (int8_t*)  dst, n); return true;
+    case TypeDesc::UINT16: convert_simd(src, (uint16_t*)dst, n); return true;
+    case TypeDesc::INT16:  convert_simd(src, (int16_t*) dst, n); return true;
+    case TypeDesc::HALF:   convert_simd(src, (half*)    dst, n); return true;
+    case TypeDesc::FLOAT:  convert_simd(src, (float*)   dst, n); return true;
+    default: return false;
+    }
+    // clang-format on
+}
+
+
+
+// Convert n values directly from src_type to dst_type, if both are among
+// the types handled by convert_simd. Return false (having done nothing)
+// for any other pair, or if the types are the same.
+bool
+convert_simd_pair(TypeDesc src_type, const void* src, TypeDesc dst_type,
+                  void* dst, size_t n)
+{
+    if (src_type.basetype == dst_type.basetype)
+        return false;
+    // clang-format off
+    switch (src_type.basetype) {
+    case TypeDesc::UINT8:  return convert_simd_from((const uint8_t*) src, dst_type, dst, n);
+    case TypeDesc::INT8:   return convert_simd_from((const int8_t*)  src, dst_type, dst, n);
+    case TypeDesc::UINT16: return convert_simd_from((const uint16_t*)src, dst_type, dst, n);
+    case TypeDesc::INT16:  return convert_simd_from((const int16_t*) src, dst_type, dst, n);
+    case TypeDesc::HALF:   return convert_simd_from((const half*)    src, dst_type, dst, n);
+    case TypeDesc::FLOAT:  return convert_simd_from((const float*)   src, dst_type, dst, n);
+    default: return false;
+    }
+    // clang-format on
+}
+
 }  // namespace
 
 const void*
@@ -545,14 +723,12 @@ pvt::convert_to_float(const void* src, float* dst, int nvals, TypeDesc format)
     switch (format.basetype) {
     case TypeDesc::FLOAT: return (float*)src;
     case TypeDesc::UINT8:
-        convert_type((const unsigned char*)src, dst, nvals);
-        break;
-    case TypeDesc::HALF: convert_type((const half*)src, dst, nvals); break;
+    case TypeDesc::HALF:
     case TypeDesc::UINT16:
-        convert_type((const unsigned short*)src, dst, nvals);
+    case TypeDesc::INT8:
+    case TypeDesc::INT16:
+        convert_simd_pair(format, src, TypeFloat, dst, nvals);
         break;
-    case TypeDesc::INT8: convert_type((const char*)src, dst, nvals); break;
-    case TypeDesc::INT16: convert_type((const short*)src, dst, nvals); break;
     case TypeDesc::INT: convert_type((const int*)src, dst, nvals); break;
     case TypeDesc::UINT:
         convert_type((const unsigned int*)src, dst, nvals);
@@ -586,12 +762,14 @@ pvt::convert_from_float(const float* src, void* dst, size_t nvals,
     case TypeDesc::FLOAT:
         // If it's already float, return the source itself
         return src;
-    case TypeDesc::HALF:   convert_type(src, (half*)    dst, nvals); break;
-    case TypeDesc::UINT8:  convert_type(src, (uint8_t*) dst, nvals); break;
-    case TypeDesc::UINT16: convert_type(src, (uint16_t*)dst, nvals); break;
+    case TypeDesc::HALF:
+    case TypeDesc::UINT8:
+    case TypeDesc::UINT16:
+    case TypeDesc::INT8:
+    case TypeDesc::INT16:
+        convert_simd_pair(TypeFloat, src, format, dst, nvals);
+        break;
     case TypeDesc::UINT:   convert_type(src, (uint32_t*)dst, nvals); break;
-    case TypeDesc::INT8:   convert_type(src, (int8_t*)  dst, nvals); break;
-    case TypeDesc::INT16:  convert_type(src, (int16_t*) dst, nvals); break;
     case TypeDesc::INT:    convert_type(src, (int32_t*) dst, nvals); break;
     case TypeDesc::DOUBLE: convert_type(src, (double*)  dst, nvals); break;
     case TypeDesc::INT64:  convert_type(src, (int64_t*) dst, nvals); break;
@@ -629,6 +807,11 @@ convert_pixel_values(TypeDesc src_type, const void* src, TypeDesc dst_type,
         return true;
     }
 
+    // Common pairs of small types convert directly with SIMD, without
+    // an intermediate float buffer.
+    if (convert_simd_pair(src_type, src, dst_type, dst, n))
+        return true;
+
     if (dst_type == TypeFloat) {
         // Special case -- converting non-float to float
         pvt::convert_to_float(src, (float*)dst, n, src_type);
@@ -92,6 +92,23 @@ time_read_image()
 
 
 
+// Same as time_read_image, but asking the reader to use only one thread,
+// for comparison with the default (which may let readers such as OpenEXR's
+// decode several chunks at once).
+static void
+time_read_image_1thread()
+{
+    for (ustring filename : input_filename) {
+        auto in = ImageInput::open(filename.c_str());
+        OIIO_ASSERT(in);
+        in->threads(1);
+        in->read_image(conversion, &buffer[0]);
+        in->close();
+    }
+}
+
+
+
 static void
 time_read_scanline_at_a_time()
 {
@@ -522,6 +539,8 @@ main(int argc, char** argv)
         buffer.resize(maxpelchans * sizeof(float), 0);
         test_read("read_image                                   ",
                   time_read_image, 0, 0);
+        test_read("read_image (1 thread)                        ",
+                  time_read_image_1thread, 0, 0);
         if (all_scanline) {
             test_read("read_scanline (1 at a time)                  ",
                       time_read_scanline_at_a_time, 0, 0);
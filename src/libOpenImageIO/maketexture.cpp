@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -17,6 +18,7 @@
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/filter.h>
 #include <OpenImageIO/fmath.h>
+#include <OpenImageIO/hash.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
@@ -611,13 +613,84 @@ maketx_merge_spec(ImageSpec& dstspec, const ImageSpec& srcspec)
 
 
 
+// Given the row ranges of one MIP level that changed, return the row
+// ranges of the next smaller level (of height `height`) that depend on
+// them, merging any that touch.
+static std::vector<std::pair<int, int>>
+halve_row_ranges(const std::vector<std::pair<int, int>>& rows, int height)
+{
+    std::vector<std::pair<int, int>> result;
+    for (auto r : rows) {
+        int y0 = std::min(r.first / 2, height - 1);
+        int y1 = std::min((r.second + 1) / 2, height);
+        y1     = std::max(y1, y0 + 1);
+        if (result.size() && y0 <= result.back().second)
+            result.back().second = std::max(result.back().second, y1);
+        else
+            result.emplace_back(y0, y1);
+    }
+    return result;
+}
+
+
+
+// Add the row range [y0,y1) to the sorted ranges in rows, merging any
+// that overlap or touch.
+static void
+add_row_range(std::vector<std::pair<int, int>>& rows, int y0, int y1)
+{
+    rows.emplace_back(y0, y1);
+    std::sort(rows.begin(), rows.end());
+    std::vector<std::pair<int, int>> merged;
+    for (auto r : rows) {
+        if (merged.size() && r.first <= merged.back().second)
+            merged.back().second = std::max(merged.back().second, r.second);
+        else
+            merged.push_back(r);
+    }
+    rows.swap(merged);
+}
+
+
+
+// For incremental mode: given the changed rows of the top level, return
+// the rows to recompute for every MIP level of a power-of-two image of the
+// given size (index 0 is the top level itself). Each level must recompute
+// the rows that depend on recomputed rows of the level above. Then,
+// working back up, every row that feeds a recomputed row is recomputed as
+// well, even if its own inputs didn't change, so that recomputed rows are
+// made only from fresh pixels and never from ones reread from the old
+// texture, which were quantized to the output data type.
+static std::vector<std::vector<std::pair<int, int>>>
+incremental_dirty_rows(const std::vector<std::pair<int, int>>& toprows,
+                       int width, int height)
+{
+    std::vector<std::vector<std::pair<int, int>>> levels { toprows };
+    std::vector<int> heights { height };
+    for (int w = width, h = height; w > 1 || h > 1;) {
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+        levels.push_back(halve_row_ranges(levels.back(), h));
+        heights.push_back(h);
+    }
+    for (size_t m = levels.size() - 1; m >= 2; --m)
+        for (auto r : levels[m])
+            add_row_range(levels[m - 1], 2 * r.first,
+                          std::min(2 * r.second, heights[m - 1]));
+    return levels;
+}
+
+
+
 static bool
 write_mipmap(ImageBufAlgo::MakeTextureMode mode, std::shared_ptr<ImageBuf>& img,
              const ImageSpec& outspec_template, std::string outputfilename,
              ImageOutput* out, TypeDesc outputdatatype, bool mipmap,
              string_view filtername, const ImageSpec& configspec,
              std::ostream& outstream, double& stat_writetime,
-             double& stat_miptime, size_t& peak_mem)
+             double& stat_miptime, size_t& peak_mem,
+             ImageInput* prev = nullptr,
+             std::vector<std::pair<int, int>> dirty_rows = {})
 {
     using OIIO::pvt::errorfmt;
     bool envlatlmode       = (mode == ImageBufAlgo::MakeTxEnvLatl);
@@ -727,9 +800,17 @@ write_mipmap(ImageBufAlgo::MakeTextureMode mode, std::shared_ptr<ImageBuf>& img,
         bool allow_shift
             = configspec.get_int_attribute("maketx:allow_pixel_shift") != 0;
 
+        std::vector<std::vector<std::pair<int, int>>> level_dirty_rows;
+        if (prev)
+            level_dirty_rows = incremental_dirty_rows(dirty_rows,
+                                                      outspec.width,
+                                                      outspec.height);
+
         std::shared_ptr<ImageBuf> small(new ImageBuf);
+        int miplevel = 0;
         while (outspec.width > 1 || outspec.height > 1) {
             Timer miptimer;
+            ++miplevel;
             ImageSpec smallspec;
 
             if (mipimages.size()) {
@@ -783,7 +864,33 @@ write_mipmap(ImageBufAlgo::MakeTextureMode mode, std::shared_ptr<ImageBuf>& img,
                               img->yend(), img->zbegin(), img->zend());
 
                 if (filtername == "box" && !orig_was_overscan
-                    && sharpen <= 0.0f) {
+                    && sharpen <= 0.0f && prev) {
+                    // Incremental: start with this level's pixels from the
+                    // previous texture, and recompute only the rows that
+                    // incremental_dirty_rows() picked out. Keep the bands
+                    // full width so resize_block takes the same path (and
+                    // gets the same answer) as a full rebuild.
+                    dirty_rows = level_dirty_rows[miplevel];
+                    if (!prev->read_image(0, miplevel, 0, smallspec.nchannels,
+                                          smallspec.format,
+                                          small->localpixels())) {
+                        errorfmt("Could not read MIP level {} of the "
+                                 "previous texture: {}",
+                                 miplevel, prev->geterror());
+                        out->close();
+                        return false;
+                    }
+                    for (auto r : dirty_rows) {
+                        ROI roi    = get_roi(small->spec());
+                        roi.ybegin = r.first;
+                        roi.yend   = r.second;
+                        ImageBufAlgo::parallel_image(
+                            roi, std::bind(resize_block, std::ref(*small),
+                                           std::cref(*img), _1, envlatlmode,
+                                           allow_shift));
+                    }
+                } else if (filtername == "box" && !orig_was_overscan
+                           && sharpen <= 0.0f) {
                     ImageBufAlgo::parallel_image(get_roi(small->spec()),
                                                  std::bind(resize_block,
                                                            std::ref(*small),
@@ -963,6 +1070,55 @@ stripdir_cmd_line(string_view cmdline)
 
 
 
+// For "incremental mode": hash each blocksize x blocksize block of the top
+// level. The result is "<blocksize>:<settings hash>:" followed by 16 hex
+// digits per block in scanline order. It contains no whitespace, so it can
+// be crammed into the ImageDescription for formats that don't support
+// arbitrary metadata. Use xxhash rather than farmhash, since the hashes
+// must stay stable across platforms and releases.
+static std::string
+compute_block_hashes(const ImageBuf& img, int blocksize, string_view settings)
+{
+    ROI roi = img.roi();
+    int nbx = (roi.width() + blocksize - 1) / blocksize;
+    int nby = (roi.height() + blocksize - 1) / blocksize;
+    std::vector<uint64_t> hashes(size_t(nbx) * size_t(nby));
+    parallel_for(0, int64_t(hashes.size()), [&](int64_t b) {
+        int x = roi.xbegin + int(b % nbx) * blocksize;
+        int y = roi.ybegin + int(b / nbx) * blocksize;
+        ROI broi(x, std::min(x + blocksize, roi.xend), y,
+                 std::min(y + blocksize, roi.yend), roi.zbegin, roi.zend,
+                 roi.chbegin, roi.chend);
+        std::vector<float> pixels(broi.npixels() * broi.nchannels());
+        img.get_pixels(broi, TypeFloat, pixels.data());
+        hashes[b] = xxhash::XXH64(pixels.data(), pixels.size() * sizeof(float));
+    });
+    std::string result
+        = Strutil::sprintf("%d:%016x:", blocksize,
+                           xxhash::XXH64(settings.data(), settings.size()));
+    result.reserve(result.size() + 16 * hashes.size());
+    for (auto h : hashes)
+        result += Strutil::sprintf("%016x", h);
+    return result;
+}
+
+
+
+// Retrieve the block hashes that incremental mode stored in a texture,
+// either as metadata or embedded in the ImageDescription.
+static std::string
+stored_block_hashes(const ImageSpec& spec)
+{
+    std::string hashes = spec.get_string_attribute("oiio:BlockHashes");
+    if (hashes.empty()) {
+        std::string desc = spec.get_string_attribute("ImageDescription");
+        hashes = Strutil::excise_string_after_head(desc, "oiio:BlockHashes=");
+    }
+    return hashes;
+}
+
+
+
 static bool
 make_texture_impl(ImageBufAlgo::MakeTextureMode mode, const ImageBuf* input,
                   std::string filename, std::string outputfilename,
@@ -1659,6 +1815,7 @@ make_texture_impl(ImageBufAlgo::MakeTextureMode mode, const ImageBuf* input,
         Strutil::excise_string_after_head(desc, "AverageColor=");
         Strutil::excise_string_after_head(desc, "oiio:SHA-1=");
         Strutil::excise_string_after_head(desc, "SHA-1=");
+        Strutil::excise_string_after_head(desc, "oiio:BlockHashes=");
         updatedDesc = true;
     }
 
@@ -1698,6 +1855,34 @@ make_texture_impl(ImageBufAlgo::MakeTextureMode mode, const ImageBuf* input,
         if (verbose)
             outstream << "  SHA-1: " << hash_digest << std::endl;
     }
+
+    // In incremental mode, also record per-block hashes of the top level,
+    // along with a hash of all the other settings that affect the pixels.
+    // A later run can compare against them to find which parts of the
+    // texture actually changed.
+    bool incremental = configspec.get_int_attribute("maketx:incremental") != 0;
+    const int incr_blocksize = 256;
+    std::string block_hashes;
+    dstspec.erase_attribute("oiio:BlockHashes");
+    if (incremental) {
+        std::string settings = Strutil::sprintf(
+            "%s%s %dx%dx%d tile=%dx%d mode=%d %s", addlHashData.str(),
+            out_dataformat, dstspec.width, dstspec.height, dstspec.nchannels,
+            dstspec.tile_width, dstspec.tile_height, int(mode),
+            stripdir_cmd_line(
+                configspec.get_string_attribute("maketx:full_command_line")));
+        block_hashes = compute_block_hashes(*toplevel, incr_blocksize,
+                                            settings);
+        if (out->supports("arbitrary_metadata")) {
+            dstspec.attribute("oiio:BlockHashes", block_hashes);
+        } else {
+            if (desc.length())
+                desc += " ";
+            desc += "oiio:BlockHashes=";
+            desc += block_hashes;
+            updatedDesc = true;
+        }
+    }
     double stat_hashtime = alltime.lap();
     STATUS("SHA-1 hash", stat_hashtime);
 
@@ -1745,13 +1930,105 @@ make_texture_impl(ImageBufAlgo::MakeTextureMode mode, const ImageBuf* input,
     double misc_time_5 = alltime.lap();
     STATUS("misc4", misc_time_5);
 
-    // Write out, and compute, the mipmap levels for the specified image
     bool nomipmap = configspec.get_int_attribute("maketx:nomipmap") != 0;
+    bool mipmap   = !shadowmode && !nomipmap;
+
+    // In incremental mode, compare against the block hashes stored in the
+    // existing texture. If nothing changed, there's nothing to write. If
+    // only some blocks changed and the MIP levels are plain box-filtered
+    // halvings, reuse the unchanged rows of every MIP level from the
+    // existing texture and recompute only the rest.
+    std::unique_ptr<ImageInput> previn;
+    std::vector<std::pair<int, int>> dirty_rows;
+    if (incremental && Filesystem::exists(outputfilename)) {
+        previn = ImageInput::open(outputfilename);
+        std::string prev_hashes = previn ? stored_block_hashes(previn->spec())
+                                         : std::string();
+        size_t prefixlen = block_hashes.find(':', block_hashes.find(':') + 1)
+                           + 1;
+        if (prev_hashes == block_hashes) {
+            if (updatemode && from_filename)
+                Filesystem::last_write_time(outputfilename, in_time);
+            outstream << "maketx: no update required for \"" << outputfilename
+                      << "\" (pixels unchanged)\n";
+            return true;
+        }
+        const ImageSpec* prevspec = previn ? &previn->spec() : nullptr;
+        bool reusable
+            = prevspec && mipmap && filtername == "box" && sharpen <= 0.0f
+              && !orig_was_overscan && !envlatlmode
+              && configspec.get_string_attribute("maketx:mipimages").empty()
+              && out->supports("mipmap") && ispow2(dstspec.width)
+              && ispow2(dstspec.height) && dstspec.depth == 1
+              && prevspec->width == dstspec.width
+              && prevspec->height == dstspec.height
+              && prevspec->nchannels == dstspec.nchannels
+              && prevspec->tile_width == dstspec.tile_width
+              && prevspec->tile_height == dstspec.tile_height
+              && prev_hashes.size() == block_hashes.size()
+              && prev_hashes.compare(0, prefixlen, block_hashes, 0, prefixlen)
+                     == 0;
+        if (reusable) {
+            // The old texture must have every MIP level we're about to make
+            int nlevels = 1;
+            for (int w = dstspec.width, h = dstspec.height; w > 1 || h > 1;
+                 w = std::max(1, w / 2), h = std::max(1, h / 2))
+                ++nlevels;
+            reusable = previn->seek_subimage(0, nlevels - 1)
+                       && !previn->seek_subimage(0, nlevels);
+        }
+        if (reusable) {
+            // Mark every block row containing a changed block as dirty
+            int nbx = (dstspec.width + incr_blocksize - 1) / incr_blocksize;
+            int nby = (dstspec.height + incr_blocksize - 1) / incr_blocksize;
+            int nchanged = 0;
+            for (int by = 0; by < nby; ++by) {
+                bool rowchanged = false;
+                for (int bx = 0; bx < nbx; ++bx) {
+                    size_t pos = prefixlen + 16 * (size_t(by) * nbx + bx);
+                    if (prev_hashes.compare(pos, 16, block_hashes, pos, 16)) {
+                        rowchanged = true;
+                        ++nchanged;
+                    }
+                }
+                if (!rowchanged)
+                    continue;
+                int y0 = by * incr_blocksize;
+                int y1 = std::min(y0 + incr_blocksize, dstspec.height);
+                if (dirty_rows.size() && dirty_rows.back().second == y0)
+                    dirty_rows.back().second = y1;
+                else
+                    dirty_rows.emplace_back(y0, y1);
+            }
+            int ndirty = 0;
+            for (auto r : dirty_rows)
+                ndirty += r.second - r.first;
+            // Not worth it if most of the image changed anyway
+            if (ndirty * 2 > dstspec.height)
+                reusable = false;
+            if (verbose)
+                outstream << Strutil::sprintf(
+                    "  Incremental: %d of %d blocks changed, %s\n", nchanged,
+                    nbx * nby,
+                    reusable ? Strutil::sprintf("recomputing %d of %d rows",
+                                                ndirty, dstspec.height)
+                             : std::string("rebuilding all levels"));
+        }
+        if (!reusable) {
+            previn.reset();
+            dirty_rows.clear();
+        }
+    }
+    double stat_incrtime = alltime.lap();
+    STATUS("incremental check", stat_incrtime);
+
+    // Write out, and compute, the mipmap levels for the specified image
     bool ok = write_mipmap(mode, toplevel, dstspec, tmpfilename, out.get(),
-                           out_dataformat, !shadowmode && !nomipmap, filtername,
-                           configspec, outstream, stat_writetime, stat_miptime,
-                           peak_mem);
+                           out_dataformat, mipmap, filtername, configspec,
+                           outstream, stat_writetime, stat_miptime, peak_mem,
+                           previn.get(), dirty_rows);
     out.reset();  // don't need it any more
+    previn.reset();
 
     // If using update mode, stamp the output file with a modification time
     // matching that of the input file.
@@ -286,6 +286,49 @@ vector_to_latlong(const Imath::V3f& R, bool y_is_up, float& s, float& t)
 
 
 
+/// Convert direction vectors (as x, y, z components) to latlong st
+/// coordinates for a whole batch. Each lane goes through the single-point
+/// vector_to_latlong(), so that batched and single-point lookups agree.
+inline void
+vector_to_latlong_batch(const Tex::FloatWide* R, bool y_is_up,
+                        Tex::FloatWide& s, Tex::FloatWide& t)
+{
+    for (int i = 0; i < Tex::BatchWidth; ++i)
+        vector_to_latlong(Imath::V3f(R[0][i], R[1][i], R[2][i]), y_is_up,
+                          s[i], t[i]);
+}
+
+
+
+// Normalize a batch of 3-vectors in place, leaving zero-length ones
+// zero, as Imath's normalize() does (dividing by the length rather than
+// multiplying by its reciprocal, to round the same way).
+inline void
+normalize_batch(Tex::FloatWide* v)
+{
+    using Tex::FloatWide;
+    FloatWide len              = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    FloatWide::vbool_t nonzero = len > FloatWide(0.0f);
+    for (int i = 0; i < 3; ++i)
+        v[i] = select(nonzero, v[i] / len, FloatWide(0.0f));
+}
+
+
+
+// Angle between two batches of unit vectors, computed per lane with
+// safe_acos of the dot product exactly as the single-point environment()
+// does.
+inline Tex::FloatWide
+angle_batch(const Tex::FloatWide* a, const Tex::FloatWide* b)
+{
+    Tex::FloatWide dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    for (int i = 0; i < Tex::BatchWidth; ++i)
+        dot[i] = safe_acos(dot[i]);
+    return dot;
+}
+
+
+
 bool
 TextureSystemImpl::environment(ustring filename, TextureOpt& options,
                                const Imath::V3f& R, const Imath::V3f& dRdx,
@@ -425,7 +468,7 @@ TextureSystemImpl::environment(TextureHandle* texture_handle_,
     }
 
     sampler_prototype sampler;
-    long long* probecount;
+    StatCounter<long long>* probecount;
     switch (options.interpmode) {
     case TextureOpt::InterpClosest:
         sampler    = &TextureSystemImpl::sample_closest;
@@ -582,20 +625,35 @@ TextureSystemImpl::environment(TextureHandle* texture_handle_,
 
 
 bool
-TextureSystemImpl::environment(TextureHandle* texture_handle,
-                               Perthread* thread_info, TextureOptBatch& options,
-                               Tex::RunMask mask, const float* R,
-                               const float* dRdx, const float* dRdy,
-                               int nchannels, float* result, float* dresultds,
-                               float* dresultdt)
+TextureSystemImpl::environment(TextureHandle* texture_handle_,
+                               Perthread* thread_info_,
+                               TextureOptBatch& options, Tex::RunMask mask,
+                               const float* R_, const float* dRdx_,
+                               const float* dRdy_, int nchannels, float* result,
+                               float* dresultds, float* dresultdt)
 {
-    // (FIXME) CHEAT! Texture points individually
+    using namespace Tex;
+    typedef FloatWide::vbool_t BoolWide;
+    PerThreadInfo* thread_info = m_imagecache->get_perthread_info(
+        (PerThreadInfo*)thread_info_);
+    TextureFile* texturefile = verify_texturefile((TextureFile*)texture_handle_,
+                                                  thread_info);
+
+    // Gather the active lanes
+    int lanes[BatchWidth];
+    int nlanes = 0;
+    for (int i = 0; i < BatchWidth; ++i)
+        if (mask & (RunMask(1) << i))
+            lanes[nlanes++] = i;
+
+    ImageCacheStatistics& stats(thread_info->m_stats);
+    ++stats.environment_batches;
+    stats.environment_queries += nlanes;
+
     TextureOpt opt;
     opt.firstchannel        = options.firstchannel;
     opt.subimage            = options.subimage;
     opt.subimagename        = options.subimagename;
-    opt.swrap               = (TextureOpt::Wrap)options.swrap;
-    opt.twrap               = (TextureOpt::Wrap)options.twrap;
     opt.mipmode             = (TextureOpt::MipMode)options.mipmode;
     opt.interpmode          = (TextureOpt::InterpMode)options.interpmode;
     opt.anisotropic         = options.anisotropic;
@@ -603,36 +661,278 @@ TextureSystemImpl::environment(TextureHandle* texture_handle,
     opt.fill                = options.fill;
     opt.missingcolor        = options.missingcolor;
 
-    bool ok          = true;
-    Tex::RunMask bit = 1;
-    for (int i = 0; i < Tex::BatchWidth; ++i, bit <<= 1) {
-        float r[4], drds[4], drdt[4];  // temp result
-        if (mask & bit) {
-            opt.sblur  = options.sblur[i];
-            opt.tblur  = options.tblur[i];
-            opt.swidth = options.swidth[i];
-            opt.twidth = options.twidth[i];
-            Imath::V3f R_(R[i], R[i + Tex::BatchWidth],
-                          R[i + 2 * Tex::BatchWidth]);
-            Imath::V3f dRdx_(dRdx[i], dRdx[i + Tex::BatchWidth],
-                             dRdx[i + 2 * Tex::BatchWidth]);
-            Imath::V3f dRdy_(dRdy[i], dRdy[i + Tex::BatchWidth],
-                             dRdy[i + 2 * Tex::BatchWidth]);
+    // Copy one lane's nc channels, starting at channel firstc, into the
+    // [nchannels][BatchWidth] results.
+    auto scatter = [&](int lane, int firstc, int nc, const float* r,
+                       const float* drds, const float* drdt) {
+        for (int c = 0; c < nc; ++c) {
+            result[(firstc + c) * BatchWidth + lane] = r[c];
             if (dresultds) {
-                ok &= environment(texture_handle, thread_info, opt, R_, dRdx_,
-                                  dRdy_, nchannels, r, drds, drdt);
-                for (int c = 0; c < nchannels; ++c) {
-                    result[c * Tex::BatchWidth + i]    = r[c];
-                    dresultds[c * Tex::BatchWidth + i] = drds[c];
-                    dresultdt[c * Tex::BatchWidth + i] = drdt[c];
+                dresultds[(firstc + c) * BatchWidth + lane] = drds[c];
+                dresultdt[(firstc + c) * BatchWidth + lane] = drdt[c];
+            }
+        }
+    };
+
+    // If the user only provided us with one pointer, zero it and then
+    // ignore both, as the single-point environment() does.
+    if (!(dresultds && dresultdt)) {
+        for (float* d : { dresultds, dresultdt })
+            if (d)
+                for (int c = 0; c < nchannels; ++c)
+                    for (int l = 0; l < nlanes; ++l)
+                        d[c * BatchWidth + lanes[l]] = 0.0f;
+        dresultds = dresultdt = nullptr;
+    }
+
+    auto missing_batch = [&]() {
+        float* r    = OIIO_ALLOCA(float, 3 * nchannels);
+        float* drds = r + nchannels;
+        float* drdt = drds + nchannels;
+        bool ok     = true;
+        for (int l = 0; l < nlanes; ++l) {
+            ok &= missing_texture(opt, nchannels, r, drds, drdt);
+            scatter(lanes[l], 0, nchannels, r, drds, drdt);
+        }
+        return ok;
+    };
+
+    if (!texturefile || texturefile->broken())
+        return missing_batch();
+
+    if (!opt.subimagename.empty()) {
+        // If subimage was specified by name, figure out its index.
+        int s = m_imagecache->subimage_from_name(texturefile,
+                                                 opt.subimagename);
+        if (s < 0) {
+            error("Unknown subimage \"{}\" in texture \"{}\"",
+                  opt.subimagename, texturefile->filename());
+            return missing_batch();
+        }
+        opt.subimage = s;
+        opt.subimagename.clear();
+    }
+    if (opt.subimage < 0 || opt.subimage >= texturefile->subimages()) {
+        error("Unknown subimage \"{}\" in texture \"{}\"", opt.subimagename,
+              texturefile->filename());
+        return missing_batch();
+    }
+    const ImageSpec& spec(texturefile->spec(opt.subimage, 0));
+
+    // Environment maps dictate particular wrap modes
+    opt.swrap     = texturefile->m_sample_border
+                        ? TextureOpt::WrapPeriodicSharedBorder
+                        : TextureOpt::WrapPeriodic;
+    opt.twrap     = TextureOpt::WrapClamp;
+    opt.envlayout = LayoutLatLong;
+
+    // Everything up to the actual texel sampling is done for all the lanes
+    // at once, following the single-point environment() step by step.
+    // Unit-length vectors in the direction of R, R+dRdx, R+dRdy define
+    // the ellipse we're filtering over.
+    FloatWide R[3], Rx[3], Ry[3];
+    for (int i = 0; i < 3; ++i) {
+        R[i]  = FloatWide(R_ + i * BatchWidth);
+        Rx[i] = R[i] + FloatWide(dRdx_ + i * BatchWidth);
+        Ry[i] = R[i] + FloatWide(dRdy_ + i * BatchWidth);
+    }
+    normalize_batch(R);
+    normalize_batch(Rx);
+    normalize_batch(Ry);
+    FloatWide xfilt_noblur = max(angle_batch(R, Rx), FloatWide(1e-8f));
+    FloatWide yfilt_noblur = max(angle_batch(R, Ry), FloatWide(1e-8f));
+    IntWide naturalres(float(M_PI) / min(xfilt_noblur, yfilt_noblur));
+
+    // Account for width and blur
+    FloatWide xfilt = xfilt_noblur * FloatWide(options.swidth)
+                      + FloatWide(options.sblur);
+    FloatWide yfilt = yfilt_noblur * FloatWide(options.twidth)
+                      + FloatWide(options.tblur);
+
+    // Figure out major versus minor, and aspect ratio
+    BoolWide x_is_majoraxis = (xfilt >= yfilt);
+    FloatWide Rmajor[3];
+    for (int i = 0; i < 3; ++i)
+        Rmajor[i] = select(x_is_majoraxis, Rx[i], Ry[i]);
+    FloatWide majorlength = select(x_is_majoraxis, xfilt, yfilt);
+    FloatWide minorlength = select(x_is_majoraxis, yfilt, xfilt);
+
+    TextureOpt::MipMode mipmode = opt.mipmode;
+    bool aniso                  = (mipmode == TextureOpt::MipModeDefault
+                  || mipmode == TextureOpt::MipModeAniso);
+    FloatWide trueaspect(1.0f), filtwidth;
+    IntWide nsamples(1);
+    if (aniso) {
+        FloatWide aspect = anisotropic_aspect_batch(majorlength, minorlength,
+                                                    opt, trueaspect);
+        filtwidth        = minorlength;
+        nsamples = max(IntWide(1), IntWide(ceil(aspect - 0.25f)));
+    } else {
+        filtwidth = opt.conservative_filter ? majorlength : minorlength;
+    }
+    FloatWide invsamples = 1.0f / FloatWide(nsamples);
+
+    // Determine the MIP-map level(s) we need, as in the single-point
+    // case. The filter width is the same for all samples of a lane, so
+    // this only needs doing once per lane.
+    ImageCacheFile::SubimageInfo& subinfo(
+        texturefile->subimageinfo(opt.subimage));
+    int min_mip_level = subinfo.min_mip_level;
+    int nmiplevels    = (int)subinfo.levels.size();
+    IntWide miplevel0(-1), miplevel1(-1);
+    FloatWide levelblend(0.0f);
+    BoolWide found(false);
+    for (int m = min_mip_level; m < nmiplevels && !all(found); ++m) {
+        FloatWide filtwidth_ras = filtwidth
+                                  * float(subinfo.spec(m).full_height
+                                          * M_1_PI);
+        BoolWide here = (filtwidth_ras <= FloatWide(1.0f)) & !found;
+        miplevel0     = select(here, IntWide(m - 1), miplevel0);
+        miplevel1     = select(here, IntWide(m), miplevel1);
+        levelblend    = select(here,
+                            min(max(2.0f * filtwidth_ras - 1.0f,
+                                    FloatWide(0.0f)),
+                                FloatWide(1.0f)),
+                            levelblend);
+        found |= here;
+    }
+    miplevel0  = select(found, miplevel0, IntWide(nmiplevels - 1));
+    miplevel1  = select(found, miplevel1, IntWide(nmiplevels - 1));
+    levelblend = select(found, levelblend, FloatWide(0.0f));
+    BoolWide finest = found & (miplevel0 < IntWide(min_mip_level));
+    miplevel0       = select(finest, IntWide(min_mip_level), miplevel0);
+    miplevel1       = select(finest, IntWide(min_mip_level), miplevel1);
+    levelblend      = select(finest, FloatWide(0.0f), levelblend);
+    if (mipmode == TextureOpt::MipModeOneLevel) {
+        // Force use of just one mipmap level
+        miplevel1  = miplevel0;
+        levelblend = FloatWide(0.0f);
+    } else if (mipmode == TextureOpt::MipModeNoMIP) {
+        // Just sample from lowest level
+        miplevel0  = IntWide(min_mip_level);
+        miplevel1  = IntWide(min_mip_level);
+        levelblend = FloatWide(0.0f);
+    }
+
+    alignas(BatchAlign) int nsamples_[BatchWidth];
+    alignas(BatchAlign) int miplevel0_[BatchWidth];
+    alignas(BatchAlign) int miplevel1_[BatchWidth];
+    alignas(BatchAlign) int naturalres_[BatchWidth];
+    alignas(BatchAlign) float levelblend_[BatchWidth];
+    alignas(BatchAlign) float trueaspect_[BatchWidth];
+    alignas(BatchAlign) float invsamples_[BatchWidth];
+    nsamples.store(nsamples_);
+    miplevel0.store(miplevel0_);
+    miplevel1.store(miplevel1_);
+    naturalres.store(naturalres_);
+    levelblend.store(levelblend_);
+    trueaspect.store(trueaspect_);
+    invsamples.store(invsamples_);
+    int maxsamples = 1;
+    for (int l = 0; l < nlanes; ++l)
+        maxsamples = std::max(maxsamples, nsamples_[lanes[l]]);
+
+    // The latlong st of every sample of every lane, along the major axis
+    // FIXME -- assuming latlong
+    float* sval = OIIO_ALLOCA(float, 2 * maxsamples * BatchWidth);
+    float* tval = sval + maxsamples * BatchWidth;
+    // Step pos the way the single-point loop does, so the sample
+    // positions round the same.
+    FloatWide pos = -0.5f + 0.5f * invsamples;
+    for (int sample = 0; sample < maxsamples; ++sample, pos += invsamples) {
+        FloatWide Rsamp[3], s, t;
+        for (int i = 0; i < 3; ++i)
+            Rsamp[i] = R[i] + pos * Rmajor[i];
+        vector_to_latlong_batch(Rsamp, texturefile->m_y_up, s, t);
+        s.store(sval + sample * BatchWidth);
+        t.store(tval + sample * BatchWidth);
+    }
+
+    // Now sample each lane: all of its samples at one MIP level go to the
+    // sampler in a single call.
+    int npadded        = round_to_multiple_of_pow2(maxsamples, 4);
+    float* lane_s      = OIIO_ALLOCA(float, 3 * npadded);
+    float* lane_t      = lane_s + npadded;
+    float* lane_weight = lane_t + npadded;
+    bool ok            = true;
+    for (int l = 0; l < nlanes; ++l) {
+        int i  = lanes[l];
+        int ns = nsamples_[i];
+        for (int sample = 0; sample < npadded; ++sample) {
+            bool on             = sample < ns;
+            lane_s[sample]      = on ? sval[sample * BatchWidth + i] : 0.0f;
+            lane_t[sample]      = on ? tval[sample * BatchWidth + i] : 0.0f;
+            lane_weight[sample] = 0.0f;
+        }
+        if (aniso && trueaspect_[i] > stats.max_aniso)
+            stats.max_aniso = trueaspect_[i];
+        int miplevel[2]      = { miplevel0_[i], miplevel1_[i] };
+        float levelweight[2] = { 1.0f - levelblend_[i], levelblend_[i] };
+
+        // Lookups are at most 4 channels wide; do wider ones in groups.
+        for (int firstc = 0; firstc < nchannels; firstc += 4) {
+            int nc             = std::min(nchannels - firstc, 4);
+            opt.firstchannel   = options.firstchannel + firstc;
+            int actualchannels = Imath::clamp(spec.nchannels
+                                                  - opt.firstchannel,
+                                              0, nc);
+            vfloat4 r_sum, drds_sum, drdt_sum;
+            r_sum.clear();
+            drds_sum.clear();
+            drdt_sum.clear();
+            for (int level = 0; level < 2; ++level) {
+                if (!levelweight[level])
+                    continue;
+                int lev = miplevel[level];
+                sampler_prototype sampler;
+                switch (opt.interpmode) {
+                case TextureOpt::InterpClosest:
+                    sampler = &TextureSystemImpl::sample_closest;
+                    stats.closest_interps += ns;
+                    break;
+                case TextureOpt::InterpBicubic:
+                    sampler = &TextureSystemImpl::sample_bicubic;
+                    stats.cubic_interps += ns;
+                    break;
+                case TextureOpt::InterpSmartBicubic:
+                    if (lev == 0
+                        || (texturefile->spec(opt.subimage, lev).full_height
+                            < naturalres_[i] / 2)) {
+                        sampler = &TextureSystemImpl::sample_bicubic;
+                        stats.cubic_interps += ns;
+                    } else {
+                        sampler = &TextureSystemImpl::sample_bilinear;
+                        stats.bilinear_interps += ns;
+                    }
+                    break;
+                default:
+                    sampler = &TextureSystemImpl::sample_bilinear;
+                    stats.bilinear_interps += ns;
+                    break;
                 }
-            } else {
-                ok &= environment(texture_handle, thread_info, opt, R_, dRdx_,
-                                  dRdy_, nchannels, r);
-                for (int c = 0; c < nchannels; ++c) {
-                    result[c * Tex::BatchWidth + i] = r[c];
+                for (int sample = 0; sample < ns; ++sample)
+                    lane_weight[sample] = levelweight[level] * invsamples_[i];
+                vfloat4 r, drds, drdt;
+                ok &= (this->*sampler)(ns, lane_s, lane_t, lev, *texturefile,
+                                       thread_info, opt, nc, actualchannels,
+                                       lane_weight, &r,
+                                       dresultds ? &drds : NULL,
+                                       dresultds ? &drdt : NULL);
+                r_sum += r;
+                if (dresultds) {
+                    drds_sum += drds;
+                    drdt_sum += drdt;
                 }
             }
+            stats.aniso_probes += ns;
+            ++stats.aniso_queries;
+            if (actualchannels < nc && opt.firstchannel == 0
+                && m_gray_to_rgb)
+                fill_gray_channels(spec, nc, (float*)&r_sum,
+                                   dresultds ? (float*)&drds_sum : nullptr,
+                                   dresultds ? (float*)&drdt_sum : nullptr);
+            scatter(i, firstc, nc, (const float*)&r_sum,
+                    (const float*)&drds_sum, (const float*)&drdt_sum);
         }
     }
     return ok;
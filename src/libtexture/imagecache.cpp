@@ -127,6 +127,9 @@ ImageCacheStatistics::init()
     files_totalsize        = 0;
     files_totalsize_ondisk = 0;
     bytes_read             = 0;
+    disk_cache_hits        = 0;
+    disk_cache_misses      = 0;
+    disk_cache_writes      = 0;
     //    open_files_created = 0;
     //    open_files_current = 0;
     //    open_files_peak = 0;
@@ -173,6 +176,9 @@ ImageCacheStatistics::merge(const ImageCacheStatistics& s)
     files_totalsize += s.files_totalsize;
     files_totalsize_ondisk += s.files_totalsize_ondisk;
     bytes_read += s.bytes_read;
+    disk_cache_hits += s.disk_cache_hits;
+    disk_cache_misses += s.disk_cache_misses;
+    disk_cache_writes += s.disk_cache_writes;
     //    open_files_created += s.open_files_created;
     //    open_files_current += s.open_files_current;
     //    open_files_peak += s.open_files_peak;
@@ -309,6 +315,9 @@ ImageCacheFile::ImageCacheFile(ImageCacheImpl& imagecache,
     // release() it, because the proxy can't be reopened.
     if (config && config->find_attribute("oiio:ioproxy", TypeDesc::PTR))
         m_allow_release = false;
+
+    if (config)
+        m_readahead = config->get_int_attribute("imagecache:readahead", -1);
 }
 
 
@@ -322,6 +331,8 @@ ImageCacheFile::reset(ImageInput::Creator creator, const ImageSpec* config)
 {
     m_inputcreator = creator;
     m_configspec.reset(config ? new ImageSpec(*config) : nullptr);
+    m_readahead = config ? config->get_int_attribute("imagecache:readahead", -1)
+                         : -1;
 }
 
 
@@ -443,6 +454,30 @@ ImageCacheFile::SubimageInfo::init(ImageCacheFile& icfile,
         const Imath::M44f* m = (const Imath::M44f*)p->data();
         Mlocal.reset(new Imath::M44f(c2w * (*m)));
     }
+
+    // Shadow maps record the light's projection, either to NDC (0-1 with
+    // y down, as OpenEXR's worldToNDC) or to screen space (-1..1 with y
+    // up, as z files and RenderMan use), plus the world-to-camera matrix
+    // whose z is the depth that was stored in the pixels.
+    const ParamValue* ndc = spec.find_attribute("worldtoNDC", TypeMatrix);
+    const ParamValue* scr = spec.find_attribute("worldtoscreen", TypeMatrix);
+    if (ndc || scr) {
+        Imath::M44f c2w;
+        icfile.m_imagecache.get_commontoworld(c2w);
+        if (ndc) {
+            Mndc.reset(new Imath::M44f(c2w * *(const Imath::M44f*)ndc->data()));
+        } else {
+            const Imath::M44f screen2ndc(0.5f, 0.0f, 0.0f, 0.0f,   //
+                                         0.0f, -0.5f, 0.0f, 0.0f,  //
+                                         0.0f, 0.0f, 1.0f, 0.0f,   //
+                                         0.5f, 0.5f, 0.0f, 1.0f);
+            Mndc.reset(new Imath::M44f(c2w * *(const Imath::M44f*)scr->data()
+                                       * screen2ndc));
+        }
+        if ((p = spec.find_attribute("worldtocamera", TypeMatrix)))
+            Mcamera.reset(
+                new Imath::M44f(c2w * *(const Imath::M44f*)p->data()));
+    }
 }
 
 
@@ -808,6 +843,15 @@ ImageCacheFile::read_tile(ImageCachePerThreadInfo* thread_info, int subimage,
         return read_unmipped(thread_info, subimage, miplevel, x, y, z, chbegin,
                              chend, format, data);
 
+    // Tiles of fingerprinted textures may be found in the on-disk cache,
+    // in which case we needn't even open the file.
+    bool use_disk_cache = !subinfo.untiled && !m_fingerprint.empty()
+                          && !imagecache().disk_cache().empty();
+    if (use_disk_cache
+        && imagecache().disk_cache_read(thread_info, *this, subimage, miplevel,
+                                        x, y, z, chbegin, chend, format, data))
+        return true;
+
     std::shared_ptr<ImageInput> inp = open(thread_info);
     if (!inp)
         return false;
@@ -847,6 +891,10 @@ ImageCacheFile::read_tile(ImageCachePerThreadInfo* thread_info, int subimage,
         thread_info->m_stats.bytes_read += b;
         m_bytesread += b;
         ++m_tilesread;
+        if (use_disk_cache)
+            imagecache().disk_cache_write(thread_info, *this, subimage,
+                                          miplevel, x, y, z, chbegin, chend,
+                                          format, data);
     }
     return ok;
 }
@@ -1255,7 +1303,7 @@ ImageCacheImpl::verify_file(ImageCacheFile* tf,
             ImageCacheStatistics& stats(thread_info->m_stats);
             stats.fileio_time += createtime;
             stats.fileopen_time += createtime;
-            tf->iotime() += createtime;
+            tf->add_iotime(createtime);
 
             // What if we've opened another file, with a different name,
             // but the SAME pixels?  It can happen!  Bad user, bad!  But
@@ -1428,7 +1476,9 @@ ImageCacheTile::ImageCacheTile(const TileID& id)
     : m_id(id)
     , m_valid(true)
 {
-    id.file().imagecache().incr_tiles(0);  // mem counted separately in read
+    ImageCacheImpl& ic(id.file().imagecache());
+    m_cache_bin = ic.tile_cache_bin(id);
+    ic.incr_tiles(0, m_cache_bin);  // mem counted separately in read
 }
 
 
@@ -1439,6 +1489,7 @@ ImageCacheTile::ImageCacheTile(const TileID& id, const void* pels,
     : m_id(id)
 {
     ImageCacheFile& file(m_id.file());
+    m_cache_bin = file.imagecache().tile_cache_bin(id);
     const ImageSpec& spec(file.spec(id.subimage(), id.miplevel()));
     m_channelsize = file.datatype(id.subimage()).size();
     m_pixelsize   = id.nchannels() * m_channelsize;
@@ -1462,7 +1513,7 @@ ImageCacheTile::ImageCacheTile(const TileID& id, const void* pels,
         m_pixels.reset((char*)pels);
         m_valid = true;
     }
-    id.file().imagecache().incr_tiles(m_pixels_size);
+    id.file().imagecache().incr_tiles(m_pixels_size, m_cache_bin);
     m_pixels_ready = true;  // Caller sent us the pixels, no read necessary
     // FIXME -- for shadow, fill in mindepth, maxdepth
 }
@@ -1471,7 +1522,7 @@ ImageCacheTile::ImageCacheTile(const TileID& id, const void* pels,
 
 ImageCacheTile::~ImageCacheTile()
 {
-    m_id.file().imagecache().decr_tiles(memsize());
+    m_id.file().imagecache().decr_tiles(memsize(), m_cache_bin);
     if (m_nofree)
         m_pixels.release();  // release without freeing
 }
@@ -1507,7 +1558,7 @@ ImageCacheTile::read(ImageCachePerThreadInfo* thread_info)
                              m_id.x(), m_id.y(), m_id.z(), m_id.chbegin(),
                              m_id.chend(), file.datatype(m_id.subimage()),
                              &m_pixels[0]);
-    m_id.file().imagecache().incr_mem(size);
+    m_id.file().imagecache().incr_mem(size, m_cache_bin);
     if (m_valid) {
         // Figure out if
         ImageCacheFile::LevelInfo& lev(
@@ -1633,6 +1684,10 @@ ImageCacheImpl::init()
 
 ImageCacheImpl::~ImageCacheImpl()
 {
+    // Let any prefetches in flight finish, then shut down the pool (so its
+    // threads release their per-thread info) before we tear down the rest.
+    prefetch_wait();
+    m_prefetch_pool.reset();
     printstats();
     erase_perthread_info();
 }
@@ -1738,6 +1793,67 @@ ImageCacheImpl::onefile_stat_line(const ImageCacheFileRef& file, int i,
 
 
 
+void
+ImageCacheImpl::get_stats(Stats& out, bool per_file) const
+{
+    // The per-thread counters are StatCounters, safe to read while their
+    // threads update them. mergestats() holds m_perthread_info_mutex while
+    // it walks the list of threads, which only stalls lookups that are
+    // registering a new thread or honoring a purge at that moment.
+    ImageCacheStatistics stats;
+    mergestats(stats);
+
+    out                     = Stats();
+    out.find_tile_calls     = stats.find_tile_calls;
+    out.microcache_misses   = stats.find_tile_microcache_misses;
+    out.cache_misses        = stats.find_tile_cache_misses;
+    out.tiles_created       = m_stat_tiles_created;
+    out.tiles_current       = m_stat_tiles_current;
+    out.tiles_peak          = m_stat_tiles_peak;
+    out.cache_memory_used   = m_mem_used;
+    out.bytes_read          = stats.bytes_read;
+    out.open_files_created  = m_stat_open_files_created;
+    out.open_files_current  = m_stat_open_files_current;
+    out.open_files_peak     = m_stat_open_files_peak;
+    out.unique_files        = stats.unique_files;
+    out.disk_cache_hits     = stats.disk_cache_hits;
+    out.disk_cache_misses   = stats.disk_cache_misses;
+    out.disk_cache_writes   = stats.disk_cache_writes;
+    out.texture_queries     = stats.texture_queries;
+    out.texture3d_queries   = stats.texture3d_queries;
+    out.shadow_queries      = stats.shadow_queries;
+    out.environment_queries = stats.environment_queries;
+    out.fileio_time         = stats.fileio_time;
+    out.fileopen_time       = stats.fileopen_time;
+    out.file_locking_time   = stats.file_locking_time;
+    out.tile_locking_time   = stats.tile_locking_time;
+    out.find_file_time      = stats.find_file_time;
+    out.find_tile_time      = stats.find_tile_time;
+    for (const TileCacheShard& sh : m_tile_shards) {
+        out.tiles_evicted += sh.evictions;
+        out.bytes_evicted += sh.evicted_bytes;
+    }
+
+    if (per_file) {
+        for (FilenameMap::iterator f = m_files.begin(); f != m_files.end();
+             ++f) {
+            const ImageCacheFileRef& file(f->second);
+            FileStats fs;
+            fs.filename             = file->filename();
+            fs.times_opened         = file->timesopened();
+            fs.tiles_read           = file->tilesread();
+            fs.bytes_read           = file->bytesread();
+            fs.redundant_tiles      = file->redundant_tiles();
+            fs.redundant_bytes_read = file->redundant_bytesread();
+            fs.io_time              = file->iotime();
+            fs.broken               = file->broken();
+            out.files.push_back(fs);
+        }
+    }
+}
+
+
+
 std::string
 ImageCacheImpl::getstats(int level) const
 {
@@ -1818,6 +1934,10 @@ ImageCacheImpl::getstats(int level) const
         INTOPT(deduplicate);
         INTOPT(unassociatedalpha);
         INTOPT(failure_retries);
+        INTOPT(tile_cache_shards);
+        INTOPT(prefetch_threads);
+        INTOPT(readahead);
+        STROPT(disk_cache);
 #undef BOOLOPT
 #undef INTOPT
 #undef STROPT
@@ -1886,6 +2006,40 @@ ImageCacheImpl::getstats(int level) const
         }
         out << "    Peak cache memory : " << Strutil::memformat(m_mem_used)
             << "\n";
+        long long total_evictions = 0, total_evicted_bytes = 0;
+        for (const TileCacheShard& sh : m_tile_shards) {
+            total_evictions += sh.evictions;
+            total_evicted_bytes += sh.evicted_bytes;
+        }
+        if (total_evictions)
+            out << "    Tiles evicted : " << total_evictions << " ("
+                << Strutil::memformat(total_evicted_bytes) << ")\n";
+        if (stats.disk_cache_hits || stats.disk_cache_writes)
+            out << "    Disk cache : " << stats.disk_cache_hits << " hits, "
+                << stats.disk_cache_misses << " misses, "
+                << stats.disk_cache_writes << " tiles written\n";
+        if (m_stat_prefetch_queued)
+            out << "    Prefetch : " << m_stat_prefetch_queued
+                << " tiles queued, " << m_stat_prefetch_read
+                << " read from disk\n";
+        const int nshards = m_tile_cache_shards.load();
+        if (nshards > 1) {
+            out << "    Tile cache shards : " << nshards << " ("
+                << Strutil::memformat(m_max_memory_bytes / nshards)
+                << " budget each)\n";
+            if (level >= 2) {
+                for (int i = 0; i < nshards; ++i) {
+                    const TileCacheShard& sh(m_tile_shards[i]);
+                    out << Strutil::sprintf(
+                        "      shard %3d : %9s used, %6lld evictions (%s), "
+                        "%lld sweeps, %lld contended\n",
+                        i, Strutil::memformat(tile_shard_mem_used(i, nshards)),
+                        (long long)sh.evictions,
+                        Strutil::memformat(sh.evicted_bytes),
+                        (long long)sh.sweeps, (long long)sh.sweep_contention);
+                }
+            }
+        }
         if (stats.tile_locking_time > 0.001)
             out << "    Tile mutex locking time : "
                 << Strutil::timeintervalformat(stats.tile_locking_time) << "\n";
@@ -2060,6 +2214,15 @@ ImageCacheImpl::reset_stats()
             m_all_perthread_info[i]->m_stats.init();
     }
 
+    m_stat_prefetch_queued = 0;
+    m_stat_prefetch_read   = 0;
+    for (TileCacheShard& sh : m_tile_shards) {
+        sh.evictions        = 0;
+        sh.evicted_bytes    = 0;
+        sh.sweeps           = 0;
+        sh.sweep_contention = 0;
+    }
+
     {
         for (FilenameMap::iterator f = m_files.begin(); f != m_files.end();
              ++f) {
@@ -2110,6 +2273,14 @@ ImageCacheImpl::attribute(string_view name, TypeDesc type, const void* val)
         }
     } else if (name == "plugin_searchpath" && type == TypeDesc::STRING) {
         m_plugin_searchpath = std::string(*(const char**)val);
+    } else if (name == "disk_cache" && type == TypeDesc::STRING) {
+        m_disk_cache = std::string(*(const char**)val);
+        if (m_disk_cache.size() && !Filesystem::is_directory(m_disk_cache)) {
+            std::string err;
+            if (!Filesystem::create_directory(m_disk_cache, err))
+                error("Could not create disk cache directory \"{}\": {}",
+                      m_disk_cache, err);
+        }
     } else if (name == "statistics:level" && type == TypeDesc::INT) {
         m_statslevel = *(const int*)val;
     } else if (name == "max_errors_per_file" && type == TypeDesc::INT) {
@@ -2182,6 +2353,20 @@ ImageCacheImpl::attribute(string_view name, TypeDesc type, const void* val)
     } else if (name == "substitute_image" && type == TypeDesc::STRING) {
         m_substitute_image = ustring(*(const char**)val);
         do_invalidate      = true;
+    } else if (name == "prefetch_threads" && type == TypeInt) {
+        int n = std::max(0, *(const int*)val);
+        if (n != m_prefetch_threads) {
+            // Resizing a pool is only safe when it has no jobs running.
+            prefetch_wait();
+            spin_lock lock(m_prefetch_pool_mutex);
+            m_prefetch_threads = n;
+            if (m_prefetch_pool)
+                m_prefetch_pool->resize(n);
+        }
+    } else if (name == "readahead" && type == TypeInt) {
+        m_readahead = std::max(0, *(const int*)val);
+    } else if (name == "tile_cache_shards" && type == TypeInt) {
+        set_tile_cache_shards(*(const int*)val);
     } else if (name == "max_mip_res" && type == TypeInt) {
         m_max_mip_res = *(const int*)val;
         do_invalidate = true;
@@ -2223,6 +2408,9 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
     ATTR_DECODE("failure_retries", int, m_failure_retries);
     ATTR_DECODE("total_files", int, m_files.size());
     ATTR_DECODE("max_mip_res", int, m_max_mip_res);
+    ATTR_DECODE("tile_cache_shards", int, m_tile_cache_shards.load());
+    ATTR_DECODE("prefetch_threads", int, m_prefetch_threads);
+    ATTR_DECODE("readahead", int, m_readahead);
 
     // The cases that don't fit in the simple ATTR_DECODE scheme
     if (name == "searchpath" && type == TypeDesc::STRING) {
@@ -2233,6 +2421,10 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         *(ustring*)val = m_plugin_searchpath;
         return true;
     }
+    if (name == "disk_cache" && type == TypeDesc::STRING) {
+        *(ustring*)val = m_disk_cache;
+        return true;
+    }
     if (name == "worldtocommon"
         && (type == TypeMatrix || type == TypeDesc(TypeDesc::FLOAT, 16))) {
         *(Imath::M44f*)val = m_Mw2c;
@@ -2271,6 +2463,17 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         ATTR_DECODE("stat:open_files_created", int, m_stat_open_files_created);
         ATTR_DECODE("stat:open_files_current", int, m_stat_open_files_current);
         ATTR_DECODE("stat:open_files_peak", int, m_stat_open_files_peak);
+        ATTR_DECODE("stat:prefetch_tiles_queued", long long,
+                    m_stat_prefetch_queued);
+        ATTR_DECODE("stat:prefetch_tiles_read", long long,
+                    m_stat_prefetch_read);
+        if (name == "stat:tiles_evicted" && type == TypeInt64) {
+            long long evictions = 0;
+            for (const TileCacheShard& sh : m_tile_shards)
+                evictions += sh.evictions;
+            *(long long*)val = evictions;
+            return true;
+        }
 
         // All the other stats are those that need to be summed from all
         // the threads.
@@ -2286,6 +2489,11 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         ATTR_DECODE("stat:image_size", long long, stats.files_totalsize);
         ATTR_DECODE("stat:file_size", long long, stats.files_totalsize_ondisk);
         ATTR_DECODE("stat:bytes_read", long long, stats.bytes_read);
+        ATTR_DECODE("stat:disk_cache_hits", long long, stats.disk_cache_hits);
+        ATTR_DECODE("stat:disk_cache_misses", long long,
+                    stats.disk_cache_misses);
+        ATTR_DECODE("stat:disk_cache_writes", long long,
+                    stats.disk_cache_writes);
         ATTR_DECODE("stat:unique_files", int, stats.unique_files);
         ATTR_DECODE("stat:fileio_time", float, stats.fileio_time);
         ATTR_DECODE("stat:fileopen_time", float, stats.fileopen_time);
@@ -2357,16 +2565,19 @@ ImageCacheImpl::find_tile_main_cache(const TileID& id, ImageCacheTileRef& tile,
 
     add_tile_to_cache(tile, thread_info);
     OIIO_DASSERT(id == tile->id());
+    if (m_readahead > 0 || id.file().readahead() > 0)
+        readahead(id, thread_info);
     return tile->valid();
 }
 
 
 
-void
+bool
 ImageCacheImpl::add_tile_to_cache(ImageCacheTileRef& tile,
                                   ImageCachePerThreadInfo* thread_info)
 {
     bool ourtile = m_tilecache.insert_retrieve(tile->id(), tile, tile);
+    bool didread = false;
 
     // If we added a new tile to the cache, we may still need to read the
     // pixels; and if we found the tile in cache, we may need to wait for
@@ -2377,21 +2588,24 @@ ImageCacheImpl::add_tile_to_cache(ImageCacheTileRef& tile,
             tile->read(thread_info);
             double readtime = timer();
             thread_info->m_stats.fileio_time += readtime;
-            tile->id().file().iotime() += readtime;
+            tile->id().file().add_iotime(readtime);
+            didread = true;
         }
-        check_max_mem(thread_info);
+        check_max_mem(thread_info, tile->cache_bin());
     } else {
         // Somebody else already added the tile to the cache before we
         // could, so we'll use their reference, but we need to wait until it
         // has read in the pixels.
         tile->wait_pixels_ready();
     }
+    return didread;
 }
 
 
 
 void
-ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
+ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/,
+                              int bin)
 {
     OIIO_DASSERT(m_mem_used < (long long)m_max_memory_bytes * 10);  // sanity
 #if 0
@@ -2406,45 +2620,109 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
     if (m_mem_used < (long long)m_max_memory_bytes)
         return;
 
-    // Try to grab the tile_sweep_mutex lock. If somebody else holds it,
-    // just return -- leave the memory limit enforcement to whomever is
-    // already in this function, no need for two threads to do it at
+    // The tile cache bins are divided among nshards sweep shards, each
+    // of which gets an equal slice of the memory budget. Start with the
+    // shard holding the tile we just added (it's most likely the one that
+    // pushed us over), then help out with any other shards that are over
+    // their slice, until the cache as a whole is back under the limit.
+    // Shards that some other thread is already sweeping are skipped, so
+    // with many shards, threads don't pile up behind a single lock.
+    // Read the shard count just once: "tile_cache_shards" may be changed
+    // by another thread while we sweep, and the budget, the first shard
+    // and the shard mask must all agree with the layout we sweep.
+    const int nshards      = m_tile_cache_shards.load();
+    const long long budget = m_max_memory_bytes / nshards;
+    const int firstshard   = bin / (TILE_CACHE_SHARDS / nshards);
+    for (int i = 0;
+         i < nshards && m_mem_used >= (long long)m_max_memory_bytes; ++i) {
+        int shard = (firstshard + i) & (nshards - 1);
+        if (tile_shard_mem_used(shard, nshards) >= budget)
+            sweep_tile_shard(shard, nshards, budget);
+    }
+}
+
+
+
+long long
+ImageCacheImpl::tile_shard_mem_used(int shard, int nshards) const
+{
+    if (nshards == 1)
+        return m_mem_used;
+    const int binsper = TILE_CACHE_SHARDS / nshards;
+    long long mem     = 0;
+    for (int b = shard * binsper, e = b + binsper; b < e; ++b)
+        mem += m_tile_bin_mem[b].mem;
+    return mem;
+}
+
+
+
+void
+ImageCacheImpl::sweep_tile_shard(int shard, int nshards, long long budget)
+{
+    TileCacheShard& sh(m_tile_shards[shard]);
+
+    // Try to grab the shard's sweep_mutex lock. If somebody else holds it,
+    // just return -- leave the memory limit enforcement of this shard to
+    // whomever is already sweeping it, no need for two threads to do it at
     // once.  If this means we may ephemerally be over the memory limit
     // (because another thread adds a tile before we have freed enough
     // here), so be it.
-    if (!m_tile_sweep_mutex.try_lock())
+    if (!sh.sweep_mutex.try_lock()) {
+        ++sh.sweep_contention;
         return;
+    }
+    ++sh.sweeps;
+
+    // This shard is responsible for the contiguous range of tile cache
+    // bins [binbegin, binend).
+    const int binsper  = TILE_CACHE_SHARDS / nshards;
+    const int binbegin = shard * binsper;
+    const int binend   = binbegin + binsper;
 
     // Now, what we want to do is have a "clock hand" that sweeps across
-    // the cache, releasing tiles that haven't been used for a long
+    // the shard, releasing tiles that haven't been used for a long
     // time.  Because of multi-thread, rather than keep an iterator
     // around for this (which could be invalidated since the last time
     // we used it), we just remember the tileID of the next tile to
-    // check, then look it up fresh.  That is m_tile_sweep_id.
+    // check, then look it up fresh.  That is the shard's sweep_id.
 
     // Get a (locked) iterator for the next tile to be examined.
     TileCache::iterator sweep;
-    if (!m_tile_sweep_id.empty()) {
+    if (!sh.sweep_id.empty()) {
         // We saved the sweep_id. Find the iterator corresponding to it.
-        sweep = m_tilecache.find(m_tile_sweep_id);
+        sweep = m_tilecache.find(sh.sweep_id);
         // Note: if the sweep_id is no longer in the table, sweep will be an
         // empty iterator. That's ok, it will be fixed early in the main
         // loop below.
     }
 
-    // Loop while we still use too much tile memory.  Also, be careful
-    // of looping for too long, exit the loop if we just keep spinning
-    // uncontrollably.
+    // Loop while the shard still uses too much tile memory.  Rather than
+    // re-sum the shard's bins for every tile, we keep a running tally of
+    // what we've freed and only refresh it once per trip around the
+    // shard. Also, be careful of looping for too long, exit the loop if we
+    // just keep spinning uncontrollably.
+    long long mem  = tile_shard_mem_used(shard, nshards);
     int full_loops = 0;
-    while (m_mem_used >= (long long)m_max_memory_bytes && full_loops < 100) {
-        // If we have fallen off the end of the cache, loop back to the
+    while (mem >= budget && full_loops < 100) {
+        // If we have walked out of this shard's bins (or the saved sweep
+        // id was left over from a different shard layout), treat it the
+        // same as falling off the end.
+        if (sweep && (sweep.bin() < binbegin || sweep.bin() >= binend))
+            sweep.clear();
+        // If we have fallen off the end of the shard, loop back to the
         // beginning and increment our full_loops count.
         if (!sweep) {
-            sweep = m_tilecache.begin();
+            sweep = m_tilecache.begin(binbegin);
+            if (sweep && sweep.bin() >= binend)
+                sweep.clear();
             ++full_loops;
+            mem = tile_shard_mem_used(shard, nshards);
+            if (mem < budget)
+                break;
         }
         // If we're STILL at the end, it must be that somehow the entire
-        // cache is empty.  So just declare ourselves done.
+        // shard is empty.  So just declare ourselves done.
         if (!sweep)
             break;
         OIIO_DASSERT(sweep->second);
@@ -2459,27 +2737,30 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
             // 2. Find the TileID of the NEXT item. We do this by
             // incrementing the sweep iterator and grabbing its id.
             ++sweep;
-            m_tile_sweep_id = (sweep ? sweep->first : TileID());
+            sh.sweep_id = (sweep ? sweep->first : TileID());
             // 3. Release the bin lock and erase the tile we wish to delete.
             sweep.unlock();
             m_tilecache.erase(todelete);
+            mem -= (long long)size;
+            ++sh.evictions;
+            sh.evicted_bytes += (long long)size;
             // 4. Re-establish a locked iterator for the next item, since
             // the old iterator may have been invalidated by the erasure.
-            if (!m_tile_sweep_id.empty())
-                sweep = m_tilecache.find(m_tile_sweep_id);
+            if (!sh.sweep_id.empty())
+                sweep = m_tilecache.find(sh.sweep_id);
         } else {
             ++sweep;
         }
     }
 
     // OK, by this point we have either freed enough tiles to be below
-    // the limit again, or the cache is empty, or we've looped over the
-    // cache too many times and are giving up.
+    // the shard's budget again, or the shard is empty, or we've looped
+    // over the shard too many times and are giving up.
 
     // Now we must save the tileid for next time.  Just set it to an
     // empty ID if we don't have a valid iterator at this point.
-    m_tile_sweep_id = (sweep ? sweep->first : TileID());
-    m_tile_sweep_mutex.unlock();
+    sh.sweep_id = (sweep ? sweep->first : TileID());
+    sh.sweep_mutex.unlock();
 
     // N.B. As we exit, the iterators will go out of scope and we will
     // retain no locks on the cache.
@@ -2487,6 +2768,20 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
 
 
 
+void
+ImageCacheImpl::set_tile_cache_shards(int n)
+{
+    n = std::min(std::max(n, 1), TILE_CACHE_SHARDS);
+    // Round down to a power of two, so the shards evenly divide the bins.
+    while (n & (n - 1))
+        n &= n - 1;
+    // The saved clock hands of the old layout will simply be discarded
+    // by the first sweep that notices they lie outside its bins.
+    m_tile_cache_shards = n;
+}
+
+
+
 std::string
 ImageCacheImpl::resolve_filename(const std::string& filename) const
 {
@@ -3236,9 +3531,277 @@ ImageCacheImpl::add_tile(ustring filename, int subimage, int miplevel, int x,
 
 
 
+bool
+ImageCacheImpl::prefetch(ustring filename, int subimage, int miplevel, ROI roi,
+                         int cache_chbegin, int cache_chend)
+{
+    ImageCachePerThreadInfo* thread_info = get_perthread_info();
+    ImageCacheFile* file                 = find_file(filename, thread_info);
+    return prefetch(file, thread_info, subimage, miplevel, roi, cache_chbegin,
+                    cache_chend);
+}
+
+
+
+bool
+ImageCacheImpl::prefetch(ImageHandle* file, Perthread* thread_info,
+                         int subimage, int miplevel, ROI roi,
+                         int cache_chbegin, int cache_chend)
+{
+    if (!thread_info)
+        thread_info = get_perthread_info();
+    file = verify_file(file, thread_info);
+    if (!file || file->broken()) {
+        if (file && file->errors_should_issue())
+            error("Invalid image file \"{}\": {}", file->filename(),
+                  file->broken_error_message());
+        return false;
+    }
+    if (file->is_udim()) {
+        error("Cannot prefetch() a UDIM-like virtual file");
+        return false;
+    }
+    if (subimage < 0 || subimage >= file->subimages()) {
+        if (file->errors_should_issue())
+            error("prefetch asked for nonexistent subimage {} of \"{}\"",
+                  subimage, file->filename());
+        return false;
+    }
+    if (miplevel < 0 || miplevel >= file->miplevels(subimage)) {
+        if (file->errors_should_issue())
+            error("prefetch asked for nonexistent MIP level {} of \"{}\"",
+                  miplevel, file->filename());
+        return false;
+    }
+
+    const ImageSpec& spec(file->spec(subimage, miplevel));
+    roi = roi.defined() ? roi_intersection(roi, get_roi(spec)) : get_roi(spec);
+    if (roi.npixels() == 0)
+        return true;  // Nothing to do
+    if (cache_chbegin < 0 || cache_chend < 0 || cache_chbegin >= cache_chend) {
+        cache_chbegin = 0;
+        cache_chend   = spec.nchannels;
+    }
+
+    // Snap the roi corner to the tile grid and walk the tiles.
+    int tz0 = roi.zbegin - ((roi.zbegin - spec.z) % spec.tile_depth);
+    int ty0 = roi.ybegin - ((roi.ybegin - spec.y) % spec.tile_height);
+    int tx0 = roi.xbegin - ((roi.xbegin - spec.x) % spec.tile_width);
+    for (int tz = tz0; tz < roi.zend; tz += spec.tile_depth)
+        for (int ty = ty0; ty < roi.yend; ty += spec.tile_height)
+            for (int tx = tx0; tx < roi.xend; tx += spec.tile_width)
+                queue_prefetch(TileID(*file, subimage, miplevel, tx, ty, tz,
+                                      cache_chbegin, cache_chend),
+                               thread_info);
+    return true;
+}
+
+
+
+void
+ImageCacheImpl::prefetch_wait()
+{
+    std::unique_lock<std::mutex> lock(m_prefetch_done_mutex);
+    m_prefetch_done.wait(lock, [this]() { return m_prefetch_pending == 0; });
+}
+
+
+
+thread_pool*
+ImageCacheImpl::prefetch_pool()
+{
+    spin_lock lock(m_prefetch_pool_mutex);
+    if (!m_prefetch_pool)
+        m_prefetch_pool.reset(new thread_pool(m_prefetch_threads));
+    return m_prefetch_pool.get();
+}
+
+
+
+void
+ImageCacheImpl::queue_prefetch(const TileID& id,
+                               ImageCachePerThreadInfo* thread_info)
+{
+    if (tile_in_cache(id, thread_info))
+        return;
+    ++m_stat_prefetch_queued;
+    ++m_prefetch_pending;
+    // N.B. We don't keep the future -- nobody waits on an individual
+    // prefetch, only on m_prefetch_pending reaching zero.
+    prefetch_pool()->push([this, id](int /*thread_id*/) {
+        prefetch_tile(id);
+        if (--m_prefetch_pending == 0) {
+            // Lock so that a prefetch_wait() can't miss the notification
+            // between checking m_prefetch_pending and going to sleep.
+            std::lock_guard<std::mutex> lock(m_prefetch_done_mutex);
+            m_prefetch_done.notify_all();
+        }
+    });
+}
+
+
+
+void
+ImageCacheImpl::prefetch_tile(const TileID& id)
+{
+    ImageCachePerThreadInfo* thread_info = get_perthread_info();
+    // Somebody may have read the tile since it was queued.
+    if (tile_in_cache(id, thread_info))
+        return;
+    ImageCacheTileRef tile = new ImageCacheTile(id);
+    if (add_tile_to_cache(tile, thread_info))
+        ++m_stat_prefetch_read;
+}
+
+
+
+void
+ImageCacheImpl::readahead(const TileID& id,
+                          ImageCachePerThreadInfo* thread_info)
+{
+    const ImageCacheFile& file(id.file());
+    int radius = file.readahead() >= 0 ? file.readahead() : m_readahead;
+    if (radius <= 0)
+        return;
+    // Don't pile on more speculative reads when the prefetch threads are
+    // already far behind.
+    if (m_prefetch_pending > 64 * std::max(m_prefetch_threads, 1))
+        return;
+    const ImageSpec& spec(file.spec(id.subimage(), id.miplevel()));
+    for (int j = -radius; j <= radius; ++j) {
+        int ty = id.y() + j * spec.tile_height;
+        if (ty < spec.y || ty >= spec.y + spec.height)
+            continue;
+        for (int i = -radius; i <= radius; ++i) {
+            int tx = id.x() + i * spec.tile_width;
+            if ((i == 0 && j == 0) || tx < spec.x
+                || tx >= spec.x + spec.width)
+                continue;
+            TileID neighbor(id);
+            neighbor.xy(tx, ty);
+            queue_prefetch(neighbor, thread_info);
+        }
+    }
+}
+
+
+
+namespace {
+
+// Each tile in the on-disk cache is a small header followed immediately
+// by the tile's pixels, exactly as they are laid out in memory. Both are
+// in native byte order; a cache written by a machine of the other
+// endianness fails the magic number test and is simply ignored.
+struct DiskCacheTileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t nbytes;  // size of the pixel data that follows
+};
+
+static const uint32_t disk_cache_magic   = 0x4f49544c;  // "OITL"
+static const uint32_t disk_cache_version = 1;
+
+}  // namespace
+
+
+
+std::string
+ImageCacheImpl::disk_cache_path(const ImageCacheFile& file, int subimage,
+                                int miplevel, int x, int y, int z,
+                                int chbegin, int chend, TypeDesc format) const
+{
+    // Only trust the fingerprint's alphanumeric characters in a filename.
+    std::string fp;
+    for (char c : file.fingerprint())
+        if (isalnum((unsigned char)c))
+            fp += c;
+    // The SHA-1 only covers the pixel values, so the tile size must be
+    // part of the key as well.
+    const ImageSpec& spec(file.spec(subimage, miplevel));
+    return Strutil::fmt::format(
+        "{}/{}/{}_s{}_m{}_t{}x{}x{}_{}_{}_{}_c{}-{}_{}.tile", m_disk_cache,
+        fp.substr(0, 2), fp, subimage, miplevel, spec.tile_width,
+        spec.tile_height, spec.tile_depth, x, y, z, chbegin, chend,
+        format.c_str());
+}
+
+
+
+bool
+ImageCacheImpl::disk_cache_read(ImageCachePerThreadInfo* thread_info,
+                                const ImageCacheFile& file, int subimage,
+                                int miplevel, int x, int y, int z, int chbegin,
+                                int chend, TypeDesc format, void* data)
+{
+    const ImageSpec& spec(file.spec(subimage, miplevel));
+    size_t nbytes = spec.tile_pixels() * size_t(chend - chbegin)
+                    * format.size();
+    Filesystem::MappedFile mapped(disk_cache_path(file, subimage, miplevel, x,
+                                                  y, z, chbegin, chend,
+                                                  format));
+    DiskCacheTileHeader header;
+    if (mapped.size() != sizeof(header) + nbytes) {
+        ++thread_info->m_stats.disk_cache_misses;
+        return false;
+    }
+    memcpy(&header, mapped.data(), sizeof(header));
+    if (header.magic != disk_cache_magic
+        || header.version != disk_cache_version || header.nbytes != nbytes) {
+        ++thread_info->m_stats.disk_cache_misses;
+        return false;
+    }
+    memcpy(data, mapped.data() + sizeof(header), nbytes);
+    ++thread_info->m_stats.disk_cache_hits;
+    return true;
+}
+
+
+
+void
+ImageCacheImpl::disk_cache_write(ImageCachePerThreadInfo* thread_info,
+                                 const ImageCacheFile& file, int subimage,
+                                 int miplevel, int x, int y, int z,
+                                 int chbegin, int chend, TypeDesc format,
+                                 const void* data)
+{
+    const ImageSpec& spec(file.spec(subimage, miplevel));
+    DiskCacheTileHeader header;
+    header.magic   = disk_cache_magic;
+    header.version = disk_cache_version;
+    header.nbytes  = spec.tile_pixels() * size_t(chend - chbegin)
+                    * format.size();
+    std::string path = disk_cache_path(file, subimage, miplevel, x, y, z,
+                                       chbegin, chend, format);
+    std::string dir  = Filesystem::parent_path(path);
+    std::string err;
+    if (!Filesystem::is_directory(dir))
+        Filesystem::create_directory(dir, err);
+
+    // Write to a temporary file and rename it into place, so that other
+    // threads or processes sharing the cache never map a partial tile.
+    // Failures are not errors -- the tile just won't be cached.
+    std::string tmp = Strutil::fmt::format("{}/{}.tmp", dir,
+                                           Filesystem::unique_path());
+    FILE* f = Filesystem::fopen(tmp, "wb");
+    if (!f)
+        return;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+              && fwrite(data, header.nbytes, 1, f) == 1;
+    ok &= (fclose(f) == 0);
+    if (ok && Filesystem::rename(tmp, path, err))
+        ++thread_info->m_stats.disk_cache_writes;
+    else
+        Filesystem::remove(tmp, err);
+}
+
+
+
 void
 ImageCacheImpl::invalidate(ustring filename, bool force)
 {
+    // Don't let a prefetch in flight re-add stale tiles behind our back.
+    prefetch_wait();
+
     ImageCacheFileRef file;
     {
         bool found = m_files.retrieve(filename, file);
@@ -3288,6 +3851,8 @@ ImageCacheImpl::invalidate(ustring filename, bool force)
 void
 ImageCacheImpl::invalidate_all(bool force)
 {
+    prefetch_wait();
+
     // Special case: invalidate EVERYTHING -- we can take some shortcuts
     // to do it all in one shot.
     if (force) {
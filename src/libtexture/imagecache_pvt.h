@@ -10,6 +10,8 @@
 #ifndef OPENIMAGEIO_IMAGECACHE_PVT_H
 #define OPENIMAGEIO_IMAGECACHE_PVT_H
 
+#include <condition_variable>
+
 #include <tsl/robin_map.h>
 
 #include <boost/container/flat_map.hpp>
@@ -20,6 +22,7 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/refcnt.h>
 #include <OpenImageIO/texture.h>
+#include <OpenImageIO/thread.h>
 #include <OpenImageIO/timer.h>
 #include <OpenImageIO/unordered_map_concurrent.h>
 
@@ -59,19 +62,75 @@ typedef unordered_map<uint64_t, ImageCacheFile*> UdimLookupMap;
 
 
 
+/// A statistic that only one thread ever updates (the thread owning the
+/// per-thread info it lives in), but that any thread may read.  Relaxed
+/// atomic loads and stores compile to plain moves, so updating one costs
+/// no more than updating an ordinary variable, yet a concurrent snapshot
+/// never sees a torn value.
+template<typename T> class StatCounter {
+public:
+    StatCounter(T val = T(0)) noexcept
+        : m_val(val)
+    {
+    }
+    StatCounter(const StatCounter& other) noexcept
+        : m_val(other.load())
+    {
+    }
+    StatCounter& operator=(const StatCounter& other) noexcept
+    {
+        store(other.load());
+        return *this;
+    }
+    StatCounter& operator=(T val) noexcept
+    {
+        store(val);
+        return *this;
+    }
+    operator T() const noexcept { return load(); }
+    T load() const noexcept { return m_val.load(std::memory_order_relaxed); }
+    void store(T val) noexcept { m_val.store(val, std::memory_order_relaxed); }
+    StatCounter& operator+=(T incr) noexcept
+    {
+        store(load() + incr);
+        return *this;
+    }
+    StatCounter& operator-=(T decr) noexcept
+    {
+        store(load() - decr);
+        return *this;
+    }
+    StatCounter& operator++() noexcept { return *this += T(1); }
+    T operator++(int) noexcept
+    {
+        T old = load();
+        store(old + T(1));
+        return old;
+    }
+
+private:
+    std::atomic<T> m_val;
+};
+
+
+
 /// Structure to hold IC and TS statistics.  We combine into a single
 /// structure to minimize the number of costly thread_specific_ptr
 /// retrievals.  If somebody is using the ImageCache without a
 /// TextureSystem, a few extra stats come along for the ride, but this
-/// has no performance penalty.
+/// has no performance penalty.  Each thread's copy is only updated by
+/// that thread, but may be read at any time by get_stats() or getstats().
 struct ImageCacheStatistics {
     // First, the ImageCache-specific fields:
-    long long find_tile_calls;
-    long long find_tile_microcache_misses;
-    int find_tile_cache_misses;
-    long long files_totalsize;
-    long long files_totalsize_ondisk;
-    long long bytes_read;
+    StatCounter<long long> find_tile_calls;
+    StatCounter<long long> find_tile_microcache_misses;
+    StatCounter<int> find_tile_cache_misses;
+    StatCounter<long long> files_totalsize;
+    StatCounter<long long> files_totalsize_ondisk;
+    StatCounter<long long> bytes_read;
+    StatCounter<long long> disk_cache_hits;
+    StatCounter<long long> disk_cache_misses;
+    StatCounter<long long> disk_cache_writes;
     // These stats are hard to deal with on a per-thread basis, so for
     // now, they are still atomics shared by the whole IC.
     // int tiles_created;
@@ -80,32 +139,32 @@ struct ImageCacheStatistics {
     // int open_files_created;
     // int open_files_current;
     // int open_files_peak;
-    int unique_files;
-    double fileio_time;
-    double fileopen_time;
-    double file_locking_time;
-    double tile_locking_time;
-    double find_file_time;
-    double find_tile_time;
+    StatCounter<int> unique_files;
+    StatCounter<double> fileio_time;
+    StatCounter<double> fileopen_time;
+    StatCounter<double> file_locking_time;
+    StatCounter<double> tile_locking_time;
+    StatCounter<double> find_file_time;
+    StatCounter<double> find_tile_time;
 
     // TextureSystem-specific fields below:
-    long long texture_queries;
-    long long texture_batches;
-    long long texture3d_queries;
-    long long texture3d_batches;
-    long long shadow_queries;
-    long long shadow_batches;
-    long long environment_queries;
-    long long environment_batches;
-    long long imageinfo_queries;
-    long long aniso_queries;
-    long long aniso_probes;
-    float max_aniso;
-    long long closest_interps;
-    long long bilinear_interps;
-    long long cubic_interps;
-    int file_retry_success;
-    int tile_retry_success;
+    StatCounter<long long> texture_queries;
+    StatCounter<long long> texture_batches;
+    StatCounter<long long> texture3d_queries;
+    StatCounter<long long> texture3d_batches;
+    StatCounter<long long> shadow_queries;
+    StatCounter<long long> shadow_batches;
+    StatCounter<long long> environment_queries;
+    StatCounter<long long> environment_batches;
+    StatCounter<long long> imageinfo_queries;
+    StatCounter<long long> aniso_queries;
+    StatCounter<long long> aniso_probes;
+    StatCounter<float> max_aniso;
+    StatCounter<long long> closest_interps;
+    StatCounter<long long> bilinear_interps;
+    StatCounter<long long> cubic_interps;
+    StatCounter<int> file_retry_success;
+    StatCounter<int> tile_retry_success;
 
     ImageCacheStatistics() { init(); }
     void init();
@@ -194,6 +253,9 @@ public:
     bool mipused(void) const { return m_mipused; }
     bool sample_border(void) const { return m_sample_border; }
     bool is_udim(void) const { return m_is_udim; }
+    /// Read-ahead radius (in tiles) requested for this file, or -1 to use
+    /// the ImageCache's default.
+    int readahead(void) const { return m_readahead; }
     const std::vector<size_t>& mipreadcount(void) const
     {
         return m_mipreadcount;
@@ -201,10 +263,11 @@ public:
 
     void invalidate();
 
-    size_t timesopened() const { return m_timesopened; }
-    size_t tilesread() const { return m_tilesread; }
-    imagesize_t bytesread() const { return m_bytesread; }
-    double& iotime() { return m_iotime; }
+    size_t timesopened() const { return (size_t)m_timesopened.load(); }
+    size_t tilesread() const { return (size_t)m_tilesread.load(); }
+    imagesize_t bytesread() const { return (imagesize_t)m_bytesread.load(); }
+    double iotime() const { return m_iotime.load(); }
+    void add_iotime(double t) { atomic_fetch_add(m_iotime, t); }
     size_t redundant_tiles() const { return (size_t)m_redundant_tiles.load(); }
     imagesize_t redundant_bytesread() const
     {
@@ -260,6 +323,8 @@ public:
         std::vector<float> average_color;  ///< Average color
         spin_mutex average_color_mutex;    ///< protect average_color
         std::unique_ptr<Imath::M44f> Mlocal;  ///< shadows/volumes: world-to-local
+        std::unique_ptr<Imath::M44f> Mndc;    ///< shadows: common-to-NDC
+        std::unique_ptr<Imath::M44f> Mcamera;  ///< shadows: common-to-camera
         // The scale/offset accounts for crops or overscans, converting
         // 0-1 texture space relative to the "display/full window" into
         // 0-1 relative to the "pixel window".
@@ -351,13 +416,14 @@ private:
     bool m_y_up;                  ///< latlong: is y "up"? (else z is up)
     bool m_sample_border;         ///< are edge samples exactly on the border?
     bool m_is_udim;               ///< Is tiled/UDIM?
+    int m_readahead = -1;         ///< Read-ahead radius (-1 = IC default)
     ustring m_fileformat;         ///< File format name
-    size_t m_tilesread;           ///< Tiles read from this file
-    imagesize_t m_bytesread;      ///< Bytes read from this file
+    atomic_ll m_tilesread;        ///< Tiles read from this file
+    atomic_ll m_bytesread;        ///< Bytes read from this file
     atomic_ll m_redundant_tiles;  ///< Redundant tile reads
     atomic_ll m_redundant_bytesread;     ///< Redundant bytes read
-    size_t m_timesopened;                ///< Separate times we opened this file
-    double m_iotime;                     ///< I/O time for this file
+    atomic_int m_timesopened;            ///< Separate times we opened this file
+    atomic<double> m_iotime;             ///< I/O time for this file
     double m_mutex_wait_time;            ///< Wait time for m_input_mutex
     bool m_mipused;                      ///< MIP level >0 accessed
     volatile bool m_validspec;           ///< If false, reread spec upon open
@@ -645,8 +711,12 @@ public:
     int channelsize() const { return m_channelsize; }
     int pixelsize() const { return m_pixelsize; }
 
+    /// Which bin of the TileCache holds this tile?
+    int cache_bin() const { return m_cache_bin; }
+
 private:
     TileID m_id;                       ///< ID of this tile
+    int m_cache_bin { 0 };             ///< Which TileCache bin we live in
     std::unique_ptr<char[]> m_pixels;  ///< The pixel data
     size_t m_pixels_size { 0 };        ///< How much m_pixels has allocated
     int m_channelsize { 0 };           ///< How big is each channel (bytes)
@@ -675,6 +745,29 @@ typedef unordered_map_concurrent<
     TileCache;
 
 
+/// For the purposes of enforcing the tile memory limit, the TileCache bins
+/// are partitioned into one or more contiguous groups ("sweep shards"),
+/// each with its own slice of the memory budget, its own "clock hand," and
+/// its own eviction lock, so that many threads can free memory at once
+/// without waiting on each other.
+struct TileCacheShard {
+    OIIO_CACHE_ALIGN                   // align shard to cache line
+        spin_mutex sweep_mutex;        ///< Only one sweeper per shard
+    TileID sweep_id;                   ///< Sweeper for "clock" paging
+    atomic_ll evictions { 0 };         ///< Tiles freed by sweeps
+    atomic_ll evicted_bytes { 0 };     ///< Tile memory freed by sweeps
+    atomic_ll sweeps { 0 };            ///< Times the shard was swept
+    atomic_ll sweep_contention { 0 };  ///< Sweeps skipped, lock was busy
+};
+
+
+/// Tile memory used by the tiles in one TileCache bin.
+struct TileCacheBinMem {
+    OIIO_CACHE_ALIGN  // align to cache line
+        atomic_ll mem { 0 };
+};
+
+
 /// A very small amount of per-thread data that saves us from locking
 /// the mutex quite as often.  We store things here used by both
 /// ImageCache and TextureSystem, so they don't each need a costly
@@ -797,6 +890,7 @@ public:
     bool unassociatedalpha() const { return m_unassociatedalpha; }
     bool trust_file_extensions() const { return m_trust_file_extensions; }
     int failure_retries() const { return m_failure_retries; }
+    const std::string& disk_cache() const { return m_disk_cache; }
     bool latlong_y_up_default() const { return m_latlong_y_up_default; }
     void get_commontoworld(Imath::M44f& result) const { result = m_Mc2w; }
     int max_errors_per_file() const { return m_max_errors_per_file; }
@@ -901,6 +995,12 @@ public:
         return handle && !handle->broken();
     }
 
+    /// Which bin of the tile cache will hold the tile with this id?
+    int tile_cache_bin(const TileID& id)
+    {
+        return (int)m_tilecache.bin_for(id);
+    }
+
     /// Is the tile specified by the TileID already in the cache?
     bool tile_in_cache(const TileID& id,
                        ImageCachePerThreadInfo* /*thread_info*/)
@@ -910,8 +1010,9 @@ public:
     }
 
     /// Add the tile to the cache.  This will also enforce cache memory
-    /// limits.
-    void add_tile_to_cache(ImageCacheTileRef& tile,
+    /// limits.  Return true if this call read the tile's pixels, false
+    /// if somebody else already had.
+    bool add_tile_to_cache(ImageCacheTileRef& tile,
                            ImageCachePerThreadInfo* thread_info);
 
     /// Find the tile specified by id.  If found, return true and place
@@ -961,6 +1062,12 @@ public:
                           int y, int z, int chbegin, int chend, TypeDesc format,
                           const void* buffer, stride_t xstride,
                           stride_t ystride, stride_t zstride, bool copy);
+    virtual bool prefetch(ustring filename, int subimage, int miplevel,
+                          ROI roi, int cache_chbegin, int cache_chend);
+    virtual bool prefetch(ImageHandle* file, Perthread* thread_info,
+                          int subimage, int miplevel, ROI roi,
+                          int cache_chbegin, int cache_chend);
+    virtual void prefetch_wait();
 
     /// Return the numerical subimage index for the given subimage name,
     /// as stored in the "oiio:subimagename" metadata.  Return -1 if no
@@ -970,6 +1077,7 @@ public:
     virtual bool has_error() const;
     virtual std::string geterror(bool clear = true) const;
     virtual std::string getstats(int level = 1) const;
+    virtual void get_stats(Stats& stats, bool per_file = false) const;
     virtual void reset_stats();
     virtual void invalidate(ustring filename, bool force);
     virtual void invalidate_all(bool force = false);
@@ -996,23 +1104,28 @@ public:
 
     /// Called when a new tile is created, to update all the stats.
     ///
-    void incr_tiles(size_t size)
+    void incr_tiles(size_t size, int bin)
     {
         ++m_stat_tiles_created;
         atomic_max(m_stat_tiles_peak, ++m_stat_tiles_current);
-        m_mem_used += size;
+        incr_mem(size, bin);
     }
 
     /// Called when a tile's pixel memory is allocated, but a new tile
     /// is not created.
-    void incr_mem(size_t size) { m_mem_used += size; }
+    void incr_mem(size_t size, int bin)
+    {
+        m_mem_used += size;
+        m_tile_bin_mem[bin].mem += size;
+    }
 
     /// Called when a tile is destroyed, to update all the stats.
     ///
-    void decr_tiles(size_t size)
+    void decr_tiles(size_t size, int bin)
     {
         --m_stat_tiles_current;
         m_mem_used -= size;
+        m_tile_bin_mem[bin].mem -= size;
         OIIO_DASSERT(m_mem_used >= 0);
     }
 
@@ -1058,6 +1171,21 @@ public:
 
     int max_mip_res() const noexcept { return m_max_mip_res; }
 
+    /// Try to fetch a tile of a fingerprinted file from the on-disk
+    /// second-level cache, storing its pixels in data. Return true if it
+    /// was found there, false if it must be read from the image file.
+    bool disk_cache_read(ImageCachePerThreadInfo* thread_info,
+                         const ImageCacheFile& file, int subimage,
+                         int miplevel, int x, int y, int z, int chbegin,
+                         int chend, TypeDesc format, void* data);
+
+    /// Store a tile just read from a fingerprinted file into the on-disk
+    /// second-level cache, so later sessions can skip decoding it.
+    void disk_cache_write(ImageCachePerThreadInfo* thread_info,
+                          const ImageCacheFile& file, int subimage,
+                          int miplevel, int x, int y, int z, int chbegin,
+                          int chend, TypeDesc format, const void* data);
+
 private:
     void init();
 
@@ -1067,8 +1195,42 @@ private:
     bool find_tile_main_cache(const TileID& id, ImageCacheTileRef& tile,
                               ImageCachePerThreadInfo* thread_info);
 
-    /// Enforce the max memory for tile data.
-    void check_max_mem(ImageCachePerThreadInfo* thread_info);
+    /// Return the thread pool used for prefetching, creating it if needed.
+    thread_pool* prefetch_pool();
+
+    /// Queue an asynchronous read of the tile with the given id, unless it
+    /// is already in the cache.
+    void queue_prefetch(const TileID& id, ImageCachePerThreadInfo* thread_info);
+
+    /// Read the tile into the cache on behalf of a prefetch request. This
+    /// is what runs on the prefetch threads.
+    void prefetch_tile(const TileID& id);
+
+    /// Return the path of the on-disk cache file for the given tile.
+    std::string disk_cache_path(const ImageCacheFile& file, int subimage,
+                                int miplevel, int x, int y, int z,
+                                int chbegin, int chend, TypeDesc format) const;
+
+    /// Queue prefetches of the neighbors of a tile that just missed the
+    /// cache, according to the file's read-ahead policy.
+    void readahead(const TileID& id, ImageCachePerThreadInfo* thread_info);
+
+    /// Enforce the max memory for tile data. The bin is the tile cache
+    /// bin of the tile just added, whose shard is swept first.
+    void check_max_mem(ImageCachePerThreadInfo* thread_info, int bin);
+
+    /// Tile memory currently used by the given sweep shard, when the
+    /// cache is split into nshards shards.
+    long long tile_shard_mem_used(int shard, int nshards) const;
+
+    /// Run the "clock" sweep over one shard of the tile cache, freeing
+    /// tiles until that shard uses less than `budget` bytes. If another
+    /// thread is already sweeping that shard, return immediately.
+    void sweep_tile_shard(int shard, int nshards, long long budget);
+
+    /// Set the number of tile cache sweep shards, clamped to a power of
+    /// two no larger than the number of tile cache bins.
+    void set_tile_cache_shards(int n);
 
     /// Internal statistics printing routine
     ///
@@ -1116,6 +1278,7 @@ private:
     Imath::M44f m_Mw2c;           ///< world-to-"common" matrix
     Imath::M44f m_Mc2w;           ///< common-to-world matrix
     ustring m_substitute_image;   ///< Substitute this image for all others
+    std::string m_disk_cache;     ///< Directory of the on-disk tile cache
 
     mutable FilenameMap m_files;    ///< Map file names to ImageCacheFile's
     ustring m_file_sweep_name;      ///< Sweeper for "clock" paging algorithm
@@ -1125,8 +1288,17 @@ private:
     FingerprintMap m_fingerprints;    ///< Map fingerprints to files
 
     TileCache m_tilecache;          ///< Our in-memory tile cache
-    TileID m_tile_sweep_id;         ///< Sweeper for "clock" paging algorithm
-    spin_mutex m_tile_sweep_mutex;  ///< Ensure only one in check_max_mem
+    atomic_int m_tile_cache_shards { 1 };  ///< Number of sweep shards in use
+    TileCacheShard m_tile_shards[TILE_CACHE_SHARDS];  ///< Sweep shards
+    TileCacheBinMem m_tile_bin_mem[TILE_CACHE_SHARDS];  ///< Mem per bin
+
+    int m_prefetch_threads = 2;  ///< Size of the prefetch thread pool
+    int m_readahead        = 0;  ///< Default read-ahead radius, in tiles
+    std::unique_ptr<thread_pool> m_prefetch_pool;  ///< Prefetch threads
+    spin_mutex m_prefetch_pool_mutex;              ///< Protect pool creation
+    atomic_int m_prefetch_pending { 0 };  ///< Queued or running prefetches
+    std::mutex m_prefetch_done_mutex;      ///< Guards m_prefetch_done
+    std::condition_variable m_prefetch_done;  ///< Signaled when none pending
 
     atomic_ll m_mem_used;       ///< Memory being used for tiles
     int m_statslevel;           ///< Statistics level
@@ -1146,27 +1318,8 @@ private:
     atomic_int m_stat_open_files_created;
     atomic_int m_stat_open_files_current;
     atomic_int m_stat_open_files_peak;
-
-    // Simulate an atomic double with a long long!
-    void incr_time_stat(double& stat, double incr)
-    {
-        stat += incr;
-        return;
-        OIIO_STATIC_ASSERT(sizeof(atomic_ll) == sizeof(double));
-        double oldval, newval;
-        long long* lloldval = (long long*)&oldval;
-        long long* llnewval = (long long*)&newval;
-        atomic_ll* llstat   = (atomic_ll*)&stat;
-        // Make long long and atomic_ll pointers to the doubles in question.
-        do {
-            // Grab the double bits, shove into a long long
-            *lloldval = *llstat;
-            // increment
-            newval = oldval + incr;
-            // Now try to atomically swap it, and repeat until we've
-            // done it with nobody else interfering.
-        } while (llstat->compare_exchange_strong(*llnewval, *lloldval));
-    }
+    atomic_ll m_stat_prefetch_queued { 0 };
+    atomic_ll m_stat_prefetch_read { 0 };
 };
 
 
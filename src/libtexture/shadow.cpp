@@ -0,0 +1,458 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+
+#include <cmath>
+#include <string>
+
+#include <OpenImageIO/dassert.h>
+#include <OpenImageIO/fmath.h>
+#include <OpenImageIO/imagecache.h>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/simd.h>
+#include <OpenImageIO/texture.h>
+#include <OpenImageIO/typedesc.h>
+#include <OpenImageIO/ustring.h>
+#include <OpenImageIO/varyingref.h>
+
+#include "imagecache_pvt.h"
+#include "texture_pvt.h"
+
+
+/*
+Discussion about shadow map conventions:
+
+A shadow map is a single-channel depth image, rendered from the light's
+point of view, and converted to a tiled texture by make_texture() in
+MakeShadow mode. Each texel holds the distance from the light to the
+nearest surface it saw.
+
+The light's projection comes from the file metadata. "worldtoNDC" (the
+OpenEXR convention) maps world space to 0-1 across the image with y
+pointing down; "worldtoscreen" (z files, RenderMan) maps to -1..1 with
+y pointing up, and is converted to NDC when the file is opened. The
+depth compared against the texels is z of "worldtocamera" if present,
+otherwise the projected z. If there is no projection at all, P is taken
+to already be (s, t, depth).
+
+A lookup projects P into the map, spreads options.samples taps over the
+filter footprint, and at each tap does a "percentage-closer" bilinear
+filter: the four surrounding texels are each compared against P's depth
+(less options.bias), and the 0/1 comparisons -- not the depths -- are
+interpolated. The result is the occluded fraction of the footprint.
+*/
+
+
+OIIO_NAMESPACE_BEGIN
+using namespace pvt;
+using namespace simd;
+
+namespace pvt {  // namespace pvt
+
+
+
+bool
+TextureSystemImpl::shadow_project(const ImageCacheFile::SubimageInfo& si,
+                                  const Imath::V3f& P, Imath::V3f& Pmap)
+{
+    if (!si.Mndc) {
+        Pmap = P;
+        return true;
+    }
+    const Imath::M44f& M(*si.Mndc);
+    float x = P.x * M[0][0] + P.y * M[1][0] + P.z * M[2][0] + M[3][0];
+    float y = P.x * M[0][1] + P.y * M[1][1] + P.z * M[2][1] + M[3][1];
+    float z = P.x * M[0][2] + P.y * M[1][2] + P.z * M[2][2] + M[3][2];
+    float w = P.x * M[0][3] + P.y * M[1][3] + P.z * M[2][3] + M[3][3];
+    if (!(w > 0.0f))
+        return false;
+    Pmap.x = x / w;
+    Pmap.y = y / w;
+    if (si.Mcamera) {
+        const Imath::M44f& C(*si.Mcamera);
+        Pmap.z = P.x * C[0][2] + P.y * C[1][2] + P.z * C[2][2] + C[3][2];
+    } else {
+        Pmap.z = z / w;
+    }
+    return true;
+}
+
+
+
+bool
+TextureSystemImpl::shadow_lookup(TextureFile& texturefile,
+                                 PerThreadInfo* thread_info,
+                                 TextureOpt& options, float s, float t,
+                                 float depth, float sfilt, float tfilt,
+                                 float* result)
+{
+    const auto& si(texturefile.subimageinfo(options.subimage));
+    const ImageSpec& spec(texturefile.spec(options.subimage, 0));
+    TypeDesc::BASETYPE pixeltype = texturefile.pixeltype(options.subimage);
+    size_t channelsize           = texturefile.channelsize(options.subimage);
+
+    // Account for crops or overscans, as texture() does.
+    s     = s * si.sscale + si.soffset;
+    t     = t * si.tscale + si.toffset;
+    sfilt = fabsf(sfilt * si.sscale);
+    tfilt = fabsf(tfilt * si.tscale);
+
+    // Lay the taps out on a stratified ns x nt grid over the footprint,
+    // with more of them along its longer axis. Taps closer together
+    // than a texel would just repeat the same comparisons.
+    int nsamples   = std::max(options.samples, 1);
+    float swidth_t = sfilt * spec.width, twidth_t = tfilt * spec.height;
+    int ns         = 1;
+    if (nsamples > 1) {
+        float aspect = (twidth_t > 0.0f) ? swidth_t / twidth_t : 1.0f;
+        ns = clamp(int(sqrtf(float(nsamples) * aspect) + 0.5f), 1, nsamples);
+    }
+    int nt = std::max(nsamples / ns, 1);
+    ns     = std::min(ns, 1 + int(swidth_t));
+    nt     = std::min(nt, 1 + int(twidth_t));
+
+    int tile_chbegin = 0, tile_chend = spec.nchannels;
+    if (spec.nchannels > m_max_tile_channels) {
+        // For files with many channels, narrow the range we cache
+        tile_chbegin = options.firstchannel;
+        tile_chend   = options.firstchannel + 1;
+    }
+    TileID id(texturefile, options.subimage, 0, 0, 0, 0, tile_chbegin,
+              tile_chend);
+    int startchan_in_tile = options.firstchannel - id.chbegin();
+    float biased_depth    = depth - options.bias;
+    bool firstsample      = true;
+    bool ok               = true;
+
+    // 1 if texel (x,y) is closer to the light than the biased depth.
+    // Texels outside the map never occlude.
+    auto occluded = [&](int x, int y) -> float {
+        if (x < spec.x || x >= spec.x + spec.width || y < spec.y
+            || y >= spec.y + spec.height)
+            return 0.0f;
+        int tile_s = (x - spec.x) % spec.tile_width;
+        int tile_t = (y - spec.y) % spec.tile_height;
+        id.xyz(x - tile_s, y - tile_t, spec.z);
+        if (!find_tile(id, thread_info, firstsample))
+            error("{}", m_imagecache->geterror());
+        firstsample = false;
+        TileRef& tile(thread_info->tile);
+        if (!tile || !tile->valid()) {
+            ok = false;
+            return 0.0f;
+        }
+        size_t offset = (size_t(tile_t) * spec.tile_width + tile_s)
+                            * tile->pixelsize()
+                        + startchan_in_tile * channelsize;
+        float z = texel_value(pixeltype, tile->bytedata() + offset, 0);
+        return biased_depth > z ? 1.0f : 0.0f;
+    };
+
+    float occlusion = 0.0f;
+    for (int j = 0; j < nt; ++j) {
+        float tt = t + tfilt * ((j + 0.5f) / nt - 0.5f);
+        for (int i = 0; i < ns; ++i) {
+            float ss = s + sfilt * ((i + 0.5f) / ns - 0.5f);
+            // Remap to texel coords, as st_to_texel_simd does.
+            float x, y;
+            if (texturefile.sample_border() == 0) {
+                x = ss * float(spec.width) + (spec.x - 0.5f);
+                y = tt * float(spec.height) + (spec.y - 0.5f);
+            } else {
+                x = ss * float(spec.width - 1) + float(spec.x);
+                y = tt * float(spec.height - 1) + float(spec.y);
+            }
+            int sint, tint;
+            float sfrac = floorfrac(x, &sint);
+            float tfrac = floorfrac(y, &tint);
+            occlusion += bilerp(occluded(sint, tint), occluded(sint + 1, tint),
+                                occluded(sint, tint + 1),
+                                occluded(sint + 1, tint + 1), sfrac, tfrac);
+        }
+    }
+    thread_info->m_stats.bilinear_interps += ns * nt;
+    result[0] = occlusion / float(ns * nt);
+    return ok;
+}
+
+
+
+bool
+TextureSystemImpl::shadow(ustring filename, TextureOpt& options,
+                          const Imath::V3f& P, const Imath::V3f& dPdx,
+                          const Imath::V3f& dPdy, float* result,
+                          float* dresultds, float* dresultdt)
+{
+    PerThreadInfo* thread_info = m_imagecache->get_perthread_info();
+    TextureFile* texturefile   = find_texturefile(filename, thread_info);
+    return shadow((TextureHandle*)texturefile, (Perthread*)thread_info,
+                  options, P, dPdx, dPdy, result, dresultds, dresultdt);
+}
+
+
+
+bool
+TextureSystemImpl::shadow(TextureHandle* texture_handle_,
+                          Perthread* thread_info_, TextureOpt& options,
+                          const Imath::V3f& P, const Imath::V3f& dPdx,
+                          const Imath::V3f& dPdy, float* result,
+                          float* dresultds, float* dresultdt)
+{
+    PerThreadInfo* thread_info = m_imagecache->get_perthread_info(
+        (PerThreadInfo*)thread_info_);
+    TextureFile* texturefile = verify_texturefile((TextureFile*)texture_handle_,
+                                                  thread_info);
+    ImageCacheStatistics& stats(thread_info->m_stats);
+    ++stats.shadow_batches;
+    ++stats.shadow_queries;
+
+    if (!texturefile || texturefile->broken())
+        return missing_texture(options, 1, result, dresultds, dresultdt);
+
+    if (!options.subimagename.empty()) {
+        // If subimage was specified by name, figure out its index.
+        int s = m_imagecache->subimage_from_name(texturefile,
+                                                 options.subimagename);
+        if (s < 0) {
+            error("Unknown subimage \"{}\" in texture \"{}\"",
+                  options.subimagename, texturefile->filename());
+            return missing_texture(options, 1, result, dresultds, dresultdt);
+        }
+        options.subimage = s;
+        options.subimagename.clear();
+    }
+    if (options.subimage < 0 || options.subimage >= texturefile->subimages()) {
+        error("Unknown subimage \"{}\" in texture \"{}\"", options.subimagename,
+              texturefile->filename());
+        return missing_texture(options, 1, result, dresultds, dresultdt);
+    }
+
+    // Shadows don't have meaningful derivatives.
+    result[0] = 0.0f;
+    if (dresultds)
+        dresultds[0] = 0.0f;
+    if (dresultdt)
+        dresultdt[0] = 0.0f;
+
+    const ImageSpec& spec(texturefile->spec(options.subimage, 0));
+    if (options.firstchannel >= spec.nchannels) {
+        result[0] = options.fill;
+        return true;
+    }
+
+    const auto& si(texturefile->subimageinfo(options.subimage));
+    Imath::V3f Pmap, Px, Py;
+    if (!shadow_project(si, P, Pmap))
+        return true;  // behind the light
+
+    // The filter footprint spans the projected derivatives, as texture()
+    // would for the same st derivatives.
+    float sfilt = options.sblur, tfilt = options.tblur;
+    if (shadow_project(si, P + dPdx, Px) && shadow_project(si, P + dPdy, Py)) {
+        sfilt += options.swidth
+                 * std::max(fabsf(Px.x - Pmap.x), fabsf(Py.x - Pmap.x));
+        tfilt += options.twidth
+                 * std::max(fabsf(Px.y - Pmap.y), fabsf(Py.y - Pmap.y));
+    }
+    return shadow_lookup(*texturefile, thread_info, options, Pmap.x, Pmap.y,
+                         Pmap.z, sfilt, tfilt, result);
+}
+
+
+
+bool
+TextureSystemImpl::shadow(TextureHandle* texture_handle_,
+                          Perthread* thread_info_, TextureOptBatch& options,
+                          Tex::RunMask mask, const float* P_,
+                          const float* dPdx_, const float* dPdy_,
+                          float* result, float* dresultds, float* dresultdt)
+{
+    using namespace Tex;
+    typedef FloatWide::vbool_t BoolWide;
+    PerThreadInfo* thread_info = m_imagecache->get_perthread_info(
+        (PerThreadInfo*)thread_info_);
+    TextureFile* texturefile = verify_texturefile((TextureFile*)texture_handle_,
+                                                  thread_info);
+    mask &= RunMaskOn;
+    int nlanes = 0;
+    for (RunMask m = mask; m; m &= m - 1)
+        ++nlanes;
+
+    ImageCacheStatistics& stats(thread_info->m_stats);
+    ++stats.shadow_batches;
+    stats.shadow_queries += nlanes;
+
+    TextureOpt opt;
+    opt.firstchannel = options.firstchannel;
+    opt.subimage     = options.subimage;
+    opt.subimagename = options.subimagename;
+    opt.fill         = options.fill;
+    opt.missingcolor = options.missingcolor;
+    opt.bias         = options.bias;
+    opt.samples      = options.samples;
+
+    // Shadows don't have meaningful derivatives; lanes that are behind
+    // the light or off the map stay at 0 (lit).
+    for (int i = 0; i < BatchWidth; ++i) {
+        if (mask & (RunMask(1) << i)) {
+            result[i] = 0.0f;
+            if (dresultds)
+                dresultds[i] = 0.0f;
+            if (dresultdt)
+                dresultdt[i] = 0.0f;
+        }
+    }
+
+    auto missing_batch = [&]() {
+        bool ok = true;
+        for (int i = 0; i < BatchWidth; ++i)
+            if (mask & (RunMask(1) << i))
+                ok &= missing_texture(opt, 1, result + i, nullptr, nullptr);
+        return ok;
+    };
+
+    if (!texturefile || texturefile->broken())
+        return missing_batch();
+
+    if (!opt.subimagename.empty()) {
+        // If subimage was specified by name, figure out its index.
+        int s = m_imagecache->subimage_from_name(texturefile,
+                                                 opt.subimagename);
+        if (s < 0) {
+            error("Unknown subimage \"{}\" in texture \"{}\"",
+                  opt.subimagename, texturefile->filename());
+            return missing_batch();
+        }
+        opt.subimage = s;
+        opt.subimagename.clear();
+    }
+    if (opt.subimage < 0 || opt.subimage >= texturefile->subimages()) {
+        error("Unknown subimage \"{}\" in texture \"{}\"", opt.subimagename,
+              texturefile->filename());
+        return missing_batch();
+    }
+
+    const ImageSpec& spec(texturefile->spec(opt.subimage, 0));
+    if (opt.firstchannel >= spec.nchannels) {
+        for (int i = 0; i < BatchWidth; ++i)
+            if (mask & (RunMask(1) << i))
+                result[i] = opt.fill;
+        return true;
+    }
+
+    // Project P, P+dPdx, and P+dPdy into the map for all lanes at once.
+    const auto& si(texturefile->subimageinfo(opt.subimage));
+    auto project = [&](const FloatWide* p, FloatWide* pmap) -> BoolWide {
+        if (!si.Mndc) {
+            for (int c = 0; c < 3; ++c)
+                pmap[c] = p[c];
+            return BoolWide::True();
+        }
+        const Imath::M44f& M(*si.Mndc);
+        FloatWide h[4];
+        for (int c = 0; c < 4; ++c)
+            h[c] = p[0] * M[0][c] + p[1] * M[1][c] + p[2] * M[2][c] + M[3][c];
+        BoolWide valid = (h[3] > FloatWide::Zero());
+        FloatWide invw = select(valid, FloatWide::One() / h[3],
+                                FloatWide::Zero());
+        pmap[0]        = h[0] * invw;
+        pmap[1]        = h[1] * invw;
+        if (si.Mcamera) {
+            const Imath::M44f& C(*si.Mcamera);
+            pmap[2] = p[0] * C[0][2] + p[1] * C[1][2] + p[2] * C[2][2]
+                      + C[3][2];
+        } else {
+            pmap[2] = h[2] * invw;
+        }
+        return valid;
+    };
+    FloatWide P[3], Px[3], Py[3];
+    for (int c = 0; c < 3; ++c) {
+        P[c]  = FloatWide(P_ + c * BatchWidth);
+        Px[c] = P[c] + FloatWide(dPdx_ + c * BatchWidth);
+        Py[c] = P[c] + FloatWide(dPdy_ + c * BatchWidth);
+    }
+    FloatWide Pmap[3], Pxmap[3], Pymap[3];
+    BoolWide valid  = project(P, Pmap);
+    BoolWide dvalid = project(Px, Pxmap) & project(Py, Pymap);
+
+    FloatWide sfilt = max(abs(Pxmap[0] - Pmap[0]), abs(Pymap[0] - Pmap[0]));
+    FloatWide tfilt = max(abs(Pxmap[1] - Pmap[1]), abs(Pymap[1] - Pmap[1]));
+    sfilt           = select(dvalid, sfilt * FloatWide(options.swidth),
+                             FloatWide::Zero())
+            + FloatWide(options.sblur);
+    tfilt = select(dvalid, tfilt * FloatWide(options.twidth),
+                   FloatWide::Zero())
+            + FloatWide(options.tblur);
+
+    // The PCF taps themselves go a lane at a time; consecutive lanes
+    // usually land on the same tiles and hit the per-thread microcache.
+    bool ok        = true;
+    RunMask active = mask & RunMask(valid.bitmask());
+    for (int i = 0; i < BatchWidth; ++i) {
+        if (active & (RunMask(1) << i))
+            ok &= shadow_lookup(*texturefile, thread_info, opt, Pmap[0][i],
+                                Pmap[1][i], Pmap[2][i], sfilt[i], tfilt[i],
+                                result + i);
+    }
+    return ok;
+}
+
+
+
+bool
+TextureSystemImpl::shadow(ustring filename, TextureOptBatch& options,
+                          Tex::RunMask mask, const float* P, const float* dPdx,
+                          const float* dPdy, float* result, float* dresultds,
+                          float* dresultdt)
+{
+    Perthread* thread_info        = get_perthread_info();
+    TextureHandle* texture_handle = get_texture_handle(filename, thread_info);
+    return shadow(texture_handle, thread_info, options, mask, P, dPdx, dPdy,
+                  result, dresultds, dresultdt);
+}
+
+
+
+bool
+TextureSystemImpl::shadow(ustring filename, TextureOptions& options,
+                          Runflag* runflags, int beginactive, int endactive,
+                          VaryingRef<Imath::V3f> P,
+                          VaryingRef<Imath::V3f> dPdx,
+                          VaryingRef<Imath::V3f> dPdy, float* result,
+                          float* dresultds, float* dresultdt)
+{
+    Perthread* thread_info        = get_perthread_info();
+    TextureHandle* texture_handle = get_texture_handle(filename, thread_info);
+    return shadow(texture_handle, thread_info, options, runflags, beginactive,
+                  endactive, P, dPdx, dPdy, result, dresultds, dresultdt);
+}
+
+
+
+bool
+TextureSystemImpl::shadow(TextureHandle* texture_handle, Perthread* thread_info,
+                          TextureOptions& options, Runflag* runflags,
+                          int beginactive, int endactive,
+                          VaryingRef<Imath::V3f> P,
+                          VaryingRef<Imath::V3f> dPdx,
+                          VaryingRef<Imath::V3f> dPdy, float* result,
+                          float* dresultds, float* dresultdt)
+{
+    bool ok = true;
+    for (int i = beginactive; i < endactive; ++i) {
+        if (runflags[i]) {
+            TextureOpt opt(options, i);
+            ok &= shadow(texture_handle, thread_info, opt, P[i], dPdx[i],
+                         dPdy[i], result + i, dresultds ? dresultds + i : NULL,
+                         dresultdt ? dresultdt + i : NULL);
+        }
+    }
+    return ok;
+}
+
+
+}  // end namespace pvt
+
+OIIO_NAMESPACE_END
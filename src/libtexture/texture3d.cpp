@@ -815,64 +815,394 @@ TextureSystemImpl::accum3d_sample_bilinear(
 
 
 bool
-TextureSystemImpl::texture3d(TextureHandle* texture_handle,
-                             Perthread* thread_info, TextureOptBatch& options,
-                             Tex::RunMask mask, const float* P,
-                             const float* dPdx, const float* dPdy,
-                             const float* dPdz, int nchannels, float* result,
+TextureSystemImpl::accum3d_sample_bilinear_batch(
+    const float* P, int miplevel, TextureFile& texturefile,
+    PerThreadInfo* thread_info, TextureOpt& options, int nchannels_result,
+    int actualchannels, Tex::RunMask& mask, Tex::FloatWide* accum,
+    Tex::FloatWide* daccumds, Tex::FloatWide* daccumdt,
+    Tex::FloatWide* daccumdr)
+{
+    using namespace Tex;
+    typedef FloatWide::vbool_t BoolWide;
+    const ImageSpec& spec(texturefile.spec(options.subimage, miplevel));
+    TypeDesc::BASETYPE pixeltype = texturefile.pixeltype(options.subimage);
+
+    // Texel coordinates and fractions, as in accum3d_sample_bilinear
+    FloatWide s = FloatWide(P) * float(spec.full_width)
+                  + float(spec.full_x - 0.5f);
+    FloatWide t = FloatWide(P + BatchWidth) * float(spec.full_height)
+                  + float(spec.full_y - 0.5f);
+    FloatWide r = FloatWide(P + 2 * BatchWidth) * float(spec.full_depth)
+                  + float(spec.full_z - 0.5f);
+    IntWide sint = ifloor(s), tint = ifloor(t), rint = ifloor(r);
+    FloatWide sfrac = s - FloatWide(sint);
+    FloatWide tfrac = t - FloatWide(tint);
+    FloatWide rfrac = r - FloatWide(rint);
+
+    // Find the lanes whose eight texels are all inside the image (where
+    // every wrap mode leaves them alone) and on the same tile. With a
+    // shared border the last texel wraps to the first, so stop short of
+    // it.
+    auto inside = [&](const IntWide& i, int origin, int width, int tilesize,
+                      TextureOpt::Wrap wrap) {
+        if (wrap == TextureOpt::WrapPeriodicSharedBorder)
+            --width;
+        IntWide intile = (i - IntWide(origin)) % IntWide(tilesize);
+        return (i >= IntWide(origin)) & (i + IntWide(1) < IntWide(origin + width))
+               & (intile != IntWide(tilesize - 1));
+    };
+    BoolWide simple = inside(sint, spec.x, spec.width, spec.tile_width,
+                             options.swrap)
+                      & inside(tint, spec.y, spec.height, spec.tile_height,
+                               options.twrap)
+                      & inside(rint, spec.z, spec.depth, spec.tile_depth,
+                               options.rwrap);
+    RunMask simplemask = RunMask(simple.bitmask()) & mask;
+    if (!simplemask)
+        return true;
+
+    alignas(BatchAlign) int sint_[BatchWidth], tint_[BatchWidth];
+    alignas(BatchAlign) int rint_[BatchWidth];
+    sint.store(sint_);
+    tint.store(tint_);
+    rint.store(rint_);
+
+    // Visit the lanes in tile order, so runs of lanes on the same tile
+    // find it in the per-thread microcache.
+    int lanes[BatchWidth], key[BatchWidth];
+    int nlanes = 0;
+    for (int i = 0; i < BatchWidth; ++i) {
+        if (!(simplemask & (RunMask(1) << i)))
+            continue;
+        key[i] = (((rint_[i] - spec.z) / spec.tile_depth) & 0x3ff) << 20
+                 | (((tint_[i] - spec.y) / spec.tile_height) & 0x3ff) << 10
+                 | (((sint_[i] - spec.x) / spec.tile_width) & 0x3ff);
+        int k = nlanes++;
+        for (; k > 0 && key[lanes[k - 1]] > key[i]; --k)
+            lanes[k] = lanes[k - 1];
+        lanes[k] = i;
+    }
+
+    // Gather the eight texels of every lane into SoA form:
+    // texel[corner][channel][lane], with corner = 4*r + 2*t + s.
+    alignas(BatchAlign) float texel[8][4][BatchWidth];
+    memset(texel, 0, sizeof(texel));
+    size_t channelsize = texturefile.channelsize(options.subimage);
+    size_t pixelsize   = texturefile.pixelsize(options.subimage);
+    int tile_chbegin = 0, tile_chend = spec.nchannels;
+    if (spec.nchannels > m_max_tile_channels) {
+        // For files with many channels, narrow the range we cache
+        tile_chbegin = options.firstchannel;
+        tile_chend   = options.firstchannel + actualchannels;
+    }
+    TileID id(texturefile, options.subimage, miplevel, 0, 0, 0, tile_chbegin,
+              tile_chend);
+    int startchan_in_tile = options.firstchannel - id.chbegin();
+    size_t rowbytes       = pixelsize * spec.tile_width;
+    size_t slicebytes     = rowbytes * spec.tile_height;
+    for (int l = 0; l < nlanes; ++l) {
+        int i      = lanes[l];
+        int tile_s = (sint_[i] - spec.x) % spec.tile_width;
+        int tile_t = (tint_[i] - spec.y) % spec.tile_height;
+        int tile_r = (rint_[i] - spec.z) % spec.tile_depth;
+        id.xyz(sint_[i] - tile_s, tint_[i] - tile_t, rint_[i] - tile_r);
+        bool ok = find_tile(id, thread_info, true);
+        if (!ok)
+            error("{}", m_imagecache->geterror());
+        TileRef& tile(thread_info->tile);
+        if (!tile->valid())
+            return false;
+        size_t tilepel = (tile_r * spec.tile_height + tile_t) * spec.tile_width
+                         + tile_s;
+        const unsigned char* b
+            = tile->bytedata()
+              + (spec.nchannels * tilepel + startchan_in_tile) * channelsize;
+        for (int corner = 0; corner < 8; ++corner) {
+            const unsigned char* p = b + (corner & 1) * pixelsize
+                                     + ((corner >> 1) & 1) * rowbytes
+                                     + (corner >> 2) * slicebytes;
+            for (int c = 0; c < actualchannels; ++c)
+                texel[corner][c][i] = texel_value(pixeltype, p, c);
+        }
+    }
+
+    // Interpolate all the lanes at once
+    const FloatWide zero(0.0f);
+    for (int c = 0; c < actualchannels; ++c) {
+        FloatWide v[8];
+        for (int corner = 0; corner < 8; ++corner)
+            v[corner] = FloatWide(texel[corner][c]);
+        accum[c] += select(simple,
+                           trilerp(v[0], v[1], v[2], v[3], v[4], v[5], v[6],
+                                   v[7], sfrac, tfrac, rfrac),
+                           zero);
+        if (daccumds) {
+            FloatWide ds = float(spec.full_width)
+                           * bilerp(v[1] - v[0], v[3] - v[2], v[5] - v[4],
+                                    v[7] - v[6], tfrac, rfrac);
+            FloatWide dt = float(spec.full_height)
+                           * bilerp(v[2] - v[0], v[3] - v[1], v[6] - v[4],
+                                    v[7] - v[5], sfrac, rfrac);
+            // Same neighbors as the single-point accum3d_sample_bilinear
+            FloatWide dr = float(spec.full_depth)
+                           * bilerp(v[2] - v[6], v[3] - v[7], v[1] - v[4],
+                                    v[3] - v[7], sfrac, tfrac);
+            daccumds[c] += select(simple, ds, zero);
+            daccumdt[c] += select(simple, dt, zero);
+            daccumdr[c] += select(simple, dr, zero);
+        }
+    }
+    // All eight texels are valid, so the extra channels get the full fill
+    if (nchannels_result > actualchannels && options.fill) {
+        FloatWide f = select(simple, FloatWide(options.fill), zero);
+        for (int c = actualchannels; c < nchannels_result; ++c)
+            accum[c] += f;
+    }
+
+    mask &= ~simplemask;
+    return true;
+}
+
+
+
+bool
+TextureSystemImpl::texture3d(TextureHandle* texture_handle_,
+                             Perthread* thread_info_, TextureOptBatch& options,
+                             Tex::RunMask mask, const float* P_,
+                             const float* dPdx_, const float* dPdy_,
+                             const float* dPdz_, int nchannels, float* result,
                              float* dresultds, float* dresultdt,
                              float* dresultdr)
 {
-    // (FIXME) CHEAT! Texture points individually
+    using namespace Tex;
+    PerThreadInfo* thread_info = m_imagecache->get_perthread_info(
+        (PerThreadInfo*)thread_info_);
+    TextureFile* texturefile = verify_texturefile((TextureFile*)texture_handle_,
+                                                  thread_info);
+    mask &= RunMaskOn;
+    int nlanes = 0;
+    for (int i = 0; i < BatchWidth; ++i)
+        if (mask & (RunMask(1) << i))
+            ++nlanes;
+
+    ImageCacheStatistics& stats(thread_info->m_stats);
+    ++stats.texture3d_batches;
+    stats.texture3d_queries += nlanes;
+
     TextureOpt opt;
     opt.firstchannel        = options.firstchannel;
     opt.subimage            = options.subimage;
     opt.subimagename        = options.subimagename;
     opt.swrap               = (TextureOpt::Wrap)options.swrap;
     opt.twrap               = (TextureOpt::Wrap)options.twrap;
+    opt.rwrap               = (TextureOpt::Wrap)options.rwrap;
     opt.mipmode             = (TextureOpt::MipMode)options.mipmode;
     opt.interpmode          = (TextureOpt::InterpMode)options.interpmode;
     opt.anisotropic         = options.anisotropic;
     opt.conservative_filter = options.conservative_filter;
     opt.fill                = options.fill;
     opt.missingcolor        = options.missingcolor;
-    opt.rwrap               = (TextureOpt::Wrap)options.rwrap;
 
-    bool ok          = true;
-    Tex::RunMask bit = 1;
-    for (int i = 0; i < Tex::BatchWidth; ++i, bit <<= 1) {
-        float r[4], drds[4], drdt[4], drdr[4];  // temp result
-        if (mask & bit) {
-            opt.sblur  = options.sblur[i];
-            opt.tblur  = options.tblur[i];
-            opt.rblur  = options.rblur[i];
-            opt.swidth = options.swidth[i];
-            opt.twidth = options.twidth[i];
-            opt.rwidth = options.rwidth[i];
-            Imath::V3f P_(P[i], P[i + Tex::BatchWidth],
-                          P[i + 2 * Tex::BatchWidth]);
-            Imath::V3f dPdx_(dPdx[i], dPdx[i + Tex::BatchWidth],
-                             dPdx[i + 2 * Tex::BatchWidth]);
-            Imath::V3f dPdy_(dPdy[i], dPdy[i + Tex::BatchWidth],
-                             dPdy[i + 2 * Tex::BatchWidth]);
-            Imath::V3f dPdz_(dPdz[i], dPdz[i + Tex::BatchWidth],
-                             dPdz[i + 2 * Tex::BatchWidth]);
+    // Copy one lane's nc channels, starting at channel firstc, into the
+    // [nchannels][BatchWidth] results.
+    auto scatter = [&](int lane, int firstc, int nc, const float* r,
+                       const float* drds, const float* drdt,
+                       const float* drdr) {
+        for (int c = 0; c < nc; ++c) {
+            result[(firstc + c) * BatchWidth + lane] = r[c];
             if (dresultds) {
-                ok &= texture3d(texture_handle, thread_info, opt, P_, dPdx_,
-                                dPdy_, dPdz_, nchannels, r, drds, drdt, drdr);
-                for (int c = 0; c < nchannels; ++c) {
-                    result[c * Tex::BatchWidth + i]    = r[c];
-                    dresultds[c * Tex::BatchWidth + i] = drds[c];
-                    dresultdt[c * Tex::BatchWidth + i] = drdt[c];
-                    dresultdr[c * Tex::BatchWidth + i] = drdr[c];
+                dresultds[(firstc + c) * BatchWidth + lane] = drds[c];
+                dresultdt[(firstc + c) * BatchWidth + lane] = drdt[c];
+                dresultdr[(firstc + c) * BatchWidth + lane] = drdr[c];
+            }
+        }
+    };
+
+    auto missing_batch = [&]() {
+        float* r    = OIIO_ALLOCA(float, 4 * nchannels);
+        float* drds = r + nchannels;
+        float* drdt = drds + nchannels;
+        float* drdr = drdt + nchannels;
+        bool ok     = true;
+        for (int i = 0; i < BatchWidth; ++i) {
+            if (mask & (RunMask(1) << i)) {
+                ok &= missing_texture(opt, nchannels, r, drds, drdt, drdr);
+                scatter(i, 0, nchannels, r, drds, drdt, drdr);
+            }
+        }
+        return ok;
+    };
+
+    // If the user didn't provide all the deriv pointers, zero the ones
+    // they did give and ignore them all, as texture3d_lookup_nomip does.
+    if (!(dresultds && dresultdt && dresultdr)) {
+        for (float* d : { dresultds, dresultdt, dresultdr })
+            if (d)
+                for (int c = 0; c < nchannels; ++c)
+                    for (int i = 0; i < BatchWidth; ++i)
+                        if (mask & (RunMask(1) << i))
+                            d[c * BatchWidth + i] = 0.0f;
+        dresultds = dresultdt = dresultdr = nullptr;
+    }
+
+    if (!texturefile || texturefile->broken())
+        return missing_batch();
+
+    if (!opt.subimagename.empty()) {
+        // If subimage was specified by name, figure out its index.
+        int s = m_imagecache->subimage_from_name(texturefile,
+                                                 opt.subimagename);
+        if (s < 0) {
+            error("Unknown subimage \"{}\" in texture \"{}\"",
+                  opt.subimagename, texturefile->filename());
+            return missing_batch();
+        }
+        opt.subimage = s;
+        opt.subimagename.clear();
+    }
+    if (opt.subimage < 0 || opt.subimage >= texturefile->subimages()) {
+        error("Unknown subimage \"{}\" in texture \"{}\"", opt.subimagename,
+              texturefile->filename());
+        return missing_batch();
+    }
+
+    const ImageSpec& spec(texturefile->spec(opt.subimage, 0));
+
+    // Figure out the wrap functions
+    if (opt.swrap == TextureOpt::WrapDefault)
+        opt.swrap = (TextureOpt::Wrap)texturefile->swrap();
+    if (opt.swrap == TextureOpt::WrapPeriodic && ispow2(spec.width))
+        opt.swrap = TextureOpt::WrapPeriodicPow2;
+    if (opt.twrap == TextureOpt::WrapDefault)
+        opt.twrap = (TextureOpt::Wrap)texturefile->twrap();
+    if (opt.twrap == TextureOpt::WrapPeriodic && ispow2(spec.height))
+        opt.twrap = TextureOpt::WrapPeriodicPow2;
+    if (opt.rwrap == TextureOpt::WrapDefault)
+        opt.rwrap = (TextureOpt::Wrap)texturefile->rwrap();
+    if (opt.rwrap == TextureOpt::WrapPeriodic && ispow2(spec.depth))
+        opt.rwrap = TextureOpt::WrapPeriodicPow2;
+
+    // Do the volume lookup in local space, transforming all lanes at once.
+    alignas(BatchAlign) float Plocal[3][BatchWidth];
+    const auto& si(texturefile->subimageinfo(opt.subimage));
+    if (si.Mlocal) {
+        // See if there is a world-to-local transform stored in the cache
+        // entry. If so, use it to transform the input point (as
+        // Imath::M44f::multVecMatrix does).
+        const Imath::M44f& M(*si.Mlocal);
+        FloatWide x(P_), y(P_ + BatchWidth), z(P_ + 2 * BatchWidth);
+        FloatWide w = x * M[0][3] + y * M[1][3] + z * M[2][3] + M[3][3];
+        for (int j = 0; j < 3; ++j)
+            ((x * M[0][j] + y * M[1][j] + z * M[2][j] + M[3][j]) / w)
+                .store(Plocal[j]);
+    } else if (texturefile->fileformat() == s_field3d) {
+        // Field3d is special -- it allows nonlinear or time-varying
+        // transforms procedurally, but we have to use a back door.
+        auto input                   = texturefile->open(thread_info);
+        Field3DInput_Interface* f3di = (Field3DInput_Interface*)input.get();
+        if (!f3di) {
+            error("Unable to open texture \"{}\"", texturefile->filename());
+            return false;
+        }
+        for (int i = 0; i < BatchWidth; ++i) {
+            if (mask & (RunMask(1) << i)) {
+                Imath::V3f Pw(P_[i], P_[i + BatchWidth],
+                              P_[i + 2 * BatchWidth]);
+                Imath::V3f Pl;
+                f3di->worldToLocal(Pw, Pl, opt.time);
+                for (int j = 0; j < 3; ++j)
+                    Plocal[j][i] = Pl[j];
+            }
+        }
+    } else {
+        // If no world-to-local matrix could be discerned, just use the
+        // input point directly.
+        memcpy(Plocal, P_, sizeof(Plocal));
+    }
+
+    bool ok = true;
+    // Lookups are at most 4 channels wide; do wider ones in groups.
+    for (int firstc = 0; firstc < nchannels; firstc += 4) {
+        int nc             = std::min(nchannels - firstc, 4);
+        opt.firstchannel   = options.firstchannel + firstc;
+        int actualchannels = Imath::clamp(spec.nchannels - opt.firstchannel,
+                                          0, nc);
+        bool gray = (actualchannels < nc && opt.firstchannel == 0
+                     && m_gray_to_rgb);
+
+        // First, every lane the batched trilinear gather can handle
+        RunMask remaining = mask;
+        if (opt.interpmode != TextureOpt::InterpClosest) {
+            FloatWide r[4], drds[4], drdt[4], drdr[4];
+            for (int c = 0; c < 4; ++c)
+                r[c] = drds[c] = drdt[c] = drdr[c] = FloatWide(0.0f);
+            ok &= accum3d_sample_bilinear_batch(
+                &Plocal[0][0], 0, *texturefile, thread_info, opt, nc,
+                actualchannels, remaining, r, dresultds ? drds : nullptr,
+                dresultds ? drdt : nullptr, dresultds ? drdr : nullptr);
+            RunMask done = mask & ~remaining;
+            if (gray) {
+                // Same as fill_gray_channels, for the whole batch
+                for (FloatWide* v : { r, drds, drdt, drdr }) {
+                    if (spec.nchannels == 1 && nc >= 3) {
+                        v[1] = v[0];
+                        v[2] = v[0];
+                    } else if (spec.nchannels == 2 && nc == 4
+                               && spec.alpha_channel == 1) {
+                        v[3] = v[1];
+                        v[1] = v[0];
+                        v[2] = v[0];
+                    }
                 }
-            } else {
-                ok &= texture3d(texture_handle, thread_info, opt, P_, dPdx_,
-                                dPdy_, dPdz_, nchannels, r);
-                for (int c = 0; c < nchannels; ++c) {
-                    result[c * Tex::BatchWidth + i] = r[c];
+            }
+            for (int i = 0; i < BatchWidth; ++i) {
+                if (!(done & (RunMask(1) << i)))
+                    continue;
+                float rl[4], dsl[4], dtl[4], drl[4];
+                for (int c = 0; c < nc; ++c) {
+                    rl[c]  = r[c][i];
+                    dsl[c] = drds[c][i];
+                    dtl[c] = drdt[c][i];
+                    drl[c] = drdr[c][i];
                 }
+                scatter(i, firstc, nc, rl, dsl, dtl, drl);
             }
+            int ndone = 0;
+            for (RunMask m = done; m; m &= m - 1)
+                ++ndone;
+            stats.aniso_queries += ndone;
+            stats.aniso_probes += ndone;
+            if (opt.interpmode == TextureOpt::InterpBicubic)
+                stats.cubic_interps += ndone;
+            else
+                stats.bilinear_interps += ndone;
+        }
+
+        // Then the rest, one at a time
+        for (int i = 0; i < BatchWidth; ++i) {
+            if (!(remaining & (RunMask(1) << i)))
+                continue;
+            Imath::V3f Pl(Plocal[0][i], Plocal[1][i], Plocal[2][i]);
+            Imath::V3f dPdx(dPdx_[i], dPdx_[i + BatchWidth],
+                            dPdx_[i + 2 * BatchWidth]);
+            Imath::V3f dPdy(dPdy_[i], dPdy_[i + BatchWidth],
+                            dPdy_[i + 2 * BatchWidth]);
+            Imath::V3f dPdz(dPdz_[i], dPdz_[i + BatchWidth],
+                            dPdz_[i + 2 * BatchWidth]);
+            simd::vfloat4 r, drds, drdt, drdr;
+            ok &= texture3d_lookup_nomip(*texturefile, thread_info, opt, nc,
+                                         actualchannels, Pl, dPdx, dPdy, dPdz,
+                                         (float*)&r,
+                                         dresultds ? (float*)&drds : nullptr,
+                                         dresultds ? (float*)&drdt : nullptr,
+                                         dresultds ? (float*)&drdr : nullptr);
+            if (gray)
+                fill_gray_channels(spec, nc, (float*)&r,
+                                   dresultds ? (float*)&drds : nullptr,
+                                   dresultds ? (float*)&drdt : nullptr,
+                                   dresultds ? (float*)&drdr : nullptr);
+            scatter(i, firstc, nc, (const float*)&r, (const float*)&drds,
+                    (const float*)&drdt, (const float*)&drdr);
         }
     }
     return ok;
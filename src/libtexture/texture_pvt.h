@@ -205,57 +205,35 @@ public:
                            float* result, float* dresultds = NULL,
                            float* dresultdt = NULL, float* dresultdr = NULL);
 
-    virtual bool shadow(ustring /*filename*/, TextureOpt& /*options*/,
-                        const Imath::V3f& /*P*/, const Imath::V3f& /*dPdx*/,
-                        const Imath::V3f& /*dPdy*/, float* /*result*/,
-                        float* /*dresultds*/, float* /*dresultdt*/)
-    {
-        return false;
-    }
-    virtual bool shadow(TextureHandle* /*texture_handle*/,
-                        Perthread* /*thread_info*/, TextureOpt& /*options*/,
-                        const Imath::V3f& /*P*/, const Imath::V3f& /*dPdx*/,
-                        const Imath::V3f& /*dPdy*/, float* /*result*/,
-                        float* /*dresultds*/, float* /*dresultdt*/)
-    {
-        return false;
-    }
-    virtual bool shadow(ustring /*filename*/, TextureOptBatch& /*options*/,
-                        Tex::RunMask /*mask*/, const float* /*P*/,
-                        const float* /*dPdx*/, const float* /*dPdy*/,
-                        float* /*result*/, float* /*dresultds*/,
-                        float* /*dresultdt*/)
-    {
-        return false;
-    }
-    virtual bool shadow(TextureHandle* /*texture_handle*/,
-                        Perthread* /*thread_info*/,
-                        TextureOptBatch& /*options*/, Tex::RunMask /*mask*/,
-                        const float* /*P*/, const float* /*dPdx*/,
-                        const float* /*dPdy*/, float* /*result*/,
-                        float* /*dresultds*/, float* /*dresultdt*/)
-    {
-        return false;
-    }
-    virtual bool shadow(ustring /*filename*/, TextureOptions& /*options*/,
-                        Runflag* /*runflags*/, int /*beginactive*/,
-                        int /*endactive*/, VaryingRef<Imath::V3f> /*P*/,
-                        VaryingRef<Imath::V3f> /*dPdx*/,
-                        VaryingRef<Imath::V3f> /*dPdy*/, float* /*result*/,
-                        float* /*dresultds*/, float* /*dresultdt*/)
-    {
-        return false;
-    }
-    virtual bool shadow(TextureHandle* /*texture_handle*/,
-                        Perthread* /*thread_info*/, TextureOptions& /*options*/,
-                        Runflag* /*runflags*/, int /*beginactive*/,
-                        int /*endactive*/, VaryingRef<Imath::V3f> /*P*/,
-                        VaryingRef<Imath::V3f> /*dPdx*/,
-                        VaryingRef<Imath::V3f> /*dPdy*/, float* /*result*/,
-                        float* /*dresultds*/, float* /*dresultdt*/)
-    {
-        return false;
-    }
+    virtual bool shadow(ustring filename, TextureOpt& options,
+                        const Imath::V3f& P, const Imath::V3f& dPdx,
+                        const Imath::V3f& dPdy, float* result,
+                        float* dresultds = NULL, float* dresultdt = NULL);
+    virtual bool shadow(TextureHandle* texture_handle, Perthread* thread_info,
+                        TextureOpt& options, const Imath::V3f& P,
+                        const Imath::V3f& dPdx, const Imath::V3f& dPdy,
+                        float* result, float* dresultds = NULL,
+                        float* dresultdt = NULL);
+    virtual bool shadow(ustring filename, TextureOptBatch& options,
+                        Tex::RunMask mask, const float* P, const float* dPdx,
+                        const float* dPdy, float* result,
+                        float* dresultds = NULL, float* dresultdt = NULL);
+    virtual bool shadow(TextureHandle* texture_handle, Perthread* thread_info,
+                        TextureOptBatch& options, Tex::RunMask mask,
+                        const float* P, const float* dPdx, const float* dPdy,
+                        float* result, float* dresultds = NULL,
+                        float* dresultdt = NULL);
+    virtual bool shadow(ustring filename, TextureOptions& options,
+                        Runflag* runflags, int beginactive, int endactive,
+                        VaryingRef<Imath::V3f> P, VaryingRef<Imath::V3f> dPdx,
+                        VaryingRef<Imath::V3f> dPdy, float* result,
+                        float* dresultds = NULL, float* dresultdt = NULL);
+    virtual bool shadow(TextureHandle* texture_handle, Perthread* thread_info,
+                        TextureOptions& options, Runflag* runflags,
+                        int beginactive, int endactive,
+                        VaryingRef<Imath::V3f> P, VaryingRef<Imath::V3f> dPdx,
+                        VaryingRef<Imath::V3f> dPdy, float* result,
+                        float* dresultds = NULL, float* dresultdt = NULL);
 
 
     virtual bool environment(ustring filename, TextureOpt& options,
@@ -421,6 +399,58 @@ private:
         float _dsdx, float _dtdx, float _dsdy, float _dtdy, float* result,
         float* dresultds, float* resultdt);
 
+    /// The filter footprint of one anisotropic texture lookup: everything
+    /// texture_lookup derives from the derivatives and options before it
+    /// starts sampling. Batched lookups compute these for all lanes at
+    /// once (see aniso_footprint_batch).
+    struct AnisoFootprint {
+        float smajor, tmajor;  ///< Half the sampling line (st space)
+        float majorlength, minorlength;  ///< Ellipse axes
+        float aspect, trueaspect;        ///< Clamped and true anisotropy
+        int miplevel[2];                 ///< MIP levels to blend
+        float levelweight[2];            ///< ...and their weights
+        int naturalsres, naturaltres;    ///< Res of the un-widened derivs
+    };
+
+    /// Compute the anisotropic footprint of one lookup.
+    static void aniso_footprint(TextureFile& texfile, TextureOpt& options,
+                                float dsdx, float dtdx, float dsdy,
+                                float dtdy, AnisoFootprint& fp);
+
+    /// Compute the anisotropic footprints of a batch of lookups with SIMD
+    /// math. The blur and width come from the batch options; everything
+    /// else from 'options'.
+    static void aniso_footprint_batch(TextureFile& texfile,
+                                      TextureOpt& options,
+                                      const TextureOptBatch& batchoptions,
+                                      const Tex::FloatWide& dsdx,
+                                      const Tex::FloatWide& dtdx,
+                                      const Tex::FloatWide& dsdy,
+                                      const Tex::FloatWide& dtdy,
+                                      AnisoFootprint* fp);
+
+    /// Anisotropic lookup of ONE point whose footprint has already been
+    /// computed. The batched texture() calls this once per active lane:
+    /// only the setup and the footprints are computed across the batch,
+    /// the samplers themselves still run one lane at a time.
+    bool texture_lookup_footprint(TextureFile& texfile,
+                                  PerThreadInfo* thread_info,
+                                  TextureOpt& options, int nchannels_result,
+                                  int actualchannels, float s, float t,
+                                  const AnisoFootprint& fp, float* result,
+                                  float* dresultds, float* dresultdt);
+
+    /// Batched texture lookup that simply calls the single-point texture()
+    /// once per active lane. Used when the lanes cannot share any setup,
+    /// such as UDIM textures, where each lane may resolve to a different
+    /// file.
+    bool texture_by_lane(TextureHandle* texture_handle,
+                         Perthread* thread_info, TextureOptBatch& options,
+                         Tex::RunMask mask, const float* s, const float* t,
+                         const float* dsdx, const float* dtdx,
+                         const float* dsdy, const float* dtdy, int nchannels,
+                         float* result, float* dresultds, float* dresultdt);
+
     // For the samplers, it's guaranteed that all float* inputs and outputs
     // are padded to length 'simd' and aligned to a simd*4-byte boundary
     // (for example, 4 for SSE). This means that the functions can behave AS
@@ -483,6 +513,32 @@ private:
                                  int actualchannels, float weight, float* accum,
                                  float* daccumds, float* daccumdt,
                                  float* daccumdr);
+    /// Trilinear lookup of a whole batch of local-space points P (laid
+    /// out as float[3][BatchWidth]). The lanes in 'mask' whose 2x2x2
+    /// texel neighborhood lies within one tile and needs no wrapping are
+    /// gathered and interpolated together with SIMD math, added to
+    /// accum[0..nchannels_result-1], and removed from 'mask'; the rest
+    /// are left in 'mask' for the caller to look up one at a time.
+    bool accum3d_sample_bilinear_batch(
+        const float* P, int level, TextureFile& texturefile,
+        PerThreadInfo* thread_info, TextureOpt& options, int nchannels_result,
+        int actualchannels, Tex::RunMask& mask, Tex::FloatWide* accum,
+        Tex::FloatWide* daccumds, Tex::FloatWide* daccumdt,
+        Tex::FloatWide* daccumdr);
+
+    /// Project common-space P into the shadow map described by 'si',
+    /// giving the map coordinates (s, t) and the light-space depth in
+    /// Pmap.  Return false if P is behind the light.
+    static bool shadow_project(const ImageCacheFile::SubimageInfo& si,
+                               const Imath::V3f& P, Imath::V3f& Pmap);
+
+    /// Percentage-closer filtered shadow lookup of depth 'depth' at map
+    /// position (s,t), over the footprint given by the st derivatives
+    /// (already scaled by width and padded by blur).  Stores the
+    /// fraction of the footprint that is occluded in result[0].
+    bool shadow_lookup(TextureFile& texfile, PerThreadInfo* thread_info,
+                       TextureOpt& options, float s, float t, float depth,
+                       float sfilt, float tfilt, float* result);
 
     /// Helper function to calculate the anisotropic aspect ratio from
     /// the major and minor ellipse axis lengths.  The "clamped" aspect
@@ -492,6 +548,13 @@ private:
     static float anisotropic_aspect(float& majorlength, float& minorlength,
                                     TextureOpt& options, float& trueaspect);
 
+    /// Batched anisotropic_aspect: the same computation for all the lanes
+    /// of a batch at once.
+    static Tex::FloatWide anisotropic_aspect_batch(Tex::FloatWide& majorlength,
+                                                   Tex::FloatWide& minorlength,
+                                                   TextureOpt& options,
+                                                   Tex::FloatWide& trueaspect);
+
     /// Convert texture coordinates (s,t), which range on 0-1 for the
     /// "full" image boundary, to texel coordinates (i+ifrac,j+jfrac)
     /// where (i,j) is the texel to the immediate upper left of the
@@ -613,6 +676,32 @@ TextureSystemImpl::anisotropic_aspect(float& majorlength, float& minorlength,
 
 
 
+inline Tex::FloatWide
+TextureSystemImpl::anisotropic_aspect_batch(Tex::FloatWide& majorlength,
+                                            Tex::FloatWide& minorlength,
+                                            TextureOpt& options,
+                                            Tex::FloatWide& trueaspect)
+{
+    using Tex::FloatWide;
+    FloatWide aniso(float(options.anisotropic));
+    FloatWide aspect = min(max(majorlength / minorlength, FloatWide(1.0f)),
+                           FloatWide(1.0e6f));
+    trueaspect                     = aspect;
+    FloatWide::vbool_t clampaspect = aspect > aniso;
+    aspect                         = select(clampaspect, aniso, aspect);
+    // See anisotropic_aspect for the choice between these two.
+    if (options.conservative_filter) {
+        FloatWide m = 0.5f * (majorlength + minorlength * aniso);
+        majorlength = select(clampaspect, m, majorlength);
+        minorlength = select(clampaspect, m / aniso, minorlength);
+    } else {
+        majorlength = select(clampaspect, minorlength * aniso, majorlength);
+    }
+    return aspect;
+}
+
+
+
 inline void
 TextureSystemImpl::st_to_texel(float s, float t, TextureFile& texturefile,
                                const ImageSpec& spec, int& i, int& j,
@@ -641,6 +730,24 @@ TextureSystemImpl::st_to_texel(float s, float t, TextureFile& texturefile,
 
 
 
+/// Fetch channel c of the texel at p, stored as the given pixel type
+/// (uint8, uint16, half, or float), as a float. The integer types are
+/// normalized as everywhere else in the texture system: uint8 by the same
+/// values EightBitConverter<float> tabulates, uint16 by 1/65535.
+OIIO_FORCEINLINE float
+texel_value(TypeDesc::BASETYPE pixeltype, const unsigned char* p, int c)
+{
+    switch (pixeltype) {
+    case TypeDesc::UINT8: return float(p[c]) * (1.0f / 255.0f);
+    case TypeDesc::UINT16:
+        return float(((const uint16_t*)p)[c]) * (1.0f / 65535.0f);
+    case TypeDesc::HALF: return float(((const half*)p)[c]);
+    default: return ((const float*)p)[c];
+    }
+}
+
+
+
 }  // end namespace pvt
 
 OIIO_NAMESPACE_END
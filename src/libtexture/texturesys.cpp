@@ -409,7 +409,7 @@ TextureSystemImpl::getstats(int level, bool icstats) const
         else
             out << Strutil::sprintf("  Average anisotropic probes : 0\n");
         out << Strutil::sprintf("  Max anisotropy in the wild : %.3g\n",
-                                stats.max_aniso);
+                                stats.max_aniso.load());
         if (icstats)
             out << "\n";
     }
@@ -1159,14 +1159,243 @@ TextureSystemImpl::texture(ustring filename, TextureOptBatch& options,
 
 
 bool
-TextureSystemImpl::texture(TextureHandle* texture_handle,
-                           Perthread* thread_info, TextureOptBatch& options,
-                           Tex::RunMask mask, const float* s, const float* t,
-                           const float* dsdx, const float* dtdx,
-                           const float* dsdy, const float* dtdy, int nchannels,
-                           float* result, float* dresultds, float* dresultdt)
+TextureSystemImpl::texture(TextureHandle* texture_handle_,
+                           Perthread* thread_info_, TextureOptBatch& options,
+                           Tex::RunMask mask, const float* s_, const float* t_,
+                           const float* dsdx_, const float* dtdx_,
+                           const float* dsdy_, const float* dtdy_,
+                           int nchannels, float* result, float* dresultds,
+                           float* dresultdt)
+{
+    using namespace Tex;
+    PerThreadInfo* thread_info = m_imagecache->get_perthread_info(
+        (PerThreadInfo*)thread_info_);
+    TextureFile* texturefile = (TextureFile*)texture_handle_;
+    if (texturefile->is_udim())
+        return texture_by_lane(texture_handle_, (Perthread*)thread_info,
+                               options, mask, s_, t_, dsdx_, dtdx_, dsdy_,
+                               dtdy_, nchannels, result, dresultds, dresultdt);
+
+    texturefile = verify_texturefile(texturefile, thread_info);
+
+    // Gather the active lanes
+    int lanes[BatchWidth];
+    int nlanes = 0;
+    for (int i = 0; i < BatchWidth; ++i)
+        if (mask & (RunMask(1) << i))
+            lanes[nlanes++] = i;
+
+    ImageCacheStatistics& stats(thread_info->m_stats);
+    ++stats.texture_batches;
+    stats.texture_queries += nlanes;
+
+    TextureOpt opt;
+    opt.firstchannel        = options.firstchannel;
+    opt.subimage            = options.subimage;
+    opt.subimagename        = options.subimagename;
+    opt.swrap               = (TextureOpt::Wrap)options.swrap;
+    opt.twrap               = (TextureOpt::Wrap)options.twrap;
+    opt.mipmode             = (TextureOpt::MipMode)options.mipmode;
+    opt.interpmode          = (TextureOpt::InterpMode)options.interpmode;
+    opt.anisotropic         = options.anisotropic;
+    opt.conservative_filter = options.conservative_filter;
+    opt.fill                = options.fill;
+    opt.missingcolor        = options.missingcolor;
+    // rwrap not needed for 2D texture
+
+    // Copy one lane's nc channels, starting at channel firstc, into the
+    // [nchannels][BatchWidth] results.
+    auto scatter = [&](int lane, int firstc, int nc, const float* r,
+                       const float* drds, const float* drdt) {
+        for (int c = 0; c < nc; ++c) {
+            result[(firstc + c) * BatchWidth + lane] = r[c];
+            if (dresultds) {
+                dresultds[(firstc + c) * BatchWidth + lane] = drds[c];
+                dresultdt[(firstc + c) * BatchWidth + lane] = drdt[c];
+            }
+        }
+    };
+
+    auto missing_batch = [&]() {
+        float* r    = OIIO_ALLOCA(float, 3 * nchannels);
+        float* drds = r + nchannels;
+        float* drdt = drds + nchannels;
+        bool ok     = true;
+        for (int l = 0; l < nlanes; ++l) {
+            ok &= missing_texture(opt, nchannels, r, drds, drdt);
+            scatter(lanes[l], 0, nchannels, r, drds, drdt);
+        }
+        return ok;
+    };
+
+    if (!texturefile || texturefile->broken())
+        return missing_batch();
+
+    if (!opt.subimagename.empty()) {
+        // If subimage was specified by name, figure out its index.
+        int s = m_imagecache->subimage_from_name(texturefile,
+                                                 opt.subimagename);
+        if (s < 0) {
+            error("Unknown subimage \"{}\" in texture \"{}\"",
+                  opt.subimagename, texturefile->filename());
+            return missing_batch();
+        }
+        opt.subimage = s;
+        opt.subimagename.clear();
+    }
+
+    const ImageCacheFile::SubimageInfo& subinfo(
+        texturefile->subimageinfo(opt.subimage));
+    const ImageSpec& spec(texturefile->spec(opt.subimage, 0));
+
+    // Figure out the wrap functions
+    if (opt.swrap == TextureOpt::WrapDefault)
+        opt.swrap = (TextureOpt::Wrap)texturefile->swrap();
+    if (opt.swrap == TextureOpt::WrapPeriodic && ispow2(spec.width))
+        opt.swrap = TextureOpt::WrapPeriodicPow2;
+    if (opt.twrap == TextureOpt::WrapDefault)
+        opt.twrap = (TextureOpt::Wrap)texturefile->twrap();
+    if (opt.twrap == TextureOpt::WrapPeriodic && ispow2(spec.height))
+        opt.twrap = TextureOpt::WrapPeriodicPow2;
+
+    // Lookup of constant color texture, non-black wrap -- skip all the
+    // hard stuff.
+    bool constant = (subinfo.is_constant_image
+                     && opt.swrap != TextureOpt::WrapBlack
+                     && opt.twrap != TextureOpt::WrapBlack);
+
+    // Coordinate remapping, for all lanes at once
+    FloatWide s(s_), t(t_), dsdx(dsdx_), dtdx(dtdx_), dsdy(dsdy_),
+        dtdy(dtdy_);
+    if (m_flip_t) {
+        t    = 1.0f - t;
+        dtdx = -dtdx;
+        dtdy = -dtdy;
+    }
+    if (!subinfo.full_pixel_range) {  // remap st for overscan or crop
+        s = s * subinfo.sscale + subinfo.soffset;
+        dsdx *= subinfo.sscale;
+        dsdy *= subinfo.sscale;
+        t = t * subinfo.tscale + subinfo.toffset;
+        dtdx *= subinfo.tscale;
+        dtdy *= subinfo.tscale;
+    }
+
+    // The default and anisotropic MIP modes get their whole filter
+    // footprint computed in SIMD up front; the rest go through the usual
+    // lookup functions lane by lane.
+    static const texture_lookup_prototype lookup_functions[] = {
+        // Must be in the same order as Mipmode enum
+        &TextureSystemImpl::texture_lookup,
+        &TextureSystemImpl::texture_lookup_nomip,
+        &TextureSystemImpl::texture_lookup_trilinear_mipmap,
+        &TextureSystemImpl::texture_lookup_trilinear_mipmap,
+        &TextureSystemImpl::texture_lookup
+    };
+    texture_lookup_prototype lookup = lookup_functions[(int)opt.mipmode];
+    bool aniso = (lookup == &TextureSystemImpl::texture_lookup);
+    AnisoFootprint fp[BatchWidth];
+    if (aniso && !constant)
+        aniso_footprint_batch(*texturefile, opt, options, dsdx, dtdx, dsdy,
+                              dtdy, fp);
+
+    alignas(BatchAlign) float sv[BatchWidth], tv[BatchWidth];
+    alignas(BatchAlign) float dsdxv[BatchWidth], dtdxv[BatchWidth];
+    alignas(BatchAlign) float dsdyv[BatchWidth], dtdyv[BatchWidth];
+    s.store(sv);
+    t.store(tv);
+    dsdx.store(dsdxv);
+    dtdx.store(dtdxv);
+    dsdy.store(dsdyv);
+    dtdy.store(dtdyv);
+
+    // Visit the lanes sorted by the MIP level and tile they will sample
+    // first, so that lanes landing on the same tile run back to back and
+    // find it in the per-thread microcache rather than the tile hash.
+    if (!constant && nlanes > 1) {
+        int key[BatchWidth];
+        for (int l = 0; l < nlanes; ++l) {
+            int i   = lanes[l];
+            int lev = aniso ? fp[i].miplevel[0] : subinfo.min_mip_level;
+            const ImageSpec& lspec(texturefile->spec(opt.subimage, lev));
+            int tx = ifloor(clamp(sv[i], -16.0f, 16.0f) * lspec.full_width)
+                     / std::max(lspec.tile_width, 1);
+            int ty = ifloor(clamp(tv[i], -16.0f, 16.0f) * lspec.full_height)
+                     / std::max(lspec.tile_height, 1);
+            key[i] = (lev << 24) + ((ty & 0xfff) << 12) + (tx & 0xfff);
+        }
+        for (int l = 1; l < nlanes; ++l) {
+            int i = lanes[l], k = l;
+            for (; k > 0 && key[lanes[k - 1]] > key[i]; --k)
+                lanes[k] = lanes[k - 1];
+            lanes[k] = i;
+        }
+    }
+
+    bool ok = true;
+    for (int l = 0; l < nlanes; ++l) {
+        int i      = lanes[l];
+        opt.sblur  = options.sblur[i];
+        opt.tblur  = options.tblur[i];
+        opt.swidth = options.swidth[i];
+        opt.twidth = options.twidth[i];
+        // rblur, rwidth not needed for 2D texture
+        // Lookups are at most 4 channels wide; do wider ones in groups.
+        for (int firstc = 0; firstc < nchannels; firstc += 4) {
+            int nc             = std::min(nchannels - firstc, 4);
+            opt.firstchannel   = options.firstchannel + firstc;
+            int actualchannels = Imath::clamp(spec.nchannels
+                                                  - opt.firstchannel,
+                                              0, nc);
+            vfloat4 r, drds, drdt;
+            if (constant) {
+                r = opt.fill;
+                for (int c = 0; c < actualchannels; ++c)
+                    r[c] = subinfo.average_color[c + opt.firstchannel];
+                // Derivs are always 0 from a constant texture lookup
+                drds.clear();
+                drdt.clear();
+            } else if (aniso) {
+                ok &= texture_lookup_footprint(*texturefile, thread_info, opt,
+                                               nc, actualchannels, sv[i],
+                                               tv[i], fp[i], (float*)&r,
+                                               dresultds ? (float*)&drds
+                                                         : nullptr,
+                                               dresultds ? (float*)&drdt
+                                                         : nullptr);
+            } else {
+                ok &= (this->*lookup)(*texturefile, thread_info, opt, nc,
+                                      actualchannels, sv[i], tv[i], dsdxv[i],
+                                      dtdxv[i], dsdyv[i], dtdyv[i],
+                                      (float*)&r,
+                                      dresultds ? (float*)&drds : nullptr,
+                                      dresultds ? (float*)&drdt : nullptr);
+            }
+            if (actualchannels < nc && opt.firstchannel == 0 && m_gray_to_rgb)
+                fill_gray_channels(spec, nc, (float*)&r,
+                                   dresultds ? (float*)&drds : nullptr,
+                                   dresultds ? (float*)&drdt : nullptr);
+            if (m_flip_t && !constant)
+                drdt = -drdt;
+            scatter(i, firstc, nc, (const float*)&r, (const float*)&drds,
+                    (const float*)&drdt);
+        }
+    }
+    return ok;
+}
+
+
+
+bool
+TextureSystemImpl::texture_by_lane(TextureHandle* texture_handle,
+                                   Perthread* thread_info,
+                                   TextureOptBatch& options, Tex::RunMask mask,
+                                   const float* s, const float* t,
+                                   const float* dsdx, const float* dtdx,
+                                   const float* dsdy, const float* dtdy,
+                                   int nchannels, float* result,
+                                   float* dresultds, float* dresultdt)
 {
-    // (FIXME) CHEAT! Texture points individually
     TextureOpt opt;
     opt.firstchannel        = options.firstchannel;
     opt.subimage            = options.subimage;
@@ -1592,25 +1821,14 @@ ellipse_axes(float dsdx, float dtdx, float dsdy, float dtdy, float& majorlength,
 
 
 
-// Given the aspect ratio, major axis orientation angle, and axis lengths,
-// calculate the smajor & tmajor values that give the orientation of the
-// line on which samples should be distributed.  If there are n samples,
-// they should be positioned as:
-//     p_i = 2*(i+0.5)/n - 1.0;
-//     sample_i = (s + p_i*smajor, t + p_i*tmajor)
-// If a weights ptr is supplied, it will be filled in [0..nsamples-1] with
-// normalized weights for each sample.
+// Given the aspect ratio and axis lengths, return the number of samples
+// to take along the major axis.  If a weights ptr is supplied, it will be
+// filled in [0..nsamples-1] with normalized weights for each sample.
 inline int
-compute_ellipse_sampling(float aspect, float theta, float majorlength,
-                         float minorlength, float& smajor, float& tmajor,
-                         float& invsamples, float* weights = NULL)
+ellipse_sample_weights(float aspect, float majorlength, float minorlength,
+                       float& invsamples, float* weights = NULL)
 {
-    // Compute the sin and cos of the sampling direction, given major
-    // axis angle
-    sincos(theta, &tmajor, &smajor);
     float L = 2.0f * (majorlength - minorlength);
-    smajor *= L;
-    tmajor *= L;
 #if 1
     // This is the theoretically correct number of samples.
     int nsamples = std::max(1, int(2.0f * aspect - 1.0f));
@@ -1649,64 +1867,298 @@ compute_ellipse_sampling(float aspect, float theta, float majorlength,
 
 
 
-bool
-TextureSystemImpl::texture_lookup(TextureFile& texturefile,
-                                  PerThreadInfo* thread_info,
-                                  TextureOpt& options, int nchannels_result,
-                                  int actualchannels, float s, float t,
-                                  float dsdx, float dtdx, float dsdy,
-                                  float dtdy, float* result, float* dresultds,
-                                  float* dresultdt)
+// Given the aspect ratio, major axis orientation angle, and axis lengths,
+// calculate the smajor & tmajor values that give the orientation of the
+// line on which samples should be distributed.  If there are n samples,
+// they should be positioned as:
+//     p_i = 2*(i+0.5)/n - 1.0;
+//     sample_i = (s + p_i*smajor, t + p_i*tmajor)
+// If a weights ptr is supplied, it will be filled in [0..nsamples-1] with
+// normalized weights for each sample.
+inline int
+compute_ellipse_sampling(float aspect, float theta, float majorlength,
+                         float minorlength, float& smajor, float& tmajor,
+                         float& invsamples, float* weights = NULL)
 {
-    OIIO_DASSERT((dresultds == NULL) == (dresultdt == NULL));
+    // Compute the sin and cos of the sampling direction, given major
+    // axis angle
+    sincos(theta, &tmajor, &smajor);
+    float L = 2.0f * (majorlength - minorlength);
+    smajor *= L;
+    tmajor *= L;
+    return ellipse_sample_weights(aspect, majorlength, minorlength,
+                                  invsamples, weights);
+}
+
 
+
+void
+TextureSystemImpl::aniso_footprint(TextureFile& texturefile,
+                                   TextureOpt& options, float dsdx, float dtdx,
+                                   float dsdy, float dtdy, AnisoFootprint& fp)
+{
     // Compute the natural resolution we want for the bare derivs, this
     // will be the threshold for knowing we're maxifying (and therefore
     // wanting cubic interpolation).
     float sfilt_noblur = std::max(std::max(fabsf(dsdx), fabsf(dsdy)), 1e-8f);
     float tfilt_noblur = std::max(std::max(fabsf(dtdx), fabsf(dtdy)), 1e-8f);
-    int naturalsres    = (int)(1.0f / sfilt_noblur);
-    int naturaltres    = (int)(1.0f / tfilt_noblur);
+    fp.naturalsres     = (int)(1.0f / sfilt_noblur);
+    fp.naturaltres     = (int)(1.0f / tfilt_noblur);
 
     // Scale by 'width'
     adjust_width(dsdx, dtdx, dsdy, dtdy, options.swidth, options.twidth);
 
-    // Determine the MIP-map level(s) we need: we will blend
-    //    data(miplevel[0]) * (1-levelblend) + data(miplevel[1]) * levelblend
-    float smajor, tmajor;
-    float majorlength, minorlength;
-    float theta;
-
     // Do a bit more math and get the exact ellipse axis lengths, and
     // therefore a more accurate aspect ratio as well.  Looks much MUCH
     // better, but for scenes with lots of grazing angles, it can greatly
     // increase the average anisotropy, therefore the number of bilinear
     // or bicubic texture probes, and therefore runtime!
-    ellipse_axes(dsdx, dtdx, dsdy, dtdy, majorlength, minorlength, theta);
+    float theta;
+    ellipse_axes(dsdx, dtdx, dsdy, dtdy, fp.majorlength, fp.minorlength,
+                 theta);
 
-    adjust_blur(majorlength, minorlength, theta, options.sblur, options.tblur);
+    adjust_blur(fp.majorlength, fp.minorlength, theta, options.sblur,
+                options.tblur);
+
+    fp.aspect = anisotropic_aspect(fp.majorlength, fp.minorlength, options,
+                                   fp.trueaspect);
+
+    // Determine the MIP-map level(s) we need: we will blend
+    //    data(miplevel[0]) * (1-levelblend) + data(miplevel[1]) * levelblend
+    fp.miplevel[0]    = -1;
+    fp.miplevel[1]    = -1;
+    fp.levelweight[0] = 0.0f;
+    fp.levelweight[1] = 0.0f;
+    compute_miplevels(texturefile, options, fp.majorlength, fp.minorlength,
+                      fp.aspect, fp.miplevel, fp.levelweight);
+
+    // The sampling line runs along the major axis. All the computations
+    // were done assuming full diametric axes of the ellipse, but our
+    // derivatives are pixel-to-pixel, yielding semi-major and semi-minor
+    // lengths, so we need to scale everything by 1/2.
+    sincos(theta, &fp.tmajor, &fp.smajor);
+    float L = fp.majorlength - fp.minorlength;
+    fp.smajor *= L;
+    fp.tmajor *= L;
+}
+
+
+
+void
+TextureSystemImpl::aniso_footprint_batch(TextureFile& texturefile,
+                                         TextureOpt& options,
+                                         const TextureOptBatch& batchoptions,
+                                         const Tex::FloatWide& dsdx_,
+                                         const Tex::FloatWide& dtdx_,
+                                         const Tex::FloatWide& dsdy_,
+                                         const Tex::FloatWide& dtdy_,
+                                         AnisoFootprint* fp)
+{
+    // This is aniso_footprint, lane for lane, with each step done for the
+    // whole batch at once. Branches become masked selects.
+    using Tex::FloatWide;
+    using Tex::IntWide;
+    typedef FloatWide::vbool_t BoolWide;
+    const FloatWide zero(0.0f), one(1.0f);
+    FloatWide dsdx(dsdx_), dtdx(dtdx_), dsdy(dsdy_), dtdy(dtdy_);
+
+    // Natural resolution of the bare derivs
+    FloatWide sfilt_noblur = max(max(abs(dsdx), abs(dsdy)), FloatWide(1e-8f));
+    FloatWide tfilt_noblur = max(max(abs(dtdx), abs(dtdy)), FloatWide(1e-8f));
+    IntWide naturalsres(one / sfilt_noblur);
+    IntWide naturaltres(one / tfilt_noblur);
+
+    // adjust_width: scale by 'width', then clamp degenerate derivatives
+    dsdx *= FloatWide(batchoptions.swidth);
+    dtdx *= FloatWide(batchoptions.twidth);
+    dsdy *= FloatWide(batchoptions.swidth);
+    dtdy *= FloatWide(batchoptions.twidth);
+    const float eps = 1.0e-8f, eps2 = eps * eps;
+    FloatWide dxlen2   = dsdx * dsdx + dtdx * dtdx;
+    FloatWide dylen2   = dsdy * dsdy + dtdy * dtdy;
+    BoolWide tinydx    = dxlen2 < FloatWide(eps2);
+    BoolWide tinydy    = dylen2 < FloatWide(eps2);
+    BoolWide tinyboth  = tinydx & tinydy;
+    BoolWide tinyxonly = tinydx & !tinydy;
+    BoolWide tinyyonly = tinydy & !tinydx;
+    FloatWide xscale   = eps / sqrt(max(dylen2, FloatWide(eps2)));
+    FloatWide yscale   = eps / sqrt(max(dxlen2, FloatWide(eps2)));
+    FloatWide epsw(eps);
+    FloatWide ndsdx = select(tinyboth, epsw,
+                             select(tinyxonly, dtdy * xscale, dsdx));
+    FloatWide ndtdx = select(tinyboth, zero,
+                             select(tinyxonly, -dsdy * xscale, dtdx));
+    FloatWide ndsdy = select(tinyboth, zero,
+                             select(tinyyonly, -dtdx * yscale, dsdy));
+    FloatWide ndtdy = select(tinyboth, epsw,
+                             select(tinyyonly, dsdx * yscale, dtdy));
+    dsdx = ndsdx;
+    dtdx = ndtdx;
+    dsdy = ndsdy;
+    dtdy = ndtdy;
+
+    // ellipse_axes. The scalar code needs doubles to keep the minor axis
+    // (A+C-root)/2 from cancelling away for very eccentric ellipses; here
+    // we use A'C' = AC - B^2/4 = (dsdx*dtdy - dsdy*dtdx)^2 instead, which
+    // stays accurate in float.
+    FloatWide A           = dtdx * dtdx + dtdy * dtdy;
+    FloatWide B           = -2.0f * (dsdx * dtdx + dsdy * dtdy);
+    FloatWide C           = dsdx * dsdx + dsdy * dsdy;
+    FloatWide AminusC     = A - C;
+    FloatWide root        = sqrt(AminusC * AminusC + B * B);
+    FloatWide sqrtCprime  = sqrt(0.5f * (A + C + root));
+    FloatWide det         = dsdx * dtdy - dsdy * dtdx;
+    FloatWide majorlength = min(sqrtCprime, FloatWide(1000.0f));
+    FloatWide minorlength = min(abs(det) / sqrtCprime, FloatWide(1000.0f));
+
+    // theta = atan2(B, A-C)/2 + pi/2, but all we ever need of it are its
+    // sine and cosine, which follow from the half-angle identities without
+    // any trig.
+    FloatWide cos2phi  = select(root > zero, AminusC / root, one);
+    FloatWide sintheta = sqrt(max(0.5f * (one + cos2phi), zero));
+    FloatWide costheta = sqrt(max(0.5f * (one - cos2phi), zero));
+    costheta           = select(B < zero, costheta, -costheta);
+
+    // adjust_blur (adds nothing when the blur is zero)
+    FloatWide sblur(batchoptions.sblur), tblur(batchoptions.tblur);
+    FloatWide abssin = abs(sintheta), abscos = abs(costheta);
+    majorlength += sblur * abscos + tblur * abssin;
+    minorlength += sblur * abssin + tblur * abscos;
+    BoolWide swapaxes = minorlength > majorlength;
+    FloatWide oldmajor(majorlength), oldcos(costheta);
+    majorlength = select(swapaxes, minorlength, majorlength);
+    minorlength = select(swapaxes, oldmajor, minorlength);
+    costheta    = select(swapaxes, -sintheta, costheta);  // theta += pi/2
+    sintheta    = select(swapaxes, oldcos, sintheta);
+
+    FloatWide trueaspect;
+    FloatWide aspect = anisotropic_aspect_batch(majorlength, minorlength,
+                                                options, trueaspect);
+    FloatWide aniso(float(options.anisotropic));
+
+    // compute_miplevels
+    const ImageCacheFile::SubimageInfo& subinfo(
+        texturefile.subimageinfo(options.subimage));
+    int nmiplevels    = (int)subinfo.levels.size();
+    int min_mip_level = subinfo.min_mip_level;
+    IntWide miplevel0(-1), miplevel1(-1);
+    FloatWide levelblend(zero);
+    BoolWide found(false);
+    for (int m = min_mip_level; m < nmiplevels && !all(found); ++m) {
+        float res = float(std::min(subinfo.spec(m).width,
+                                   subinfo.spec(m).height));
+        FloatWide filtwidth_ras = minorlength * res;
+        BoolWide here           = (filtwidth_ras <= one) & !found;
+        miplevel0               = select(here, IntWide(m - 1), miplevel0);
+        miplevel1               = select(here, IntWide(m), miplevel1);
+        levelblend = select(here, min(max(2.0f * filtwidth_ras - one, zero), one),
+                            levelblend);
+        found |= here;
+    }
+    // Lanes that want to blur more than the coarsest level allows
+    miplevel0  = select(found, miplevel0, IntWide(nmiplevels - 1));
+    miplevel1  = select(found, miplevel1, IntWide(nmiplevels - 1));
+    levelblend = select(found, levelblend, zero);
+    // Lanes that want more resolution than the finest level has
+    BoolWide finest = found & (miplevel0 < IntWide(min_mip_level));
+    miplevel0       = select(finest, IntWide(min_mip_level), miplevel0);
+    miplevel1       = select(finest, IntWide(min_mip_level), miplevel1);
+    levelblend      = select(finest, zero, levelblend);
+    float r         = float(std::max(subinfo.spec(0).full_width,
+                                     subinfo.spec(0).full_height));
+    BoolWide degenerate = finest & (minorlength * r < FloatWide(0.5f));
+    aspect = select(degenerate, min(max(majorlength * (2.0f * r), one), aniso),
+                    aspect);
+    if (options.mipmode == TextureOpt::MipModeOneLevel) {
+        miplevel0  = miplevel1;
+        levelblend = zero;
+    }
+
+    // Half the sampling line along the major axis (see aniso_footprint)
+    FloatWide L      = majorlength - minorlength;
+    FloatWide smajor = costheta * L;
+    FloatWide tmajor = sintheta * L;
+
+    // Transpose into the per-lane footprints
+    alignas(Tex::BatchAlign) float smajor_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) float tmajor_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) float major_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) float minor_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) float aspect_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) float trueaspect_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) float levelblend_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) int miplevel0_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) int miplevel1_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) int naturalsres_[Tex::BatchWidth];
+    alignas(Tex::BatchAlign) int naturaltres_[Tex::BatchWidth];
+    smajor.store(smajor_);
+    tmajor.store(tmajor_);
+    majorlength.store(major_);
+    minorlength.store(minor_);
+    aspect.store(aspect_);
+    trueaspect.store(trueaspect_);
+    levelblend.store(levelblend_);
+    miplevel0.store(miplevel0_);
+    miplevel1.store(miplevel1_);
+    naturalsres.store(naturalsres_);
+    naturaltres.store(naturaltres_);
+    for (int i = 0; i < Tex::BatchWidth; ++i) {
+        fp[i].smajor         = smajor_[i];
+        fp[i].tmajor         = tmajor_[i];
+        fp[i].majorlength    = major_[i];
+        fp[i].minorlength    = minor_[i];
+        fp[i].aspect         = aspect_[i];
+        fp[i].trueaspect     = trueaspect_[i];
+        fp[i].miplevel[0]    = miplevel0_[i];
+        fp[i].miplevel[1]    = miplevel1_[i];
+        fp[i].levelweight[0] = 1.0f - levelblend_[i];
+        fp[i].levelweight[1] = levelblend_[i];
+        fp[i].naturalsres    = naturalsres_[i];
+        fp[i].naturaltres    = naturaltres_[i];
+    }
+}
 
-    float aspect, trueaspect;
-    aspect = anisotropic_aspect(majorlength, minorlength, options, trueaspect);
 
-    int miplevel[2]      = { -1, -1 };
-    float levelweight[2] = { 0, 0 };
-    compute_miplevels(texturefile, options, majorlength, minorlength, aspect,
-                      miplevel, levelweight);
+
+bool
+TextureSystemImpl::texture_lookup(TextureFile& texturefile,
+                                  PerThreadInfo* thread_info,
+                                  TextureOpt& options, int nchannels_result,
+                                  int actualchannels, float s, float t,
+                                  float dsdx, float dtdx, float dsdy,
+                                  float dtdy, float* result, float* dresultds,
+                                  float* dresultdt)
+{
+    AnisoFootprint fp;
+    aniso_footprint(texturefile, options, dsdx, dtdx, dsdy, dtdy, fp);
+    return texture_lookup_footprint(texturefile, thread_info, options,
+                                    nchannels_result, actualchannels, s, t, fp,
+                                    result, dresultds, dresultdt);
+}
+
+
+
+bool
+TextureSystemImpl::texture_lookup_footprint(
+    TextureFile& texturefile, PerThreadInfo* thread_info, TextureOpt& options,
+    int nchannels_result, int actualchannels, float s, float t,
+    const AnisoFootprint& fp, float* result, float* dresultds,
+    float* dresultdt)
+{
+    OIIO_DASSERT((dresultds == NULL) == (dresultdt == NULL));
+
+    const int* miplevel      = fp.miplevel;
+    const float* levelweight = fp.levelweight;
+    float smajor = fp.smajor, tmajor = fp.tmajor;
+    int naturalsres = fp.naturalsres, naturaltres = fp.naturaltres;
 
     float* lineweight
         = OIIO_ALLOCA(float,
                       round_to_multiple_of_pow2(2 * options.anisotropic, 4));
     float invsamples;
-    int nsamples = compute_ellipse_sampling(aspect, theta, majorlength,
-                                            minorlength, smajor, tmajor,
-                                            invsamples, lineweight);
-    // All the computations were done assuming full diametric axes of
-    // the ellipse, but our derivatives are pixel-to-pixel, yielding
-    // semi-major and semi-minor lengths, so we need to scale everything
-    // by 1/2.
-    smajor *= 0.5f;
-    tmajor *= 0.5f;
+    int nsamples = ellipse_sample_weights(fp.aspect, fp.majorlength,
+                                          fp.minorlength, invsamples,
+                                          lineweight);
 
     bool ok           = true;
     int npointson     = 0;
@@ -1813,8 +2265,8 @@ TextureSystemImpl::texture_lookup(TextureFile& texturefile,
     ImageCacheStatistics& stats(thread_info->m_stats);
     stats.aniso_queries += npointson;
     stats.aniso_probes += npointson * nsamples;
-    if (trueaspect > stats.max_aniso)
-        stats.max_aniso = trueaspect;  // FIXME?
+    if (fp.trueaspect > stats.max_aniso)
+        stats.max_aniso = fp.trueaspect;  // FIXME?
     stats.closest_interps += closestprobes * nsamples;
     stats.bilinear_interps += bilinearprobes * nsamples;
     stats.cubic_interps += bicubicprobes * nsamples;
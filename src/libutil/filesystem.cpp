@@ -26,6 +26,8 @@
 #    include <io.h>
 #    include <shellapi.h>
 #else
+#    include <sys/mman.h>
+#    include <sys/stat.h>
 #    include <unistd.h>
 #endif
 
@@ -576,6 +578,73 @@ Filesystem::read_bytes(string_view path, void* buffer, size_t n, size_t pos)
 
 
 
+bool
+Filesystem::MappedFile::open(string_view filename)
+{
+    close();
+#ifdef _WIN32
+    std::wstring wpath = Strutil::utf8_to_utf16(filename);
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0,
+                                            NULL);
+        if (mapping) {
+            void* ptr = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            if (ptr) {
+                m_data   = (const unsigned char*)ptr;
+                m_size   = size_t(size.QuadPart);
+                m_handle = mapping;
+            } else {
+                CloseHandle(mapping);
+            }
+        }
+    }
+    // The mapping keeps its own reference to the file.
+    CloseHandle(file);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* ptr = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            m_data = (const unsigned char*)ptr;
+            m_size = size_t(st.st_size);
+        }
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+#endif
+    return m_data != nullptr;
+}
+
+
+
+void
+Filesystem::MappedFile::close()
+{
+    if (!m_data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle((HANDLE)m_handle);
+#else
+    munmap((void*)m_data, m_size);
+#endif
+    m_data   = nullptr;
+    m_size   = 0;
+    m_handle = nullptr;
+}
+
+
+
 std::time_t
 Filesystem::last_write_time(string_view path) noexcept
 {
@@ -1177,4 +1246,29 @@ Filesystem::IOMemReader::pread(void* buf, size_t size, int64_t offset)
 }
 
 
+
+Filesystem::IOMemMapped::IOMemMapped(string_view filename)
+    : IOMemReader(nullptr, 0)
+{
+    m_filename = filename;
+    if (m_file.open(m_filename))
+        m_buf = m_file.buffer();
+    else {
+        m_mode = Closed;
+        error(Strutil::sprintf("Could not map file \"%s\"", m_filename));
+    }
+}
+
+
+
+void
+Filesystem::IOMemMapped::close()
+{
+    m_file.close();
+    m_buf  = cspan<unsigned char>();
+    m_pos  = 0;
+    m_mode = Closed;
+}
+
+
 OIIO_NAMESPACE_END
@@ -509,6 +509,44 @@ test_mem_proxies()
 
 
 
+void
+test_mapped_file()
+{
+    std::cout << "Testing MappedFile:\n";
+    std::string contents = "Four score and seven years ago";
+    Filesystem::write_text_file("testfile_mmap", contents);
+    {
+        Filesystem::MappedFile mf("testfile_mmap");
+        OIIO_CHECK_ASSERT(mf.is_open());
+        OIIO_CHECK_EQUAL(mf.size(), contents.size());
+        OIIO_CHECK_EQUAL(string_view((const char*)mf.data(), mf.size()),
+                         contents);
+        mf.close();
+        OIIO_CHECK_ASSERT(!mf.is_open());
+        OIIO_CHECK_EQUAL(mf.size(), 0);
+    }
+    {
+        Filesystem::IOMemMapped in("testfile_mmap");
+        OIIO_CHECK_ASSERT(in.opened());
+        OIIO_CHECK_EQUAL(in.size(), contents.size());
+        char buf[5] = { 0 };
+        in.seek(5);
+        OIIO_CHECK_EQUAL(in.read(buf, 4), 4);
+        OIIO_CHECK_EQUAL(string_view(buf), "core");
+        in.close();
+        OIIO_CHECK_ASSERT(!in.opened());
+    }
+    // Empty and missing files can't be mapped
+    Filesystem::write_text_file("testfile_mmap", "");
+    OIIO_CHECK_ASSERT(!Filesystem::MappedFile("testfile_mmap").is_open());
+    OIIO_CHECK_ASSERT(!Filesystem::MappedFile("does_not_exist").is_open());
+    OIIO_CHECK_ASSERT(!Filesystem::IOMemMapped("does_not_exist").opened());
+    std::string err;
+    Filesystem::remove("testfile_mmap", err);
+}
+
+
+
 int
 main(int /*argc*/, char* /*argv*/[])
 {
@@ -518,6 +556,7 @@ main(int /*argc*/, char* /*argv*/[])
     test_frame_sequences();
     test_scan_sequences();
     test_mem_proxies();
+    test_mapped_file();
 
     return unit_test_failures;
 }
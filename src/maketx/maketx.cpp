@@ -2,12 +2,15 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <mutex>
 #include <sstream>
 
 #include <OpenImageIO/argparse.h>
@@ -20,6 +23,7 @@
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/sysutil.h>
+#include <OpenImageIO/thread.h>
 #include <OpenImageIO/timer.h>
 
 using namespace OIIO;
@@ -34,6 +38,8 @@ static std::string outputfilename;
 static bool verbose  = false;
 static bool runstats = false;
 static int nthreads  = 0;  // default: use #cores threads if available
+static int maxjobs   = 0;  // default: choose based on #cores
+static float membudget_MB = 0.0f;  // default: half of physical memory
 
 // Conversion modes.  If none are true, we just make an ordinary texture.
 static bool mipmapmode     = false;
@@ -149,6 +155,7 @@ getargs(int argc, char* argv[], ImageSpec& configspec)
     int tile[3] = { 64, 64, 1 };  // FIXME if we ever support volume MIPmaps
     std::string compression = "zip";
     bool updatemode         = false;
+    bool incremental        = false;
     bool checknan           = false;
     std::string fixnan;  // none, black, box3
     bool set_full_to_pixels        = false;
@@ -200,8 +207,14 @@ getargs(int argc, char* argv[], ImageSpec& configspec)
       .help("Output filename");
     ap.arg("--threads %d:NUMTHREADS", &nthreads)
       .help("Number of threads (default: #cores)");
+    ap.arg("--jobs %d:N", &maxjobs)
+      .help("Maximum number of input files to convert at once (default: automatic)");
+    ap.arg("--membudget %f:MB", &membudget_MB)
+      .help("Memory budget shared by files converted at once, in MB (default: half of physical memory)");
     ap.arg("-u", &updatemode)
       .help("Update mode");
+    ap.arg("--incremental", &incremental)
+      .help("Only recompute the parts of an existing texture whose pixels changed");
     ap.arg("--format %s:FILEFORMAT", &fileformatname)
       .help("Specify output file format (default: guess from extension)");
     ap.arg("--nchannels %d:N", &nchannels)
@@ -345,12 +358,6 @@ getargs(int argc, char* argv[], ImageSpec& configspec)
         exit(EXIT_FAILURE);
     }
 
-    if (filenames.size() != 1) {
-        std::cerr << "maketx ERROR: requires exactly one input filename\n";
-        exit(EXIT_FAILURE);
-    }
-
-
     //    std::cout << "Converting " << filenames[0] << " to " << outputfilename << "\n";
 
     // Figure out which data format we want for output
@@ -398,6 +405,7 @@ getargs(int argc, char* argv[], ImageSpec& configspec)
     configspec.attribute("maketx:resize", doresize);
     configspec.attribute("maketx:nomipmap", nomipmap);
     configspec.attribute("maketx:updatemode", updatemode);
+    configspec.attribute("maketx:incremental", incremental);
     configspec.attribute("maketx:constant_color_detect", constant_color_detect);
     configspec.attribute("maketx:monochrome_detect", monochrome_detect);
     configspec.attribute("maketx:opaque_detect", opaque_detect);
@@ -477,6 +485,170 @@ getargs(int argc, char* argv[], ImageSpec& configspec)
 
 
 
+// One input file to convert, as part of a batch.
+struct TextureJob {
+    std::string input;
+    std::string output;
+    imagesize_t npixels = 0;
+    imagesize_t mem     = 0;  // estimated peak memory for its conversion
+};
+
+
+
+// Expand the input filenames into a list of jobs. An input containing
+// "<UDIM>" (or "<udim>") stands for every existing file in which that
+// token is replaced by a four digit UDIM tile number, 1001 or higher.
+// With a single input, the output name is used as-is. Otherwise, it must
+// either be a directory, or contain the same token to be replaced by each
+// tile's number.
+static bool
+expand_jobs(std::vector<TextureJob>& jobs)
+{
+    jobs.clear();
+    bool multiple = filenames.size() > 1;
+    for (auto& f : filenames) {
+        size_t pos = f.find("<UDIM>");
+        if (pos == std::string::npos)
+            pos = f.find("<udim>");
+        if (pos == std::string::npos) {
+            jobs.push_back({ f, outputfilename });
+            continue;
+        }
+        multiple = true;
+        std::string pattern = f.substr(0, pos) + "%04d" + f.substr(pos + 6);
+        std::vector<int> numbers;
+        std::vector<std::string> matches;
+        Filesystem::scan_for_matching_filenames(pattern, numbers, matches);
+        size_t njobs = jobs.size();
+        for (size_t i = 0; i < matches.size(); ++i) {
+            if (numbers[i] < 1001)
+                continue;
+            std::string out = outputfilename;
+            std::string tile = Strutil::sprintf("%04d", numbers[i]);
+            out = Strutil::replace(out, "<UDIM>", tile, true);
+            out = Strutil::replace(out, "<udim>", tile, true);
+            jobs.push_back({ matches[i], out });
+        }
+        if (jobs.size() == njobs) {
+            std::cerr << "maketx ERROR: No UDIM tiles match \"" << f << "\"\n";
+            return false;
+        }
+    }
+    if (multiple && outputfilename.size()) {
+        bool isdir = Filesystem::is_directory(outputfilename);
+        for (auto& job : jobs) {
+            if (isdir) {
+                job.output = Filesystem::replace_extension(
+                    outputfilename + "/" + Filesystem::filename(job.input),
+                    ".tx");
+            } else if (job.output == outputfilename) {
+                std::cerr << "maketx ERROR: With multiple inputs, -o must "
+                             "name a directory or contain <UDIM>\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+
+// Convert a batch of textures, several at a time. Each conversion still
+// parallelizes internally using the shared default thread pool, so running
+// several at once mostly serves to overlap one file's I/O and serial
+// stages with another's computation, which matters for sets of many small
+// files such as UDIM tiles. A conversion only starts when its estimated
+// memory fits within the budget alongside those already running (or when
+// nothing else is running).
+static bool
+convert_batch(ImageBufAlgo::MakeTextureMode mode,
+              std::vector<TextureJob>& jobs, const ImageSpec& configspec)
+{
+    Timer timer;
+    ImageCache* ic = ImageCache::create();  // get the shared one
+    for (auto& job : jobs) {
+        // Float copies of the source and the top level, plus the MIP
+        // levels, add up to about three float images.
+        ImageSpec spec;
+        if (ic->get_imagespec(ustring(job.input), spec)) {
+            job.npixels = spec.image_pixels();
+            job.mem     = job.npixels * spec.nchannels * sizeof(float) * 3;
+        }
+    }
+    // Largest first, so a big one doesn't end up running alone at the end
+    std::stable_sort(jobs.begin(), jobs.end(),
+                     [](const TextureJob& a, const TextureJob& b) {
+                         return a.mem > b.mem;
+                     });
+
+    imagesize_t budget = membudget_MB > 0.0f
+                             ? imagesize_t(membudget_MB * 1024.0 * 1024.0)
+                             : imagesize_t(Sysutil::physical_memory() / 2);
+    int njobs = maxjobs > 0
+                    ? maxjobs
+                    : std::max(2, int(Sysutil::hardware_concurrency()) / 4);
+    njobs     = std::min(njobs, int(jobs.size()));
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t next          = 0;
+    imagesize_t inflight = 0;
+    imagesize_t npixels  = 0;
+    int nfailed          = 0;
+    auto worker          = [&]() {
+        for (;;) {
+            size_t j;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (next >= jobs.size())
+                    return;
+                j = next++;
+                cv.wait(lock, [&]() {
+                    return inflight == 0 || inflight + jobs[j].mem <= budget;
+                });
+                inflight += jobs[j].mem;
+            }
+            Timer jobtimer;
+            std::ostringstream log;
+            bool ok = ImageBufAlgo::make_texture(mode, jobs[j].input,
+                                                 jobs[j].output, configspec,
+                                                 &log);
+            if (!ok)
+                OIIO::geterror();  // already sent to log, don't let it linger
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                inflight -= jobs[j].mem;
+                std::cout << log.str();
+                if (ok) {
+                    npixels += jobs[j].npixels;
+                    if (verbose)
+                        std::cout << Strutil::sprintf("maketx: %s (%.2fs)\n",
+                                                      jobs[j].input,
+                                                      jobtimer());
+                } else {
+                    ++nfailed;
+                }
+            }
+            cv.notify_all();
+        }
+    };
+    thread_group threads;
+    for (int i = 0; i < njobs; ++i)
+        threads.create_thread(worker);
+    threads.join_all();
+
+    double elapsed = timer();
+    std::cout << Strutil::sprintf(
+        "maketx: %d textures (%d failed) in %s, up to %d at once: "
+        "%.1f Mpixels/s, %.2f files/s\n",
+        jobs.size(), nfailed, Strutil::timeintervalformat(elapsed, 2), njobs,
+        npixels / 1.0e6 / std::max(elapsed, 1.0e-6),
+        (jobs.size() - nfailed) / std::max(elapsed, 1.0e-6));
+    return nfailed == 0;
+}
+
+
+
 int
 main(int argc, char* argv[])
 {
@@ -511,10 +683,18 @@ main(int argc, char* argv[])
     if (bumpslopesmode)
         mode = ImageBufAlgo::MakeTxBumpWithSlopes;
 
-    bool ok = ImageBufAlgo::make_texture(mode, filenames[0], outputfilename,
-                                         configspec);
-    if (!ok)
-        std::cout << "make_texture ERROR: " << OIIO::geterror() << "\n";
+    std::vector<TextureJob> jobs;
+    if (!expand_jobs(jobs))
+        return EXIT_FAILURE;
+    bool ok;
+    if (jobs.size() == 1) {
+        ok = ImageBufAlgo::make_texture(mode, jobs[0].input, jobs[0].output,
+                                        configspec);
+        if (!ok)
+            std::cout << "make_texture ERROR: " << OIIO::geterror() << "\n";
+    } else {
+        ok = convert_batch(mode, jobs, configspec);
+    }
     if (runstats)
         std::cout << "\n" << ic->getstats();
 
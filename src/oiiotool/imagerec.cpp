@@ -3,11 +3,13 @@
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -191,11 +193,166 @@ ImageRec::ImageRec(const std::string& name, const ImageSpec& spec,
 
 
 
+ImageRec::ImageRec(const std::string& name, ImageRecRef src,
+                   cspan<ImageRecRef> others, const ImageSpec& spec,
+                   FusedKernel kernel)
+    : m_name(name)
+    , m_elaborated(false)
+    , m_pixels_modified(true)
+    , m_time(src->time())
+    , m_imagecache(src->m_imagecache)
+{
+    if (src->deferred()) {
+        m_fused_src = src->m_fused_src;
+        m_fused     = src->m_fused;
+    } else {
+        m_fused_src = src;
+    }
+    m_fused.push_back(
+        FusedStage { kernel, { others.begin(), others.end() }, spec });
+    m_subimages.resize(1);
+    m_subimages[0].m_miplevels.resize(1);
+    m_subimages[0].m_specs.push_back(spec);
+}
+
+
+
+bool
+ImageRec::evaluate_fused()
+{
+    ImageBufRef result(new ImageBuf(m_fused.back().spec));
+    if (!evaluate_fused(*result, result->roi()))
+        return false;
+    m_subimages[0].m_miplevels[0] = result;
+    m_subimages[0].m_specs[0]     = result->spec();
+    m_fused_src.reset();
+    m_fused.clear();
+    m_elaborated = true;
+    return true;
+}
+
+
+
+bool
+ImageRec::evaluate_fused(ImageBuf& dst, ROI roi)
+{
+    const ImageBuf& src((*m_fused_src)(0, 0));
+
+    // Split the region into bands of whole scanlines small enough that
+    // each stage's intermediate result for a band stays in cache, and
+    // run every stage over one band before moving on to the next.
+    const imagesize_t chunkpixels = 16384;
+    int rows = int(std::max(imagesize_t(1), chunkpixels / roi.width()));
+    std::vector<ROI> chunks;
+    for (int z = roi.zbegin; z < roi.zend; ++z)
+        for (int y = roi.ybegin; y < roi.yend; y += rows)
+            chunks.emplace_back(roi.xbegin, roi.xend, y,
+                                std::min(y + rows, roi.yend), z, z + 1, 0,
+                                roi.nchannels());
+
+    std::mutex err_mutex;
+    std::string err;
+    parallel_for(int64_t(0), int64_t(chunks.size()), [&](int64_t c) {
+        const ROI& chunk(chunks[c]);
+        bool& quiet(in_fused_kernel());
+        bool was_quiet = quiet;
+        quiet          = true;
+        // The first stage reads a float copy of just this band of the
+        // source, so every kernel sees a source no bigger than its dest.
+        ImageBuf in;
+        bool ok = ImageBufAlgo::copy(in, src, TypeFloat, chunk, 1);
+        std::string chunkerr = ok ? std::string() : in.geterror();
+        std::vector<ImageBuf*> img;
+        for (size_t s = 0; ok && s < m_fused.size(); ++s) {
+            const FusedStage& stage(m_fused[s]);
+            ImageSpec spec = stage.spec;
+            set_roi(spec, chunk);
+            ImageBuf out(spec);
+            img.clear();
+            img.push_back(&out);
+            img.push_back(&in);
+            for (auto& other : stage.others)
+                img.push_back(&(*other)(0, 0));
+            ok = stage.kernel(img);
+            if (ok)
+                in.swap(out);
+            else
+                chunkerr = out.has_error() ? out.geterror()
+                                           : "fused operation failed";
+        }
+        if (ok) {
+            ok = ImageBufAlgo::copy(dst, in, TypeUnknown, chunk, 1);
+            if (!ok)
+                chunkerr = dst.geterror();
+        }
+        if (!ok) {
+            std::lock_guard<std::mutex> lock(err_mutex);
+            if (err.empty())
+                err = chunkerr;
+        }
+        quiet = was_quiet;
+    });
+    if (err.size()) {
+        errorf("%s", err);
+        return false;
+    }
+    return true;
+}
+
+
+
+bool
+ImageRec::write_fused(ImageOutput* out, imagesize_t budget)
+{
+    const ImageSpec& spec(m_fused.back().spec);
+    const ImageSpec& outspec(out->spec());
+    ROI roi = get_roi(spec);
+
+    // Each band is a whole number of tile rows (or scanlines for a
+    // scanline file), as many as fit in the budget.
+    bool tiled     = outspec.tile_width > 0;
+    int tileheight = tiled ? std::max(outspec.tile_height, 1) : 1;
+    int zstep      = tiled ? std::max(outspec.tile_depth, 1) : 1;
+    imagesize_t rowbytes = std::max(spec.scanline_bytes() * zstep,
+                                    imagesize_t(1));
+    int rows = std::max(1, int(std::min(budget / rowbytes, imagesize_t(1 << 30))
+                               / tileheight))
+               * tileheight;
+
+    for (int z = roi.zbegin; z < roi.zend; z += zstep) {
+        for (int y = roi.ybegin; y < roi.yend; y += rows) {
+            ROI band(roi.xbegin, roi.xend, y, std::min(y + rows, roi.yend), z,
+                     std::min(z + zstep, roi.zend), 0, spec.nchannels);
+            ImageSpec bandspec = spec;
+            set_roi(bandspec, band);
+            ImageBuf buf(bandspec);
+            if (!evaluate_fused(buf, band))
+                return false;
+            bool ok = tiled ? out->write_tiles(band.xbegin, band.xend,
+                                               band.ybegin, band.yend,
+                                               band.zbegin, band.zend,
+                                               spec.format, buf.localpixels())
+                            : out->write_scanlines(band.ybegin, band.yend,
+                                                   band.zbegin, spec.format,
+                                                   buf.localpixels());
+            if (!ok) {
+                errorf("%s", out->geterror());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+
 bool
 ImageRec::read_nativespec()
 {
     if (elaborated())
         return true;
+    if (deferred())
+        return evaluate_fused();
     // If m_subimages has already been resized, we've been here before.
     if (m_subimages.size())
         return true;
@@ -239,6 +396,8 @@ ImageRec::read(ReadPolicy readpolicy, string_view channel_set)
 {
     if (elaborated())
         return true;
+    if (deferred())
+        return evaluate_fused();
     static ustring u_subimages("subimages"), u_miplevels("miplevels");
     int subimages = 0;
     ustring uname(name());
@@ -11,6 +11,7 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -30,6 +31,7 @@
 #include <OpenImageIO/simd.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/sysutil.h>
+#include <OpenImageIO/thread.h>
 #include <OpenImageIO/timer.h>
 
 #include "oiiotool.h"
@@ -39,8 +41,14 @@ using namespace OiioTool;
 using namespace ImageBufAlgo;
 
 
-static Oiiotool ot;
-static ArgParse ap;
+// Each thread gets its own oiiotool state and argument parser, so that
+// --parallel-frames can run several iterations of a frame sequence at
+// once. Outside of that, only the main thread ever touches them. Code
+// that may run on a worker pool thread (such as the kernels of a --fuse
+// chain) must not use these directly, but the Oiiotool of the frame it
+// belongs to, e.g. OiiotoolOp::oiiotool().
+static thread_local Oiiotool ot;
+static thread_local ArgParse ap;
 
 
 
@@ -53,8 +61,9 @@ static ArgParse ap;
     {                                                                 \
         if (ot.postpone_callback(ninputs, action_##name, argc, argv)) \
             return 0;                                                 \
-        OiiotoolOp op(ot, #name, argc, argv, ninputs, __VA_ARGS__);   \
-        return op();                                                  \
+        auto op = std::make_shared<OiiotoolOp>(ot, #name, argc, argv, \
+                                               ninputs, __VA_ARGS__); \
+        return (*op)();                                               \
     }
 
 // Canned setup for an op that uses one image on the stack.
@@ -88,8 +97,8 @@ static ArgParse ap;
     {                                                                 \
         if (ot.postpone_callback(ninputs, action_##name, argc, argv)) \
             return 0;                                                 \
-        opclass op(ot, #name, argc, argv);                            \
-        return op();                                                  \
+        auto op = std::make_shared<opclass>(ot, #name, argc, argv);   \
+        return (*op)();                                               \
     }
 
 
@@ -119,6 +128,8 @@ Oiiotool::clear_options()
     autopremult        = true;
     nativeread         = false;
     metamerge          = false;
+    fuse               = false;
+    stream_budget      = 0;
     cachesize          = 4096;
     autotile           = 0;  // was: 4096
     // FIXME: Turned off autotile by default Jan 2018 after thinking that
@@ -228,6 +239,15 @@ Oiiotool::read(ImageRecRef img, ReadPolicy readpolicy, string_view channel_set)
     if (img->elaborated())
         return true;
 
+    // A deferred chain of --fuse ops just needs evaluating. Its inputs
+    // were read, and accounted for, when the ops were deferred.
+    if (img->deferred()) {
+        bool ok = img->read();
+        if (!ok)
+            error("fuse", img->geterror());
+        return ok;
+    }
+
     // Cause the ImageRec to get read.  Try to compute how long it took.
     // Subtract out ImageCache time, to avoid double-accounting it later.
     float pre_ic_time, post_ic_time;
@@ -267,6 +287,8 @@ Oiiotool::read_nativespec(ImageRecRef img)
     // tile adjustments below as images are read in fresh from disk.
     if (img->elaborated())
         return true;
+    if (img->deferred())
+        return read(img);
 
     // Cause the ImageRec to get read.  Try to compute how long it took.
     // Subtract out ImageCache time, to avoid double-accounting it later.
@@ -285,6 +307,109 @@ Oiiotool::read_nativespec(ImageRecRef img)
 
 
 
+// Do a and b cover the same pixels? Unlike ROI::operator==, this ignores
+// the channel range.
+static bool
+same_window(const ROI& a, const ROI& b)
+{
+    return a.xbegin == b.xbegin && a.xend == b.xend && a.ybegin == b.ybegin
+           && a.yend == b.yend && a.zbegin == b.zbegin && a.zend == b.zend;
+}
+
+
+
+// --fuse: Return a deferred ImageRec whose pixels will be computed by
+// kernel from subimage 0 of A and of the others (which must already be
+// read and share A's pixel window), or an empty ref if the op can't be
+// deferred. The result spec comes from running the kernel once on
+// single-pixel stand-ins for the inputs, which also issues any warnings
+// now, once, rather than for every chunk.
+static ImageRecRef
+defer_pointwise(string_view name, ImageRecRef A, cspan<ImageRecRef> others,
+                ImageRec::FusedKernel kernel)
+{
+    if (ot.metamerge || !(A->elaborated() || A->deferred()) || !A->spec(0, 0)
+        || A->spec(0, 0)->deep || A->miplevels(0) != 1)
+        return {};
+    const ImageSpec& Aspec(*A->spec(0, 0));
+    ROI roi = get_roi(Aspec);
+    std::vector<ImageBuf> probes(others.size() + 2);
+    auto make_probe = [](ImageBuf& probe, const ImageSpec& spec) {
+        ImageSpec pspec = spec;
+        pspec.width = pspec.height = pspec.depth = 1;
+        probe.reset(pspec, InitializePixels::Yes);
+    };
+    make_probe(probes[1], Aspec);
+    for (size_t i = 0; i < others.size(); ++i) {
+        const ImageSpec* spec = others[i]->spec(0, 0);
+        if (!others[i]->elaborated() || !spec || spec->deep
+            || !same_window(get_roi(*spec), roi))
+            return {};
+        make_probe(probes[i + 2], *spec);
+    }
+    std::vector<ImageBuf*> img;
+    for (auto& probe : probes)
+        img.push_back(&probe);
+    if (!kernel(img)
+        || !same_window(get_roi_full(probes[0].spec()), get_roi_full(Aspec)))
+        return {};
+    ImageSpec spec = probes[0].spec();
+    set_roi(spec, roi);
+    auto R = std::make_shared<ImageRec>(name, A, others, spec, kernel);
+    R->metadata_modified(true);
+    return R;
+}
+
+
+
+bool
+OiiotoolOp::pointwise() const
+{
+    // Ops whose impl is a per-pixel IBA function of the inputs that
+    // writes into whatever destination window it is given.
+    static const char* ops[]
+        = { "add",  "sub",     "mul",  "div",  "absdiff", "addc",
+            "subc", "mulc",    "divc", "absdiffc", "powc", "abs",
+            "max",  "min",     "maxc", "minc", "premult", "unpremult",
+            "mad",  "ccmatrix", "colorconvert" };
+    if (m_new_output_imagerec_func)
+        return false;
+    for (auto op : ops)
+        if (opname() == op)
+            return true;
+    return false;
+}
+
+
+
+bool
+OiiotoolOp::defer(int subimages)
+{
+    ImageRecRef R;
+    if (subimages == 1 && subimage_includes.empty()
+        && subimage_excludes.empty()) {
+        auto self = shared_from_this();
+        std::vector<ImageRecRef> others(m_ir.begin() + 2, m_ir.end());
+        R = defer_pointwise(opname(), ir(1), others,
+                            [self](span<ImageBuf*> img) {
+                                return self->impl(img);
+                            });
+    }
+    if (!R) {
+        // Not after all. Make sure the input is there for the usual path.
+        ot.read(ir(1));
+        return false;
+    }
+    // Replace the empty result we pushed with the deferred one. R's
+    // kernel holds on to this op, so the op must not hold on to R.
+    ot.pop();
+    ot.push(R);
+    m_ir[0].reset();
+    return true;
+}
+
+
+
 void
 Oiiotool::remember_input_channelformats(ImageRecRef img)
 {
@@ -410,6 +535,8 @@ Oiiotool::error(string_view command, string_view explanation) const
 void
 Oiiotool::warning(string_view command, string_view explanation) const
 {
+    if (ImageRec::in_fused_kernel())
+        return;  // Already issued when the op was deferred
     std::cerr << "oiiotool WARNING";
     if (command.size())
         std::cerr << ": " << command;
@@ -464,6 +591,18 @@ set_cachesize(int argc, const char* argv[])
 
 
 
+// --stream
+static int
+set_stream(int argc, const char* argv[])
+{
+    OIIO_DASSERT(argc == 2);
+    ot.stream_budget = std::max(1, Strutil::stoi(argv[1]));
+    ot.fuse          = true;  // Only deferred results can be streamed
+    return 0;
+}
+
+
+
 // --autotile
 static int
 set_autotile(int argc, const char* argv[])
@@ -2100,6 +2239,12 @@ public:
         }
         return true;
     }
+    virtual bool pointwise() const override
+    {
+        // A non-strict failure falls back to a plain copy, which resizes
+        // the destination, so only strict conversions can be fused.
+        return options().get_int("strict", 1) != 0;
+    }
     virtual bool impl(span<ImageBuf*> img) override
     {
         std::string contextkey   = options()["key"];
@@ -2162,8 +2307,9 @@ OIIOTOOL_OP(ccmatrix, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     } else if (M.size() == 16) {
         memcpy((float*)&MM, M.data(), 16 * sizeof(float));
     } else {
-        ot.error(op.opname(),
-                 "expected 9 or 16 comma-separated floats to form a matrix");
+        op.oiiotool().error(
+            op.opname(),
+            "expected 9 or 16 comma-separated floats to form a matrix");
         return false;
     }
     if (op.options().get_int("transpose"))
@@ -2192,7 +2338,7 @@ OIIOTOOL_OP(ociolook, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
                                                       "Linear");
     return ImageBufAlgo::ociolook(*img[0], *img[1], lookname, fromspace,
                                   tospace, unpremult, inverse, contextkey,
-                                  contextvalue, &ot.colorconfig);
+                                  contextvalue, &op.oiiotool().colorconfig);
 });
 
 
@@ -2211,7 +2357,8 @@ OIIOTOOL_OP(ociodisplay, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
                                                         "Linear");
     return ImageBufAlgo::ociodisplay(*img[0], *img[1], displayname, viewname,
                                      fromspace, looks, unpremult, contextkey,
-                                     contextvalue, &ot.colorconfig);
+                                     contextvalue,
+                                     &op.oiiotool().colorconfig);
 });
 
 
@@ -2222,7 +2369,8 @@ OIIOTOOL_OP(ociofiletransform, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     bool inverse     = op.options().get_int("inverse");
     bool unpremult   = op.options().get_int("unpremult");
     return ImageBufAlgo::ociofiletransform(*img[0], *img[1], name, unpremult,
-                                           inverse, &ot.colorconfig);
+                                           inverse,
+                                           &op.oiiotool().colorconfig);
 });
 
 
@@ -2429,8 +2577,10 @@ action_channels(int argc, const char* argv[])
     auto options      = ot.extract_options(command);
     bool allsubimages = options.get_int("allsubimages", ot.allsubimages);
 
+    bool fuse = ot.fuse && !allsubimages;
     ImageRecRef A(ot.pop());
-    ot.read(A);
+    if (!(fuse && A->deferred()))
+        ot.read(A);
 
     if (chanlist == "RGB")  // Fix common synonyms/mistakes
         chanlist = "R,G,B";
@@ -2465,6 +2615,27 @@ action_channels(int argc, const char* argv[])
         }
     }
 
+    if (fuse) {
+        // Try to make the shuffle one more stage of a deferred chain.
+        std::vector<std::string> newchannelnames;
+        std::vector<int> channels;
+        std::vector<float> values;
+        decode_channel_set(*A->spec(0, 0), chanlist, newchannelnames, channels,
+                           values);
+        ImageRecRef R = defer_pointwise(
+            command, A, {}, [=](span<ImageBuf*> img) {
+                return ImageBufAlgo::channels(*img[0], *img[1],
+                                              (int)channels.size(), channels,
+                                              values, newchannelnames, false);
+            });
+        if (R) {
+            ot.push(R);
+            ot.function_times[command] += timer();
+            return 0;
+        }
+        ot.read(A);
+    }
+
     // Create the replacement ImageRec
     ImageRecRef R(new ImageRec(A->name(), (int)allmiplevels.size(),
                                allmiplevels, allspecs));
@@ -2521,10 +2692,10 @@ action_chappend(int argc, const char* argv[])
             // Shuffle the indexed/named channels
             bool ok = ImageBufAlgo::channel_append(*img[0], *img[1], *img[2]);
             if (!ok) {
-                ot.error(op.opname(), img[0]->geterror());
+                op.oiiotool().error(op.opname(), img[0]->geterror());
                 return false;
             }
-            if (ot.metamerge) {
+            if (op.oiiotool().metamerge) {
                 img[0]->specmod().extra_attribs.merge(
                     img[1]->spec().extra_attribs);
                 img[0]->specmod().extra_attribs.merge(
@@ -2770,7 +2941,8 @@ action_colorcount(cspan<const char*> argv)
                                         &colorvalues[0], &eps[0]);
     if (ok) {
         for (int col = 0; col < ncolors; ++col)
-            Strutil::printf("%8d  %s\n", count[col], colorstrings[col]);
+            Strutil::fprintf(std::cout, "%8d  %s\n", count[col],
+                             colorstrings[col]);
     } else {
         ot.error(command, (*ot.curimg)(0, 0).geterror());
     }
@@ -2805,9 +2977,9 @@ action_rangecheck(cspan<const char*> argv)
                                               &highcount, &inrangecount,
                                               &low[0], &high[0]);
     if (ok) {
-        Strutil::printf("%8d  < %s\n", lowcount, lowarg);
-        Strutil::printf("%8d  > %s\n", highcount, higharg);
-        Strutil::printf("%8d  within range\n", inrangecount);
+        Strutil::fprintf(std::cout, "%8d  < %s\n", lowcount, lowarg);
+        Strutil::fprintf(std::cout, "%8d  > %s\n", highcount, higharg);
+        Strutil::fprintf(std::cout, "%8d  within range\n", inrangecount);
     } else {
         ot.error(command, (*ot.curimg)(0, 0).geterror());
     }
@@ -2883,7 +3055,7 @@ UNARY_IMAGE_OP(premult, ImageBufAlgo::premult);  // --premult
 OIIOTOOL_OP(unpremult, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     if (img[1]->spec().get_int_attribute("oiio:UnassociatedAlpha")
         && img[1]->spec().alpha_channel >= 0) {
-        ot.warning(
+        op.oiiotool().warning(
             op.opname(),
             "Image appears to already be unassociated alpha (un-premultiplied color), beware double unpremult.");
     }
@@ -2923,7 +3095,7 @@ OIIOTOOL_OP(noise, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
         A = op.options().get_float("value", 0.0f);
         B = op.options().get_float("portion", 0.01f);
     } else {
-        ot.errorf(op.opname(), "Unknown noise type \"%s\"", type);
+        op.oiiotool().errorf(op.opname(), "Unknown noise type \"%s\"", type);
         return false;
     }
     bool mono     = op.options().get_int("mono");
@@ -3046,8 +3218,9 @@ OIIOTOOL_OP(warp, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     bool recompute_roi     = op.options().get_int("recompute_roi");
     std::vector<float> M(9);
     if (Strutil::extract_from_list_string(M, op.args(1)) != 9) {
-        ot.error(op.opname(),
-                 "expected 9 comma-separatd floats to form a 3x3 matrix");
+        op.oiiotool().error(
+            op.opname(),
+            "expected 9 comma-separatd floats to form a 3x3 matrix");
         return false;
     }
     return ImageBufAlgo::warp(*img[0], *img[1], *(Imath::M33f*)&M[0],
@@ -3063,7 +3236,8 @@ OIIOTOOL_OP(cshift, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     int y = 0;
     int z = 0;
     if (sscanf(op.args(1).c_str(), "%d%d%d", &x, &y, &z) < 2) {
-        ot.errorf(op.opname(), "Invalid shift offset '%s'", op.args(1));
+        op.oiiotool().errorf(op.opname(), "Invalid shift offset '%s'",
+                             op.args(1));
         return false;
     }
     return ImageBufAlgo::circular_shift(*img[0], *img[1], x, y, z);
@@ -3266,7 +3440,7 @@ OIIOTOOL_OP(kernel, 0, [](OiiotoolOp& op, span<ImageBuf*> img) {
     float w = 1.0f;
     float h = 1.0f;
     if (sscanf(kernelsize.c_str(), "%fx%f", &w, &h) != 2)
-        ot.errorf(op.opname(), "Unknown size %s", kernelsize);
+        op.oiiotool().errorf(op.opname(), "Unknown size %s", kernelsize);
     return ImageBufAlgo::make_kernel(*img[0], kernelname, w, h);
 });
 
@@ -3809,10 +3983,10 @@ OIIOTOOL_OP(blur, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     float w             = 1.0f;
     float h             = 1.0f;
     if (sscanf(op.args(1).c_str(), "%fx%f", &w, &h) != 2)
-        ot.errorf(op.opname(), "Unknown size %s", op.args(1));
+        op.oiiotool().errorf(op.opname(), "Unknown size %s", op.args(1));
     ImageBuf Kernel;
     if (!ImageBufAlgo::make_kernel(Kernel, kernopt, w, h)) {
-        ot.error(op.opname(), Kernel.geterror());
+        op.oiiotool().error(op.opname(), Kernel.geterror());
         return false;
     }
     return ImageBufAlgo::convolve(*img[0], *img[1], Kernel);
@@ -3826,7 +4000,7 @@ OIIOTOOL_OP(median, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     int w = 3;
     int h = 3;
     if (sscanf(size.c_str(), "%dx%d", &w, &h) != 2)
-        ot.errorf(op.opname(), "Unknown size %s", size);
+        op.oiiotool().errorf(op.opname(), "Unknown size %s", size);
     return ImageBufAlgo::median_filter(*img[0], *img[1], w, h);
 });
 
@@ -3838,7 +4012,7 @@ OIIOTOOL_OP(dilate, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     int w = 3;
     int h = 3;
     if (sscanf(size.c_str(), "%dx%d", &w, &h) != 2)
-        ot.errorf(op.opname(), "Unknown size %s", size);
+        op.oiiotool().errorf(op.opname(), "Unknown size %s", size);
     return ImageBufAlgo::dilate(*img[0], *img[1], w, h);
 });
 
@@ -3850,7 +4024,7 @@ OIIOTOOL_OP(erode, 1, [](OiiotoolOp& op, span<ImageBuf*> img) {
     int w = 3;
     int h = 3;
     if (sscanf(size.c_str(), "%dx%d", &w, &h) != 2)
-        ot.errorf(op.opname(), "Unknown size %s", size);
+        op.oiiotool().errorf(op.opname(), "Unknown size %s", size);
     return ImageBufAlgo::erode(*img[0], *img[1], w, h);
 });
 
@@ -3980,9 +4154,10 @@ action_paste(int argc, const char* argv[])
     ROI roi_all, roi_full_all;
     for (int i = 0; i < ninputs; ++i) {
         if (ot.debug && ninputs > 4)
-            Strutil::printf("    paste/1 %d (total time %s, mem %s)\n", i,
-                            Strutil::timeintervalformat(ot.total_runtime(), 2),
-                            Strutil::memformat(Sysutil::memory_used()));
+            Strutil::fprintf(std::cout,
+                             "    paste/1 %d (total time %s, mem %s)\n", i,
+                             Strutil::timeintervalformat(ot.total_runtime(), 2),
+                             Strutil::memformat(Sysutil::memory_used()));
         ot.read(inputs[i]);
         roi_all      = roi_union(roi_all, inputs[i]->spec()->roi());
         roi_full_all = roi_union(roi_full_all, inputs[i]->spec()->roi_full());
@@ -4008,10 +4183,10 @@ action_paste(int argc, const char* argv[])
         // to pre-allocate the fully merged set of samples.
         for (int i = 0; i < ninputs; ++i) {
             if (ot.debug && ninputs > 4)
-                Strutil::printf("    paste/2 %d (total time %s, mem %s)\n", i,
-                                Strutil::timeintervalformat(ot.total_runtime(),
-                                                            2),
-                                Strutil::memformat(Sysutil::memory_used()));
+                Strutil::fprintf(
+                    std::cout, "    paste/2 %d (total time %s, mem %s)\n", i,
+                    Strutil::timeintervalformat(ot.total_runtime(), 2),
+                    Strutil::memformat(Sysutil::memory_used()));
             ImageRecRef FG = inputs[i];
             if (!FG->spec()->deep)
                 break;
@@ -4039,9 +4214,10 @@ action_paste(int argc, const char* argv[])
     // Now paste the other images, back to front
     for (int i = 1; i < ninputs && ok; ++i) {
         if (ot.debug && ninputs > 4)
-            Strutil::printf("    paste/3 %d (total time %s, mem %s)\n", i,
-                            Strutil::timeintervalformat(ot.total_runtime(), 2),
-                            Strutil::memformat(Sysutil::memory_used()));
+            Strutil::fprintf(std::cout,
+                             "    paste/3 %d (total time %s, mem %s)\n", i,
+                             Strutil::timeintervalformat(ot.total_runtime(), 2),
+                             Strutil::memformat(Sysutil::memory_used()));
         ImageRecRef FG = inputs[i];
         ok             = ImageBufAlgo::paste(*Rbuf, x, y, 0, 0, (*FG)());
         if (!ok)
@@ -4259,7 +4435,30 @@ action_clamp(int argc, const char* argv[])
     bool allsubimages = options.get_int("allsubimages", ot.allsubimages);
 
     ImageRecRef A = ot.pop();
-    ot.read(A);
+    bool fuse     = ot.fuse && !allsubimages;
+    if (!(fuse && A->deferred()))
+        ot.read(A);
+    if (fuse && A->spec(0, 0)) {
+        // Try to make the clamp one more stage of a deferred chain.
+        int nchans      = A->spec(0, 0)->nchannels;
+        const float big = std::numeric_limits<float>::max();
+        std::vector<float> min(nchans, -big);
+        std::vector<float> max(nchans, big);
+        Strutil::extract_from_list_string(min, options.get_string("min"));
+        Strutil::extract_from_list_string(max, options.get_string("max"));
+        bool clampalpha01 = options.get_int("clampalpha");
+        ImageRecRef R     = defer_pointwise(
+            command, A, {}, [=](span<ImageBuf*> img) {
+                return ImageBufAlgo::clamp(*img[0], *img[1], min, max,
+                                           clampalpha01);
+            });
+        if (R) {
+            ot.push(R);
+            ot.function_times[command] += timer();
+            return 0;
+        }
+        ot.read(A);
+    }
     int subimages = allsubimages ? A->subimages() : 1;
     ImageRecRef R(new ImageRec(*A, allsubimages ? -1 : 0, allsubimages ? -1 : 0,
                                true /*writable*/, false /*copy_pixels*/));
@@ -4835,7 +5034,10 @@ output_file(int /*argc*/, const char* argv[])
     bool supports_negativeorigin = out->supports("negativeorigin");
     bool supports_tiles = out->supports("tiles") || ot.output_force_tiles;
     bool procedural     = out->supports("procedural");
-    ot.read();
+    // With --stream, a deferred result is left unevaluated, to be computed
+    // a band at a time as it's written.
+    if (!(ot.stream_budget && ot.curimg->deferred()))
+        ot.read();
     ImageRecRef saveimg = ot.curimg;
     ImageRecRef ir(ot.curimg);
     TypeDesc saved_output_dataformat = ot.output_dataformat;
@@ -4863,6 +5065,7 @@ output_file(int /*argc*/, const char* argv[])
     // Handle --autotrim
     int autotrim = fileoptions.get_int("autotrim", ot.output_autotrim);
     if (supports_displaywindow && autotrim) {
+        ot.read(ir);  // Needs all the pixels, so no streaming
         ROI roi           = nonzero_region_all_subimages(ir);
         bool crops_needed = false;
         for (int s = 0; s < ir->subimages(); ++s)
@@ -4990,6 +5193,7 @@ output_file(int /*argc*/, const char* argv[])
 
     bool ok = true;
     if (do_tex || do_latlong || do_bumpslopes) {
+        ot.read(ir);  // make_texture needs the whole image
         ImageSpec configspec;
         adjust_output_options(filename, configspec, nullptr, ot, supports_tiles,
                               fileoptions);
@@ -5073,7 +5277,15 @@ output_file(int /*argc*/, const char* argv[])
                         break;
                     }
                 }
-                if (!(*ir)(s, m).write(out.get())) {
+                if (ir->deferred()) {
+                    // Only reachable with --stream
+                    imagesize_t budget = imagesize_t(ot.stream_budget) << 20;
+                    if (!ir->write_fused(out.get(), budget)) {
+                        ot.error(command, ir->geterror());
+                        ok = false;
+                        break;
+                    }
+                } else if (!(*ir)(s, m).write(out.get())) {
                     ot.error(command, (*ir)(s, m).geterror());
                     ok = false;
                     break;
@@ -5146,10 +5358,11 @@ output_file(int /*argc*/, const char* argv[])
     ot.num_outputs += 1;
 
     if (ot.debug)
-        Strutil::printf("    output took %s  (total time %s, mem %s)\n",
-                        Strutil::timeintervalformat(optime, 2),
-                        Strutil::timeintervalformat(ot.total_runtime(), 2),
-                        Strutil::memformat(Sysutil::memory_used()));
+        Strutil::fprintf(std::cout,
+                         "    output took %s  (total time %s, mem %s)\n",
+                         Strutil::timeintervalformat(optime, 2),
+                         Strutil::timeintervalformat(ot.total_runtime(), 2),
+                         Strutil::memformat(Sysutil::memory_used()));
     return 0;
 }
 
@@ -5532,6 +5745,8 @@ getargs(int argc, char* argv[])
       .help("Views for %V/%v wildcards (comma-separated, defaults to \"left,right\")");
     ap.arg("--skip-bad-frames", &ot.skip_bad_frames)
       .help("Skip to next frame in range if there's an error, rather than exiting");
+    ap.arg("--parallel-frames %d:N")
+      .help("Process up to N frames of a sequence at once (default 1; 0 == #cores)");
     ap.arg("--wildcardoff")
       .help("Disable numeric wildcard expansion for subsequent command line arguments");
     ap.arg("--wildcardon")
@@ -5568,6 +5783,11 @@ getargs(int argc, char* argv[])
       .action(set_autotile);
     ap.arg("--metamerge", &ot.metamerge)
       .help("Always merge metadata of all inputs into output");
+    ap.arg("--fuse", &ot.fuse)
+      .help("Defer chains of pointwise ops and run them in one tiled pass");
+    ap.arg("--stream %d:MB")
+      .help("Write deferred (--fuse) results in bands of at most MB, never holding the whole image (implies --fuse)")
+      .action(set_stream);
     ap.arg("--crash")
       .hidden()
       .action(crash_me);
@@ -6035,6 +6255,75 @@ getargs(int argc, char* argv[])
 
 
 
+// The console output of one iteration of a --parallel-frames sequence,
+// held back so that the iterations' logs come out in frame order. It's
+// kept as runs of text, each tagged with whether it was sent to std::cerr,
+// so the interleaving of the two streams is preserved.
+struct FrameLog {
+    std::vector<std::pair<bool, std::string>> chunks;
+    bool done = false;  // The iteration finished (or was never started)
+
+    // The log that the calling thread's console output is diverted to,
+    // or nullptr to write it through.
+    static thread_local FrameLog* current;
+
+    void append(bool err, const char* s, size_t n)
+    {
+        if (chunks.empty() || chunks.back().first != err)
+            chunks.emplace_back(err, std::string());
+        chunks.back().second.append(s, n);
+    }
+
+    void replay(std::streambuf* out, std::streambuf* err)
+    {
+        for (auto& c : chunks) {
+            std::streambuf* dest = c.first ? err : out;
+            dest->sputn(c.second.data(), std::streamsize(c.second.size()));
+            dest->pubsync();
+        }
+        chunks.clear();
+    }
+};
+
+thread_local FrameLog* FrameLog::current = nullptr;
+
+
+// Unbuffered streambuf that stands in for std::cout's or std::cerr's
+// while frames run in parallel, sending each thread's output to its
+// FrameLog.
+class FrameLogBuf final : public std::streambuf {
+public:
+    FrameLogBuf(std::streambuf* dest, bool err)
+        : m_dest(dest)
+        , m_err(err)
+    {
+    }
+
+protected:
+    int overflow(int c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+        char ch = traits_type::to_char_type(c);
+        return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        if (FrameLog::current) {
+            FrameLog::current->append(m_err, s, size_t(n));
+            return n;
+        }
+        return m_dest->sputn(s, n);
+    }
+    int sync() override { return FrameLog::current ? 0 : m_dest->pubsync(); }
+
+private:
+    std::streambuf* m_dest;
+    bool m_err;
+};
+
+
+
 // Check if any of the command line arguments contains numeric ranges or
 // wildcards.  If not, just return 'false'.  But if they do, the
 // remainder of processing will happen here (and return 'true').
@@ -6060,7 +6349,8 @@ handle_sequence(int argc, const char** argv)
     std::vector<string_view> views;
     Strutil::split(default_views, views, ",");
 
-    int framepadding = 0;
+    int framepadding    = 0;
+    int parallel_frames = 1;
     std::vector<int> sequence_args;  // Args with sequence numbers
     std::vector<bool> sequence_is_output;
     bool is_sequence = false;
@@ -6091,6 +6381,12 @@ handle_sequence(int argc, const char** argv)
             int f = Strutil::stoi(argv[++a]);
             if (f >= 1 && f < 10)
                 framepadding = f;
+        } else if ((strarg == "--parallel-frames"
+                    || strarg == "-parallel-frames")
+                   && a < argc - 1) {
+            parallel_frames = Strutil::stoi(argv[++a]);
+            if (parallel_frames <= 0)
+                parallel_frames = Sysutil::hardware_concurrency();
         } else if ((strarg == "--views" || strarg == "-views")
                    && a < argc - 1) {
             Strutil::split(argv[++a], views, ",");
@@ -6187,10 +6483,11 @@ handle_sequence(int argc, const char** argv)
 
     // OK, now we just call getargs once for each item in the sequences,
     // substituting the i-th sequence entry for its respective argument
-    // every time.
+    // every time. This uses (and leaves behind) the calling thread's ot and
+    // ap, and returns false if the iteration failed in a way that should
+    // stop the whole sequence.
     // Note: nfilenames really means, number of frame number iterations.
-    std::vector<const char*> seq_argv(argv, argv + argc + 1);
-    for (size_t i = 0; i < nfilenames; ++i) {
+    auto run_iteration = [&](size_t i, std::vector<const char*>& seq_argv) {
         if (ot.debug)
             std::cout << "SEQUENCE " << i << "\n";
         for (size_t a : sequence_args) {
@@ -6205,9 +6502,8 @@ handle_sequence(int argc, const char** argv)
 
         if (ap.aborted()) {
             if (!ot.skip_bad_frames)
-                break;
-            else
-                ap.abort(false);
+                return false;
+            ap.abort(false);
         } else {
             ot.process_pending();
             if (ot.pending_callback())
@@ -6226,8 +6522,91 @@ handle_sequence(int argc, const char** argv)
                       << "\n";
         if (ot.debug)
             std::cout << "\n";
+        return true;
+    };
+
+    if (parallel_frames <= 1 || nfilenames <= 1) {
+        std::vector<const char*> seq_argv(argv, argv + argc + 1);
+        for (size_t i = 0; i < nfilenames; ++i)
+            if (!run_iteration(i, seq_argv))
+                break;
+        return true;
     }
 
+    // --parallel-frames: worker threads claim iterations in order, each
+    // with its own thread_local ot and ap but all sharing the main
+    // thread's ImageCache. Console output is captured per iteration and
+    // written out in frame order as soon as all earlier frames are done.
+    // A failed frame (without --skip-bad-frames) keeps any later frame
+    // from starting, as in the serial case, though frames already under
+    // way are allowed to finish.
+    Oiiotool& main_ot = ot;
+    std::vector<FrameLog> logs(nfilenames);
+    std::streambuf* cout_buf = std::cout.rdbuf();
+    std::streambuf* cerr_buf = std::cerr.rdbuf();
+    FrameLogBuf cout_log(cout_buf, false), cerr_log(cerr_buf, true);
+    std::cout.flush();
+    std::cerr.flush();
+    std::cout.rdbuf(&cout_log);
+    std::cerr.rdbuf(&cerr_log);
+
+    std::mutex mutex;  // Guards logs, next_log, stop_at, and main_ot
+    std::atomic<size_t> next_iteration(0);
+    size_t next_log = 0;           // First frame whose log isn't written yet
+    size_t stop_at  = nfilenames;  // Don't start frames at or past this
+    auto flush_logs = [&]() {
+        for (; next_log < nfilenames && logs[next_log].done; ++next_log)
+            logs[next_log].replay(cout_buf, cerr_buf);
+    };
+    auto worker = [&]() {
+        ot.imagecache = main_ot.imagecache;
+        ot.debug      = main_ot.debug;
+        std::vector<const char*> seq_argv(argv, argv + argc + 1);
+        for (;;) {
+            size_t i = next_iteration++;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (i >= stop_at)
+                    break;
+            }
+            FrameLog::current = &logs[i];
+            bool keep_going   = run_iteration(i, seq_argv);
+            FrameLog::current = nullptr;
+            std::lock_guard<std::mutex> lock(mutex);
+            logs[i].done = true;
+            if (!keep_going)
+                stop_at = std::min(stop_at, i + 1);
+            flush_logs();
+        }
+        // Fold this thread's results into the main thread's ot.
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ot.return_value != EXIT_SUCCESS)
+            main_ot.return_value = ot.return_value;
+        main_ot.num_outputs += ot.num_outputs;
+        main_ot.printed_info |= ot.printed_info;
+        main_ot.printinfo |= ot.printinfo;
+        main_ot.printstats |= ot.printstats;
+        main_ot.dumpdata |= ot.dumpdata;
+        main_ot.dryrun |= ot.dryrun;
+        main_ot.runstats |= ot.runstats;
+        main_ot.peak_memory = std::max(main_ot.peak_memory, ot.peak_memory);
+        for (auto& f : ot.function_times)
+            main_ot.function_times[f.first] += f.second;
+    };
+    thread_group workers;
+    for (int t = 0; t < std::min(parallel_frames, int(nfilenames)); ++t)
+        workers.create_thread(worker);
+    workers.join_all();
+
+    // Frames that were never started have nothing to say; write out the
+    // logs of any that ran after them.
+    for (auto& log : logs)
+        log.done = true;
+    flush_logs();
+    std::cout.rdbuf(cout_buf);
+    std::cerr.rdbuf(cerr_buf);
+    if (stop_at < nfilenames)
+        ap.abort();  // as the serial loop leaves it after a failed frame
     return true;
 }
 
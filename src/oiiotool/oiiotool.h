@@ -61,7 +61,9 @@ public:
     bool autopremult;              // auto premult unassociated alpha input
     bool nativeread;               // force native data type reads
     bool printinfo_verbose;
-    bool metamerge;  // Merge source input metadata into output
+    bool metamerge;     // Merge source input metadata into output
+    bool fuse;          // Defer and fuse chains of pointwise ops
+    int stream_budget;  // MB for streaming deferred outputs (0 = off)
     int cachesize;
     int autotile;
     int frame_padding;
@@ -384,6 +386,20 @@ public:
     ImageRec(const std::string& name, const ImageSpec& spec,
              ImageCache* imagecache);
 
+    // A deferred pointwise operation (see --fuse). img[0] is the
+    // destination, img[1] the source, and img[2...] any additional
+    // inputs. The destination is already allocated and the kernel must
+    // fill its whole pixel window.
+    using FusedKernel = std::function<bool(span<ImageBuf*> img)>;
+
+    // Create a deferred ImageRec whose single subimage will be the result
+    // of running kernel on src and others, with the given result spec.
+    // If src is itself deferred, the new stage is appended to its chain,
+    // so that the whole chain is evaluated in one pass by read().
+    ImageRec(const std::string& name, ImageRecRef src,
+             cspan<ImageRecRef> others, const ImageSpec& spec,
+             FusedKernel kernel);
+
     ImageRec(const ImageRec& copy) = delete;  // Disallow copy ctr
 
     enum WinMerge { WinMergeUnion, WinMergeIntersection, WinMergeA, WinMergeB };
@@ -426,6 +442,28 @@ public:
     // it's lazily kept as name only, without reading the file.)
     bool elaborated() const { return m_elaborated; }
 
+    // Is this the not-yet-evaluated result of a chain of fused pointwise
+    // operations? Its spec() is known, but it has no pixels until read().
+    bool deferred() const { return !m_fused.empty(); }
+
+    // True while the calling thread is running a fused kernel on one
+    // chunk of a deferred image. Any warnings were already issued when
+    // the operation was deferred, so they shouldn't be repeated per chunk.
+    static bool& in_fused_kernel()
+    {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    // Compute just the region roi of a deferred image into dst, whose
+    // pixel window must contain roi, leaving the ImageRec itself deferred.
+    bool evaluate_fused(ImageBuf& dst, ROI roi);
+
+    // Write a deferred image to out, which has already been opened for
+    // its only subimage, computing it in bands of whole scanlines (or tile
+    // rows) that use no more than about budget bytes at a time.
+    bool write_fused(ImageOutput* out, imagesize_t budget);
+
     // Read just enough to fill in the nativespecs
     bool read_nativespec();
 
@@ -455,6 +493,8 @@ public:
 
     const ImageSpec* nativespec(int subimg = 0, int mip = 0) const
     {
+        if (deferred())  // no pixels yet, nor a file they came from
+            return spec(subimg, mip);
         return subimg < subimages() ? &((*this)(subimg, mip).nativespec())
                                     : nullptr;
     }
@@ -533,6 +573,18 @@ private:
     mutable std::string m_err;
     std::unique_ptr<ImageSpec> m_configspec;
 
+    // Deferred pointwise ops, applied in order to m_fused_src.
+    struct FusedStage {
+        FusedKernel kernel;
+        std::vector<ImageRecRef> others;  // Additional, elaborated inputs
+        ImageSpec spec;                   // Spec of this stage's result
+    };
+    ImageRecRef m_fused_src;
+    std::vector<FusedStage> m_fused;
+
+    // Evaluate the deferred chain, one cache-sized chunk at a time.
+    bool evaluate_fused();
+
     // Add to the error message
     void append_error(string_view message) const;
 };
@@ -661,7 +713,7 @@ apply_spec_mod(ImageRec& img, Action act, const Type& t, bool allsubimages)
 /// with just a couple tiny places that need to be overridden for each op,
 /// generally only the impl() method.
 ///
-class OiiotoolOp {
+class OiiotoolOp : public std::enable_shared_from_this<OiiotoolOp> {
 public:
     using setup_func_t = std::function<bool(OiiotoolOp& op)>;
     using impl_func_t = std::function<bool(OiiotoolOp& op, span<ImageBuf*> img)>;
@@ -719,9 +771,13 @@ public:
         m_options                 = ot.extract_options(m_args[0]);
 
         // Read all input images, and reserve (and push) the output image.
+        // With --fuse, a deferred first input is left unevaluated for
+        // now, in case this op can simply be appended to its chain.
+        bool try_fuse = ot.fuse && pointwise();
         int subimages = compute_subimages();
         for (int i = 1; i < nimages(); ++i)
-            ot.read(m_ir[i]);
+            if (!(i == 1 && try_fuse && m_ir[1]->deferred()))
+                ot.read(m_ir[i]);
         if (nimages()) {
             // Read the inputs
             subimages = compute_subimages();
@@ -740,7 +796,7 @@ public:
                 // Just copy the input instead.
                 if (nimages())
                     m_ir[0] = m_ir[1];
-            } else {
+            } else if (!(try_fuse && defer(subimages))) {
                 traverse_subimages(subimages);
             }
         }
@@ -755,10 +811,11 @@ public:
         double optime = timer();
         ot.function_times[opname()] += optime;
         if (ot.debug) {
-            Strutil::printf("    %s took %s  (total time %s, mem %s)\n",
-                            opname(), Strutil::timeintervalformat(optime, 2),
-                            Strutil::timeintervalformat(ot.total_runtime(), 2),
-                            Strutil::memformat(Sysutil::memory_used()));
+            Strutil::fprintf(std::cout,
+                             "    %s took %s  (total time %s, mem %s)\n",
+                             opname(), Strutil::timeintervalformat(optime, 2),
+                             Strutil::timeintervalformat(ot.total_runtime(), 2),
+                             Strutil::memformat(Sysutil::memory_used()));
         }
         return 0;
     }
@@ -821,6 +878,17 @@ public:
     // setup_func, without needing to subclass at all.
     virtual bool setup() { return m_setup_func ? m_setup_func(*this) : true; }
 
+    // Is this op eligible for --fuse? It must be pointwise (each result
+    // pixel depends only on the same pixel of the inputs) and its impl
+    // must honor an already-allocated destination. By default this is
+    // decided by the op name.
+    virtual bool pointwise() const;
+
+    // Try to replace the output with a deferred ImageRec that runs impl()
+    // as part of a fused chain (see --fuse). Return false, with the
+    // inputs fully read, if this op can't be deferred after all.
+    bool defer(int subimages);
+
     // Return an ImageRecRef of the new output image. The default just
     // makes an ImageRecRef with enough slots for the number of subimages
     // that can be discerned from the inputs. This can be overloaded for
@@ -923,6 +991,11 @@ public:
         return -1;
     }
 
+    // The Oiiotool state of the command line this op came from. Op bodies
+    // should use this rather than the global, since they may be run on
+    // another thread.
+    Oiiotool& oiiotool() const { return ot; }
+
     int nargs() const { return m_nargs; }
     string_view args(int i) const { return m_args[i]; }
     int nimages() const { return m_nimages; }
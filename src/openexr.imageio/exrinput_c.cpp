@@ -45,6 +45,7 @@ using boost::math::gcd;
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imagebufalgo_util.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/parallel.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/sysutil.h>
 #include <OpenImageIO/thread.h>
@@ -242,6 +243,9 @@ private:
 
     bool valid_file(const std::string& filename, Filesystem::IOProxy* io) const;
 
+    // How many threads to use for decoding independent chunks at once.
+    int decode_threads() const;
+
     // Fill in with 'missing' color/pattern.
     bool check_fill_missing(int xbegin, int xend, int ybegin, int yend,
                             int zbegin, int zend, int chbegin, int chend,
@@ -1163,6 +1167,32 @@ OpenEXRInput::close()
 
 
 
+// Point the decoder's channels [chbegin,chend) of spec at their place in
+// the interleaved buffer starting at `ptr`.
+static void
+bind_decode_channels(exr_decode_pipeline_t& decoder, const ImageSpec& spec,
+                     int chbegin, int chend, uint8_t* ptr, size_t pixelbytes,
+                     size_t linebytes)
+{
+    size_t chanoffset = 0;
+    for (int c = chbegin; c < chend; ++c) {
+        size_t chanbytes  = spec.channelformat(c).size();
+        string_view cname = spec.channel_name(c);
+        for (int dc = 0; dc < decoder.channel_count; ++dc) {
+            exr_coding_channel_info_t& curchan = decoder.channels[dc];
+            if (cname == curchan.channel_name) {
+                curchan.decode_to_ptr     = ptr + chanoffset;
+                curchan.user_pixel_stride = pixelbytes;
+                curchan.user_line_stride  = linebytes;
+                chanoffset += chanbytes;
+                break;
+            }
+        }
+    }
+}
+
+
+
 bool
 OpenEXRInput::read_native_scanline(int subimage, int miplevel, int y, int z,
                                    void* data)
@@ -1217,12 +1247,9 @@ OpenEXRInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
 
     chend = clamp(chend, chbegin + 1, spec.nchannels);
 
-    uint8_t* linedata    = static_cast<uint8_t*>(data);
     size_t pixelbytes    = spec.pixel_bytes(chbegin, chend, true);
     size_t scanlinebytes = (size_t)spec.width * pixelbytes;
 
-    exr_chunk_block_info_t cinfo;
-    exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
     int32_t scansperchunk;
     exr_result_t rv;
     rv = exr_get_scanlines_per_chunk(m_exr_context, subimage, &scansperchunk);
@@ -1242,83 +1269,78 @@ OpenEXRInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
 #endif
     int endy = spec.y + spec.height;
     yend     = std::min(endy, yend);
-    std::vector<uint8_t> fullchunk;
-    bool first = true;
-    int nlines = scansperchunk;
-    for (int y = ybegin; y < yend; y += nlines) {
-        uint8_t* cdata = linedata;
-        // handle scenario where caller asked us to read a scanline
-        // that isn't aligned to a chunk boundary
-        int invalid = (y - spec.y) % scansperchunk;
-        if (invalid != 0) {
-            fullchunk.resize(scanlinebytes * scansperchunk);
-            nlines = scansperchunk - invalid;
-            cdata  = &fullchunk[0];
-            y      = y - invalid;
-        } else if ((y + scansperchunk) > yend && yend < endy) {
-            fullchunk.resize(scanlinebytes * scansperchunk);
-            nlines = yend - y;
-            cdata  = &fullchunk[0];
-        } else
-            nlines = scansperchunk;
-
-        rv = exr_read_scanline_block_info(m_exr_context, subimage, y, &cinfo);
-        if (rv != EXR_ERR_SUCCESS)
-            break;
-        if (first) {
-            rv = exr_decoding_initialize(m_exr_context, subimage, &cinfo,
-                                         &decoder);
-        } else {
-            rv = exr_decoding_update(m_exr_context, subimage, &cinfo, &decoder);
-        }
-        if (rv != EXR_ERR_SUCCESS)
-            break;
+    if (yend <= ybegin)
+        return true;
 
-        size_t chanoffset = 0;
-        for (int c = chbegin; c < chend; ++c) {
-            size_t chanbytes  = spec.channelformat(c).size();
-            string_view cname = spec.channel_name(c);
-            for (int dc = 0; dc < decoder.channel_count; ++dc) {
-                exr_coding_channel_info_t& curchan = decoder.channels[dc];
-#if ENABLE_READ_DEBUG_PRINTS
-                //std::cerr << " looking for " << cname.c_str() << ": dc " << dc
-                //          << " curchan " << curchan.channel_name << std::endl;
-#endif
-                if (cname == curchan.channel_name) {
-                    curchan.decode_to_ptr     = cdata + chanoffset;
-                    curchan.user_pixel_stride = pixelbytes;
-                    curchan.user_line_stride  = scanlinebytes;
-                    chanoffset += chanbytes;
-#if ENABLE_READ_DEBUG_PRINTS
-                    //std::cerr << "   chan " << c << " offset " << chanoffset
-                    //          << " stride " << pixelbytes << " linestride "
-                    //          << scanlinebytes << std::endl;
-#endif
+    // Every chunk is independent, so decode them in parallel. Each worker
+    // handles a run of adjacent chunks with its own decode pipeline. Chunks
+    // that straddle either end of the requested range are decoded into a
+    // scratch buffer and only the requested scanlines copied out.
+    int firsty  = ybegin - (ybegin - spec.y) % scansperchunk;
+    int nchunks = (yend - firsty + scansperchunk - 1) / scansperchunk;
+    std::atomic<exr_result_t> failure(EXR_ERR_SUCCESS);
+    parallel_for_chunked(
+        0, nchunks, 0,
+        [&](int64_t cbegin, int64_t cend) {
+            exr_chunk_block_info_t cinfo;
+            exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+            std::vector<uint8_t> fullchunk;
+            bool first = true;
+            for (int64_t c = cbegin; c < cend; ++c) {
+                if (failure != EXR_ERR_SUCCESS)
                     break;
+                int y          = firsty + int(c) * scansperchunk;
+                int chunkend   = std::min(y + scansperchunk, endy);
+                bool partial   = y < ybegin || (chunkend > yend);
+                uint8_t* cdata = static_cast<uint8_t*>(data)
+                                 + (y - ybegin) * scanlinebytes;
+                if (partial) {
+                    fullchunk.resize(scanlinebytes * scansperchunk);
+                    cdata = fullchunk.data();
                 }
-            }
-        }
 
-        if (first) {
-            rv = exr_decoding_choose_default_routines(m_exr_context, subimage,
-                                                      &decoder);
-            if (rv != EXR_ERR_SUCCESS)
-                break;
-        }
-        rv = exr_decoding_run(m_exr_context, subimage, &decoder);
-        if (rv != EXR_ERR_SUCCESS)
-            break;
+                exr_result_t crv
+                    = exr_read_scanline_block_info(m_exr_context, subimage, y,
+                                                   &cinfo);
+                if (crv == EXR_ERR_SUCCESS) {
+                    if (first)
+                        crv = exr_decoding_initialize(m_exr_context, subimage,
+                                                      &cinfo, &decoder);
+                    else
+                        crv = exr_decoding_update(m_exr_context, subimage,
+                                                  &cinfo, &decoder);
+                }
+                if (crv == EXR_ERR_SUCCESS) {
+                    bind_decode_channels(decoder, spec, chbegin, chend, cdata,
+                                         pixelbytes, scanlinebytes);
+                    if (first)
+                        crv = exr_decoding_choose_default_routines(
+                            m_exr_context, subimage, &decoder);
+                }
+                if (crv == EXR_ERR_SUCCESS)
+                    crv = exr_decoding_run(m_exr_context, subimage, &decoder);
+                if (crv != EXR_ERR_SUCCESS) {
+                    failure = crv;
+                    break;
+                }
+                first = false;
 
-        if (cdata != linedata) {
-            y += invalid;
-            nlines = std::min(nlines, yend - y);
-            memcpy(linedata, cdata + invalid * scanlinebytes,
-                   nlines * scanlinebytes);
-        }
-        first = false;
-        linedata += scanlinebytes * nlines;
-    }
-    exr_decoding_destroy(m_exr_context, &decoder);
+                if (partial) {
+                    int y0 = std::max(y, ybegin);
+                    int y1 = std::min(chunkend, yend);
+                    memcpy(static_cast<uint8_t*>(data)
+                               + (y0 - ybegin) * scanlinebytes,
+                           cdata + (y0 - y) * scanlinebytes,
+                           (y1 - y0) * scanlinebytes);
+                }
+            }
+            exr_decoding_destroy(m_exr_context, &decoder);
+        },
+        parallel_options(decode_threads(), Split_Y, 1));
+    rv = failure;
+    if (rv != EXR_ERR_SUCCESS && !has_error())
+        errorf("Could not decode scanlines %d-%d: %s", ybegin, yend - 1,
+               exr_get_error_code_as_string(rv));
     return (rv == EXR_ERR_SUCCESS);
 }
 
@@ -1505,109 +1527,94 @@ OpenEXRInput::read_native_tiles(int subimage, int miplevel, int xbegin,
 
 #endif
 
-    exr_chunk_block_info_t cinfo;
-    exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
-    bool first                    = true;
-
-    int curytile = firstytile;
-    bool retval  = true;
-    for (int ty = 0; ty < nytiles; ++ty, ++curytile) {
-        int curxtile         = firstxtile;
-        uint8_t* tilesetdata = static_cast<uint8_t*>(data);
-        tilesetdata += ty * tileh * scanlinebytes;
-        for (int tx = 0; tx < nxtiles; ++tx, ++curxtile) {
-            uint8_t* curtilestart = tilesetdata + tx * tilew * pixelbytes;
-            rv = exr_read_tile_block_info(m_exr_context, subimage, curxtile,
-                                          curytile, miplevel, miplevel, &cinfo);
-            if (rv != EXR_ERR_SUCCESS) {
-                retval &= check_fill_missing(xbegin + tx * tilew,
-                                             xbegin + (tx + 1) * tilew,
-                                             ybegin + ty * tileh,
-                                             ybegin + (ty + 1) * tileh, zbegin,
-                                             zend, chbegin, chend, curtilestart,
-                                             pixelbytes, scanlinebytes);
-                continue;
-            }
-
-            if (first) {
-                rv = exr_decoding_initialize(m_exr_context, subimage, &cinfo,
-                                             &decoder);
-            } else {
-                rv = exr_decoding_update(m_exr_context, subimage, &cinfo,
-                                         &decoder);
-            }
-            if (rv != EXR_ERR_SUCCESS) {
-                retval &= check_fill_missing(xbegin + tx * tilew,
-                                             xbegin + (tx + 1) * tilew,
-                                             ybegin + ty * tileh,
-                                             ybegin + (ty + 1) * tileh, zbegin,
-                                             zend, chbegin, chend, curtilestart,
-                                             pixelbytes, scanlinebytes);
-                continue;
-            }
-            size_t chanoffset = 0;
-            for (int c = chbegin; c < chend; ++c) {
-                size_t chanbytes  = spec.channelformat(c).size();
-                string_view cname = spec.channel_name(c);
-                for (int dc = 0; dc < decoder.channel_count; ++dc) {
-                    exr_coding_channel_info_t& curchan = decoder.channels[dc];
-                    if (cname == curchan.channel_name) {
-                        curchan.decode_to_ptr     = curtilestart + chanoffset;
-                        curchan.user_pixel_stride = pixelbytes;
-                        curchan.user_line_stride  = scanlinebytes;
-                        chanoffset += chanbytes;
-#if ENABLE_READ_DEBUG_PRINTS
-                        //std::cerr << " chan " << c << " tile " << tx << ", "
-                        //          << ty << ": linestride "
-                        //          << curchan.user_line_stride << " tilesize "
-                        //          << curchan.width << " x " << curchan.height
-                        //          << std::endl;
-#endif
-                        break;
-                    }
+    // Every tile is independent, so decode them in parallel. Each worker
+    // handles a run of adjacent tiles with its own decode pipeline.
+    std::atomic<bool> retval(true);
+    std::atomic<exr_result_t> failure(EXR_ERR_SUCCESS);
+    parallel_for_chunked(
+        0, int64_t(nxtiles) * int64_t(nytiles), 0,
+        [&](int64_t tbegin, int64_t tend) {
+            exr_chunk_block_info_t cinfo;
+            exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+            bool first = true;
+            for (int64_t t = tbegin; t < tend; ++t) {
+                int tx                = int(t % nxtiles);
+                int ty                = int(t / nxtiles);
+                uint8_t* curtilestart = static_cast<uint8_t*>(data)
+                                        + ty * tileh * scanlinebytes
+                                        + tx * tilew * pixelbytes;
+                exr_result_t crv
+                    = exr_read_tile_block_info(m_exr_context, subimage,
+                                               firstxtile + tx,
+                                               firstytile + ty, miplevel,
+                                               miplevel, &cinfo);
+                if (crv == EXR_ERR_SUCCESS) {
+                    if (first)
+                        crv = exr_decoding_initialize(m_exr_context, subimage,
+                                                      &cinfo, &decoder);
+                    else
+                        crv = exr_decoding_update(m_exr_context, subimage,
+                                                  &cinfo, &decoder);
                 }
-            }
+                if (crv == EXR_ERR_SUCCESS) {
 #if ENABLE_READ_DEBUG_PRINTS
-            std::cerr << " -> read " << curxtile << ", " << curytile
-                      << ": toff " << tx * tilew * pixelbytes << " tilesize "
-                      << cinfo.width << " x " << cinfo.height << " pos "
-                      << cinfo.start_x << ", " << cinfo.start_y << std::endl;
+                    std::cerr << " -> read " << firstxtile + tx << ", "
+                              << firstytile + ty << ": toff "
+                              << tx * tilew * pixelbytes << " tilesize "
+                              << cinfo.width << " x " << cinfo.height
+                              << " pos " << cinfo.start_x << ", "
+                              << cinfo.start_y << std::endl;
 #endif
-
-            if (first) {
-                rv = exr_decoding_choose_default_routines(m_exr_context,
-                                                          subimage, &decoder);
-                if (rv != EXR_ERR_SUCCESS) {
-                    retval &= check_fill_missing(xbegin + tx * tilew,
-                                                 xbegin + (tx + 1) * tilew,
-                                                 ybegin + ty * tileh,
-                                                 ybegin + (ty + 1) * tileh,
-                                                 zbegin, zend, chbegin, chend,
-                                                 curtilestart, pixelbytes,
-                                                 scanlinebytes);
-                    continue;
+                    bind_decode_channels(decoder, spec, chbegin, chend,
+                                         curtilestart, pixelbytes,
+                                         scanlinebytes);
+                    if (first)
+                        crv = exr_decoding_choose_default_routines(
+                            m_exr_context, subimage, &decoder);
+                }
+                if (crv == EXR_ERR_SUCCESS) {
+                    first = false;
+                    crv = exr_decoding_run(m_exr_context, subimage, &decoder);
+                }
+                if (crv != EXR_ERR_SUCCESS) {
+                    failure = crv;
+                    if (!check_fill_missing(xbegin + tx * tilew,
+                                            xbegin + (tx + 1) * tilew,
+                                            ybegin + ty * tileh,
+                                            ybegin + (ty + 1) * tileh, zbegin,
+                                            zend, chbegin, chend, curtilestart,
+                                            pixelbytes, scanlinebytes))
+                        retval = false;
                 }
             }
-            first = false;
-            rv    = exr_decoding_run(m_exr_context, subimage, &decoder);
-            if (rv != EXR_ERR_SUCCESS) {
-                retval &= check_fill_missing(xbegin + tx * tilew,
-                                             xbegin + (tx + 1) * tilew,
-                                             ybegin + ty * tileh,
-                                             ybegin + (ty + 1) * tileh, zbegin,
-                                             zend, chbegin, chend, curtilestart,
-                                             pixelbytes, scanlinebytes);
-                continue;
-            }
-        }
-    }
-    exr_decoding_destroy(m_exr_context, &decoder);
+            exr_decoding_destroy(m_exr_context, &decoder);
+        },
+        parallel_options(decode_threads(), Split_Y, 1));
 
+    if (!retval && !has_error())
+        errorf("Could not decode tiles: %s",
+               exr_get_error_code_as_string(failure));
     return retval;
 }
 
 
 
+int
+OpenEXRInput::decode_threads() const
+{
+    // The ImageInput's own threads() setting wins. Otherwise follow the
+    // global "exr_threads": -1 means single-threaded, 0 means use as many
+    // threads as the rest of OIIO, and n > 0 means use n threads.
+    int n = threads();
+    if (n == 0) {
+        OIIO::getattribute("exr_threads", n);
+        n = (n < 0) ? 1 : n;
+    }
+    return n;
+}
+
+
+
 bool
 OpenEXRInput::check_fill_missing(int xbegin, int xend, int ybegin, int yend,
                                  int /*zbegin*/, int /*zend*/, int chbegin,
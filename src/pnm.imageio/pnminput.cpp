@@ -26,16 +26,23 @@ public:
     PNMInput() {}
     virtual ~PNMInput() { close(); }
     virtual const char* format_name(void) const override { return "pnm"; }
+    virtual int supports(string_view feature) const override
+    {
+        return (feature == "mmap_pixels");
+    }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
     virtual bool close() override;
     virtual int current_subimage(void) const override { return 0; }
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual const void* mapped_native_pixels(int subimage,
+                                             int miplevel) override;
 
 private:
     enum PNMType { P1, P2, P3, P4, P5, P6, Pf, PF };
 
     OIIO::ifstream m_file;
+    std::string m_filename;
     std::streampos m_header_end_pos;  // file position after the header
     std::string m_current_line;       ///< Buffer the image pixels
     const char* m_pos;
@@ -427,6 +434,7 @@ PNMInput::open(const std::string& name, ImageSpec& newspec)
     close();  //close previously opened file
 
     Filesystem::open(m_file, name, std::ios::in | std::ios::binary);
+    m_filename = name;
 
     m_current_line = "";
     m_pos          = m_current_line.c_str();
@@ -464,4 +472,29 @@ PNMInput::read_native_scanline(int subimage, int miplevel, int y, int z,
     return true;
 }
 
+
+
+
+const void*
+PNMInput::mapped_native_pixels(int subimage, int miplevel)
+{
+    lock_guard lock(*this);
+    if (!seek_subimage(subimage, miplevel))
+        return nullptr;
+
+    // Only binary graymaps and pixmaps whose samples span the full range
+    // of their type (so need no rescaling) can be used in place. 16 bit
+    // samples are big endian in the file.
+    if (m_pnm_type != P5 && m_pnm_type != P6)
+        return nullptr;
+    if (m_max_val != 255 && !(m_max_val == 65535 && bigendian()))
+        return nullptr;
+
+    cspan<unsigned char> file = mapped_file(m_filename);
+    imagesize_t offset        = imagesize_t(m_header_end_pos);
+    if (offset + m_spec.image_bytes() > imagesize_t(file.size()))
+        return nullptr;
+    return file.data() + offset;
+}
+
 OIIO_PLUGIN_NAMESPACE_END
@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <iterator>
 
@@ -55,6 +56,11 @@ static bool filtertest        = false;
 static TextureSystem* texsys  = NULL;
 static std::string searchpath;
 static bool batch        = false;
+static bool batchbench   = false;
+static float batchtol    = 1.0e-3f;
+static float shadowdepth = 0.5f;
+static float shadowbias  = 0.0f;
+static int shadowsamples = 1;
 static bool nowarp       = false;
 static bool tube         = false;
 static bool use_handle   = false;
@@ -139,6 +145,12 @@ getargs(int argc, const char* argv[])
       .help("Set fill value for missing channels");
     ap.arg("--wrap %s:MODE", &wrapmodes)
       .help("Set wrap mode (default, black, clamp, periodic, mirror, overscan)");
+    ap.arg("--shadowdepth %f:DEPTH", &shadowdepth)
+      .help("Depth of the plane looked up in a shadow map (default: 0.5)");
+    ap.arg("--bias %f:BIAS", &shadowbias)
+      .help("Depth bias for shadow lookups");
+    ap.arg("--samples %d:N", &shadowsamples)
+      .help("Number of samples for shadow lookups");
     ap.arg("--anisoaspect %f:ASPECT", &anisoaspect)
       .help("Set anisotropic ellipse aspect ratio for threadtimes tests (default: 2.0)");
     ap.arg("--anisomax %d:MAX", &anisomax)
@@ -155,6 +167,10 @@ getargs(int argc, const char* argv[])
       .help("Set auto-MIPmap for the image cache");
     ap.arg("--batch", &batch)
       .help(Strutil::sprintf("Use batched shading, batch size = %d", Tex::BatchWidth));
+    ap.arg("--batchbench", &batchbench)
+      .help("Benchmark batched against single-point texture, 3d texture, or environment lookups");
+    ap.arg("--batchtol %f:TOL", &batchtol)
+      .help("With --batchbench, fail if batched and single-point results differ by more than TOL (default: 1e-3)");
     ap.arg("--handle", &use_handle)
       .help("Use texture handle rather than name lookup");
     ap.arg("--searchpath %s:PATHLIST", &searchpath)
@@ -792,6 +808,81 @@ test_plain_texture_batch(Mapping2DWide mapping)
 
 
 
+// Time the same image of lookups made one point at a time and in batches,
+// and make sure both give the same answer. Each region function fills in
+// one ROI of the image it is handed.
+static bool
+benchmark_batch(string_view what, ustring filename,
+                const std::function<void(ImageBuf&, ROI)>& single_region,
+                const std::function<void(ImageBuf&, ROI)>& batch_region)
+{
+    std::cout << "Benchmarking batched vs. single-point " << what << " "
+              << filename << "\n";
+    const int nchannels = 4;
+    ImageSpec outspec(output_xres, output_yres, nchannels, TypeDesc::FLOAT);
+    ImageBuf image(outspec), image_batch(outspec);
+
+    // Warm up the cache so neither side pays for the I/O.
+    single_region(image, get_roi(outspec));
+
+    double range;
+    double single = time_trial(
+        [&]() {
+            for (int iter = 0; iter < iters; ++iter)
+                ImageBufAlgo::parallel_image(get_roi(outspec), nthreads,
+                                             [&](ROI roi) {
+                                                 single_region(image, roi);
+                                             });
+        },
+        ntrials, &range);
+    double batched = time_trial(
+        [&]() {
+            for (int iter = 0; iter < iters; ++iter)
+                ImageBufAlgo::parallel_image(get_roi(outspec), nthreads,
+                                             [&](ROI roi) {
+                                                 batch_region(image_batch,
+                                                              roi);
+                                             });
+        },
+        ntrials, &range);
+
+    auto cr = ImageBufAlgo::compare(image, image_batch, batchtol, batchtol);
+    std::cout << Strutil::sprintf("  single-point: %.3fs\n", single);
+    std::cout << Strutil::sprintf("  batch of %2d:  %.3fs  (%.2fx)\n",
+                                  Tex::BatchWidth, batched,
+                                  single / std::max(batched, 1.0e-9));
+    std::cout << Strutil::sprintf("  max difference %g, %d pixels over %g\n",
+                                  cr.maxerror, int(cr.nfail), batchtol);
+    if (cr.error || cr.nfail) {
+        Strutil::fprintf(std::cerr,
+                         "ERROR: batched and single-point lookups differ "
+                         "by up to %g (%d pixels over %g, worst at %d,%d)\n",
+                         cr.maxerror, int(cr.nfail), batchtol, cr.maxx,
+                         cr.maxy);
+        return false;
+    }
+    return true;
+}
+
+
+
+bool
+benchmark_batch_texture(Mapping2D mapping, Mapping2DWide mapping_wide)
+{
+    ustring filename = filenames[0];
+    return benchmark_batch(
+        "2d texture", filename,
+        [&](ImageBuf& image, ROI roi) {
+            plain_tex_region(image, filename, mapping, nullptr, nullptr, roi);
+        },
+        [&](ImageBuf& image, ROI roi) {
+            plain_tex_region_batch(image, filename, mapping_wide, nullptr,
+                                   nullptr, roi);
+        });
+}
+
+
+
 void
 tex3d_region(ImageBuf& image, ustring filename, Mapping3D mapping, ROI roi)
 {
@@ -952,7 +1043,115 @@ test_texture3d_batch(ustring filename, Mapping3DWide mapping)
 
 
 
-static void test_shadow(ustring /*filename*/) {}
+bool
+benchmark_batch_texture3d(ustring filename, Mapping3D mapping,
+                          Mapping3DWide mapping_wide)
+{
+    return benchmark_batch(
+        "3d texture", filename,
+        [&](ImageBuf& image, ROI roi) {
+            tex3d_region(image, filename, mapping, roi);
+        },
+        [&](ImageBuf& image, ROI roi) {
+            tex3d_region_batch(image, filename, mapping_wide, roi);
+        });
+}
+
+
+
+// Look up a shadow map for the plane z = shadowdepth, with (x,y) taken
+// straight from the map's st coordinates (as for a map without a light
+// projection).
+static void
+shadow_region(ImageBuf& image, ustring filename, Mapping2D mapping, ROI roi)
+{
+    TextureSystem::Perthread* perthread_info     = texsys->get_perthread_info();
+    TextureSystem::TextureHandle* texture_handle = texsys->get_texture_handle(
+        filename);
+    TextureOpt opt;
+    initialize_opt(opt);
+    opt.bias    = shadowbias;
+    opt.samples = shadowsamples;
+
+    for (ImageBuf::Iterator<float> p(image, roi); !p.done(); ++p) {
+        float s, t, dsdx, dtdx, dsdy, dtdy;
+        mapping(p.x(), p.y(), s, t, dsdx, dtdx, dsdy, dtdy);
+        Imath::V3f P(s, t, shadowdepth), dPdx(dsdx, dtdx, 0.0f),
+            dPdy(dsdy, dtdy, 0.0f);
+        float result = 0.0f;
+        bool ok = texsys->shadow(texture_handle, perthread_info, opt, P, dPdx,
+                                 dPdy, &result, nullptr, nullptr);
+        if (!ok) {
+            std::string e = texsys->geterror();
+            if (!e.empty())
+                Strutil::fprintf(std::cerr, "ERROR: %s\n", e);
+        }
+        p[0] = result;
+    }
+}
+
+
+
+static void
+shadow_region_batch(ImageBuf& image, ustring filename, Mapping2DWide mapping,
+                    ROI roi)
+{
+    using namespace Tex;
+    TextureSystem::Perthread* perthread_info     = texsys->get_perthread_info();
+    TextureSystem::TextureHandle* texture_handle = texsys->get_texture_handle(
+        filename);
+    TextureOptBatch opt;
+    initialize_opt(opt);
+    opt.bias    = shadowbias;
+    opt.samples = shadowsamples;
+
+    for (int y = roi.ybegin; y < roi.yend; ++y) {
+        for (int x = roi.xbegin; x < roi.xend; x += BatchWidth) {
+            FloatWide s, t, dsdx, dtdx, dsdy, dtdy;
+            mapping(IntWide::Iota(x), y, s, t, dsdx, dtdx, dsdy, dtdy);
+            FloatWide P[3]    = { s, t, FloatWide(shadowdepth) };
+            FloatWide dPdx[3] = { dsdx, dtdx, FloatWide::Zero() };
+            FloatWide dPdy[3] = { dsdy, dtdy, FloatWide::Zero() };
+            FloatWide result;
+            int npoints  = std::min(BatchWidth, roi.xend - x);
+            RunMask mask = RunMaskOn >> (BatchWidth - npoints);
+            bool ok = texsys->shadow(texture_handle, perthread_info, opt, mask,
+                                     (const float*)P, (const float*)dPdx,
+                                     (const float*)dPdy, (float*)&result,
+                                     nullptr, nullptr);
+            if (!ok) {
+                std::string e = texsys->geterror();
+                if (!e.empty())
+                    Strutil::fprintf(std::cerr, "ERROR: %s\n", e);
+            }
+            float* resultptr = (float*)image.pixeladdr(x, y);
+            for (int i = 0; i < npoints; ++i)
+                resultptr[i] = result[i];
+        }
+    }
+}
+
+
+
+static void
+test_shadow(ustring filename)
+{
+    std::cout << "Testing " << (batch ? "BATCHED " : "") << "shadow "
+              << filename << ", output = " << output_filename << "\n";
+    ImageSpec outspec(output_xres, output_yres, 1, TypeDesc::FLOAT);
+    ImageBuf image(outspec);
+    image.set_write_format(TypeDesc(dataformatname));
+    OIIO::ImageBufAlgo::zero(image);
+    ImageBufAlgo::parallel_image(get_roi(image.spec()), nthreads, [&](ROI roi) {
+        if (batch)
+            shadow_region_batch(image, filename, map_default, roi);
+        else
+            shadow_region(image, filename, map_default, roi);
+    });
+    if (!image.write(output_filename))
+        Strutil::fprintf(std::cerr, "Error writing %s : %s\n", output_filename,
+                         image.geterror());
+}
 
 
 
@@ -960,6 +1159,123 @@ static void test_environment(ustring /*filename*/) {}
 
 
 
+// Map pixels to directions covering the whole sphere the way a y-up
+// latlong environment map is laid out, with the differences to the next
+// pixel over and down as the derivatives.
+static void
+map_env_latlong(const int& x, const int& y, Imath::V3f& R, Imath::V3f& dRdx,
+                Imath::V3f& dRdy)
+{
+    auto dir = [](float x, float y) {
+        float phi   = float(2.0 * M_PI) * (x / output_xres - 0.5f);
+        float theta = float(M_PI) * (0.5f - y / output_yres);
+        return Imath::V3f(-sinf(phi) * cosf(theta), sinf(theta),
+                          cosf(phi) * cosf(theta));
+    };
+    R    = dir(float(x) + 0.5f, float(y) + 0.5f);
+    dRdx = dir(float(x) + 1.5f, float(y) + 0.5f) - R;
+    dRdy = dir(float(x) + 0.5f, float(y) + 1.5f) - R;
+}
+
+
+
+// Batched map_env_latlong, just looping over the scalar version.
+static void
+map_env_latlong(const Tex::IntWide& x, const Tex::IntWide& y,
+                Imath::Vec3<Tex::FloatWide>& R,
+                Imath::Vec3<Tex::FloatWide>& dRdx,
+                Imath::Vec3<Tex::FloatWide>& dRdy)
+{
+    for (int i = 0; i < Tex::BatchWidth; ++i) {
+        Imath::V3f r, rx, ry;
+        map_env_latlong(x[i], y[i], r, rx, ry);
+        for (int c = 0; c < 3; ++c) {
+            R[c][i]    = r[c];
+            dRdx[c][i] = rx[c];
+            dRdy[c][i] = ry[c];
+        }
+    }
+}
+
+
+
+static void
+env_region(ImageBuf& image, ustring filename, ROI roi)
+{
+    TextureSystem::Perthread* perthread_info     = texsys->get_perthread_info();
+    TextureSystem::TextureHandle* texture_handle = texsys->get_texture_handle(
+        filename);
+    int nchannels = image.nchannels();
+    TextureOpt opt;
+    initialize_opt(opt);
+
+    float* result = OIIO_ALLOCA(float, nchannels);
+    for (ImageBuf::Iterator<float> p(image, roi); !p.done(); ++p) {
+        Imath::V3f R, dRdx, dRdy;
+        map_env_latlong(p.x(), p.y(), R, dRdx, dRdy);
+        bool ok = texsys->environment(texture_handle, perthread_info, opt, R,
+                                      dRdx, dRdy, nchannels, result);
+        if (!ok) {
+            std::string e = texsys->geterror();
+            if (!e.empty())
+                Strutil::fprintf(std::cerr, "ERROR: %s\n", e);
+        }
+        image.setpixel(p.x(), p.y(), result);
+    }
+}
+
+
+
+static void
+env_region_batch(ImageBuf& image, ustring filename, ROI roi)
+{
+    using namespace Tex;
+    TextureSystem::Perthread* perthread_info     = texsys->get_perthread_info();
+    TextureSystem::TextureHandle* texture_handle = texsys->get_texture_handle(
+        filename);
+    int nchannels = image.nchannels();
+    TextureOptBatch opt;
+    initialize_opt(opt);
+
+    FloatWide* result = OIIO_ALLOCA(FloatWide, nchannels);
+    for (int y = roi.ybegin; y < roi.yend; ++y) {
+        for (int x = roi.xbegin; x < roi.xend; x += BatchWidth) {
+            Imath::Vec3<FloatWide> R, dRdx, dRdy;
+            map_env_latlong(IntWide::Iota(x), IntWide(y), R, dRdx, dRdy);
+            int npoints  = std::min(BatchWidth, roi.xend - x);
+            RunMask mask = RunMaskOn >> (BatchWidth - npoints);
+            bool ok      = texsys->environment(texture_handle, perthread_info,
+                                               opt, mask, (float*)&R,
+                                               (float*)&dRdx, (float*)&dRdy,
+                                               nchannels, (float*)result);
+            if (!ok) {
+                std::string e = texsys->geterror();
+                if (!e.empty())
+                    Strutil::fprintf(std::cerr, "ERROR: %s\n", e);
+            }
+            float* resultptr = (float*)image.pixeladdr(x, y);
+            for (int c = 0; c < nchannels; ++c)
+                for (int i = 0; i < npoints; ++i)
+                    resultptr[c + i * nchannels] = result[c][i];
+        }
+    }
+}
+
+
+
+static bool
+benchmark_batch_environment(ustring filename)
+{
+    return benchmark_batch(
+        "environment", filename,
+        [&](ImageBuf& image, ROI roi) { env_region(image, filename, roi); },
+        [&](ImageBuf& image, ROI roi) {
+            env_region_batch(image, filename, roi);
+        });
+}
+
+
+
 static void
 test_getimagespec_gettexels(ustring filename)
 {
@@ -1427,6 +1743,7 @@ main(int argc, const char* argv[])
 {
     Filesystem::convert_native_arguments(argc, argv);
     getargs(argc, argv);
+    int retcode = EXIT_SUCCESS;
 
     // environment variable TESTTEX_BATCH can force batch mode
     string_view testtex_batch = Sysutil::getenv("TESTTEX_BATCH");
@@ -1550,7 +1867,20 @@ main(int argc, const char* argv[])
                                  TypeDesc::STRING, &texturetype);
         Timer timer;
         if (!strcmp(texturetype, "Plain Texture")) {
-            if (batch) {
+            if (batchbench) {
+                bool ok;
+                if (nowarp)
+                    ok = benchmark_batch_texture(map_default, map_default);
+                else if (tube)
+                    ok = benchmark_batch_texture(map_tube, map_tube);
+                else if (filtertest)
+                    ok = benchmark_batch_texture(map_filtertest,
+                                                 map_filtertest);
+                else
+                    ok = benchmark_batch_texture(map_warp, map_warp);
+                if (!ok)
+                    retcode = EXIT_FAILURE;
+            } else if (batch) {
                 if (nowarp)
                     test_plain_texture_batch(map_default);
                 else if (tube)
@@ -1572,7 +1902,17 @@ main(int argc, const char* argv[])
             }
         }
         if (!strcmp(texturetype, "Volume Texture")) {
-            if (batch) {
+            if (batchbench) {
+                bool ok;
+                if (nowarp)
+                    ok = benchmark_batch_texture3d(filename, map_default_3D,
+                                                   map_default_3D);
+                else
+                    ok = benchmark_batch_texture3d(filename, map_warp_3D,
+                                                   map_warp_3D);
+                if (!ok)
+                    retcode = EXIT_FAILURE;
+            } else if (batch) {
                 if (nowarp)
                     test_texture3d_batch(filename, map_default_3D);
                 else
@@ -1588,7 +1928,12 @@ main(int argc, const char* argv[])
             test_shadow(filename);
         }
         if (!strcmp(texturetype, "Environment")) {
-            test_environment(filename);
+            if (batchbench) {
+                if (!benchmark_batch_environment(filename))
+                    retcode = EXIT_FAILURE;
+            } else {
+                test_environment(filename);
+            }
         }
         test_getimagespec_gettexels(filename);
         std::cout << "Time: " << Strutil::timeintervalformat(timer()) << "\n";
@@ -1644,5 +1989,5 @@ main(int argc, const char* argv[])
 
     if (verbose)
         std::cout << "\nustrings: " << ustring::getstats(false) << "\n\n";
-    return 0;
+    return retcode;
 }
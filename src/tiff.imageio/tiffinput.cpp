@@ -77,7 +77,8 @@ public:
     virtual bool valid_file(const std::string& filename) const override;
     virtual int supports(string_view feature) const override
     {
-        return (feature == "exif" || feature == "iptc" || feature == "ioproxy");
+        return (feature == "exif" || feature == "iptc" || feature == "ioproxy"
+                || feature == "mmap_pixels");
         // N.B. No support for arbitrary metadata.
     }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
@@ -123,6 +124,8 @@ public:
                             int chbegin, int chend, TypeDesc format, void* data,
                             stride_t xstride, stride_t ystride,
                             stride_t zstride) override;
+    virtual const void* mapped_native_pixels(int subimage,
+                                             int miplevel) override;
     virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
     {
         m_io = ioproxy;
@@ -158,6 +161,8 @@ private:
     std::vector<uint32_t> m_rgbadata;         ///< Sometimes we punt
     std::vector<ImageSpec> m_subimage_specs;  ///< Cached subimage specs
     Filesystem::IOProxy* m_io = nullptr;
+    int m_parallel_chunks     = 0;  ///< Strips/tiles decoded in thread pool
+    int m_serial_chunks       = 0;  ///< Strips/tiles decoded serially
 
     // Reset everything to initial state
     void init()
@@ -174,7 +179,32 @@ private:
         m_colormap.clear();
         m_use_rgba_interface = false;
         m_subimage_specs.clear();
-        m_io = nullptr;
+        m_io              = nullptr;
+        m_parallel_chunks = 0;
+        m_serial_chunks   = 0;
+    }
+
+    // Tally strips/tiles (counting each plane of "separate" files) of the
+    // current subimage that were decoded in the thread pool or serially,
+    // and publish the running totals as "tiff:parallel_chunks" and
+    // "tiff:serial_chunks" in m_spec. The caller must hold the lock.
+    void count_chunks(int parallel, int serial)
+    {
+        if (!parallel && !serial)
+            return;
+        m_parallel_chunks += parallel;
+        m_serial_chunks += serial;
+        m_spec.attribute("tiff:parallel_chunks", m_parallel_chunks);
+        m_spec.attribute("tiff:serial_chunks", m_serial_chunks);
+    }
+
+    // Start the chunk tallies over, for a new subimage.
+    void reset_chunk_counts()
+    {
+        m_parallel_chunks = 0;
+        m_serial_chunks   = 0;
+        m_spec.erase_attribute("tiff:parallel_chunks");
+        m_spec.erase_attribute("tiff:serial_chunks");
     }
 
     // Just close the TIFF file handle, but don't forget anything we
@@ -405,41 +435,24 @@ private:
             }
     }
 
-    void uncompress_one_strip(void* compressed_buf, unsigned long csize,
+    // Copy a height x width x chans region of src to dst, un-applying the
+    // floating point predictor (Adobe Photoshop TIFF Technical Note 3) to
+    // each row in place.
+    void undo_floatingpoint_predictor(unsigned char* data, int chans,
+                                      int width, int height);
+
+    // Can uncompress_one_strip decode our compression and predictor
+    // itself, so that raw strips/tiles may be decoded in parallel?
+    bool can_uncompress_in_parallel() const;
+
+    // Decode one raw strip or tile of height rows of width pixels, each of
+    // chans interleaved channels (1 for separate planarconfig), leaving
+    // strip_bytes of native data in uncompressed_buf. Return false if the
+    // data could not be decoded here (the caller should fall back on
+    // libtiff to read that chunk).
+    bool uncompress_one_strip(const void* compressed_buf, unsigned long csize,
                               void* uncompressed_buf, size_t strip_bytes,
-                              int channels, int width, int height, bool* ok)
-    {
-        OIIO_DASSERT (m_compression == COMPRESSION_ADOBE_DEFLATE /*||
-                      m_compression == COMPRESSION_NONE*/);
-        if (m_compression == COMPRESSION_NONE) {
-            // just copy if there's no compression
-            memcpy(uncompressed_buf, compressed_buf, csize);
-            if (m_is_byte_swapped && m_spec.format == TypeUInt16)
-                TIFFSwabArrayOfShort((unsigned short*)uncompressed_buf,
-                                     width * height * channels);
-            return;
-        }
-        uLong uncompressed_size = (uLong)strip_bytes;
-        auto zok = uncompress((Bytef*)uncompressed_buf, &uncompressed_size,
-                              (const Bytef*)compressed_buf, csize);
-        if (zok != Z_OK || uncompressed_size != strip_bytes) {
-            *ok = false;
-            return;
-        }
-        if (m_is_byte_swapped && m_spec.format == TypeUInt16)
-            TIFFSwabArrayOfShort((unsigned short*)uncompressed_buf,
-                                 width * height * channels);
-        if (m_predictor == PREDICTOR_HORIZONTAL) {
-            if (m_spec.format == TypeUInt8)
-                undo_horizontal_predictor((unsigned char*)uncompressed_buf,
-                                          (unsigned char*)uncompressed_buf,
-                                          channels, width, height);
-            else if (m_spec.format == TypeUInt16)
-                undo_horizontal_predictor((unsigned short*)uncompressed_buf,
-                                          (unsigned short*)uncompressed_buf,
-                                          channels, width, height);
-        }
-    }
+                              int chans, int width, int height);
 
     int tile_index(int x, int y, int z)
     {
@@ -740,6 +753,7 @@ TIFFInput::seek_subimage(int subimage, int miplevel)
         // We're already pointing to the right subimage
         return true;
     }
+    reset_chunk_counts();
 
     // If we're emulating a MIPmap, only resolution is allowed to change
     // between MIP levels, so if we already have a valid level in m_spec,
@@ -1542,6 +1556,51 @@ cmyk_to_rgb(int n, const T* cmyk, size_t cmyk_stride, T* rgb, size_t rgb_stride)
 
 
 
+const void*
+TIFFInput::mapped_native_pixels(int subimage, int miplevel)
+{
+    lock_guard lock(*this);
+    if (!seek_subimage(subimage, miplevel))
+        return nullptr;
+
+    // Only uncompressed contiguous scanline images whose samples fill
+    // whole bytes in our byte order, and which need no color or alpha
+    // conversion, hold their native pixels verbatim in the file.
+    size_t fmtsize = m_spec.format.size();
+    if (m_use_rgba_interface || m_compression != COMPRESSION_NONE
+        || m_spec.tile_width || m_separate
+        || m_planarconfig != PLANARCONFIG_CONTIG
+        || m_bitspersample != int(8 * fmtsize)
+        || (m_is_byte_swapped && fmtsize > 1)
+        || m_inputchannels != m_spec.nchannels
+        || m_photometric == PHOTOMETRIC_PALETTE
+        || m_photometric == PHOTOMETRIC_MINISWHITE
+        || (m_photometric == PHOTOMETRIC_SEPARATED && !m_raw_color)
+        || m_convert_alpha)
+        return nullptr;
+
+    // The strips must also follow one another with no gaps.
+    toff_t* offsets = nullptr;
+    if (!TIFFGetField(m_tif, TIFFTAG_STRIPOFFSETS, &offsets) || !offsets)
+        return nullptr;
+    int nstrips         = (int)TIFFNumberOfStrips(m_tif);
+    imagesize_t stripsz = imagesize_t(m_rowsperstrip > 0
+                                          ? std::min(m_rowsperstrip,
+                                                     m_spec.height)
+                                          : m_spec.height)
+                          * m_spec.scanline_bytes(true);
+    for (int s = 1; s < nstrips; ++s)
+        if (offsets[s] != offsets[0] + s * stripsz)
+            return nullptr;
+
+    cspan<unsigned char> file = mapped_file(m_filename, m_io);
+    if (offsets[0] + m_spec.image_bytes(true) > imagesize_t(file.size()))
+        return nullptr;
+    return file.data() + offsets[0];
+}
+
+
+
 bool
 TIFFInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
                                 void* data)
@@ -1729,6 +1788,221 @@ TIFFInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
 
 
 
+// Decode a TIFF LZW stream (MSB-first codes with "early change", as
+// written by libtiff since 5.0) into exactly outsize bytes. Return false
+// if that's not what the stream holds, including old-style (pre-5.0,
+// LSB-first) LZW, which we leave to libtiff.
+static bool
+lzw_decode(const unsigned char* in, size_t n, unsigned char* out,
+           size_t outsize)
+{
+    enum { Clear = 256, EOI = 257, First = 258, MaxCode = 4096 };
+    if (n >= 2 && in[0] == 0 && (in[1] & 0x1))
+        return false;  // old-style LZW
+    uint16_t prefix[MaxCode], length[MaxCode];
+    unsigned char suffix[MaxCode], firstchar[MaxCode];
+    for (int i = 0; i < 256; ++i) {
+        prefix[i] = 0;
+        length[i] = 1;
+        suffix[i] = firstchar[i] = (unsigned char)i;
+    }
+    const unsigned char *ip = in, *end = in + n;
+    uint32_t bitbuf = 0;
+    int nbufbits = 0, nbits = 9, free_ent = First, oldcode = -1;
+    size_t o = 0;
+    while (o < outsize) {
+        while (nbufbits < nbits && ip < end) {
+            bitbuf = (bitbuf << 8) | *ip++;
+            nbufbits += 8;
+        }
+        if (nbufbits < nbits)
+            break;  // ran out of data without an EOI
+        nbufbits -= nbits;
+        int code = int(bitbuf >> nbufbits) & ((1 << nbits) - 1);
+        if (code == EOI)
+            break;
+        if (code == Clear) {
+            free_ent = First;
+            nbits    = 9;
+            oldcode  = -1;
+            continue;
+        }
+        if (oldcode < 0) {
+            // First code after a Clear is always a literal
+            if (code >= 256)
+                return false;
+            out[o++] = (unsigned char)code;
+            oldcode  = code;
+            continue;
+        }
+        if (code > free_ent || free_ent >= MaxCode)
+            return false;
+        // Add oldcode + first char of this code's string (which, for the
+        // code we're just now defining, is oldcode's first char).
+        prefix[free_ent]    = uint16_t(oldcode);
+        suffix[free_ent]    = firstchar[code < free_ent ? code : oldcode];
+        firstchar[free_ent] = firstchar[oldcode];
+        length[free_ent]    = uint16_t(length[oldcode] + 1);
+        ++free_ent;
+        int len = length[code];
+        if (o + len > outsize)
+            return false;
+        for (int c = code, i = len - 1; i >= 0; c = prefix[c], --i)
+            out[o + i] = suffix[c];
+        o += len;
+        oldcode = code;
+        if (free_ent >= (1 << nbits) - 1 && nbits < 12)
+            ++nbits;
+    }
+    return o == outsize;
+}
+
+
+
+// Decode a PackBits stream into exactly outsize bytes.
+static bool
+packbits_decode(const unsigned char* in, size_t n, unsigned char* out,
+                size_t outsize)
+{
+    const unsigned char *ip = in, *end = in + n;
+    size_t o = 0;
+    while (o < outsize && ip < end) {
+        int b = (signed char)*ip++;
+        if (b >= 0) {
+            // b+1 literal bytes
+            size_t len = size_t(b) + 1;
+            if (len > size_t(end - ip) || o + len > outsize)
+                return false;
+            memcpy(out + o, ip, len);
+            ip += len;
+            o += len;
+        } else if (b != -128) {
+            // -b+1 copies of the next byte
+            size_t len = size_t(-b) + 1;
+            if (ip == end || o + len > outsize)
+                return false;
+            memset(out + o, *ip++, len);
+            o += len;
+        }
+    }
+    return o == outsize;
+}
+
+
+
+void
+TIFFInput::undo_floatingpoint_predictor(unsigned char* data, int chans,
+                                        int width, int height)
+{
+    size_t bytes    = m_spec.format.size();
+    size_t nvals    = size_t(chans) * width;
+    size_t rowbytes = nvals * bytes;
+    std::unique_ptr<unsigned char[]> tmp(new unsigned char[rowbytes]);
+    for (int y = 0; y < height; ++y, data += rowbytes) {
+        for (size_t i = chans; i < rowbytes; ++i)
+            data[i] += data[i - chans];
+        // Byte planes are stored most significant byte first
+        memcpy(tmp.get(), data, rowbytes);
+        for (size_t b = 0; b < bytes; ++b) {
+            size_t plane             = littleendian() ? bytes - 1 - b : b;
+            const unsigned char* src = tmp.get() + plane * nvals;
+            for (size_t i = 0; i < nvals; ++i)
+                data[i * bytes + b] = src[i];
+        }
+    }
+}
+
+
+
+bool
+TIFFInput::can_uncompress_in_parallel() const
+{
+    size_t size = m_spec.format.size();
+    if (m_compression == COMPRESSION_PACKBITS)
+        return m_predictor == PREDICTOR_NONE;
+    if (m_compression != COMPRESSION_ADOBE_DEFLATE
+        && m_compression != COMPRESSION_DEFLATE
+        && m_compression != COMPRESSION_LZW)
+        return false;
+    if (m_predictor == PREDICTOR_NONE)
+        return true;
+    if (m_predictor == PREDICTOR_HORIZONTAL)
+        return size == 1 || size == 2 || size == 4;
+    if (m_predictor == PREDICTOR_FLOATINGPOINT)
+        return m_spec.format == TypeDesc::HALF
+               || m_spec.format == TypeDesc::FLOAT
+               || m_spec.format == TypeDesc::DOUBLE;
+    return false;
+}
+
+
+
+bool
+TIFFInput::uncompress_one_strip(const void* compressed_buf,
+                                unsigned long csize, void* uncompressed_buf,
+                                size_t strip_bytes, int chans, int width,
+                                int height)
+{
+    const unsigned char* cbuf = (const unsigned char*)compressed_buf;
+    unsigned char* ubuf       = (unsigned char*)uncompressed_buf;
+    if (m_compression == COMPRESSION_LZW) {
+        if (!lzw_decode(cbuf, csize, ubuf, strip_bytes))
+            return false;
+    } else if (m_compression == COMPRESSION_PACKBITS) {
+        if (!packbits_decode(cbuf, csize, ubuf, strip_bytes))
+            return false;
+    } else {
+        uLong uncompressed_size = (uLong)strip_bytes;
+        auto zok = uncompress((Bytef*)ubuf, &uncompressed_size,
+                              (const Bytef*)cbuf, csize);
+        if (zok != Z_OK || uncompressed_size != strip_bytes)
+            return false;
+    }
+
+    // The floating point predictor leaves native byte order behind it, so
+    // it's the only case that doesn't need swapping.
+    size_t size = m_spec.format.size();
+    size_t nvals = size_t(chans) * width * height;
+    if (m_predictor == PREDICTOR_FLOATINGPOINT) {
+        undo_floatingpoint_predictor(ubuf, chans, width, height);
+        return true;
+    }
+    if (m_is_byte_swapped) {
+        if (size == 2)
+            TIFFSwabArrayOfShort((unsigned short*)ubuf, tmsize_t(nvals));
+        else if (size == 4)
+            TIFFSwabArrayOfLong((uint32_t*)ubuf, tmsize_t(nvals));
+        else if (size == 8)
+            TIFFSwabArrayOfDouble((double*)ubuf, tmsize_t(nvals));
+    }
+    if (m_predictor == PREDICTOR_HORIZONTAL) {
+        if (size == 1)
+            undo_horizontal_predictor(ubuf, ubuf, chans, width, height);
+        else if (size == 2)
+            undo_horizontal_predictor((unsigned short*)ubuf,
+                                      (unsigned short*)ubuf, chans, width,
+                                      height);
+        else if (size == 4)
+            undo_horizontal_predictor((uint32_t*)ubuf, (uint32_t*)ubuf, chans,
+                                      width, height);
+    }
+    return true;
+}
+
+
+
+// Upper bound on the raw (compressed) size of a chunk that decodes to
+// nbytes, for any of the codecs handled by uncompress_one_strip. (LZW's
+// worst case is a 12 bit code per byte, plus the periodic Clear codes.)
+static size_t
+compressed_bound(size_t nbytes)
+{
+    return std::max(size_t(compressBound((uLong)nbytes)),
+                    nbytes * 3 / 2 + nbytes / 256 + 64);
+}
+
+
+
 bool
 TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
                                  int yend, int z, void* data)
@@ -1772,17 +2046,7 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
 
     // Are we reading raw (compressed) strips and doing the decompression
     // ourselves?
-    bool read_raw_strips =
-        // only deflate/zip compression
-        (m_compression
-         == COMPRESSION_ADOBE_DEFLATE /*|| m_compression == COMPRESSION_NONE*/)
-        // only horizontal predictor (or none)
-        && (m_predictor == PREDICTOR_HORIZONTAL
-            || m_predictor == PREDICTOR_NONE)
-        // contig planarconfig only (for now?)
-        && !m_separate
-        // only uint8, uint16
-        && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16);
+    bool read_raw_strips = can_uncompress_in_parallel();
 
     // We know we wish to read as strips. But additionally, there are some
     // circumstances in which we want to read RAW strips, and do the
@@ -1814,7 +2078,8 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
     int stripvals = m_spec.width * stripchans
                     * m_rowsperstrip;  // values in a strip
     imagesize_t strip_bytes = stripvals * m_spec.format.size();
-    size_t cbound           = compressBound((uLong)strip_bytes);
+    size_t cbound           = compressed_bound(strip_bytes);
+    int strips_in_file = (m_spec.height + m_rowsperstrip - 1) / m_rowsperstrip;
     std::unique_ptr<char[]> compressed_scratch;
     std::unique_ptr<char[]> separate_tmp(
         m_separate ? new char[strip_bytes * nstrips * planes] : nullptr);
@@ -1822,29 +2087,56 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
     if (read_raw_strips) {
         // Make room for, and read the raw (still compressed) strips. As each
         // one is read, kick off the decompress and any other extras, to execute
-        // in parallel.
+        // in parallel. For "separate" planarconfig, the strips of all the
+        // planes of a band of scanlines are decoded by the same task.
         compressed_scratch.reset(new char[cbound * nstrips * planes]);
+        std::vector<tsize_t> csizes(nstrips * planes);
+        std::vector<char> failed(nstrips, 0);  // strips we couldn't decode
+        char* stripdata = (char*)data;
+        size_t nread    = 0;  // full strips read raw
         for (size_t stripidx = 0; y + m_rowsperstrip <= yend;
-             y += m_rowsperstrip, ++stripidx) {
-            char* cbuf        = compressed_scratch.get() + stripidx * cbound;
-            tstrip_t stripnum = (y - m_spec.y) / m_rowsperstrip;
-            tsize_t csize     = TIFFReadRawStrip(m_tif, stripnum, cbuf,
-                                             tmsize_t(cbound));
-            if (csize < 0) {
-                std::string err = oiio_tiff_last_error();
-                errorf("TIFFRead%sStrip failed reading line y=%d,z=%d: %s",
-                       read_raw_strips ? "Raw" : "Encoded", y, z,
-                       err.size() ? err.c_str() : "unknown error");
-                ok = false;
+             y += m_rowsperstrip, ++stripidx, ++nread) {
+            for (int c = 0; c < planes; ++c) {
+                size_t chunk      = stripidx * planes + c;
+                tstrip_t stripnum = (y - m_spec.y) / m_rowsperstrip
+                                    + c * strips_in_file;
+                csizes[chunk]
+                    = TIFFReadRawStrip(m_tif, stripnum,
+                                       compressed_scratch.get() + chunk * cbound,
+                                       tmsize_t(cbound));
             }
+            // Strips that fail to read raw are re-read (and any errors
+            // reported) by the serial fallback below.
             auto out            = this;
-            auto uncompress_etc = [=, &ok](int /*id*/) {
-                out->uncompress_one_strip(cbuf, (unsigned long)csize, data,
-                                          strip_bytes, out->m_spec.nchannels,
-                                          out->m_spec.width,
-                                          out->m_rowsperstrip, &ok);
+            char* cbufs         = compressed_scratch.get();
+            const tsize_t* csz  = csizes.data();
+            char* failedp       = failed.data();
+            char* sepbuf        = m_separate ? separate_tmp.get()
+                                            + stripidx * strip_bytes * planes
+                                                 : nullptr;
+            auto uncompress_etc = [=](int /*id*/) {
+                for (int c = 0; c < planes; ++c) {
+                    size_t chunk = stripidx * planes + c;
+                    char* ubuf = (sepbuf ? sepbuf : (char*)data) + c * strip_bytes;
+                    if (csz[chunk] < 0
+                        || !out->uncompress_one_strip(cbufs + chunk * cbound,
+                                                      (unsigned long)csz[chunk],
+                                                      ubuf, strip_bytes,
+                                                      stripchans,
+                                                      out->m_spec.width,
+                                                      out->m_rowsperstrip)) {
+                        failedp[stripidx] = 1;
+                        return;
+                    }
+                }
+                if (sepbuf)
+                    out->separate_to_contig(planes,
+                                            out->m_spec.width
+                                                * out->m_rowsperstrip,
+                                            (unsigned char*)sepbuf,
+                                            (unsigned char*)data);
                 if (out->m_photometric == PHOTOMETRIC_MINISWHITE)
-                    out->invert_photometric(stripvals * stripchans, data);
+                    out->invert_photometric(stripvals * planes, data);
             };
             if (parallelize) {
                 // Push the rest of the work onto the thread pool queue
@@ -1854,14 +2146,53 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
             }
             data = (char*)data + strip_bytes * planes;
         }
+        tasks.wait();
+
+        // Any strips we couldn't decode ourselves (say, old-style LZW), let
+        // libtiff read serially.
+        int ndecoded = 0;
+        for (size_t stripidx = 0; stripidx < nread; ++stripidx) {
+            if (!failed[stripidx]) {
+                ndecoded += planes;
+                continue;
+            }
+            int sy        = ybegin + int(stripidx) * m_rowsperstrip;
+            char* sdata   = stripdata + stripidx * strip_bytes * planes;
+            char* readbuf = m_separate ? separate_tmp.get()
+                                             + stripidx * strip_bytes * planes
+                                       : sdata;
+            for (int c = 0; c < planes; ++c) {
+                tstrip_t stripnum = (sy - m_spec.y) / m_rowsperstrip
+                                    + c * strips_in_file;
+                if (TIFFReadEncodedStrip(m_tif, stripnum,
+                                         readbuf + c * strip_bytes,
+                                         tmsize_t(strip_bytes))
+                    < 0) {
+                    std::string err = oiio_tiff_last_error();
+                    errorf(
+                        "TIFFReadEncodedStrip failed reading line y=%d,z=%d: %s",
+                        sy, z, err.size() ? err.c_str() : "unknown error");
+                    return false;
+                }
+            }
+            if (m_separate)
+                separate_to_contig(planes, m_spec.width * m_rowsperstrip,
+                                   (unsigned char*)readbuf,
+                                   (unsigned char*)sdata);
+            if (m_photometric == PHOTOMETRIC_MINISWHITE)
+                invert_photometric(stripvals * planes, sdata);
+            count_chunks(0, planes);
+        }
+        if (parallelize)
+            count_chunks(ndecoded, 0);
+        else
+            count_chunks(0, ndecoded);
 
     } else {
         // One of the cases where we don't bother reading raw, we read
         // encoded strips. Still can be a lot more efficient than reading
         // individual scanlines. This is the clause that has to handle
         // "separate" planarconfig.
-        int strips_in_file = (m_spec.height + m_rowsperstrip - 1)
-                             / m_rowsperstrip;
         for (size_t stripidx = 0; y < yend; y += m_rowsperstrip, ++stripidx) {
             int myrps       = std::min(yend - y, m_rowsperstrip);
             int strip_endy  = std::min(y + m_rowsperstrip, yend);
@@ -1896,6 +2227,7 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
             }
             data = (char*)data + mystrip_bytes * planes;
         }
+        count_chunks(0, planes * nstrips);
     }
 
     // If we have left over scanlines, read them serially
@@ -2014,6 +2346,7 @@ TIFFInput::read_native_tile(int subimage, int miplevel, int x, int y, int z,
     if (m_photometric == PHOTOMETRIC_MINISWHITE)
         invert_photometric(nvals, data);
 
+    count_chunks(0, m_separate ? m_spec.nchannels : 1);
     return true;
 }
 
@@ -2032,11 +2365,11 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
 
     // If the stars all align properly, use the thread pool to parallelize
     // the decompression. This can give a large speedup (5x or more!)
-    // because the zip decompression dwarfs the actual raw I/O. But libtiff
-    // is totally serialized, so we can only parallelize by making calls to
-    // zlib ourselves and then writing "raw" (compressed) strips. Don't
-    // bother trying to handle any of the uncommon cases with strips. This
-    // covers most real-world cases.
+    // because the decompression dwarfs the actual raw I/O. But libtiff is
+    // totally serialized, so we can only parallelize by reading "raw"
+    // (compressed) tiles and decoding them ourselves. Don't bother trying
+    // to handle any of the uncommon cases with tiles. This covers most
+    // real-world cases.
     thread_pool* pool = default_thread_pool();
     OIIO_DASSERT(m_spec.tile_depth >= 1);
     size_t ntiles = size_t(
@@ -2051,13 +2384,8 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
             && m_photometric != PHOTOMETRIC_PALETTE)
         // no non-multiple-of-8 bits per sample
         && (spec().format.size() * 8 == m_bitspersample)
-        // contig planarconfig only (for now?)
-        && !m_separate
-        // only deflate/zip compression with horizontal predictor
-        && m_compression == COMPRESSION_ADOBE_DEFLATE
-        && m_predictor == PREDICTOR_HORIZONTAL
-        // only uint8, uint16
-        && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16)
+        // only compression and predictors we know how to decode ourselves
+        && can_uncompress_in_parallel()
         // No other unusual cases
         && !m_use_rgba_interface
         // only if we're threading and don't enter the thread pool recursively!
@@ -2079,19 +2407,27 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
 
     // Make room for, and read the raw (still compressed) tiles. As each one
     // is read, kick off the decompress and any other extras, to execute in
-    // parallel.
+    // parallel. For "separate" planarconfig, each tile is stored as one
+    // single-channel tile per plane, all decoded by the same task.
+    int planes             = m_separate ? m_spec.nchannels : 1;
+    int tilechans          = m_separate ? 1 : m_spec.nchannels;
     stride_t pixel_bytes   = (stride_t)m_spec.pixel_bytes(true);
     stride_t tileystride   = pixel_bytes * m_spec.tile_width;
     stride_t tilezstride   = tileystride * m_spec.tile_height;
     stride_t ystride       = (xend - xbegin) * pixel_bytes;
     stride_t zstride       = (yend - ybegin) * ystride;
     imagesize_t tile_bytes = m_spec.tile_bytes(true);
-    int tilevals           = m_spec.tile_pixels() * m_spec.nchannels;
-    size_t cbound          = compressBound((uLong)tile_bytes);
-    std::unique_ptr<char[]> compressed_scratch(new char[cbound * ntiles]);
+    imagesize_t plane_bytes = tile_bytes / planes;
+    int tilevals            = m_spec.tile_pixels() * m_spec.nchannels;
+    size_t cbound           = compressed_bound(plane_bytes);
+    ttile_t tiles_per_plane = TIFFNumberOfTiles(m_tif) / planes;
+    std::unique_ptr<char[]> compressed_scratch(
+        new char[cbound * ntiles * planes]);
     std::unique_ptr<char[]> scratch(new char[tile_bytes * ntiles]);
+    std::unique_ptr<char[]> separate_tmp(
+        m_separate ? new char[tile_bytes * ntiles] : nullptr);
+    std::vector<char> failed(ntiles, 0);  // tiles we couldn't decode
     task_set tasks(pool);
-    bool ok = true;  // failed compression will stash a false here
 
     // Strutil::printf ("Parallel tile case %d %d  %d %d  %d %d\n",
     //                  xbegin, xend, ybegin, yend, zbegin, zend);
@@ -2099,26 +2435,47 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
     for (int z = zbegin; z < zend; z += m_spec.tile_depth) {
         for (int y = ybegin; y < yend; y += m_spec.tile_height) {
             for (int x = xbegin; x < xend; x += m_spec.tile_width, ++tileidx) {
-                char* cbuf = compressed_scratch.get() + tileidx * cbound;
+                char* cbuf = compressed_scratch.get() + tileidx * planes * cbound;
                 char* ubuf = scratch.get() + tileidx * tile_bytes;
-                auto csize = TIFFReadRawTile(m_tif, tile_index(x, y, z), cbuf,
-                                             tmsize_t(cbound));
-                if (csize < 0) {
-                    std::string err = oiio_tiff_last_error();
-                    errorf(
-                        "TIFFReadRawTile failed reading tile x=%d,y=%d,z=%d: %s",
-                        x, y, z, err.size() ? err.c_str() : "unknown error");
-                    return false;
+                char* sepbuf = m_separate
+                                   ? separate_tmp.get() + tileidx * tile_bytes
+                                   : nullptr;
+                std::vector<tsize_t> csize(planes);
+                for (int c = 0; c < planes; ++c) {
+                    csize[c] = TIFFReadRawTile(m_tif,
+                                               tile_index(x, y, z)
+                                                   + c * tiles_per_plane,
+                                               cbuf + c * cbound,
+                                               tmsize_t(cbound));
+                    if (csize[c] < 0) {
+                        std::string err = oiio_tiff_last_error();
+                        errorf(
+                            "TIFFReadRawTile failed reading tile x=%d,y=%d,z=%d: %s",
+                            x, y, z, err.size() ? err.c_str() : "unknown error");
+                        return false;
+                    }
                 }
                 // Push the rest of the work onto the thread pool queue
-                auto out = this;
-                tasks.push(pool->push([=, &ok](int /*id*/) {
-                    out->uncompress_one_strip(cbuf, (unsigned long)csize, ubuf,
-                                              tile_bytes, out->m_spec.nchannels,
-                                              out->m_spec.tile_width,
-                                              out->m_spec.tile_height
-                                                  * out->m_spec.tile_depth,
-                                              &ok);
+                auto out      = this;
+                char* failedp = failed.data();
+                tasks.push(pool->push([=](int /*id*/) {
+                    for (int c = 0; c < planes; ++c) {
+                        char* pbuf = (sepbuf ? sepbuf : ubuf) + c * plane_bytes;
+                        if (!out->uncompress_one_strip(
+                                cbuf + c * cbound, (unsigned long)csize[c],
+                                pbuf, plane_bytes, tilechans,
+                                out->m_spec.tile_width,
+                                out->m_spec.tile_height
+                                    * out->m_spec.tile_depth)) {
+                            failedp[tileidx] = 1;
+                            return;
+                        }
+                    }
+                    if (sepbuf)
+                        out->separate_to_contig(planes,
+                                                out->m_spec.tile_pixels(),
+                                                (unsigned char*)sepbuf,
+                                                (unsigned char*)ubuf);
                     if (out->m_photometric == PHOTOMETRIC_MINISWHITE)
                         out->invert_photometric(tilevals, ubuf);
                     copy_image(out->m_spec.nchannels, out->m_spec.tile_width,
@@ -2133,7 +2490,35 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
             }
         }
     }
-    return ok;
+    tasks.wait();
+
+    // Any tiles we couldn't decode ourselves (say, old-style LZW), let
+    // libtiff read serially (read_native_tile counts those).
+    tileidx = 0;
+    int ndecoded = 0;
+    for (int z = zbegin; z < zend; z += m_spec.tile_depth) {
+        for (int y = ybegin; y < yend; y += m_spec.tile_height) {
+            for (int x = xbegin; x < xend; x += m_spec.tile_width, ++tileidx) {
+                if (!failed[tileidx]) {
+                    ndecoded += planes;
+                    continue;
+                }
+                char* ubuf = scratch.get() + tileidx * tile_bytes;
+                if (!read_native_tile(subimage, miplevel, x, y, z, ubuf))
+                    return false;
+                copy_image(m_spec.nchannels, m_spec.tile_width,
+                           m_spec.tile_height, m_spec.tile_depth, ubuf,
+                           size_t(pixel_bytes), pixel_bytes, tileystride,
+                           tilezstride,
+                           (char*)data + (z - zbegin) * zstride
+                               + (y - ybegin) * ystride
+                               + (x - xbegin) * pixel_bytes,
+                           pixel_bytes, ystride, zstride);
+            }
+        }
+    }
+    count_chunks(ndecoded, 0);
+    return true;
 }
 
 
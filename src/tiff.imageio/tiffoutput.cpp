@@ -70,6 +70,7 @@ private:
     int m_planarconfig;
     int m_compression;
     int m_predictor;
+    int m_zipquality;  // zlib level for our own parallel deflate
     int m_photometric;
     int m_rowsperstrip;
     unsigned int m_bitspersample;  ///< Of the *file*, not the client's view
@@ -83,6 +84,7 @@ private:
         m_checkpointItems     = 0;
         m_compression         = COMPRESSION_ADOBE_DEFLATE;
         m_predictor           = PREDICTOR_NONE;
+        m_zipquality          = Z_DEFAULT_COMPRESSION;
         m_photometric         = PHOTOMETRIC_RGB;
         m_rowsperstrip        = 32;
         m_outputchans         = 0;
@@ -139,6 +141,19 @@ private:
             }
     }
 
+    // Apply the TIFF floating point predictor (Adobe Photoshop TIFF
+    // Technical Note 3) in place to each of the height rows of data: split
+    // each row into byte planes, most significant byte first, then
+    // difference the bytes horizontally.
+    void floatingpoint_predictor(unsigned char* data, int chans, int width,
+                                 int height);
+
+    // Can compress_one_strip handle our compression and predictor itself?
+    bool can_compress_in_parallel() const;
+
+    // Upper bound on the compressed size of a strip of strip_bytes.
+    static size_t compress_bound(size_t strip_bytes);
+
     void compress_one_strip(void* uncompressed_buf, size_t strip_bytes,
                             void* compressed_buf, unsigned long cbound,
                             int channels, int width, int height,
@@ -480,7 +495,8 @@ TIFFOutput::open(const std::string& name, const ImageSpec& userspec,
     TIFFSetField(m_tif, TIFFTAG_COMPRESSION, m_compression);
 
     // Use predictor when using compression
-    m_predictor = PREDICTOR_NONE;
+    m_predictor  = PREDICTOR_NONE;
+    m_zipquality = Z_DEFAULT_COMPRESSION;
     if (m_compression == COMPRESSION_LZW
         || m_compression == COMPRESSION_ADOBE_DEFLATE) {
         if (m_spec.format == TypeDesc::FLOAT
@@ -500,9 +516,10 @@ TIFFOutput::open(const std::string& name, const ImageSpec& userspec,
             TIFFSetField(m_tif, TIFFTAG_PREDICTOR, m_predictor);
         if (m_compression == COMPRESSION_ADOBE_DEFLATE) {
             qual = m_spec.get_int_attribute("tiff:zipquality", qual);
-            if (qual > 0)
-                TIFFSetField(m_tif, TIFFTAG_ZIPQUALITY,
-                             OIIO::clamp(qual, 1, 9));
+            if (qual > 0) {
+                m_zipquality = OIIO::clamp(qual, 1, 9);
+                TIFFSetField(m_tif, TIFFTAG_ZIPQUALITY, m_zipquality);
+            }
         }
     } else if (m_compression == COMPRESSION_JPEG) {
         if (qual <= 0)
@@ -1068,24 +1085,151 @@ TIFFOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
 
 
 
+// Encode n bytes with the TIFF flavor of LZW (MSB-first codes, explicit
+// Clear/EOI codes, and "early change" code width bumps), the same stream
+// libtiff's LZWEncode would produce. The caller must supply an output
+// buffer of at least compress_bound(n) bytes. Return the encoded length.
+static size_t
+lzw_encode(const unsigned char* in, size_t n, unsigned char* out)
+{
+    enum { Clear = 256, EOI = 257, First = 258, Full = 4094, HashBits = 13 };
+    const uint32_t hashsize = 1 << HashBits;
+    std::vector<int32_t> keys(hashsize, -1);  // (prefix << 8) | byte
+    std::vector<uint16_t> codes(hashsize);
+    unsigned char* op = out;
+    uint32_t bitbuf   = 0;
+    int nbufbits = 0, nbits = 9, free_ent = First;
+    auto put = [&](int code) {
+        bitbuf = (bitbuf << nbits) | uint32_t(code);
+        for (nbufbits += nbits; nbufbits >= 8; nbufbits -= 8)
+            *op++ = (unsigned char)(bitbuf >> (nbufbits - 8));
+    };
+    // Account for one more table entry (which the decoder will also add),
+    // widening the codes or starting over when the table fills.
+    auto next_entry = [&]() {
+        if (++free_ent == Full) {
+            put(Clear);
+            std::fill(keys.begin(), keys.end(), -1);
+            free_ent = First;
+            nbits    = 9;
+        } else if (free_ent > (1 << nbits) - 1) {
+            ++nbits;
+        }
+    };
+
+    put(Clear);
+    if (n) {
+        int ent = in[0];
+        for (size_t i = 1; i < n; ++i) {
+            int32_t key = (ent << 8) | in[i];
+            uint32_t h  = (uint32_t(key) * 2654435761u) >> (32 - HashBits);
+            while (keys[h] != -1 && keys[h] != key)
+                h = (h + 1) & (hashsize - 1);
+            if (keys[h] == key) {
+                ent = codes[h];
+                continue;
+            }
+            put(ent);
+            keys[h]  = key;
+            codes[h] = uint16_t(free_ent);
+            ent      = in[i];
+            next_entry();
+        }
+        put(ent);
+        next_entry();
+    }
+    put(EOI);
+    if (nbufbits > 0)
+        *op++ = (unsigned char)(bitbuf << (8 - nbufbits));
+    return size_t(op - out);
+}
+
+
+
+void
+TIFFOutput::floatingpoint_predictor(unsigned char* data, int chans, int width,
+                                    int height)
+{
+    size_t bytes    = m_spec.format.size();
+    size_t nvals    = size_t(chans) * width;
+    size_t rowbytes = nvals * bytes;
+    std::unique_ptr<unsigned char[]> tmp(new unsigned char[rowbytes]);
+    for (int y = 0; y < height; ++y, data += rowbytes) {
+        memcpy(tmp.get(), data, rowbytes);
+        for (size_t b = 0; b < bytes; ++b) {
+            size_t plane = littleendian() ? bytes - 1 - b : b;
+            unsigned char* dst = data + plane * nvals;
+            for (size_t i = 0; i < nvals; ++i)
+                dst[i] = tmp[i * bytes + b];
+        }
+        for (size_t i = rowbytes - 1; i >= size_t(chans); --i)
+            data[i] -= data[i - chans];
+    }
+}
+
+
+
+bool
+TIFFOutput::can_compress_in_parallel() const
+{
+    if (m_compression != COMPRESSION_ADOBE_DEFLATE
+        && m_compression != COMPRESSION_LZW)
+        return false;
+    if (m_predictor == PREDICTOR_NONE)
+        return true;
+    if (m_predictor == PREDICTOR_HORIZONTAL)
+        return m_spec.format.size() == 1 || m_spec.format.size() == 2;
+    if (m_predictor == PREDICTOR_FLOATINGPOINT)
+        return m_spec.format == TypeDesc::HALF
+               || m_spec.format == TypeDesc::FLOAT
+               || m_spec.format == TypeDesc::DOUBLE;
+    return false;
+}
+
+
+
+size_t
+TIFFOutput::compress_bound(size_t strip_bytes)
+{
+    // LZW's worst case is a 12 bit code per input byte, plus the periodic
+    // Clear codes.
+    size_t lzwbound = strip_bytes * 3 / 2 + strip_bytes / 256 + 64;
+    return std::max(size_t(compressBound((uLong)strip_bytes)), lzwbound);
+}
+
+
+
 void
 TIFFOutput::compress_one_strip(void* uncompressed_buf, size_t strip_bytes,
                                void* compressed_buf, unsigned long cbound,
                                int channels, int width, int height,
                                unsigned long* compressed_size, bool* ok)
 {
-    if (m_spec.format == TypeUInt8)
-        horizontal_predictor((unsigned char*)uncompressed_buf,
-                             (unsigned char*)uncompressed_buf, channels, width,
-                             height);
-    else if (m_spec.format == TypeUInt16)
-        horizontal_predictor((unsigned short*)uncompressed_buf,
-                             (unsigned short*)uncompressed_buf, channels, width,
-                             height);
+    if (m_predictor == PREDICTOR_HORIZONTAL) {
+        if (m_spec.format.size() == 1)
+            horizontal_predictor((unsigned char*)uncompressed_buf,
+                                 (unsigned char*)uncompressed_buf, channels,
+                                 width, height);
+        else if (m_spec.format.size() == 2)
+            horizontal_predictor((unsigned short*)uncompressed_buf,
+                                 (unsigned short*)uncompressed_buf, channels,
+                                 width, height);
+    } else if (m_predictor == PREDICTOR_FLOATINGPOINT) {
+        floatingpoint_predictor((unsigned char*)uncompressed_buf, channels,
+                                width, height);
+    }
+    if (m_compression == COMPRESSION_LZW) {
+        *compressed_size = (unsigned long)lzw_encode(
+            (const unsigned char*)uncompressed_buf, strip_bytes,
+            (unsigned char*)compressed_buf);
+        if (*compressed_size > cbound)
+            *ok = false;
+        return;
+    }
     *compressed_size = cbound;
-    auto zok         = compress((Bytef*)compressed_buf, compressed_size,
-                        (const Bytef*)uncompressed_buf,
-                        (unsigned long)strip_bytes);
+    auto zok         = compress2((Bytef*)compressed_buf, compressed_size,
+                         (const Bytef*)uncompressed_buf,
+                         (unsigned long)strip_bytes, m_zipquality);
     if (zok != Z_OK)
         *ok = false;
 }
@@ -1099,9 +1243,9 @@ TIFFOutput::write_scanlines(int ybegin, int yend, int z, TypeDesc format,
 {
     // If the stars all align properly, try to write strips, and use the
     // thread pool to parallelize the compression. This can give a large
-    // speedup (5x or more!) because the zip compression dwarfs the
+    // speedup (5x or more!) because the zip/LZW compression dwarfs the
     // actual raw I/O. But libtiff is totally serialized, so we can only
-    // parallelize by making calls to zlib ourselves and then writing
+    // parallelize by compressing ourselves (zlib or lzw_encode) and writing
     // "raw" (compressed) strips. Don't bother trying to handle any of
     // the uncommon cases with strips. This covers most real-world cases.
     thread_pool* pool = default_thread_pool();
@@ -1119,11 +1263,8 @@ TIFFOutput::write_scanlines(int ybegin, int yend, int z, TypeDesc format,
         && (spec().format.size() * 8 == m_bitspersample)
         // contig planarconfig only
         && m_planarconfig == PLANARCONFIG_CONTIG
-        // only deflate/zip compression with horizontal predictor
-        && m_compression == COMPRESSION_ADOBE_DEFLATE
-        && m_predictor == PREDICTOR_HORIZONTAL
-        // only uint8, uint16
-        && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16)
+        // only deflate/zip or LZW, with a predictor we can apply ourselves
+        && can_compress_in_parallel()
         // only if we're threading and don't enter the thread pool recursively!
         && pool->size() > 1
         && !pool->is_worker()
@@ -1162,7 +1303,7 @@ TIFFOutput::write_scanlines(int ybegin, int yend, int z, TypeDesc format,
     memcpy(scratch.get(), data, scratch_bytes);
     data                    = scratch.get();
     imagesize_t strip_bytes = m_spec.scanline_bytes(true) * m_rowsperstrip;
-    size_t cbound           = compressBound((uLong)strip_bytes);
+    size_t cbound           = compress_bound(strip_bytes);
     std::unique_ptr<char[]> compressed_scratch(new char[cbound * nstrips]);
     unsigned long* compressed_len;
     OIIO_ALLOCATE_STACK_OR_HEAP(compressed_len, unsigned long, nstrips);
@@ -1328,11 +1469,11 @@ TIFFOutput::write_tiles(int xbegin, int xend, int ybegin, int yend, int zbegin,
 
     // If the stars all align properly, try to use the thread pool to
     // parallelize the compression of the tiles. This can give a large
-    // speedup (5x or more!) because the zip compression dwarfs the actual
-    // raw I/O. But libtiff is totally serialized, so we can only
-    // parallelize by making calls to zlib ourselves and then writing "raw"
-    // (compressed) strips. Don't bother trying to handle any of the
-    // uncommon cases with strips. This covers most real-world cases.
+    // speedup (5x or more!) because the zip/LZW compression dwarfs the
+    // actual raw I/O. But libtiff is totally serialized, so we can only
+    // parallelize by compressing ourselves (zlib or lzw_encode) and then
+    // writing "raw" (compressed) tiles. Don't bother trying to handle any of
+    // the uncommon cases with strips. This covers most real-world cases.
     thread_pool* pool = default_thread_pool();
     OIIO_DASSERT(m_spec.tile_depth >= 1);
     size_t ntiles = size_t(
@@ -1349,11 +1490,8 @@ TIFFOutput::write_tiles(int xbegin, int xend, int ybegin, int yend, int zbegin,
         && (spec().format.size() * 8 == m_bitspersample)
         // contig planarconfig only
         && m_planarconfig == PLANARCONFIG_CONTIG
-        // only deflate/zip compression with horizontal predictor
-        && m_compression == COMPRESSION_ADOBE_DEFLATE
-        && m_predictor == PREDICTOR_HORIZONTAL
-        // only uint8, uint16
-        && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16)
+        // only deflate/zip or LZW, with a predictor we can apply ourselves
+        && can_compress_in_parallel()
         // only if we're threading and don't enter the thread pool recursively!
         && pool->size() > 1
         && !pool->is_worker()
@@ -1375,7 +1513,7 @@ TIFFOutput::write_tiles(int xbegin, int xend, int ybegin, int yend, int zbegin,
     // Allocate various temporary space we need
     stride_t tile_bytes = (stride_t)m_spec.tile_bytes(true);
     std::vector<std::vector<unsigned char>> tilebuf(ntiles);
-    size_t cbound = compressBound((uLong)tile_bytes);
+    size_t cbound = compress_bound(tile_bytes);
     std::unique_ptr<char[]> compressed_scratch(new char[ntiles * cbound]);
     unsigned long* compressed_len = OIIO_ALLOCA(unsigned long, ntiles);
 
@@ -1426,7 +1564,7 @@ TIFFOutput::write_tiles(int xbegin, int xend, int ybegin, int yend, int zbegin,
                     if (buf == (const void*)tilestart) {
                         // Ugly detail: if to_native_rectangle did not allocate
                         // scratch space and copy to it, we need to do it now,
-                        // because the horizontal predictor is destructive.
+                        // because the predictors are destructive.
                         tilebuf[tileno].assign((char*)buf,
                                                ((char*)buf)
                                                    + m_spec.tile_bytes(true));
@@ -0,0 +1,32 @@
+#!/usr/bin/env python
+
+# With -q, idiff compares in bands of 1024 scanlines (for this width) and
+# stops as soon as the images are known to fail. Check that it reaches the
+# same verdict (exit code) as a full comparison, whether the failure shows
+# up in the first band, only in the last one, or only once the failures of
+# several bands add up to more than -failpercent. The images are black
+# with flat patches, so which pixels differ, and by how much, is exact.
+
+command += oiiotool ("--create 1024x2100 3 -d uint8 -o a.tif")
+command += oiiotool ("a.tif --fill:color=1,0,0 1024x512+0+0 -o early.tif")
+command += oiiotool ("a.tif --fill:color=1,0,0 4x4+500+2090 -o late.tif")
+# 700 differing rows in each of the first two bands: a third of the image
+# after the first band, two thirds after the second.
+command += oiiotool ("a.tif --fill:color=1,0,0 1024x700+0+0 "
+                     + "--fill:color=1,0,0 1024x700+0+1100 -o percent.tif")
+# Every pixel off by 5/255, between -warn and -fail.
+command += oiiotool ("a.tif --fill:color=0.02,0.02,0.02 1024x2100+0+0 "
+                     + "-o warn.tif")
+
+def idiff_exit (name, args) :
+    global command
+    for q in [ " -q", "" ] :
+        command += (oiio_app("idiff") + q + " " + args + " > /dev/null 2>&1"
+                    + " && echo '" + name + q + ": exit 0' >> out.txt"
+                    + " || echo '" + name + q + ": exit '$? >> out.txt ;\n")
+
+idiff_exit ("same", "a.tif a.tif")
+idiff_exit ("early", "a.tif early.tif")
+idiff_exit ("late", "a.tif late.tif")
+idiff_exit ("percent", "-failpercent 50 a.tif percent.tif")
+idiff_exit ("warn", "-fail 0.05 -warn 0.01 a.tif warn.tif")
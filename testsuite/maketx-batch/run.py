@@ -0,0 +1,36 @@
+#!/usr/bin/env python
+
+# Test maketx with several inputs at once: a UDIM set and a list of files
+# converted concurrently (--jobs 2) must give the same textures as
+# converting each file alone. Also check the output naming and the usage
+# errors.
+
+maketx = oiio_app("maketx")
+tiles = [ ("1001", ".5,.1,.1"), ("1002", ".1,.5,.1"),
+          ("1011", ".1,.1,.5"), ("1012", ".1,.5,.5") ]
+for (tile, color) in tiles :
+    command += oiiotool ("--pattern constant:color=" + color + " 96x64 3 "
+                         + "--pattern checker:width=8:height=8:color1=0,0,0:color2=.2,.2,.2 96x64 3 "
+                         + "--add -d uint8 -o tile." + tile + ".tif")
+    command += maketx_command ("tile." + tile + ".tif", "single." + tile + ".tx")
+
+# UDIM input and output. The batch summary has timings in it, so don't
+# keep it.
+command += (maketx + " \"tile.<UDIM>.tif\" --jobs 2 -o \"udim.<UDIM>.tx\""
+            + " > udim.log ;\n")
+for (tile, color) in tiles :
+    command += diff_command ("udim." + tile + ".tx", "single." + tile + ".tx")
+
+# Several inputs into a directory, named after the inputs
+command += "mkdir -p outdir ;\n"
+command += (maketx + " tile.1001.tif tile.1012.tif --jobs 2 -o outdir"
+            + " > outdir.log ;\n")
+command += diff_command ("outdir/tile.1001.tx", "single.1001.tx")
+command += diff_command ("outdir/tile.1012.tx", "single.1012.tx")
+
+# Errors: several inputs into one file, and a UDIM pattern with no tiles
+command += maketx + " tile.1001.tif tile.1002.tif -o both.tx" + redirect + " 2>&1 ;\n"
+command += maketx + " \"missing.<UDIM>.tif\" -o \"missing.<UDIM>.tx\"" + redirect + " 2>&1 ;\n"
+
+# The error cases are supposed to fail
+failureok = 1
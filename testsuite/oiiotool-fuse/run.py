@@ -0,0 +1,23 @@
+#!/usr/bin/env python
+
+# Run chains of ops with and without --fuse, and check that deferring and
+# fusing the pointwise ones gives the same pixels as running each op on
+# the whole image. The chains mix in ops that can't be fused (--ch,
+# --clamp) and so break a chain into pieces.
+
+command += oiiotool ("--pattern fill:topleft=0,0,0,1:topright=1,0.5,0,1:bottomleft=0,0.5,1,0.5:bottomright=1,1,1,0.25 300x200 4 -d float -o a.exr")
+command += oiiotool ("--pattern checker:width=16:height=16:color1=0.1,0.2,0.3,1:color2=0.7,0.5,0.2,0.5 300x200 4 -d float -o b.exr")
+
+chains = [
+    ("unary",        "a.exr --mulc 0.5 --addc 0.1 --powc 1.2 --abs"),
+    ("binary",       "a.exr b.exr --add --mulc 0.5 b.exr --sub --absdiffc 0.1"),
+    ("mad",          "a.exr --mulc 2 b.exr a.exr --mad --divc 3"),
+    ("ch",           "a.exr --mulc 2 --ch R,G,B --addc 0.1 b.exr --ch R,G,B --mul"),
+    ("clamp",        "a.exr --mulc 2 --clamp:min=0:max=1 --subc 0.25 --abs --maxc 0.1"),
+    ("colorconvert", "a.exr --unpremult --colorconvert linear sRGB --premult --mulc 0.9"),
+    ("mixed",        "a.exr --ch R,G,B --colorconvert linear sRGB b.exr --ch R,G,B --absdiff --mulc 4 --clamp"),
+]
+for (name, chain) in chains :
+    command += oiiotool (chain + " -d float -o " + name + ".exr")
+    command += oiiotool ("--fuse " + chain + " -d float -o " + name + "-fused.exr")
+    command += diff_command (name + "-fused.exr", name + ".exr")
@@ -0,0 +1,28 @@
+#!/usr/bin/env python
+
+# Run the same frame sequences serially and with --parallel-frames 2, and
+# check that the outputs and the (frame ordered) console logs match.
+
+# A short sequence of source frames that differ from each other
+command += oiiotool ("--frames 1-6 --pattern \"constant:color={FRAME_NUMBER/10},0.5,0.25\" 32x32 3 -d uint8 -o src.#.tif")
+
+def run_both (name, args) :
+    global command
+    for (prefix, extra) in [ ("serial", ""), ("parallel", "--parallel-frames 2 ") ] :
+        command += (oiiotool (extra + args.replace("OUT", prefix),
+                              silent=True, concat=False)
+                    + " > " + name + "-" + prefix + ".log 2>&1 ;\n")
+    command += ("diff " + name + "-serial.log " + name + "-parallel.log"
+                + redirect + " ;\n")
+
+# Image outputs, with some per-frame console output
+run_both ("resize", "--frames 1-6 src.#.tif --echo \"frame {FRAME_NUMBER} {TOP.width}x{TOP.height}\" --resize 16x16 -o OUT.#.tif")
+for f in range(1, 7) :
+    command += diff_command ("serial.%04d.tif" % f, "parallel.%04d.tif" % f)
+
+# Options that only print, or suppress output, must reach the main
+# thread's state or oiiotool warns that it produced no output.
+run_both ("stats", "--frames 1-6 --stats src.#.tif")
+run_both ("dumpdata", "--frames 1-3 --dumpdata src.#.tif --resize 2x2")
+run_both ("dryrun", "--frames 1-6 -n src.#.tif --resize 16x16")
+run_both ("info", "--frames 1-6 --info src.#.tif")
@@ -0,0 +1,22 @@
+#!/usr/bin/env python
+
+# Write --fuse chains in bands with --stream 1 (at most 1 MB per band),
+# and check the results match writing the whole image at once. The
+# source is big enough to take several bands, and its height (500) is not
+# a multiple of the tile heights, so the last band holds partial tiles.
+
+command += oiiotool ("--pattern fill:topleft=0,0,0,1:topright=1,0.5,0,1:bottomleft=0,0.5,1,0.5:bottomright=1,1,1,0.25 600x500 4 -d float -o src.exr")
+command += oiiotool ("--pattern checker:width=24:height=24:color1=0.1,0.2,0.3,1:color2=0.7,0.5,0.2,0.5 600x500 4 -d float -o checker.exr")
+
+outputs = [
+    # name, output options
+    ("scanline.tif",  "-d float --scanline"),
+    ("scanline8.tif", "-d uint8 --scanline"),
+    ("tiled.tif",     "-d float --tile 64 64"),
+    ("tiled48.exr",   "-d half --tile 32 48"),
+]
+chain = "src.exr --mulc 0.5 --addc 0.1 checker.exr --mul --powc 0.8"
+for (name, args) in outputs :
+    command += oiiotool (chain + " " + args + " -o " + name)
+    command += oiiotool ("--stream 1 " + chain + " " + args + " -o stream-" + name)
+    command += diff_command ("stream-" + name, name)
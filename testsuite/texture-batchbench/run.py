@@ -0,0 +1,24 @@
+#!/usr/bin/env python
+
+# Render the same image with single-point and with batched texture lookups
+# and fail if they disagree by more than the tolerance. The timings are
+# not deterministic, so the output is not compared, only the exit status.
+command += testtex_command ("../common/textures/grid.tx",
+                            "--batchbench --batchtol 0.001 -res 128 128",
+                            silent=True)
+command += testtex_command ("../common/textures/grid.tx",
+                            "--batchbench --batchtol 0.001 -res 128 128 -interpmode 1 --tube",
+                            silent=True)
+command += testtex_command ("../common/textures/grid.tx",
+                            "--batchbench --batchtol 0.001 -res 128 128 -interpmode 0 --nowarp",
+                            silent=True)
+
+# The same for a latlong environment map, over the whole sphere.
+command += oiiotool ("--pattern checker:width=16:height=16 256x128 3 -d half -o envsrc.exr",
+                     silent=True)
+command += maketx_command ("envsrc.exr", "env.tx", "--envlatl", silent=True)
+command += testtex_command ("env.tx",
+                            "--batchbench --batchtol 0.001 -res 128 64",
+                            silent=True)
+
+outputs = [ ]
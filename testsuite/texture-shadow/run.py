@@ -0,0 +1,40 @@
+#!/usr/bin/env python
+
+# Shadow map of a known depth "plane": the left half of the map is at
+# depth 0.25, the right half at 1.0. With no light projection in the
+# file, each lookup P is (s, t, depth).
+command += oiiotool ("--pattern constant:color=1.0 64x64 1 --box:color=0.25:fill=1 0,0,31,63 -d float -o depth.exr")
+command += maketx_command ("depth.exr", "shadow.tx", "--shadow")
+
+# Expected results: the left half occluded, nothing occluded, and the
+# penumbra that 4 taps spread over a 0.5 wide blur give across the edge
+# (the taps land on texel centers 4 and 12 texels either side of each
+# pixel, so every pixel is 0, 1/4, 1/2, 3/4 or 1).
+command += oiiotool ("--pattern constant:color=0 64x64 1 --box:color=1:fill=1 0,0,31,63 -d float -o expect-occluded.exr")
+command += oiiotool ("--pattern constant:color=0 64x64 1 -d float -o expect-lit.exr")
+command += oiiotool ("--pattern constant:color=0 64x64 1 "
+                     + "--box:color=0.5:fill=1 0,0,3,63 "
+                     + "--box:color=0.75:fill=1 4,0,11,63 "
+                     + "--box:color=1:fill=1 12,0,19,63 "
+                     + "--box:color=0.75:fill=1 20,0,27,63 "
+                     + "--box:color=0.5:fill=1 28,0,35,63 "
+                     + "--box:color=0.25:fill=1 36,0,43,63 "
+                     + "-d float -o expect-penumbra.exr")
+
+tests = [
+    # name, testtex arguments, expected image
+    ("occluded",  "--shadowdepth 0.5", "expect-occluded.exr"),
+    ("unbiased",  "--shadowdepth 0.3", "expect-occluded.exr"),
+    ("biased",    "--shadowdepth 0.3 --bias 0.1", "expect-lit.exr"),
+    ("lit",       "--shadowdepth 0.2", "expect-lit.exr"),
+    ("samples1",  "--shadowdepth 0.5 --stblur 0.5 0 --width 0 --samples 1", "expect-occluded.exr"),
+    ("penumbra",  "--shadowdepth 0.5 --stblur 0.5 0 --width 0 --samples 16", "expect-penumbra.exr"),
+]
+for (name, args, expected) in tests :
+    args = "--nowarp -res 64 64 -d float " + args
+    command += testtex_command ("shadow.tx", args + " -o " + name + ".exr",
+                                silent=True)
+    command += testtex_command ("shadow.tx", args + " --batch -o " + name + "-batch.exr",
+                                silent=True)
+    command += diff_command (name + ".exr", expected)
+    command += diff_command (name + "-batch.exr", name + ".exr")
@@ -0,0 +1,52 @@
+#!/usr/bin/env python
+
+# Round trips of TIFF compression through libtiff's own tools, to make sure
+# that our parallel compressors write streams that libtiff can decode.
+# This test is only run if libtiff's "tiffcp" was found.
+
+# A smooth gradient with a little noise, so the predictors and LZW both
+# have something to chew on.
+pattern = ("--pattern fill:topleft=0,0,0:topright=1,0,0:bottomleft=0,1,0:bottomright=0,0,1 100x75 3"
+           + " --pattern noise:type=uniform:min=0:max=0.1:seed=3 100x75 3 --add")
+
+# 100x75 has a partial last strip (32 rows per strip), and the tile sizes
+# give partial tiles on the right and bottom edges.
+layouts = [ ("strips", ""),
+            ("tiled32x32", "--tile 32 32"),
+            ("tiled64x16", "--tile 64 16") ]
+
+# Write with OIIO, have tiffcp decode it and rewrite it uncompressed, and
+# compare that to an uncompressed file written by OIIO. uint8 and uint16
+# get the horizontal predictor (2), half and float get the floating point
+# predictor (3), and uint32 gets no predictor.
+for fmt in [ "uint8", "uint16", "uint32", "half", "float" ] :
+    for (layoutname, layout) in layouts :
+        for comp in [ "lzw", "zip" ] :
+            name = fmt + "-" + layoutname + "-" + comp
+            command += oiiotool (pattern + " -d " + fmt + " " + layout
+                                 + " --compression none -o " + name + "-none.tif"
+                                 + " --compression " + comp + " -o " + name + ".tif")
+            command += "tiffcp -c none " + name + ".tif " + name + "-libtiff.tif ;\n"
+            command += diff_command (name + "-libtiff.tif", name + "-none.tif")
+
+
+# The other direction: have libtiff (tiffcp) write each compression,
+# predictor, and planarconfig, in strips and tiles, and make sure our own
+# decoders read it back. iconvert reads the whole image at once, which
+# decodes the strips or tiles in parallel; idiff reads through the
+# ImageCache.
+for fmt in [ "uint8", "uint16", "float" ] :
+    src = "src-" + fmt + ".tif"
+    command += oiiotool (pattern + " -d " + fmt + " --compression none -o " + src)
+    predictor = "3" if fmt == "float" else "2"
+    for comp in [ "lzw", "lzw:" + predictor, "zip", "zip:" + predictor, "packbits" ] :
+        for planar in [ "contig", "separate" ] :
+            for (layoutname, layout) in [ ("strips", "-r 16"),
+                                          ("tiled", "-t -w 32 -l 32") ] :
+                name = ("libtiff-" + fmt + "-" + comp.replace(":", "-pred")
+                        + "-" + planar + "-" + layoutname)
+                command += ("tiffcp -c " + comp + " -p " + planar + " "
+                            + layout + " " + src + " " + name + ".tif ;\n")
+                command += oiio_app("iconvert") + name + ".tif " + name + "-oiio.tif ;\n"
+                command += diff_command (name + "-oiio.tif", src)
+                command += diff_command (name + ".tif", src)